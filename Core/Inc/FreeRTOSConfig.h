@@ -169,6 +169,26 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+
+/* Run-time stats (rtstats.c): the kernel charges the DWT cycle counter delta
+   to the outgoing task at every switch. main() enables the counter
+   (CYCCNT_Init) before the kernel starts, so there is nothing to configure. */
+#define configGENERATE_RUN_TIME_STATS            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()         ( *( volatile uint32_t * ) 0xE0001004UL ) /* DWT->CYCCNT */
+#define INCLUDE_xTaskGetIdleTaskHandle           1
+
+/* Static allocation profile (rtos_static.h): build with VECU_STATIC_ALLOC=1
+   and without heap_4.c. Every task and queue then has its own static
+   buffer and the kernel cannot allocate at all. */
+#ifndef VECU_STATIC_ALLOC
+#define VECU_STATIC_ALLOC                        0
+#endif
+#if VECU_STATIC_ALLOC
+#undef  configSUPPORT_DYNAMIC_ALLOCATION
+#define configSUPPORT_DYNAMIC_ALLOCATION         0
+#undef  USE_FreeRTOS_HEAP_4
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
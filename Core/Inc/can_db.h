@@ -0,0 +1,222 @@
+/* Generated by Tools/can_db/dbc2c.py from vecu.dbc - do not edit. */
+
+#ifndef CAN_DB_H
+#define CAN_DB_H
+
+#include <stdint.h>
+
+/*
+ * Module: CAN signal database (can_db)
+ *
+ * Role:
+ *   - ID, DLC, raw signal struct and Pack / Unpack per message.
+ *   - Encode / Decode per signal: physical value <-> raw value
+ *     (phys = raw * scale + offset, saturated to [min, max]).
+ *
+ * Byte order is per signal: Intel (little-endian) or Motorola
+ * (big-endian), as in the DBC. Pack writes all DLC bytes; bits not
+ * covered by a signal are 0.
+ */
+
+/* --------------------------------------------------------------------------
+ * VehicleTelemetry (0x100, DLC 6, sent by VECU)
+ * Periodic vehicle state, sent by VehicleTask every 100 ms.
+ * -------------------------------------------------------------------------- */
+
+#define CAN_DB_VEHICLE_TELEMETRY_ID        0x100U
+#define CAN_DB_VEHICLE_TELEMETRY_IDE       0U
+#define CAN_DB_VEHICLE_TELEMETRY_DLC       6U
+
+typedef struct
+{
+    uint16_t  speed;           /**< unsigned 7|16 Motorola, x0.1+0 km/h */
+    uint16_t  engine_rpm;      /**< unsigned 23|16 Motorola, x1+0 rpm */
+    int16_t   coolant_temp;    /**< signed 39|16 Motorola, x0.1+0 degC */
+} CAN_DB_VehicleTelemetry_t;
+
+static inline void CAN_DB_VehicleTelemetry_Pack(uint8_t data[CAN_DB_VEHICLE_TELEMETRY_DLC],
+                                                 const CAN_DB_VehicleTelemetry_t *m)
+{
+    data[0] = (uint8_t)(((uint16_t)m->speed >> 8));
+    data[1] = (uint8_t)((uint16_t)m->speed);
+    data[2] = (uint8_t)(((uint16_t)m->engine_rpm >> 8));
+    data[3] = (uint8_t)((uint16_t)m->engine_rpm);
+    data[4] = (uint8_t)(((uint16_t)m->coolant_temp >> 8));
+    data[5] = (uint8_t)((uint16_t)m->coolant_temp);
+}
+
+static inline void CAN_DB_VehicleTelemetry_Unpack(CAN_DB_VehicleTelemetry_t *m,
+                                                   const uint8_t data[CAN_DB_VEHICLE_TELEMETRY_DLC])
+{
+    m->speed = (uint16_t)(((uint16_t)data[0] << 8) | (uint16_t)data[1]);
+    m->engine_rpm = (uint16_t)(((uint16_t)data[2] << 8) | (uint16_t)data[3]);
+    m->coolant_temp = (int16_t)(((uint16_t)data[4] << 8) | (uint16_t)data[5]);
+}
+
+static inline float CAN_DB_VehicleTelemetry_Speed_Decode(uint16_t raw)
+{
+    return (float)raw * 0.1f;
+}
+
+static inline uint16_t CAN_DB_VehicleTelemetry_Speed_Encode(float phys)
+{
+    float x = phys / 0.1f;
+
+    if (x <= 0.0f) return (uint16_t)0U;
+    if (x >= 65535.0f) return (uint16_t)65535U;
+    return (uint16_t)(x + 0.5f);
+}
+
+static inline float CAN_DB_VehicleTelemetry_EngineRpm_Decode(uint16_t raw)
+{
+    return (float)raw;
+}
+
+static inline uint16_t CAN_DB_VehicleTelemetry_EngineRpm_Encode(float phys)
+{
+    float x = phys;
+
+    if (x <= 0.0f) return (uint16_t)0U;
+    if (x >= 65535.0f) return (uint16_t)65535U;
+    return (uint16_t)(x + 0.5f);
+}
+
+static inline float CAN_DB_VehicleTelemetry_CoolantTemp_Decode(int16_t raw)
+{
+    return (float)raw * 0.1f;
+}
+
+static inline int16_t CAN_DB_VehicleTelemetry_CoolantTemp_Encode(float phys)
+{
+    float x = phys / 0.1f;
+
+    if (x <= -32768.0f) return (int16_t)-32768;
+    if (x >= 32767.0f) return (int16_t)32767;
+    return (int16_t)((x < 0.0f) ? (x - 0.5f) : (x + 0.5f));
+}
+
+/* --------------------------------------------------------------------------
+ * VehicleCommand (0x080, DLC 3, sent by HOST)
+ * Control frame (FIFO1 range 0x000-0x0FF).
+ * -------------------------------------------------------------------------- */
+
+#define CAN_DB_VEHICLE_COMMAND_ID        0x080U
+#define CAN_DB_VEHICLE_COMMAND_IDE       0U
+#define CAN_DB_VEHICLE_COMMAND_DLC       3U
+#define CAN_DB_VEHICLE_COMMAND_CMD_MODE_NONE  0U
+#define CAN_DB_VEHICLE_COMMAND_CMD_MODE_SET_TARGET_SPEED  1U
+
+typedef struct
+{
+    uint16_t  target_speed;    /**< unsigned 0|12 Intel, x0.1+0 km/h */
+    uint8_t   cmd_mode;        /**< unsigned 12|2 Intel, x1+0 */
+    uint8_t   alive_counter;   /**< unsigned 14|4 Intel, x1+0 */
+    int8_t    accel_limit;     /**< signed 18|6 Intel, x0.5+0 km/h/s */
+} CAN_DB_VehicleCommand_t;
+
+static inline void CAN_DB_VehicleCommand_Pack(uint8_t data[CAN_DB_VEHICLE_COMMAND_DLC],
+                                               const CAN_DB_VehicleCommand_t *m)
+{
+    data[0] = (uint8_t)((uint16_t)m->target_speed);
+    data[1] = (uint8_t)((((uint16_t)m->target_speed >> 8) & 0xFU) | (((uint8_t)m->cmd_mode & 0x3U) << 4) | (((uint8_t)m->alive_counter & 0x3U) << 6));
+    data[2] = (uint8_t)((((uint8_t)m->alive_counter >> 2) & 0x3U) | (((uint8_t)m->accel_limit & 0x3FU) << 2));
+}
+
+static inline void CAN_DB_VehicleCommand_Unpack(CAN_DB_VehicleCommand_t *m,
+                                                 const uint8_t data[CAN_DB_VEHICLE_COMMAND_DLC])
+{
+    m->target_speed = (uint16_t)((uint16_t)data[0] | ((uint16_t)(data[1] & 0xFU) << 8));
+    m->cmd_mode = (uint8_t)((data[1] >> 4) & 0x3U);
+    m->alive_counter = (uint8_t)((uint8_t)(data[1] >> 6) | ((uint8_t)(data[2] & 0x3U) << 2));
+    m->accel_limit = (int8_t)(((int32_t)((uint8_t)(data[2] >> 2)) ^ 0x20) - 0x20);
+}
+
+static inline float CAN_DB_VehicleCommand_TargetSpeed_Decode(uint16_t raw)
+{
+    return (float)raw * 0.1f;
+}
+
+static inline uint16_t CAN_DB_VehicleCommand_TargetSpeed_Encode(float phys)
+{
+    float x = phys / 0.1f;
+
+    if (x <= 0.0f) return (uint16_t)0U;
+    if (x >= 4095.0f) return (uint16_t)4095U;
+    return (uint16_t)(x + 0.5f);
+}
+
+static inline float CAN_DB_VehicleCommand_CmdMode_Decode(uint8_t raw)
+{
+    return (float)raw;
+}
+
+static inline uint8_t CAN_DB_VehicleCommand_CmdMode_Encode(float phys)
+{
+    float x = phys;
+
+    if (x <= 0.0f) return (uint8_t)0U;
+    if (x >= 3.0f) return (uint8_t)3U;
+    return (uint8_t)(x + 0.5f);
+}
+
+static inline float CAN_DB_VehicleCommand_AliveCounter_Decode(uint8_t raw)
+{
+    return (float)raw;
+}
+
+static inline uint8_t CAN_DB_VehicleCommand_AliveCounter_Encode(float phys)
+{
+    float x = phys;
+
+    if (x <= 0.0f) return (uint8_t)0U;
+    if (x >= 15.0f) return (uint8_t)15U;
+    return (uint8_t)(x + 0.5f);
+}
+
+static inline float CAN_DB_VehicleCommand_AccelLimit_Decode(int8_t raw)
+{
+    return (float)raw * 0.5f;
+}
+
+static inline int8_t CAN_DB_VehicleCommand_AccelLimit_Encode(float phys)
+{
+    float x = phys / 0.5f;
+
+    if (x <= -32.0f) return (int8_t)-32;
+    if (x >= 31.0f) return (int8_t)31;
+    return (int8_t)((x < 0.0f) ? (x - 0.5f) : (x + 0.5f));
+}
+
+/* --------------------------------------------------------------------------
+ * Signal descriptors (define CAN_DB_DESCRIPTORS in one translation unit)
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uint32_t    msg_id;     /**< Message ID                               */
+    const char *name;       /**< Message.Signal                           */
+    uint8_t     start;      /**< DBC start bit                            */
+    uint8_t     length;     /**< Bits                                     */
+    uint8_t     intel;      /**< 1 = little-endian, 0 = big-endian        */
+    uint8_t     is_signed;  /**< 1 = two's complement                     */
+    float       scale;
+    float       offset;
+    float       minimum;
+    float       maximum;
+} CAN_DB_SignalDesc_t;
+
+#define CAN_DB_SIGNAL_COUNT  7U
+
+#ifdef CAN_DB_DESCRIPTORS
+static const CAN_DB_SignalDesc_t CAN_DB_Signals[CAN_DB_SIGNAL_COUNT] = {
+    { 0x100U, "VehicleTelemetry.Speed", 7, 16, 0, 0, 0.1f, 0.0f, 0.0f, 6553.5f },
+    { 0x100U, "VehicleTelemetry.EngineRpm", 23, 16, 0, 0, 1.0f, 0.0f, 0.0f, 65535.0f },
+    { 0x100U, "VehicleTelemetry.CoolantTemp", 39, 16, 0, 1, 0.1f, 0.0f, -3276.8f, 3276.7f },
+    { 0x080U, "VehicleCommand.TargetSpeed", 0, 12, 1, 0, 0.1f, 0.0f, 0.0f, 409.5f },
+    { 0x080U, "VehicleCommand.CmdMode", 12, 2, 1, 0, 1.0f, 0.0f, 0.0f, 3.0f },
+    { 0x080U, "VehicleCommand.AliveCounter", 14, 4, 1, 0, 1.0f, 0.0f, 0.0f, 15.0f },
+    { 0x080U, "VehicleCommand.AccelLimit", 18, 6, 1, 1, 0.5f, 0.0f, -16.0f, 15.5f },
+};
+#endif /* CAN_DB_DESCRIPTORS */
+
+#endif /* CAN_DB_H */
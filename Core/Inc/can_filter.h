@@ -0,0 +1,114 @@
+#ifndef CAN_FILTER_H
+#define CAN_FILTER_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Module: CAN filter compiler (can_filter)
+ *
+ * Role:
+ *   - Turns a table of accepted IDs / ID ranges, each with a target RX FIFO,
+ *     into bxCAN filter bank settings, so unwanted frames are rejected in
+ *     hardware and high-priority IDs get their own FIFO.
+ *   - Keeps the FMI (filter match index) -> rule mapping, so software can
+ *     tell which rule accepted a frame without comparing IDs again.
+ *
+ * Compilation:
+ *   - A range is split into aligned power-of-two blocks, which cover it
+ *     exactly. Single IDs become list entries and larger blocks become mask
+ *     entries.
+ *   - 11-bit IDs use 16-bit scale: 4 IDs per bank in list mode, or 2
+ *     ID/mask pairs per bank in mask mode.
+ *   - 29-bit IDs use 32-bit scale: 2 IDs per bank in list mode, or 1
+ *     ID/mask pair per bank in mask mode.
+ *   - Entries only match data frames of their own ID type (the IDE and RTR
+ *     bits are compared).
+ *   - Banks are packed FIFO1 first, then FIFO0. Unused slots repeat the
+ *     bank's last entry.
+ *
+ * Overlapping rules follow the hardware match priority: 32-bit beats
+ * 16-bit, list beats mask, and a lower bank beats a higher one. Within one
+ * ID type this means an exact ID beats a range. Between two overlapping
+ * ranges, the FIFO1 range wins because FIFO1 banks come first.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial filter compiler (27 banks, list/mask, 16/32-bit).
+ */
+
+/* CAN1 and CAN2 share 28 banks; CAN2 starts at SlaveStartFilterBank, which
+   the HAL limits to 27, so CAN1 gets banks 0..26 and bank 27 stays unused */
+#define CAN_FILTER_BANKS       27U                      /**< Banks owned by CAN1   */
+#define CAN_FILTER_MAX_FMI     (CAN_FILTER_BANKS * 4U)  /**< Per FIFO             */
+#define CAN_FILTER_MAX_RULES   255U
+#define CAN_FILTER_NO_RULE     0xFFU
+
+/**
+ * @brief One accepted ID or inclusive ID range.
+ */
+typedef struct
+{
+    uint32_t id_first;     /**< First accepted ID                         */
+    uint32_t id_last;      /**< Last accepted ID (== id_first for one ID) */
+    uint8_t  extended;     /**< 0 = 11-bit standard, 1 = 29-bit extended  */
+    uint8_t  fifo;         /**< CAN_FILTER_FIFO0 or CAN_FILTER_FIFO1      */
+} CAN_FILTER_Rule_t;
+
+/**
+ * @brief One compiled bank, in FxR1/FxR2 register layout.
+ */
+typedef struct
+{
+    uint32_t fr1;
+    uint32_t fr2;
+    uint8_t  fifo;         /**< CAN_FILTER_FIFO0 / CAN_FILTER_FIFO1 */
+    uint8_t  list_mode;    /**< 1 = identifier list, 0 = mask       */
+    uint8_t  scale32;      /**< 1 = 32-bit, 0 = 16-bit              */
+} CAN_FILTER_Bank_t;
+
+/**
+ * @brief Result of CAN_FILTER_Compile().
+ */
+typedef struct
+{
+    CAN_FILTER_Bank_t bank[CAN_FILTER_BANKS];
+    uint8_t  bank_count;                          /**< Banks in use (from bank 0) */
+    uint8_t  fmi_count[2];                        /**< FMIs used per FIFO         */
+    uint8_t  fmi_rule[2][CAN_FILTER_MAX_FMI];     /**< FMI -> rule index          */
+} CAN_FILTER_Plan_t;
+
+/**
+ * @brief Compile a rule table into filter banks.
+ *
+ * @param rules  Rule table.
+ * @param count  Number of rules (at most CAN_FILTER_MAX_RULES).
+ * @param plan   Output.
+ * @retval HAL_OK on success. HAL_ERROR if a rule is invalid (ID out of
+ *         range, first > last, bad FIFO) or the table needs more than
+ *         CAN_FILTER_BANKS banks.
+ */
+HAL_StatusTypeDef CAN_FILTER_Compile(const CAN_FILTER_Rule_t *rules,
+                                     uint32_t count,
+                                     CAN_FILTER_Plan_t *plan);
+
+/**
+ * @brief Program a compiled plan into the filter banks and deactivate the
+ *        remaining banks. All banks are assigned to CAN1.
+ *
+ * @param hcan  CAN handle (state READY or LISTENING).
+ * @param plan  Compiled plan.
+ * @retval HAL status of the first failing HAL_CAN_ConfigFilter(), or HAL_OK.
+ */
+HAL_StatusTypeDef CAN_FILTER_Apply(CAN_HandleTypeDef *hcan, const CAN_FILTER_Plan_t *plan);
+
+/**
+ * @brief Rule that produced a filter match.
+ *
+ * @param plan  Plan that is programmed.
+ * @param fifo  CAN_RX_FIFO0 / CAN_RX_FIFO1.
+ * @param fmi   CAN_RxHeaderTypeDef::FilterMatchIndex.
+ * @return Rule index, or -1 if the FMI is not part of the plan.
+ */
+int32_t CAN_FILTER_RuleForFmi(const CAN_FILTER_Plan_t *plan, uint32_t fifo, uint32_t fmi);
+
+#endif /* CAN_FILTER_H */
@@ -4,6 +4,7 @@
 #include "main.h"
 #include "cmsis_os2.h"
 #include "vehicle.h"
+#include "can_filter.h"
 #include <stdint.h>
 
 /*
@@ -11,15 +12,77 @@
  *
  * Role:
  *   - Wraps low-level HAL CAN access behind a small, testable API.
- *   - Owns the RX message queue used by the CanRxTask.
- *   - Encodes/decodes a simple telemetry frame from VehicleState_t.
+ *   - Programs the RX hardware filters from an ID/range table (can_filter).
+ *   - Owns one RX ring per hardware FIFO: FIFO0 (bulk traffic, CanRxTask)
+ *     and FIFO1 (control IDs, CanCtrlTask), each with its own ISR.
+ *   - Queues outgoing frames in CAN-ID priority order in front of the three
+ *     TX mailboxes, refilled from the TX-mailbox-empty interrupt.
+ *   - Encodes/decodes a simple telemetry frame from VehicleState_t, using
+ *     the codec generated from the signal database (can_db.h).
  *
  * Version history (module-level):
  *   v2.0 - Initial CAN loopback + basic send helper.
  *   v2.1 - Added RX queue, ISR → RTOS hand-off, logging control.
  *   v2.2 - Integrated with VehicleState_t telemetry encoding.
+ *   v2.4 - Lock-free SPSC RX ring (zero-copy, thread-flag wakeup) replacing
+ *          the osMessageQueue; RX statistics with ISR-to-task latency.
+ *        - RX ISR drains all pending FIFO0 frames per interrupt as one batch
+ *          (one head update, at most one wakeup); per-frame DWT stamps;
+ *          CAN_IF_RxFrameCallback() hook.
+ *        - Both RX FIFOs: compiled filter table (CAN_IF_ConfigFilters()),
+ *          control IDs routed to FIFO1 with its own ISR, ring and task
+ *          (same NVIC priority as FIFO0); extended IDs, FIFO and FMI
+ *          recorded per frame.
+ *        - Telemetry packed / RX frames decoded with the generated can_db.h
+ *          codec (Tools/can_db/vecu.dbc).
+ *        - Non-blocking CAN_IF_Send() into a priority-ordered TX queue; the
+ *          TX ISR refills the mailboxes and preempts a higher-ID frame when
+ *          all three are busy; TX statistics.
  */
 
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* RX ring depths in frames (FIFO0 / FIFO1); must be powers of two */
+#ifndef CAN_IF_RX_RING_LEN
+#define CAN_IF_RX_RING_LEN   32U
+#endif
+#ifndef CAN_IF_RX1_RING_LEN
+#define CAN_IF_RX1_RING_LEN  8U
+#endif
+
+/* Standard IDs the default filter table routes to FIFO1 (control traffic) */
+#define CAN_IF_CTRL_ID_FIRST 0x000U
+#define CAN_IF_CTRL_ID_LAST  0x0FFU
+
+/*
+ * 1 = previous RX path: 8-deep osMessageQueue, one copy in and one copy out.
+ * Kept as a build option for comparison benchmarks (bench_canrx_queue).
+ * Applies to FIFO0 only; FIFO1 always uses its ring.
+ */
+#ifndef CAN_IF_RX_QUEUE
+#define CAN_IF_RX_QUEUE      0
+#endif
+
+/* Frames CAN_IF_Send() can hold beyond the three TX mailboxes */
+#ifndef CAN_IF_TX_QUEUE_LEN
+#define CAN_IF_TX_QUEUE_LEN  16U
+#endif
+
+/*
+ * 1 = priority-ordered software TX queue (default).
+ * 0 = previous TX path: straight into a free mailbox, HAL_BUSY when all
+ *     three are full, mailboxes served in hardware request order. Kept as a
+ *     build option for comparison benchmarks (bench_cantx_direct).
+ */
+#ifndef CAN_IF_TX_QUEUE
+#define CAN_IF_TX_QUEUE      1
+#endif
+
+/* Thread flag an RX ISR sets on its consumer task */
+#define CAN_IF_RX_FLAG       0x0001U
+
 /* --------------------------------------------------------------------------
  * CAN interface types
  * -------------------------------------------------------------------------- */
@@ -28,28 +91,68 @@
  * @brief Simple CAN message representation for the interface layer.
  *
  * This type is used by:
- *   - HAL CAN RX ISR (producer)
- *   - CanRxTask (consumer)
+ *   - HAL CAN RX ISRs (producers)
+ *   - CanRxTask / CanCtrlTask (consumers)
  */
 typedef struct
 {
-    uint32_t id;          /**< Standard CAN ID (11-bit) */
-    uint8_t  dlc;         /**< Data Length Code (0–8)   */
-    uint8_t  data[8];     /**< Data bytes               */
+    uint32_t id;          /**< CAN ID (11-bit, or 29-bit if ide)      */
+    uint8_t  dlc;         /**< Data Length Code (0–8)                 */
+    uint8_t  ide;         /**< 1 = extended (29-bit) ID               */
+    uint8_t  fifo;        /**< Hardware FIFO the frame came from      */
+    uint8_t  fmi;         /**< Filter match index (see CAN_IF_RxRule) */
+    uint8_t  data[8];     /**< Data bytes (only dlc are valid)        */
+    uint32_t rx_cyc;      /**< CYCCNT when the ISR drained the frame  */
 } CAN_IF_Msg_t;
 
+/**
+ * @brief RX path counters (one set per FIFO).
+ *
+ * Latency is measured from the ISR draining a frame (CAN_IF_Msg_t::rx_cyc)
+ * to CAN_IF_RxGet() returning it, in core cycles (cyccnt.h).
+ */
+typedef struct
+{
+    uint32_t received;      /**< Frames stored by the ISR                 */
+    uint32_t dropped;       /**< Frames lost because the ring was full    */
+    uint32_t processed;     /**< Frames returned by CAN_IF_RxGet()        */
+    uint32_t wakeups;       /**< Thread-flag notifications sent by the ISR
+                                 (not counted with CAN_IF_RX_QUEUE)      */
+    uint32_t high_water;    /**< Most frames waiting at once              */
+    uint32_t batches;       /**< ISR runs that stored at least one frame  */
+    uint32_t batch_max;     /**< Most frames drained by one ISR run       */
+    uint32_t lat_min_cyc;   /**< Shortest ISR-to-task latency             */
+    uint32_t lat_max_cyc;   /**< Longest ISR-to-task latency              */
+    uint64_t lat_sum_cyc;   /**< Sum of latencies (avg = sum / processed) */
+} CAN_IF_RxStats_t;
+
+/**
+ * @brief TX path counters.
+ */
+typedef struct
+{
+    uint32_t queued;        /**< Frames accepted by CAN_IF_Send()          */
+    uint32_t rejected;      /**< Frames refused with HAL_BUSY (queue full) */
+    uint32_t sent;          /**< Frames confirmed on the bus               */
+    uint32_t preempted;     /**< Mailbox aborts to let a lower ID go first */
+    uint32_t errors;        /**< Frames dropped by a transmit error        */
+    uint32_t high_water;    /**< Most frames waiting in the queue at once  */
+    uint32_t pending;       /**< Frames queued or in a mailbox right now   */
+} CAN_IF_TxStats_t;
+
 /* --------------------------------------------------------------------------
  * Public API
  * -------------------------------------------------------------------------- */
 
 /**
- * @brief Initialize CAN application layer: filters, start, notifications, RX queue.
+ * @brief Initialize CAN application layer: filters, start, notifications, RX ring.
  *
  * Steps:
- *   - Configure a simple "accept all" filter into FIFO0.
+ *   - Program the default filter table: standard IDs CAN_IF_CTRL_ID_FIRST..
+ *     CAN_IF_CTRL_ID_LAST into FIFO1, all other IDs into FIFO0.
+ *   - Reset both RX rings.
  *   - Start the CAN peripheral (assumes low-level init done in MX_CAN1_Init()).
- *   - Enable RX and error notifications.
- *   - Create the RX message queue used by CanRxTask.
+ *   - Enable RX (both FIFOs), TX-mailbox-empty and error notifications.
  *
  * @retval HAL_OK on success, error status otherwise.
  */
@@ -58,7 +161,8 @@ HAL_StatusTypeDef CAN_IF_Init(void);
 /**
  * @brief Send a telemetry CAN frame with the current vehicle state.
  *
- * Encodes:
+ * Packs message VehicleTelemetry (ID 0x100, DLC 6) with
+ * CAN_DB_VehicleTelemetry_Pack(); all signals are big-endian (Motorola):
  *   - speed_kph * 10 (uint16_t)
  *   - engine_rpm     (uint16_t)
  *   - coolant_temp_c * 10 (int16_t)
@@ -68,6 +172,34 @@ HAL_StatusTypeDef CAN_IF_Init(void);
  */
 HAL_StatusTypeDef CAN_IF_SendTelemetry(const VehicleState_t *vs);
 
+/**
+ * @brief Queue a data frame for transmission. Never blocks.
+ *
+ * Frames leave in bus arbitration order: lowest ID first, a standard ID
+ * before an extended ID with the same 11 base bits, equal IDs in the order
+ * they were sent. When all three mailboxes are busy and the new head of the
+ * queue has a lower ID than one of them, that mailbox is aborted and its
+ * frame requeued, so a low ID never waits behind higher IDs.
+ *
+ * Callable from tasks and from ISRs at or below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ *
+ * @param id    11-bit or 29-bit identifier.
+ * @param ide   0 = standard, 1 = extended.
+ * @param data  Payload (dlc bytes; may be NULL if dlc is 0).
+ * @param dlc   0..8.
+ * @retval HAL_OK if queued, HAL_BUSY if the queue is full (counted in
+ *         CAN_IF_TxStats_t::rejected), HAL_ERROR on bad arguments.
+ */
+HAL_StatusTypeDef CAN_IF_Send(uint32_t id, uint8_t ide, const uint8_t *data, uint8_t dlc);
+
+/**
+ * @brief Copy the TX path counters.
+ *
+ * @param out Destination.
+ */
+void CAN_IF_GetTxStats(CAN_IF_TxStats_t *out);
+
 /**
  * @brief Enable/disable CAN RX logging over UART.
  *
@@ -78,22 +210,78 @@ HAL_StatusTypeDef CAN_IF_SendTelemetry(const VehicleState_t *vs);
 void CAN_IF_SetLogging(uint8_t enable);
 
 /**
- * @brief Get the handle to the CAN RX message queue.
+ * @brief Wait for the next frame received through one FIFO and return it
+ *        in place.
+ *
+ * Each FIFO has a single consumer task (FIFO0: CanRxTask, FIFO1:
+ * CanCtrlTask). The frame stays in the RX ring, and is valid, until
+ * CAN_IF_RxRelease(). The first call registers the calling thread as the
+ * one that FIFO's ISR notifies; the ISR only sets CAN_IF_RX_FLAG when the
+ * ring goes from empty to non-empty.
+ *
+ * @param fifo     CAN_RX_FIFO0 or CAN_RX_FIFO1.
+ * @param timeout  CMSIS-RTOS2 timeout in ticks (osWaitForever to block).
+ * @return Oldest unreleased frame, or NULL on timeout / bad FIFO.
+ */
+const CAN_IF_Msg_t *CAN_IF_RxGet(uint32_t fifo, uint32_t timeout);
+
+/**
+ * @brief Hand the frame returned by CAN_IF_RxGet() back to the ISR.
+ *
+ * @param fifo Same FIFO as the CAN_IF_RxGet() call.
+ */
+void CAN_IF_RxRelease(uint32_t fifo);
+
+/**
+ * @brief Copy the RX path counters of one FIFO.
  *
- * CanRxTask blocks on this queue and receives CAN_IF_Msg_t messages.
+ * @param fifo CAN_RX_FIFO0 or CAN_RX_FIFO1.
+ * @param out  Destination.
+ */
+void CAN_IF_GetRxStats(uint32_t fifo, CAN_IF_RxStats_t *out);
+
+/**
+ * @brief Replace the RX filter table.
+ *
+ * Compiles the table (can_filter.h) and programs all 27 CAN1 banks. Call while
+ * the CAN peripheral is stopped or before CAN_IF_Init() returns; the HAL
+ * only accepts filter changes in READY / LISTENING state.
+ *
+ * @param rules  Accepted IDs / ranges with their target FIFO.
+ * @param count  Number of rules.
+ * @retval HAL_OK, or HAL_ERROR if the table is invalid or too large.
+ */
+HAL_StatusTypeDef CAN_IF_ConfigFilters(const CAN_FILTER_Rule_t *rules, uint32_t count);
+
+/**
+ * @brief Index of the filter rule that accepted a frame (from its FMI).
  *
- * @return osMessageQueueId_t of the RX queue, or NULL if init failed.
+ * @param msg Received frame.
+ * @return Rule index in the table passed to CAN_IF_ConfigFilters(), or -1.
  */
-osMessageQueueId_t CAN_IF_GetRxQueueHandle(void);
+int32_t CAN_IF_RxRule(const CAN_IF_Msg_t *msg);
 
 /**
  * @brief Process a received CAN message (decode/log/etc).
  *
- * Called from CanRxTask at thread level, not from ISR.
- * Current implementation just logs the frame when logging is enabled.
+ * Called at thread level, not from ISR: by CanRxTask for FIFO0 frames and
+ * by CanCtrlTask for FIFO1 frames. Runs CAN_IF_RxFrameCallback(), passes
+ * the frame to HOSTLINK_CanFrame() and, when logging is enabled, logs it
+ * together with its can_db.h decoding.
  *
  * @param msg Pointer to a valid CAN_IF_Msg_t.
  */
 void CAN_IF_ProcessRxMsg(const CAN_IF_Msg_t *msg);
 
+/**
+ * @brief Per-frame hook, called by CAN_IF_ProcessRxMsg() at thread level.
+ *
+ * Weak, empty by default (HAL callback style). Override it to consume
+ * frames, e.g. to measure end-to-end latency from msg->rx_cyc or from a
+ * time stamp carried in the payload.
+ *
+ * @param msg Frame being processed (valid until the call returns).
+ */
+void CAN_IF_RxFrameCallback(const CAN_IF_Msg_t *msg);
+
 #endif /* CAN_IF_H */
@@ -2,43 +2,205 @@
 #define CLI_IF_H
 
 #include "main.h"
+#include "cmsis_os2.h"
 #include "vehicle.h"
+#include "vehicle_snap.h"
 
 /*
  * Module: CLI Interface (cli_if)
  *
  * Role:
  *   - Owns a small line-based UART CLI.
- *   - Uses interrupt-driven RX into a ring buffer.
- *   - Parsed in CLI_IF_Task() at thread level.
+ *   - Receives by circular DMA straight into a CLI_IF_RX_LEN ring. The
+ *     DMA half/full transfer and UART IDLE-line events publish whole bursts,
+ *     so there is one interrupt per burst (or half ring) instead of one per
+ *     byte, and nothing has to be re-armed between bytes.
+ *   - Parsed in CLI_IF_Task() at thread level. The RX event wakes the
+ *     CLI task with a thread flag (CLI_IF_WaitRx()), so the task sleeps
+ *     until input arrives instead of polling.
+ *   - Losses are counted, never silent: ring overruns (the task fell more
+ *     than CLI_IF_RX_LEN bytes behind) and UART line errors (ORE/FE/NE).
+ *     A line error restarts reception and discards input not yet read.
  *
- * Example commands (current set):
- *   help          - show built-in help
- *   status        - show basic vehicle state
- *   veh status    - detailed vehicle state view
- *   veh speed X   - set target speed to X km/h
- *   veh cool-hot  - inject coolant overheat
- *   log on/off    - enable/disable CAN RX log printing
+ * Commands:
+ *   - Each module defines its own commands next to the code they drive,
+ *     with CLI_IF_CMD(): name, argument schema, handler and help line.
+ *     The descriptors are const data collected by the linker into one
+ *     table (section "cli_cmds"), so the CLI needs no list of them and
+ *     `help` is generated from the same descriptors.
+ *   - CLI_IF_Init() indexes the table once: an open-addressing hash of
+ *     the names (lookup cost independent of the number of commands) and a
+ *     name-sorted order for `help`. The dispatcher tokenises the line,
+ *     looks up "word1 word2", then "word1", and converts the arguments
+ *     according to the schema before calling the handler.
+ *
+ * Example commands (see CLI_COMMANDS.md; `help` lists them all):
+ *   help, cli stats        - cli_if.c
+ *   status, veh ...        - vehicle_cli.c
+ *   log on/off, can stats  - can_if.c
+ *   log text/bin/stats     - dlog.c
+ *   uart stats             - uart_tx.c
+ *
+ * Version history (module-level):
+ *   v2.4 - Event-driven: RX ISR wakes the CLI task (thread flag).
+ *        - Circular DMA RX with IDLE-line detection; RX error counters.
+ *        - Table-driven dispatch: modules register command descriptors
+ *          (CLI_IF_CMD), looked up through a hash index.
+ *        - RX hook for binary protocols on the CLI UART (hostlink).
+ *        - Vehicle snapshot binding: commands read a consistent state.
+ *        - No vehicle state pointer: control commands go through the
+ *          vehicle command mailbox (vehicle_cmd.h).
+ *        - Line editor time per input character in a probe (probe.h).
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/*
+ * 1 = circular DMA reception with IDLE-line events (default).
+ * 0 = previous behaviour: one HAL_UART_Receive_IT() interrupt per byte.
+ *     Kept as a build option for comparison benchmarks (bench_clirx_it).
+ */
+#ifndef CLI_IF_RX_DMA
+#define CLI_IF_RX_DMA      1
+#endif
+
+/* RX ring / DMA buffer size in bytes; must be a power of two. The task must
+   drain it within CLI_IF_RX_LEN byte times (5.5 ms at 921600 baud). */
+#ifndef CLI_IF_RX_LEN
+#define CLI_IF_RX_LEN      512U
+#endif
+
+/* Thread flag the RX ISR sets on the CLI task */
+#define CLI_IF_RX_FLAG     0x0001U
+
+/*
+ * 0  = CLI_IF_WaitRx() blocks until the RX ISR signals input (default).
+ * >0 = previous behaviour: CLI_IF_WaitRx() sleeps this many ms and returns,
+ *      whether or not input arrived. Kept as a build option for comparison
+ *      benchmarks (bench_cli_poll).
+ */
+#ifndef CLI_IF_POLL_MS
+#define CLI_IF_POLL_MS     0U
+#endif
+
+/* Command index size (power of two); holds CLI_IF_HASH_SLOTS / 2 commands */
+#ifndef CLI_IF_HASH_SLOTS
+#define CLI_IF_HASH_SLOTS  512U
+#endif
+
+/* Longest command line, and most arguments after the command name */
+#define CLI_IF_LINE_LEN    64U
+#define CLI_IF_MAX_ARGS    6U
+
+/* --------------------------------------------------------------------------
+ * Command registration
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief One converted argument; the member follows the schema type.
+ */
+typedef union
+{
+    uint32_t    u;          /**< 'u': unsigned decimal or 0x hex          */
+    int32_t     i;          /**< 'i': signed decimal                      */
+    float       f;          /**< 'f': decimal with optional fraction      */
+    const char *s;          /**< 's': one word, as typed                  */
+} CLI_IF_Arg_t;
+
+/**
+ * @brief Arguments passed to a command handler.
+ */
+typedef struct
+{
+    uint32_t     argc;
+    CLI_IF_Arg_t argv[CLI_IF_MAX_ARGS];
+} CLI_IF_Args_t;
+
+typedef void (*CLI_IF_Handler_t)(const CLI_IF_Args_t *args);
+
+/**
+ * @brief Command descriptor. Define with CLI_IF_CMD(), never at run time.
+ *
+ * The argument schema lists one "type:name" per argument, separated by
+ * spaces, e.g. "f:kph" or "u:id u:len". Types are u, i, f and s (see
+ * CLI_IF_Arg_t); the names are only used for usage and help text. The
+ * line must supply exactly these arguments.
+ *
+ * Replies start on a fresh line; the dispatcher prints the prompt after
+ * the handler returns. End every line of output with "\r\n".
+ */
+typedef struct
+{
+    const char      *name;      /**< One word, or two separated by a space */
+    const char      *args;      /**< Argument schema, "" for none          */
+    CLI_IF_Handler_t handler;
+    const char      *help;      /**< One line for `help`; NULL hides it    */
+} CLI_IF_Cmd_t;
+
+/**
+ * @brief Register a command (file scope, in the module that owns it).
+ *
+ * @param ident   C identifier, unique in the program (names the descriptor).
+ * @param name    Command name, e.g. "veh speed".
+ * @param args    Argument schema, e.g. "f:kph".
+ * @param handler void handler(const CLI_IF_Args_t *args).
+ * @param help    Help line, or NULL.
+ *
+ * The alignment pin keeps the compiler from padding descriptors apart, so
+ * the section is a plain array.
+ */
+#define CLI_IF_CMD(ident, name, args, handler, help)                           \
+    static const CLI_IF_Cmd_t cli_cmd_##ident                                  \
+        __attribute__((section("cli_cmds"), used,                              \
+                       aligned(__alignof__(CLI_IF_Cmd_t)))) =                  \
+        { (name), (args), (handler), (help) }
+
+/**
+ * @brief Receiver of raw input while the line editor is bypassed
+ *        (CLI_IF_SetRxHook()). Runs in CliTask.
  */
+typedef void (*CLI_IF_RxHook_t)(uint8_t c);
+
+/**
+ * @brief CLI counters.
+ */
+typedef struct
+{
+    uint32_t rx_bytes;      /**< Bytes received into the RX ring          */
+    uint32_t rx_dropped;    /**< Bytes lost to ring overrun or error reset*/
+    uint32_t rx_events;     /**< RX interrupts that delivered input       */
+    uint32_t rx_idle;       /**< ... of which IDLE-line events (DMA)      */
+    uint32_t rx_overrun;    /**< UART overrun errors (ORE)                */
+    uint32_t rx_framing;    /**< UART framing errors (FE)                 */
+    uint32_t rx_noise;      /**< UART noise / parity errors (NE, PE)      */
+    uint32_t lines;         /**< Command lines parsed                     */
+    uint32_t wakeups;       /**< CLI_IF_WaitRx() returns                  */
+    uint32_t idle_wakeups;  /**< ... of which found no input              */
+} CLI_IF_Stats_t;
 
 /**
  * @brief Initialize the CLI interface.
  *
  * This:
  *   - Stores the UART handle used for CLI (typically &huart2).
- *   - Binds a VehicleState_t pointer for status/diagnostic commands.
- *   - Arms the first UART RX interrupt and prints a greeting/prompt.
+ *   - Binds the published vehicle snapshot (vehicle_snap.h) for status
+ *     commands. Control commands post to the vehicle command mailbox
+ *     (vehicle_cmd.h) and need no binding.
+ *   - Starts reception (circular DMA, or the first RX interrupt) and
+ *     prints a greeting/prompt.
  *
  * @param huart    UART handle used for CLI (e.g., &huart2).
- * @param vehicle  Pointer to global vehicle state to inspect/control.
+ * @param snap     Snapshot published by the vehicle task, to inspect.
  */
-void CLI_IF_Init(UART_HandleTypeDef *huart, VehicleState_t *vehicle);
+void CLI_IF_Init(UART_HandleTypeDef *huart, const VehicleSnap_t *snap);
 
 /**
  * @brief Poll the CLI, process any received characters/commands.
  *
- * Call this frequently from:
- *   - A dedicated RTOS task (recommended), or
+ * Call this from:
+ *   - A dedicated RTOS task after CLI_IF_WaitRx() (recommended), or
  *   - A main() super-loop in a non-RTOS build.
  *
  * This function is non-blocking; it simply drains the ring buffer and
@@ -46,5 +208,66 @@ void CLI_IF_Init(UART_HandleTypeDef *huart, VehicleState_t *vehicle);
  */
 void CLI_IF_Task(void);
 
+/**
+ * @brief Block the calling task until received input is waiting.
+ *
+ * The first caller becomes the task the RX ISR wakes; call it from one
+ * task only. Returns at once if input is already buffered. The ISR only
+ * signals when the ring goes from empty to non-empty, so drain it with
+ * CLI_IF_Task() before waiting again.
+ *
+ * @param timeout Ticks to wait, or osWaitForever.
+ */
+void CLI_IF_WaitRx(uint32_t timeout);
+
+/**
+ * @brief Copy the CLI counters.
+ *
+ * @param out Destination.
+ */
+void CLI_IF_GetStats(CLI_IF_Stats_t *out);
+
+/**
+ * @brief Find a command by its full name.
+ *
+ * @param name Command name, e.g. "veh speed".
+ * @retval Descriptor, or NULL if no such command is registered.
+ */
+const CLI_IF_Cmd_t *CLI_IF_Find(const char *name);
+
+/**
+ * @brief Run one command line (without the line ending).
+ *
+ * Prints the reply, or an error for an unknown command or bad arguments;
+ * does not print the prompt. The line is split into words in place.
+ *
+ * @param line Command line, modified.
+ */
+void CLI_IF_Exec(char *line);
+
+/**
+ * @brief Print part of a reply (command handlers).
+ *
+ * @param s NUL-terminated text.
+ */
+void CLI_IF_Print(const char *s);
+
+/**
+ * @brief Vehicle snapshot bound by CLI_IF_Init() (command handlers).
+ */
+const VehicleSnap_t *CLI_IF_GetVehicleSnap(void);
+
+/**
+ * @brief Hand every received byte to hook instead of the line editor.
+ *
+ * For binary protocols on the CLI UART (hostlink.h). No echo and no
+ * prompt while a hook is set; NULL returns to the line editor. May be
+ * called from a command handler or from the hook itself: the bytes that
+ * follow go to the new receiver.
+ *
+ * @param hook Receiver, or NULL.
+ */
+void CLI_IF_SetRxHook(CLI_IF_RxHook_t hook);
+
 #endif /* CLI_IF_H */
 
@@ -0,0 +1,51 @@
+#ifndef CYCCNT_H
+#define CYCCNT_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Module: Cycle counter (cyccnt)
+ *
+ * Role:
+ *   - Free-running 32-bit core cycle counter (DWT->CYCCNT) for time stamps
+ *     and latency measurement from both tasks and ISRs.
+ *   - Wraps after 2^32 cycles (about 268 s at 16 MHz); differences of two
+ *     readings are valid across one wrap when taken as uint32_t.
+ *
+ * The host build provides Host/Inc/cyccnt.h with the same API, counting
+ * at SystemCoreClock from the host's monotonic clock.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial DWT cycle counter helpers.
+ */
+
+/**
+ * @brief Enable the DWT cycle counter (trace enable + CYCCNTENA) and clear it.
+ *
+ * Call once after SystemClock_Config().
+ */
+static inline void CYCCNT_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Current core cycle count.
+ */
+static inline uint32_t CYCCNT_Read(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Convert a cycle count to microseconds at the current core clock.
+ */
+static inline uint32_t CYCCNT_ToUs(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000U) / SystemCoreClock);
+}
+
+#endif /* CYCCNT_H */
@@ -0,0 +1,153 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+#include "main.h"
+#include "dlog_fmt.h"
+#include <stdint.h>
+
+/*
+ * Module: Deferred binary logger (dlog)
+ *
+ * Role:
+ *   - Call sites record a message ID, a time stamp and up to
+ *     DLOG_MAX_ARGS raw 32-bit arguments into a RAM ring. Nothing is
+ *     formatted and nothing waits for the UART, so a log call costs a slot
+ *     reservation and a few stores.
+ *   - LogTask (low priority) drains the ring with DLOG_Process() and either
+ *     formats each record (text mode, the default) or sends it as a binary
+ *     record for the host decoder (Tools/dlog/dlog_decode.c). The catalog
+ *     of messages and the record format are in dlog_fmt.h.
+ *
+ * Concurrency:
+ *   - Any number of producers (tasks and ISRs at or below
+ *     configMAX_SYSCALL_INTERRUPT_PRIORITY), one consumer. A producer
+ *     reserves a slot by advancing the head with LDREX/STREX, so producers
+ *     never mask interrupts or wait for each other. It fills the slot and
+ *     then publishes it by writing the slot header.
+ *   - The consumer stops at the first reserved slot that is not yet
+ *     published, so records come out in reservation order.
+ *   - A full ring drops the new record and counts it.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial deferred logger (MPSC slot ring, text/binary output).
+ *        - Hold mode: output paused while hostlink owns the UART.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* Ring size in records (slots of 32 bytes); must be a power of two */
+#ifndef DLOG_RING_LEN
+#define DLOG_RING_LEN      64U
+#endif
+
+/* LogTask drain period */
+#ifndef DLOG_DRAIN_MS
+#define DLOG_DRAIN_MS      10U
+#endif
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief How DLOG_Process() sends records to the console UART.
+ */
+typedef enum
+{
+    DLOG_MODE_TEXT = 0,     /**< Formatted on the target (default)        */
+    DLOG_MODE_BINARY,       /**< Binary records, formatted by the host    */
+    DLOG_MODE_HOLD          /**< Nothing sent; records wait in the ring
+                                 (the UART carries another protocol)      */
+} DLOG_Mode_t;
+
+/**
+ * @brief Logger counters.
+ */
+typedef struct
+{
+    uint32_t written;       /**< Records accepted into the ring           */
+    uint32_t dropped;       /**< Records lost to a full ring              */
+    uint32_t emitted;       /**< Records handed to the UART               */
+    uint32_t stalls;        /**< Drains stopped by a full UART TX ring    */
+    uint32_t high_water;    /**< Most records waiting at a drain          */
+    uint32_t pending;       /**< Records waiting right now                */
+} DLOG_Stats_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Record a message. Never blocks, never formats.
+ *
+ * Use the DLOGn() macros rather than calling this directly.
+ *
+ * @param id    Catalog entry (dlog_fmt.h).
+ * @param nargs Number of arguments; must match the catalog.
+ * @param args  Arguments (nargs words).
+ */
+void DLOG_Write(DLOG_FmtId_t id, uint32_t nargs, const uint32_t *args);
+
+#define DLOG0(id)                      DLOG_Write((id), 0U, NULL)
+#define DLOG1(id, a)                   do { const uint32_t dl_[1] = { (uint32_t)(a) };  \
+                                            DLOG_Write((id), 1U, dl_); } while (0)
+#define DLOG2(id, a, b)                do { const uint32_t dl_[2] = { (uint32_t)(a),    \
+                                            (uint32_t)(b) };                            \
+                                            DLOG_Write((id), 2U, dl_); } while (0)
+#define DLOG3(id, a, b, c)             do { const uint32_t dl_[3] = { (uint32_t)(a),    \
+                                            (uint32_t)(b), (uint32_t)(c) };             \
+                                            DLOG_Write((id), 3U, dl_); } while (0)
+#define DLOG4(id, a, b, c, d)          do { const uint32_t dl_[4] = { (uint32_t)(a),    \
+                                            (uint32_t)(b), (uint32_t)(c),               \
+                                            (uint32_t)(d) };                            \
+                                            DLOG_Write((id), 4U, dl_); } while (0)
+#define DLOG5(id, a, b, c, d, e)       do { const uint32_t dl_[5] = { (uint32_t)(a),    \
+                                            (uint32_t)(b), (uint32_t)(c),               \
+                                            (uint32_t)(d), (uint32_t)(e) };             \
+                                            DLOG_Write((id), 5U, dl_); } while (0)
+
+/**
+ * @brief Empty the ring and reset the counters. Call before any producer.
+ */
+void DLOG_Init(void);
+
+/**
+ * @brief Select text or binary output (default DLOG_MODE_TEXT).
+ */
+void DLOG_SetMode(DLOG_Mode_t mode);
+
+/**
+ * @brief Current output mode.
+ */
+DLOG_Mode_t DLOG_GetMode(void);
+
+/**
+ * @brief Send published records to the console UART (uart_tx.h).
+ *
+ * Stops early, without losing the record, when the UART TX ring has no
+ * room for it; the next call continues. Sends nothing in DLOG_MODE_HOLD.
+ * Single consumer: call from LogTask only (or from DLOG_Flush()).
+ *
+ * @return Number of records sent.
+ */
+uint32_t DLOG_Process(void);
+
+/**
+ * @brief Send everything published, waiting for the UART. Fatal paths only.
+ *
+ * Uses UART_TX_Flush() whenever the UART TX ring is full, so it also works
+ * with interrupts disabled, e.g. just before Error_Handler(). Sends text in
+ * DLOG_MODE_HOLD.
+ */
+void DLOG_Flush(void);
+
+/**
+ * @brief Copy the logger counters.
+ *
+ * @param out Destination.
+ */
+void DLOG_GetStats(DLOG_Stats_t *out);
+
+#endif /* DLOG_H */
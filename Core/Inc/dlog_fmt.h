@@ -0,0 +1,147 @@
+#ifndef DLOG_FMT_H
+#define DLOG_FMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Module: Deferred log catalog and record format (dlog_fmt)
+ *
+ * Role:
+ *   - The message catalog: every deferred log message has a numeric ID,
+ *     a fixed argument count and a format string. Only the ID and the raw
+ *     32-bit arguments are recorded at the call site (dlog.h); the text is
+ *     produced later, by LogTask on the target or by the host decoder
+ *     (Tools/dlog/dlog_decode.c). Both use this file, so the output is the
+ *     same wherever a record is formatted.
+ *   - The binary record encoding used on the UART in binary mode.
+ *
+ * Format strings accept a small printf subset, all on uint32_t arguments:
+ *   %u %d %x %X %c %%   with optional '0' flag and field width
+ *   %.Nu %.Nd           fixed point: the value is in units of 10^-N and is
+ *                       printed with N decimals (-5 with %.1d is "-0.5")
+ *   %*H                 hex dump: takes a byte count (0..8) and two words
+ *                       holding bytes 0..3 and 4..7 (little-endian), and
+ *                       prints each byte as "%02X "
+ *
+ * Binary record (little-endian):
+ *   [0]      DLOG_SYNC
+ *   [1]      argument count n
+ *   [2..3]   message ID
+ *   [4..7]   time stamp (core cycles, cyccnt.h)
+ *   [8..]    n arguments, 4 bytes each
+ *   [8+4n]   check byte: two's complement of the sum of bytes 1..7+4n
+ * Plain text may surround records on the same stream (CLI output); a
+ * decoder passes through any byte that does not start a valid record.
+ *
+ * Adding a message: append an entry to DLOG_CATALOG. IDs are positions in
+ * the list, so append only; captures made with an older catalog then still
+ * decode.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial catalog: CAN_IF start-up and CAN RX log.
+ *        - Vehicle command trace (vehicle_cmd.h).
+ *        - Scheduler overruns (sched_tt.h).
+ *        - Low stack / heap warnings (memmon.h).
+ */
+
+/* --------------------------------------------------------------------------
+ * Catalog: X(name, argument count, format)
+ * -------------------------------------------------------------------------- */
+
+#define DLOG_CATALOG(X)                                                                      \
+    X(DLOG_CAN_FILTERS,   3, "CAN_IF: ConfigFilters status=%d banks=%u err=0x%08X\r\n")       \
+    X(DLOG_CAN_START,     3, "CAN_IF: Start status=%d state=%u err=0x%08X\r\n")               \
+    X(DLOG_CAN_NOTIFY,    2, "CAN_IF: ActivateNotification status=%d err=0x%08X\r\n")         \
+    X(DLOG_CAN_RXQ_FAIL,  0, "CAN_IF: Failed to create RX queue\r\n")                         \
+    X(DLOG_CAN_RX_STD,    5, "CAN RX: ID=0x%03X DLC=%u Data=%*H\r\n")                         \
+    X(DLOG_CAN_RX_EXT,    5, "CAN RX: ID=0x%08X DLC=%u Data=%*H\r\n")                         \
+    X(DLOG_CAN_TELEMETRY, 3, "  Telemetry: speed=%.1u kph rpm=%u coolant=%.1d C\r\n")        \
+    X(DLOG_CAN_COMMAND,   4, "  Command: mode=%u target=%.1u kph accel_limit=%.1d kph/s"      \
+                             " alive=%u\r\n")                                                 \
+    X(DLOG_VEH_TARGET,    2, "VEH: step=%u target=%.1d kph\r\n")                              \
+    X(DLOG_VEH_FORCE,     4, "VEH: step=%u force speed=%.1d kph rpm=%u coolant=%.1d C\r\n")   \
+    X(DLOG_VEH_COOLANT,   2, "VEH: step=%u force coolant=%.1d C\r\n")                         \
+    X(DLOG_SCHED_OVERRUN, 3, "SCHED: tick=%u slot=%u overran its period (%u us)\r\n")         \
+    X(DLOG_MEM_STACK_LOW, 3, "MEM: task %u (see mem) has %u of %u stack bytes left\r\n")      \
+    X(DLOG_MEM_MSP_LOW,   2, "MEM: main stack has %u of %u bytes left\r\n")                   \
+    X(DLOG_MEM_HEAP_LOW,  2, "MEM: heap went down to %u of %u bytes free\r\n")
+
+#define DLOG_FMT_ENUM(name, nargs, fmt)  name,
+
+typedef enum
+{
+    DLOG_CATALOG(DLOG_FMT_ENUM)
+    DLOG_FMT_COUNT
+} DLOG_FmtId_t;
+
+#undef DLOG_FMT_ENUM
+
+/* --------------------------------------------------------------------------
+ * Records
+ * -------------------------------------------------------------------------- */
+
+#define DLOG_MAX_ARGS      6U
+#define DLOG_SYNC          0x1EU                          /**< ASCII RS        */
+#define DLOG_WIRE_MAX      (9U + 4U * DLOG_MAX_ARGS)      /**< Encoded bytes   */
+#define DLOG_TEXT_MAX      192U                           /**< Formatted line  */
+
+/**
+ * @brief One decoded record.
+ */
+typedef struct
+{
+    uint16_t id;                    /**< DLOG_FmtId_t                       */
+    uint8_t  nargs;                 /**< Arguments recorded                 */
+    uint32_t ts;                    /**< CYCCNT_Read() at the call site     */
+    uint32_t arg[DLOG_MAX_ARGS];
+} DLOG_Record_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Format string of a message, or NULL for an unknown ID.
+ */
+const char *DLOG_FmtString(uint32_t id);
+
+/**
+ * @brief Argument count of a message (0 for an unknown ID).
+ */
+uint32_t DLOG_FmtArgs(uint32_t id);
+
+/**
+ * @brief Render a record as text.
+ *
+ * Unknown IDs and argument counts that do not match the catalog produce a
+ * "[dlog] ..." line instead, so a bad record is visible, not lost.
+ *
+ * @param buf  Destination, always NUL-terminated if size > 0.
+ * @param size Size of buf.
+ * @param rec  Record.
+ * @return Length written (without the NUL), at most size - 1.
+ */
+uint32_t DLOG_Format(char *buf, size_t size, const DLOG_Record_t *rec);
+
+/**
+ * @brief Encode a record for the binary stream.
+ *
+ * @param out Destination, at least DLOG_WIRE_MAX bytes.
+ * @param rec Record.
+ * @return Number of bytes written.
+ */
+uint32_t DLOG_Encode(uint8_t *out, const DLOG_Record_t *rec);
+
+/**
+ * @brief Try to decode a record at the start of a byte stream.
+ *
+ * @param buf Stream bytes; buf[0] is the candidate DLOG_SYNC.
+ * @param len Bytes available.
+ * @param rec Decoded record (valid when the return value is > 0).
+ * @return Bytes consumed (> 0), 0 if more bytes are needed, or -1 if buf
+ *         does not start a valid record (pass buf[0] through as text).
+ */
+int DLOG_Decode(const uint8_t *buf, size_t len, DLOG_Record_t *rec);
+
+#endif /* DLOG_FMT_H */
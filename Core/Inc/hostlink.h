@@ -0,0 +1,107 @@
+#ifndef HOSTLINK_H
+#define HOSTLINK_H
+
+#include "main.h"
+#include "cmsis_os2.h"
+#include "vehicle_snap.h"
+#include "can_if.h"
+#include "hostlink_proto.h"
+
+/*
+ * Module: Binary host protocol (hostlink)
+ *
+ * Role:
+ *   - A binary mode on the CLI UART for tools: `link bin` switches the
+ *     console from text to COBS/CRC frames (hostlink_proto.h), and a TEXT
+ *     frame switches it back. In binary mode the CLI hands every received
+ *     byte to this module (CLI_IF_SetRxHook()).
+ *   - Streams the host subscribes to, each at its own rate:
+ *       VEHICLE - VehicleState_t samples every period_ms, sent by LinkTask
+ *                 (HOSTLINK_Poll()) from the published snapshot
+ *                 (vehicle_snap.h).
+ *       CAN     - received CAN frames, sent from CAN_IF_ProcessRxMsg();
+ *                 period_ms 0 = every frame, else at most one per period.
+ *   - While binary mode is active, deferred log output is held
+ *     (DLOG_MODE_HOLD) so no text lands between frames.
+ *
+ * Output goes through the UART TX ring (uart_tx.h), one write per frame.
+ * A frame that does not fit is dropped and counted; its sequence number
+ * is skipped, so the host sees the loss.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial binary mode: vehicle and CAN streams.
+ *        - VEHICLE samples read from the vehicle snapshot.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* Thread flag that wakes LinkTask (HOSTLINK_Wait()) */
+#define HOSTLINK_WAKE_FLAG     0x0001U
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Link counters (also sent as STATS_REPLY, in this order).
+ */
+typedef struct
+{
+    uint32_t rx_frames;     /**< Valid frames received                    */
+    uint32_t rx_errors;     /**< Corrupt frames dropped (COBS/CRC/length) */
+    uint32_t tx_frames;     /**< Frames handed to the UART                */
+    uint32_t tx_dropped;    /**< Frames lost to a full UART TX ring       */
+    uint32_t vehicle;       /**< VEHICLE samples generated                */
+    uint32_t can;           /**< CAN frames generated                     */
+    uint32_t can_skipped;   /**< CAN frames left out by the rate limit    */
+    uint32_t late;          /**< VEHICLE periods missed (LinkTask late)   */
+} HOSTLINK_Stats_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Bind the vehicle snapshot sampled by the VEHICLE stream.
+ */
+void HOSTLINK_Init(const VehicleSnap_t *snap);
+
+/**
+ * @brief Switch the CLI UART to binary mode (the `link bin` command).
+ *
+ * Sends an empty frame so the host can synchronise on its delimiter.
+ */
+void HOSTLINK_Enter(void);
+
+/**
+ * @brief 1 while binary mode is active.
+ */
+uint8_t HOSTLINK_IsActive(void);
+
+/**
+ * @brief Send the VEHICLE samples that are due. LinkTask only.
+ *
+ * @return Ticks until the next sample is due, or osWaitForever.
+ */
+uint32_t HOSTLINK_Poll(void);
+
+/**
+ * @brief Sleep until timeout or a subscription change. LinkTask only.
+ */
+void HOSTLINK_Wait(uint32_t timeout);
+
+/**
+ * @brief Offer a received frame to the CAN stream (task context).
+ */
+void HOSTLINK_CanFrame(const CAN_IF_Msg_t *msg);
+
+/**
+ * @brief Copy the link counters.
+ *
+ * @param out Destination.
+ */
+void HOSTLINK_GetStats(HOSTLINK_Stats_t *out);
+
+#endif /* HOSTLINK_H */
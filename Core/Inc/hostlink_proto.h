@@ -0,0 +1,204 @@
+#ifndef HOSTLINK_PROTO_H
+#define HOSTLINK_PROTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Module: Binary host protocol, wire format (hostlink_proto)
+ *
+ * Role:
+ *   - Frame codec and message layout of the binary host protocol on the
+ *     CLI UART (hostlink.h). Used by the firmware and by the host client
+ *     (Tools/hostlink/hostlink_client.c), so both sides share one
+ *     definition.
+ *
+ * Frame:
+ *   COBS( payload | CRC ) 0x00
+ *   - payload: message type (1 byte) and body, at most
+ *     HOSTLINK_MAX_PAYLOAD bytes.
+ *   - CRC: CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of the payload,
+ *     little-endian.
+ *   - COBS removes every 0x00 from the frame, so 0x00 only ever ends a
+ *     frame and a receiver resynchronises at the next one after noise or
+ *     a lost byte. Empty frames (0x00 0x00) are ignored and may be sent
+ *     to flush a receiver.
+ *
+ * Messages (multi-byte fields little-endian, floats IEEE-754 binary32):
+ *   Host -> ECU, each answered by ACK:
+ *     PING         -
+ *     SUBSCRIBE    stream u8, period_ms u16
+ *     UNSUBSCRIBE  stream u8 (HOSTLINK_STREAM_ALL: all)
+ *     STATS        -                 (answered by STATS_REPLY, no ACK)
+ *     TOP          -                 (answered by TOP_REPLY frames, no ACK)
+ *     TEXT         -                 (ACK, then the CLI is back in text mode)
+ *   ECU -> host:
+ *     ACK          request type u8, status u8 (HOSTLINK_Status_t)
+ *     VEHICLE      seq u32, tick u32, speed_kph f32, rpm u16, coolant_c f32
+ *     CAN          seq u32, tick u32, id u32 (bit 31 = extended),
+ *                  dlc u8, fifo u8, data[dlc]
+ *     STATS_REPLY  HOSTLINK_STATS_WORDS counters, u32 each
+ *     TOP_REPLY    idx u8, count u8, load_x100 u16, kind u8, prio u8,
+ *                  win_x100 u16, total_x100 u16, win_cyc u32, calls u32,
+ *                  cyc_max u32, name[16] (NUL-padded)
+ *                  One frame per `top` line (rtstats.h), idx 0..count-1;
+ *                  count 0 (one frame, rest zero) = no window closed yet.
+ *   Each stream numbers its messages (seq, from 0 at SUBSCRIBE), so the
+ *   host counts losses from the gaps.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial protocol: COBS + CRC-16 frames, vehicle and CAN streams.
+ *        - TOP / TOP_REPLY: run-time stats snapshot.
+ */
+
+/* --------------------------------------------------------------------------
+ * Frames
+ * -------------------------------------------------------------------------- */
+
+#define HOSTLINK_DELIM         0x00U
+#define HOSTLINK_MAX_PAYLOAD   40U
+/* Payload + CRC + COBS overhead (one code byte per 254) + delimiter */
+#define HOSTLINK_MAX_FRAME     (HOSTLINK_MAX_PAYLOAD + 2U + 1U + \
+                                (HOSTLINK_MAX_PAYLOAD + 2U) / 254U + 1U)
+
+typedef enum
+{
+    HOSTLINK_MSG_PING        = 0x01,
+    HOSTLINK_MSG_SUBSCRIBE   = 0x02,
+    HOSTLINK_MSG_UNSUBSCRIBE = 0x03,
+    HOSTLINK_MSG_STATS       = 0x04,
+    HOSTLINK_MSG_TEXT        = 0x05,
+    HOSTLINK_MSG_TOP         = 0x06,
+
+    HOSTLINK_MSG_ACK         = 0x80,
+    HOSTLINK_MSG_VEHICLE     = 0x81,
+    HOSTLINK_MSG_CAN         = 0x82,
+    HOSTLINK_MSG_STATS_REPLY = 0x83,
+    HOSTLINK_MSG_TOP_REPLY   = 0x84
+} HOSTLINK_MsgType_t;
+
+typedef enum
+{
+    HOSTLINK_STREAM_VEHICLE = 0,
+    HOSTLINK_STREAM_CAN     = 1,
+    HOSTLINK_STREAM_COUNT,
+    HOSTLINK_STREAM_ALL     = 0xFF
+} HOSTLINK_Stream_t;
+
+typedef enum
+{
+    HOSTLINK_OK          = 0,
+    HOSTLINK_BAD_LENGTH  = 1,
+    HOSTLINK_BAD_STREAM  = 2,
+    HOSTLINK_BAD_PERIOD  = 3,
+    HOSTLINK_BAD_TYPE    = 4
+} HOSTLINK_Status_t;
+
+/* Body sizes */
+#define HOSTLINK_VEHICLE_LEN   18U
+#define HOSTLINK_CAN_LEN_MIN   14U     /* + dlc data bytes */
+#define HOSTLINK_TOP_NAME_LEN  16U
+#define HOSTLINK_TOP_LEN       (22U + HOSTLINK_TOP_NAME_LEN)
+
+/* STATS_REPLY: the HOSTLINK_Stats_t counters of hostlink.h, in order */
+#define HOSTLINK_STATS_WORDS   8U
+
+/* --------------------------------------------------------------------------
+ * Field access (little-endian on the wire)
+ * -------------------------------------------------------------------------- */
+
+static inline void HOSTLINK_PutU16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void HOSTLINK_PutU32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline void HOSTLINK_PutF32(uint8_t *p, float v)
+{
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    HOSTLINK_PutU32(p, u);
+}
+
+static inline uint16_t HOSTLINK_GetU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline uint32_t HOSTLINK_GetU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline float HOSTLINK_GetF32(const uint8_t *p)
+{
+    const uint32_t u = HOSTLINK_GetU32(p);
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+/* --------------------------------------------------------------------------
+ * Codec
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Streaming frame decoder state. Zero it (or call
+ *        HOSTLINK_DecoderInit()) before use.
+ */
+typedef struct
+{
+    uint8_t  buf[HOSTLINK_MAX_FRAME];
+    uint32_t len;           /**< Encoded bytes collected so far            */
+    uint8_t  overflow;      /**< Frame too long: skip to the delimiter     */
+    uint8_t  synced;        /**< A delimiter has been seen                 */
+} HOSTLINK_Decoder_t;
+
+/**
+ * @brief CRC-16/CCITT-FALSE.
+ */
+uint16_t HOSTLINK_Crc16(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Build a frame: CRC, COBS and delimiter.
+ *
+ * @param out     At least HOSTLINK_MAX_FRAME bytes.
+ * @param payload Message type and body.
+ * @param len     Payload length, 1..HOSTLINK_MAX_PAYLOAD.
+ * @return Frame length in bytes (delimiter included), 0 if len is invalid.
+ */
+uint32_t HOSTLINK_Encode(uint8_t *out, const uint8_t *payload, uint32_t len);
+
+/**
+ * @brief Reset a decoder.
+ *
+ * @param synced 1 if the stream is known to start at a frame boundary,
+ *               0 to discard everything up to the first delimiter (e.g.
+ *               text that preceded binary mode).
+ */
+void HOSTLINK_DecoderInit(HOSTLINK_Decoder_t *d, uint8_t synced);
+
+/**
+ * @brief Feed one received byte.
+ *
+ * @param d       Decoder.
+ * @param c       Byte.
+ * @param payload Set to the decoded payload (inside the decoder) on 1.
+ * @param len     Set to its length on 1.
+ * @return 1 = valid frame, -1 = corrupt frame dropped (COBS, CRC or too
+ *         long), 0 = nothing yet.
+ */
+int HOSTLINK_DecodeByte(HOSTLINK_Decoder_t *d, uint8_t c,
+                        const uint8_t **payload, uint32_t *len);
+
+#endif /* HOSTLINK_PROTO_H */
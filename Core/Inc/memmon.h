@@ -0,0 +1,137 @@
+#ifndef MEMMON_H
+#define MEMMON_H
+
+#include "main.h"
+#include "cmsis_os2.h"
+#include <stdint.h>
+
+/*
+ * Module: Memory monitor (memmon)
+ *
+ * Role:
+ *   - Peak stack use of every task, the peak use of the FreeRTOS heap
+ *     (heap_4) and the peak depth of the main stack (MSP), which carries
+ *     main() before the scheduler starts and every interrupt after.
+ *   - `mem` shows them; `mem plan` turns them into a tightened
+ *     configuration: task stack sizes, configTOTAL_HEAP_SIZE and
+ *     _Min_Stack_Size, each with a safety margin.
+ *
+ * How the peaks are found:
+ *   - Task stacks: the kernel fills each new stack with a known byte, and
+ *     uxTaskGetStackHighWaterMark() counts the words still untouched.
+ *   - Heap: heap_4 keeps its minimum-ever free size.
+ *   - MSP: MEMMON_PaintMsp() fills the unused part of the region reserved
+ *     by the linker script (_Min_Stack_Size below _estack) with the same
+ *     pattern at start-up; the first overwritten word from the bottom is
+ *     the deepest point reached. Stack below the reserved region is not
+ *     watched.
+ * All three are all-time values, so nothing is lost between samples.
+ * MEMMON_Update() only checks them once per MEMMON_PERIOD_MS and logs a
+ * task or the MSP whose free space falls under MEMMON_WARN_BYTES, once.
+ *
+ * The static allocation profile (VECU_STATIC_ALLOC, rtos_static.h) has
+ * no heap: the heap figures stay 0 and every task is reported as static.
+ *
+ * The host build runs tasks and interrupts on pthread stacks; the
+ * FreeRTOS stacks are never used and there is no MSP. It builds with
+ * MEMMON_STACKS=0: heap figures only.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial memory monitor: task stacks, heap_4, MSP, `mem plan`.
+ *        - No heap figures in the static allocation profile.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* 1 = measure task and main stacks (target); 0 = heap only (host) */
+#ifndef MEMMON_STACKS
+#define MEMMON_STACKS       1
+#endif
+
+#ifndef MEMMON_MAX_TASKS
+#define MEMMON_MAX_TASKS    12U
+#endif
+
+#ifndef MEMMON_PERIOD_MS
+#define MEMMON_PERIOD_MS    1000U
+#endif
+
+/* Free stack below which a task or the MSP is logged */
+#ifndef MEMMON_WARN_BYTES
+#define MEMMON_WARN_BYTES   64U
+#endif
+
+/* `mem plan`: peak + MEMMON_MARGIN_PCT %, at least MEMMON_MARGIN_MIN
+   bytes more, rounded up to MEMMON_STACK_ROUND (stacks) or
+   MEMMON_HEAP_ROUND (heap, MSP) */
+#define MEMMON_MARGIN_PCT   25U
+#define MEMMON_MARGIN_MIN   64U
+#define MEMMON_STACK_ROUND  32U
+#define MEMMON_HEAP_ROUND   256U
+#define MEMMON_STACK_MIN    256U    /* no task stack is planned below this */
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+/** One task; sizes in bytes. */
+typedef struct
+{
+    const char *name;
+    uint32_t    size;       /**< Stack size                                 */
+    uint32_t    peak;       /**< Deepest use so far (0 if not measured)     */
+    uint32_t    plan;       /**< Recommended size                           */
+    uint8_t     on_heap;    /**< Stack and TCB come from heap_4             */
+} MEMMON_Task_t;
+
+/** Memory report; sizes in bytes. */
+typedef struct
+{
+    uint32_t      n;
+    MEMMON_Task_t task[MEMMON_MAX_TASKS];
+    uint32_t      heap_size;      /**< configTOTAL_HEAP_SIZE (0: no heap)   */
+    uint32_t      heap_free;      /**< Free now                             */
+    uint32_t      heap_peak;      /**< Most ever in use                     */
+    uint32_t      heap_plan;      /**< Recommended, with the planned stacks */
+    uint32_t      msp_size;       /**< _Min_Stack_Size (0 if not measured)  */
+    uint32_t      msp_peak;
+    uint32_t      msp_plan;
+} MEMMON_Report_t;
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Paint the unused part of the main stack region.
+ *
+ * Call first thing in main(), while it runs on the MSP. Interrupts may be
+ * enabled: the painting stays below the caller's frame.
+ */
+void MEMMON_PaintMsp(void);
+
+/**
+ * @brief Track a task created by osThreadNew() with @p attr.
+ *
+ * The idle and timer tasks are added by the monitor itself once the
+ * scheduler runs.
+ *
+ * @return HAL_ERROR if @p id is NULL or MEMMON_MAX_TASKS are tracked.
+ */
+HAL_StatusTypeDef MEMMON_AddTask(osThreadId_t id, const osThreadAttr_t *attr);
+
+/**
+ * @brief Periodic check; call from one task.
+ *
+ * @param dt_ms Time since the previous call.
+ */
+void MEMMON_Update(uint32_t dt_ms);
+
+/**
+ * @brief Measure now and fill @p out, recommendations included.
+ */
+void MEMMON_GetReport(MEMMON_Report_t *out);
+
+#endif /* MEMMON_H */
@@ -0,0 +1,168 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "main.h"
+#include <cyccnt.h>         /* <>: the host build's Host/Inc copy wins */
+#include <stdint.h>
+
+/*
+ * Module: Hot-path latency probes (probe)
+ *
+ * Role:
+ *   - Cycle counts of a few hot paths, one log2 histogram per probe, with
+ *     min / max / mean and percentiles read from the histogram.
+ *     `probe` prints the summary, `probe hist <name>` one histogram,
+ *     `probe reset` clears them.
+ *
+ * A probe covers a C scope: PROBE_SCOPE(id) at its start reads the cycle
+ * counter, and the compiler's cleanup attribute records the difference
+ * wherever the scope is left, early returns included. Recording is a
+ * counter read, a count-leading-zeros, and a handful of adds and compares
+ * on the probe's own RAM; no lock, no call into the kernel.
+ *
+ * Each probe has exactly one writer at a time: its task, or interrupts
+ * that cannot preempt each other (the CAN1 vectors share one priority,
+ * since any of them may run the FIFO0 callback). Readers copy without a
+ * lock, so a copy may mix two calls; `probe reset` only raises a flag and
+ * the writer clears its own counters on the next call.
+ *
+ * On the host, the cycle counter is Host/Inc/cyccnt.h: CLOCK_MONOTONIC
+ * scaled to SystemCoreClock, so figures are in target cycle units but
+ * measure host wall-clock time.
+ *
+ * PROBE_ENABLE=0 compiles everything out: PROBE_SCOPE() expands to
+ * nothing and the module has no data and no commands.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial probes: model step, CAN telemetry, CAN RX ISR, CLI input.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+#ifndef PROBE_ENABLE
+#define PROBE_ENABLE        1
+#endif
+
+/* Bin b counts durations in [2^b, 2^(b+1)) cycles; bin 0 also holds 0 */
+#define PROBE_BINS          32U
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+/** Instrumented hot paths. */
+typedef enum
+{
+    PROBE_VEHICLE_UPDATE = 0,   /**< Vehicle_UpdateMs() in the model slot  */
+    PROBE_CAN_TELEMETRY  = 1,   /**< CAN_IF_SendTelemetry()                */
+    PROBE_CAN_RX_ISR     = 2,   /**< CAN FIFO0 RX callback (interrupt)     */
+    PROBE_CLI_CHAR       = 3,   /**< One input character, commands incl.  */
+    PROBE_COUNT          = 4
+} PROBE_Id_t;
+
+/** Live counters; written only by the probe's own context. */
+typedef struct
+{
+    uint32_t         calls;
+    uint32_t         min;
+    uint32_t         max;
+    uint64_t         sum;
+    uint32_t         hist[PROBE_BINS];
+    volatile uint8_t reset;     /**< Set by PROBE_Reset(), cleared by writer */
+} PROBE_Acc_t;
+
+/** Summary of one probe, in cycles. */
+typedef struct
+{
+    const char *name;
+    uint32_t    calls;
+    uint32_t    min;
+    uint32_t    max;
+    uint32_t    mean;
+    uint32_t    p50;        /**< Upper edge of the median's bin, <= max    */
+    uint32_t    p99;        /**< Upper edge of the 99th percentile's bin   */
+    uint32_t    hist[PROBE_BINS];
+} PROBE_Stats_t;
+
+/* --------------------------------------------------------------------------
+ * Instrumentation (inline)
+ * -------------------------------------------------------------------------- */
+
+#if PROBE_ENABLE
+
+extern PROBE_Acc_t g_probe[PROBE_COUNT];
+
+typedef struct
+{
+    uint32_t   t0;
+    PROBE_Id_t id;
+} PROBE_Scope_t;
+
+/** Out of line: runs once after a reset request. */
+void PROBE_Clear(PROBE_Acc_t *a);
+
+static inline void PROBE_Record(PROBE_Id_t id, uint32_t cyc)
+{
+    PROBE_Acc_t *a = &g_probe[id];
+
+    if (a->reset != 0U)
+    {
+        PROBE_Clear(a);
+    }
+    if (a->calls == 0U || cyc < a->min)
+    {
+        a->min = cyc;
+    }
+    if (cyc > a->max)
+    {
+        a->max = cyc;
+    }
+    a->calls++;
+    a->sum += cyc;
+    a->hist[31U - (uint32_t)__builtin_clz(cyc | 1U)]++;
+}
+
+static inline void PROBE_ScopeEnd(const PROBE_Scope_t *s)
+{
+    PROBE_Record(s->id, CYCCNT_Read() - s->t0);
+}
+
+/**
+ * @brief Measure the rest of the enclosing scope as probe @p id.
+ *
+ * A declaration: at most one per scope.
+ */
+#define PROBE_SCOPE(id)                                                        \
+    const PROBE_Scope_t probe_scope_                                           \
+        __attribute__((cleanup(PROBE_ScopeEnd), unused)) = { CYCCNT_Read(), (id) }
+
+#else
+
+#define PROBE_SCOPE(id)     do { } while (0)
+
+#endif /* PROBE_ENABLE */
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+#if PROBE_ENABLE
+
+/**
+ * @brief Copy and summarise probe @p id.
+ *
+ * @return HAL_ERROR if @p id is out of range or @p out is NULL.
+ */
+HAL_StatusTypeDef PROBE_GetStats(PROBE_Id_t id, PROBE_Stats_t *out);
+
+/**
+ * @brief Ask every probe to start over (done by each writer on its next
+ *        call).
+ */
+void PROBE_Reset(void);
+
+#endif /* PROBE_ENABLE */
+
+#endif /* PROBE_H */
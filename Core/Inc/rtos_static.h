@@ -0,0 +1,98 @@
+#ifndef RTOS_STATIC_H
+#define RTOS_STATIC_H
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+/*
+ * Module: Static RTOS objects (rtos_static)
+ *
+ * Role:
+ *   - Memory for the tasks and queues created through CMSIS-RTOS2, chosen
+ *     by the build profile:
+ *       VECU_STATIC_ALLOC=0 (default): osThreadNew() / osMessageQueueNew()
+ *         take control block, stack and storage from heap_4.
+ *       VECU_STATIC_ALLOC=1: every object gets a statically sized buffer
+ *         here and the kernel has no heap (FreeRTOSConfig.h). heap_4.c
+ *         must be left out of the build; freertos.c supplies a
+ *         pvPortMalloc() that fails, so nothing can allocate, before or
+ *         after osKernelStart().
+ *
+ * Placement (static profile, see the linker scripts):
+ *   - Control blocks go to .bss.rtos_cb, at the start of .bss: zeroed at
+ *     start-up like any other static, between _srtos_cb and _ertos_cb.
+ *   - Stacks and queue storage go to .noinit.rtos, a NOLOAD section after
+ *     .bss between _srtos_noinit and _ertos_noinit. The start-up code does
+ *     not clear it: the kernel fills a new stack itself, and a queue never
+ *     reads a slot it has not written.
+ *
+ * Usage, once per object at file scope:
+ *
+ *   RTOS_STATIC_TASK(vehicleTask, 256 * 4);
+ *   static const osThreadAttr_t vehicleTask_attributes = {
+ *     .name = "VehicleTask",
+ *     RTOS_STATIC_TASK_MEM(vehicleTask)
+ *   };
+ *
+ * The default profile turns RTOS_STATIC_TASK() into a size constant and
+ * RTOS_STATIC_TASK_MEM() into `.stack_size`, so one source serves both.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial static allocation profile for tasks and message queues.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* VECU_STATIC_ALLOC defaults to 0 in FreeRTOSConfig.h */
+#define RTOS_STATIC_CB      __attribute__((section(".bss.rtos_cb")))
+#define RTOS_STATIC_NOINIT  __attribute__((section(".noinit.rtos"), aligned(8)))
+
+/* --------------------------------------------------------------------------
+ * Object memory
+ * -------------------------------------------------------------------------- */
+
+#if VECU_STATIC_ALLOC
+
+/** Control block and @p bytes of stack for task @p name. */
+#define RTOS_STATIC_TASK(name, bytes)                                          \
+    static StaticTask_t name##_cb RTOS_STATIC_CB;                              \
+    static StackType_t  name##_stack[(bytes) / sizeof(StackType_t)] RTOS_STATIC_NOINIT
+
+/** osThreadAttr_t members for task @p name. */
+#define RTOS_STATIC_TASK_MEM(name)                                             \
+    .cb_mem    = &name##_cb,                                                   \
+    .cb_size   = sizeof(name##_cb),                                            \
+    .stack_mem = name##_stack,                                                 \
+    .stack_size = sizeof(name##_stack)
+
+/** Control block and storage for @p count messages of @p size bytes. */
+#define RTOS_STATIC_QUEUE(name, count, size)                                   \
+    static StaticQueue_t name##_cb RTOS_STATIC_CB;                             \
+    static uint8_t       name##_mq[(count) * (size)] RTOS_STATIC_NOINIT
+
+/** osMessageQueueAttr_t members for queue @p name. */
+#define RTOS_STATIC_QUEUE_MEM(name)                                            \
+    .cb_mem  = &name##_cb,                                                     \
+    .cb_size = sizeof(name##_cb),                                              \
+    .mq_mem  = name##_mq,                                                      \
+    .mq_size = sizeof(name##_mq)
+
+#else
+
+#define RTOS_STATIC_TASK(name, bytes)                                          \
+    enum { name##_stack_bytes = (bytes) }
+
+#define RTOS_STATIC_TASK_MEM(name)                                             \
+    .stack_size = name##_stack_bytes
+
+#define RTOS_STATIC_QUEUE(name, count, size)                                   \
+    enum { name##_mq_bytes = (count) * (size) }
+
+#define RTOS_STATIC_QUEUE_MEM(name)                                            \
+    .cb_mem = NULL
+
+#endif /* VECU_STATIC_ALLOC */
+
+#endif /* RTOS_STATIC_H */
@@ -0,0 +1,157 @@
+#ifndef RTSTATS_H
+#define RTSTATS_H
+
+#include "main.h"
+#include <cyccnt.h>         /* <>: the host build's Host/Inc copy wins */
+#include <stdint.h>
+
+/*
+ * Module: Run-time statistics (rtstats)
+ *
+ * Role:
+ *   - CPU time per task and per instrumented interrupt, in core cycles,
+ *     over the last window (RTSTATS_WINDOW_MS) and since the first one.
+ *     `top` prints it; RTSTATS_GetSnapshot() gives it in binary form
+ *     (hostlink TOP request).
+ *
+ * Task time: the kernel's run-time stats (configGENERATE_RUN_TIME_STATS)
+ * add the DWT cycle counter delta to the outgoing task at every context
+ * switch. Reading the counter is a single load, so a switch pays a few
+ * cycles for it. The counters are 32-bit: RTSTATS_Update() samples them
+ * once per window, far inside the wrap period (about 268 s at 16 MHz),
+ * and keeps 64-bit totals.
+ *
+ * Interrupt time: handlers bracket their body with RTSTATS_IsrEnter() /
+ * RTSTATS_IsrExit(): two counter reads and three adds, inline. The kernel
+ * charges interrupt time to the task it interrupted, so a task's share
+ * includes the interrupts taken while it ran; the interrupt lines show
+ * that time on its own. A nested interrupt counts in both handlers.
+ *
+ * CPU load is 100 % minus the idle task's share.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial run-time stats: tasks, CAN RX / USART2 / TIM6 interrupts.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+#ifndef RTSTATS_WINDOW_MS
+#define RTSTATS_WINDOW_MS   1000U
+#endif
+
+/* Tasks tracked; more are left out of the statistics */
+#ifndef RTSTATS_MAX_TASKS
+#define RTSTATS_MAX_TASKS   12U
+#endif
+
+#define RTSTATS_NAME_LEN    16U     /* configMAX_TASK_NAME_LEN */
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+/** Instrumented interrupt handlers (stm32f4xx_it.c). */
+typedef enum
+{
+    RTSTATS_ISR_CAN1_RX0 = 0,
+    RTSTATS_ISR_CAN1_RX1 = 1,
+    RTSTATS_ISR_USART2   = 2,
+    RTSTATS_ISR_TIM6     = 3,
+    RTSTATS_ISRS         = 4
+} RTSTATS_Isr_t;
+
+/** Live interrupt counters; written only by their handler. */
+typedef struct
+{
+    uint32_t calls;
+    uint32_t cyc;           /**< Wraps; sampled once per window           */
+    uint32_t cyc_max;       /**< Longest call                              */
+} RTSTATS_IsrAcc_t;
+
+typedef enum
+{
+    RTSTATS_KIND_TASK = 0,
+    RTSTATS_KIND_ISR  = 1
+} RTSTATS_Kind_t;
+
+/**
+ * @brief One line of the snapshot: a task or an interrupt.
+ *
+ * Shares are in hundredths of a percent (10000 = the whole CPU).
+ */
+typedef struct
+{
+    char     name[RTSTATS_NAME_LEN];
+    uint8_t  kind;          /**< RTSTATS_Kind_t                            */
+    uint8_t  prio;          /**< Task priority (0 for interrupts)          */
+    uint16_t win_x100;      /**< Share of the last window                  */
+    uint16_t total_x100;    /**< Share since the first window              */
+    uint32_t win_cyc;       /**< Cycles in the last window                 */
+    uint64_t total_cyc;     /**< Cycles since the first window             */
+    uint32_t calls;         /**< Interrupts: calls in the last window      */
+    uint32_t cyc_max;       /**< Interrupts: longest call ever             */
+} RTSTATS_Entry_t;
+
+/**
+ * @brief Statistics as of the end of the last window.
+ *
+ * Tasks come first, busiest first, then the interrupts in RTSTATS_Isr_t
+ * order.
+ */
+typedef struct
+{
+    uint32_t        windows;    /**< Windows closed; 0 = no data yet      */
+    uint32_t        win_cyc;    /**< Length of the last window, cycles    */
+    uint64_t        total_cyc;  /**< Since the first window, cycles       */
+    uint16_t        load_x100;  /**< CPU load in the last window          */
+    uint16_t        n;          /**< Entries used                         */
+    RTSTATS_Entry_t e[RTSTATS_MAX_TASKS + RTSTATS_ISRS];
+} RTSTATS_Snapshot_t;
+
+/* --------------------------------------------------------------------------
+ * Interrupt instrumentation (inline; in the handler's USER CODE blocks)
+ * -------------------------------------------------------------------------- */
+
+extern RTSTATS_IsrAcc_t g_rtstatsIsr[RTSTATS_ISRS];
+
+static inline uint32_t RTSTATS_IsrEnter(void)
+{
+    return CYCCNT_Read();
+}
+
+static inline void RTSTATS_IsrExit(RTSTATS_Isr_t isr, uint32_t t0)
+{
+    const uint32_t c = CYCCNT_Read() - t0;
+    RTSTATS_IsrAcc_t *a = &g_rtstatsIsr[isr];
+
+    a->calls++;
+    a->cyc += c;
+    if (c > a->cyc_max)
+    {
+        a->cyc_max = c;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Advance the window; call periodically from one task.
+ *
+ * Samples the kernel and interrupt counters and publishes a new snapshot
+ * every RTSTATS_WINDOW_MS. The first call only takes the baseline.
+ *
+ * @param dt_ms Time since the previous call.
+ */
+void RTSTATS_Update(uint32_t dt_ms);
+
+/**
+ * @brief Copy the latest snapshot (consistent; the scheduler is locked
+ *        for the copy).
+ */
+void RTSTATS_GetSnapshot(RTSTATS_Snapshot_t *out);
+
+#endif /* RTSTATS_H */
@@ -0,0 +1,187 @@
+#ifndef SCHED_TT_H
+#define SCHED_TT_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Module: Time-triggered scheduler (sched_tt)
+ *
+ * Role:
+ *   - Runs the periodic work of the ECU from one static table of slots,
+ *     each a job in one of three rate groups: 1 ms, 10 ms and 100 ms.
+ *   - Time base: basic timer TIM6, one update interrupt per millisecond
+ *     (SCHED_TimerIRQHandler()). The ISR only counts the tick and wakes
+ *     the scheduler task, so the schedule does not depend on the RTOS
+ *     tick or on how long the jobs take.
+ *   - SCHED_Run() is the body of that task (VehicleTask): a cyclic
+ *     executive that runs, for each 1 ms frame, the slots due in it, in
+ *     table order, on one thread. Jobs of all groups can share state
+ *     without locks.
+ *
+ * Schedule: a slot is released at every tick t with
+ * t % period == offset. Giving the slots of the slower groups different
+ * offsets spreads them over the frames of their period instead of
+ * stacking them on frame 0 (e.g. 10 ms jobs at offsets 0 and 5, the
+ * 100 ms job at 2). The pattern repeats every SCHED_HYPER_MS frames.
+ *
+ * Each job gets the time since its previous run, in ms, as dt: its period
+ * normally, a multiple of it after a skipped release. Models integrate
+ * exactly the scheduled time.
+ *
+ * Gated slots: a slot with a ready() hook is released only at ticks where
+ * it reports work (e.g. a non-empty mailbox). The timer ISR calls ready()
+ * and wakes the task only for frames with a release, so an idle 1 ms slot
+ * costs no context switch. The task calls ready() again when it runs the
+ * frame. A gated slot is never counted as skipped: its work waits for the
+ * next frame that runs. ready() runs in the ISR: short, no blocking.
+ *
+ * Overruns:
+ *   - A job that finishes after its next release (deadline = one period)
+ *     is an overrun of its rate group.
+ *   - If the frames fall behind the timer, the missed frames are not
+ *     replayed: their releases are skipped and counted per slot. The next
+ *     frame starts at the current tick.
+ *   Both are counted and shown by `sched`, together with per-slot
+ *   execution times (DWT cycles) and the busiest frame. Overruns are also
+ *   logged (dlog). On the host build, skips also count the host process
+ *   being descheduled: its time base is the wall clock.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial scheduler: TIM6 1 ms tick, 1 / 10 / 100 ms rate groups.
+ *        - Gated slots (ready() hook): no wake-up for frames with nothing due.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* Table size limit */
+#ifndef SCHED_MAX_SLOTS
+#define SCHED_MAX_SLOTS     16U
+#endif
+
+/* Preemption priority of the TIM6 interrupt; the ISR uses the RTOS, so it
+   must not be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY (5) */
+#ifndef SCHED_TIM_IRQ_PRIO
+#define SCHED_TIM_IRQ_PRIO  5U
+#endif
+
+#define SCHED_TICK_MS       1U      /* frame length                       */
+#define SCHED_HYPER_MS      100U    /* schedule cycle: the slowest period  */
+
+/* Thread flag set by the timer ISR */
+#define SCHED_FLAG_TICK     0x0001U
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+typedef enum
+{
+    SCHED_RATE_1MS   = 0,
+    SCHED_RATE_10MS  = 1,
+    SCHED_RATE_100MS = 2,
+    SCHED_RATES      = 3
+} SCHED_Rate_t;
+
+/** Job: dt_ms is the time since its previous run (its period, normally). */
+typedef void (*SCHED_Job_t)(uint32_t dt_ms);
+
+/** Gate of a slot: nonzero if the job has work (ISR-safe). */
+typedef uint32_t (*SCHED_Ready_t)(void);
+
+/**
+ * @brief One slot of the schedule table.
+ */
+typedef struct
+{
+    const char *name;       /**< Short name for `sched`                    */
+    SCHED_Job_t job;
+    uint8_t     rate;       /**< SCHED_Rate_t                              */
+    uint8_t     offset_ms;  /**< Release frame within the period           */
+    SCHED_Ready_t ready;    /**< NULL: every release; else gated by it     */
+} SCHED_Slot_t;
+
+/**
+ * @brief Per-slot counters.
+ */
+typedef struct
+{
+    uint32_t runs;          /**< Releases run                              */
+    uint32_t skipped;       /**< Releases lost to frames falling behind    */
+    uint32_t cyc_last;      /**< Execution time of the last run, cycles    */
+    uint32_t cyc_max;       /**< Longest run, cycles                       */
+    uint64_t cyc_sum;       /**< Total, for the mean                       */
+} SCHED_SlotStats_t;
+
+/**
+ * @brief Per-rate-group counters.
+ */
+typedef struct
+{
+    uint32_t releases;      /**< Slot releases, run or skipped (gated
+                                 slots: runs)                              */
+    uint32_t overruns;      /**< Jobs finished after their next release    */
+    uint32_t skipped;       /**< Slot releases skipped                     */
+} SCHED_RateStats_t;
+
+/**
+ * @brief Scheduler counters.
+ */
+typedef struct
+{
+    uint32_t ticks;         /**< Timer interrupts                          */
+    uint32_t frames;        /**< Frames run (with a release)               */
+    uint32_t frames_skipped;/**< Frames not run: the task was behind       */
+    uint32_t frames_late;   /**< Frames that ended after the next tick     */
+    uint32_t frame_cyc_max; /**< Busiest frame, cycles ...                 */
+    uint8_t  frame_max_at;  /**< ... and its index, 0 .. SCHED_HYPER_MS-1  */
+    SCHED_RateStats_t rate[SCHED_RATES];
+} SCHED_Stats_t;
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Install the schedule table (not copied; keep it static).
+ *
+ * Call once before the kernel starts.
+ *
+ * @retval HAL_OK, or HAL_ERROR for an empty or oversized table, a missing
+ *         job, an unknown rate or an offset outside the period.
+ */
+HAL_StatusTypeDef SCHED_Init(const SCHED_Slot_t *table, uint32_t n);
+
+/**
+ * @brief Start TIM6 and run the schedule; never returns.
+ *
+ * Call from the task that owns the jobs' state.
+ */
+void SCHED_Run(void);
+
+/**
+ * @brief TIM6 update interrupt; call from TIM6_DAC_IRQHandler().
+ */
+void SCHED_TimerIRQHandler(void);
+
+/**
+ * @brief Period of a rate group in ms (0 for an unknown rate).
+ */
+uint32_t SCHED_PeriodMs(uint32_t rate);
+
+void SCHED_GetStats(SCHED_Stats_t *out);
+
+/**
+ * @brief Slot table entry and counters (HAL_ERROR for i out of range).
+ */
+HAL_StatusTypeDef SCHED_GetSlot(uint32_t i, const SCHED_Slot_t **slot,
+                                SCHED_SlotStats_t *stats);
+
+/**
+ * @brief Clear the counters at the next frame (the tick count is kept).
+ */
+void SCHED_ResetStats(void);
+
+#endif /* SCHED_TT_H */
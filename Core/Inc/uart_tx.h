@@ -0,0 +1,154 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Module: Console UART transmit pipeline (uart_tx)
+ *
+ * Role:
+ *   - Single owner of the console UART's transmit side. Every module that
+ *     prints (main, can_if, cli_if) goes through UART_TX_Write().
+ *   - Producers copy their bytes into a ring buffer and return; DMA sends
+ *     the ring contents in the background, one contiguous chunk at a time,
+ *     restarted from the TX complete interrupt.
+ *   - A full ring never blocks the caller: the overflow policy decides
+ *     what is kept, and every lost byte is counted.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial DMA TX ring replacing blocking HAL_UART_Transmit().
+ *        - UART_TX_Free() for producers that wait instead of dropping.
+ *        - TX DMA errors restart the transfer (UART_TX_ErrorCallback());
+ *          before, one error stopped all console output.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* Ring size in bytes; must be a power of two */
+#ifndef UART_TX_RING_LEN
+#define UART_TX_RING_LEN   2048U
+#endif
+
+/*
+ * 1 = DMA TX ring (default).
+ * 0 = previous behaviour: UART_TX_Write() calls the blocking
+ *     HAL_UART_Transmit(). Kept as a build option for comparison
+ *     benchmarks (bench_uarttx_blocking).
+ */
+#ifndef UART_TX_DMA
+#define UART_TX_DMA        1
+#endif
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief What UART_TX_Write() does with a message that does not fit.
+ */
+typedef enum
+{
+    UART_TX_DROP_MSG = 0,   /**< Drop the whole message (default): no torn lines */
+    UART_TX_TRUNCATE        /**< Keep the part that fits, drop the rest          */
+} UART_TX_Policy_t;
+
+/**
+ * @brief Transmit path counters.
+ *
+ * Write time is measured inside UART_TX_Write() in core cycles
+ * (cyccnt.h), so it is the CPU time the callers spend on output.
+ */
+typedef struct
+{
+    uint32_t writes;          /**< UART_TX_Write() calls                     */
+    uint32_t bytes;           /**< Bytes accepted into the ring              */
+    uint32_t dropped_msgs;    /**< Messages cut or dropped by the policy     */
+    uint32_t dropped_bytes;   /**< Bytes lost to a full ring                 */
+    uint32_t dma_starts;      /**< DMA transfers started                     */
+    uint32_t tx_errors;       /**< DMA transfers ended by an error           */
+    uint32_t high_water;      /**< Most bytes waiting in the ring at once    */
+    uint32_t pending;         /**< Bytes waiting or in flight right now      */
+    uint32_t write_cyc_max;   /**< Longest UART_TX_Write() call              */
+    uint64_t write_cyc_sum;   /**< Total cycles spent in UART_TX_Write()     */
+} UART_TX_Stats_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Bind the pipeline to a UART and empty the ring.
+ *
+ * The UART must be initialized with a TX DMA stream linked to it
+ * (huart->hdmatx, see HAL_UART_MspInit()). Call before any other
+ * UART_TX function; output written before is lost.
+ *
+ * @param huart Console UART.
+ * @retval HAL_OK, or HAL_ERROR if the UART has no TX DMA (UART_TX_DMA=1).
+ */
+HAL_StatusTypeDef UART_TX_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Queue bytes for transmission. Never blocks (with UART_TX_DMA=1).
+ *
+ * One call is one message: with UART_TX_DROP_MSG it is either queued
+ * completely or not at all, and messages from different callers are never
+ * interleaved. Callable from tasks and from ISRs at or below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ *
+ * @param data Bytes to send.
+ * @param len  Number of bytes.
+ * @return Number of bytes queued.
+ */
+uint32_t UART_TX_Write(const void *data, uint32_t len);
+
+/**
+ * @brief UART_TX_Write() for a NUL-terminated string.
+ */
+uint32_t UART_TX_Print(const char *s);
+
+/**
+ * @brief Bytes a UART_TX_Write() could queue right now without a drop.
+ *
+ * With UART_TX_DMA=0 there is no ring and UINT32_MAX is returned.
+ */
+uint32_t UART_TX_Free(void);
+
+/**
+ * @brief Select the overflow policy (default UART_TX_DROP_MSG).
+ */
+void UART_TX_SetPolicy(UART_TX_Policy_t policy);
+
+/**
+ * @brief Copy the transmit counters.
+ *
+ * @param out Destination.
+ */
+void UART_TX_GetStats(UART_TX_Stats_t *out);
+
+/**
+ * @brief Send everything queued by polling, for fatal paths only.
+ *
+ * Stops the running DMA transfer and transmits the rest of the ring with
+ * the blocking HAL_UART_Transmit(). Works with interrupts disabled, e.g.
+ * just before Error_Handler().
+ */
+void UART_TX_Flush(void);
+
+/**
+ * @brief Recover from a TX DMA error. Call from HAL_UART_ErrorCallback().
+ *
+ * On a DMA transfer error the HAL ends the transmission without calling
+ * HAL_UART_TxCpltCallback(). The bytes the DMA had already fetched count
+ * as sent, and the rest of the ring goes out in a new transfer. Does
+ * nothing for other UARTs, for reception errors and while a transfer is
+ * still running.
+ *
+ * @param huart UART that reported the error.
+ */
+void UART_TX_ErrorCallback(UART_HandleTypeDef *huart);
+
+#endif /* UART_TX_H */
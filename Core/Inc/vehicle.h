@@ -9,11 +9,72 @@
  * Role:
  *   - Encapsulates a tiny "virtual vehicle" state.
  *   - Provides a simple update step and helper APIs for CLI control.
+ *   - Longitudinal model (VEHICLE_DYNAMICS=1): a PI controller tracks the
+ *     target speed within acceleration and braking limits, against rolling
+ *     resistance and aerodynamic drag. RPM follows speed through a
+ *     six-speed gear table with a load-dependent shift schedule; coolant
+ *     temperature follows engine heat (idle + load) against the radiator
+ *     (thermostat, airflow, fan). All physics is precomputed into the
+ *     calibration maps of vehicle_lut.h (vehicle_map.h), so a step is a
+ *     fixed sequence of map lookups and arithmetic.
  *
  * Version history (module-level):
  *   v2.2 - Initial model: speed, RPM, coolant temperature.
+ *   v2.4 - Batch (structure-of-arrays) update for fleet simulation.
+ *        - Compile-time Q16.16 fixed-point build (VEHICLE_FIXED_POINT),
+ *          Vehicle_UpdateMs() and unit-independent getters.
+ *        - Longitudinal dynamics (VEHICLE_DYNAMICS): PI target-speed
+ *          controller, drag and rolling resistance, gear table, coolant
+ *          heat flow; tables generated by Tools/vehicle_lut.
+ *        - Model tables as calibration maps (vehicle_map.h): torque and
+ *          radiator curves on their own breakpoints, RPM x load heat map.
  */
 
+/*
+ * Model arithmetic, selected at build time (e.g. -DVEHICLE_FIXED_POINT=1):
+ *   0 - single-precision float (default).
+ *   1 - Q16.16 fixed point (vehicle_q16.h): no FPU needed, bit-exact
+ *       between host and target. speed_kph / coolant_temp_c become
+ *       q16_16_t, so other modules read them through the getters below.
+ * The fleet API (VehicleFleet_t) is float in both builds.
+ */
+#ifndef VEHICLE_FIXED_POINT
+#define VEHICLE_FIXED_POINT 0
+#endif
+
+/*
+ * Model physics, selected at build time (e.g. -DVEHICLE_DYNAMICS=0):
+ *   1 - longitudinal model described above (default in the float build).
+ *   0 - basic model: speed decays by 1 km/h/s, RPM lags 800 + 50 RPM per
+ *       km/h, coolant warms at 2 °C/s while driving; Vehicle_SetTargetSpeed()
+ *       sets the speed directly. This is the model of the Q16.16 build and
+ *       of the fleet API (Vehicle_UpdateBatch(), vehicle_simd.h) in every
+ *       build.
+ */
+#ifndef VEHICLE_DYNAMICS
+#if VEHICLE_FIXED_POINT
+#define VEHICLE_DYNAMICS 0
+#else
+#define VEHICLE_DYNAMICS 1
+#endif
+#endif
+
+#if VEHICLE_DYNAMICS && VEHICLE_FIXED_POINT
+#error "VEHICLE_DYNAMICS needs the float build (VEHICLE_FIXED_POINT=0)"
+#endif
+
+#if VEHICLE_DYNAMICS
+#include "vehicle_map.h"
+#endif
+
+#if VEHICLE_FIXED_POINT
+#include "vehicle_q16.h"
+
+/**
+ * @brief Simple virtual vehicle state (Q16.16 build).
+ */
+typedef VehicleStateQ16_t VehicleState_t;
+#else
 /**
  * @brief Simple virtual vehicle state.
  */
@@ -22,7 +83,32 @@ typedef struct
     float    speed_kph;        /**< Vehicle speed in km/h        */
     uint16_t engine_rpm;       /**< Engine speed in RPM          */
     float    coolant_temp_c;   /**< Coolant temperature in °C    */
+#if VEHICLE_DYNAMICS
+    float    target_kph;       /**< Controller set point, km/h   */
+    float    pi_int;           /**< PI integrator, km/h/s        */
+    float    accel_kph_s;      /**< Last step's accel., km/h/s   */
+    float    shift_hold_s;     /**< No shift until this is <= 0  */
+    uint8_t  gear;             /**< Engaged gear, 1 .. 6         */
+    uint8_t  load_pct;         /**< % of full-load torque        */
+    VehicleMapHint_t hint_rpm;  /**< Map search hints (vehicle_map.h) */
+    VehicleMapHint_t hint_temp;
+#endif
 } VehicleState_t;
+#endif
+
+/**
+ * @brief Many vehicles in structure-of-arrays layout.
+ *
+ * Element i of each array belongs to vehicle i. The arrays are owned by the
+ * caller and must not overlap.
+ */
+typedef struct
+{
+    float    *speed_kph;       /**< [count] speeds in km/h                */
+    uint16_t *engine_rpm;      /**< [count] engine speeds in RPM          */
+    float    *coolant_temp_c;  /**< [count] coolant temperatures in °C    */
+    uint32_t  count;           /**< Number of vehicles                    */
+} VehicleFleet_t;
 
 /**
  * @brief Initialize the vehicle state to sane defaults.
@@ -40,14 +126,51 @@ void Vehicle_Init(VehicleState_t *vs);
  * @param vs      Pointer to vehicle state.
  * @param dt_s    Time step in seconds (e.g. 0.1f).
  *
- * The model is intentionally very simple – just enough to make the
- * telemetry feel "alive" when plotted or inspected over time.
+ * With VEHICLE_DYNAMICS=1 the cost of a step does not depend on the state
+ * (bench_vdyn measures mean and worst case); with 0 the model is
+ * intentionally very simple – just enough to make the telemetry feel
+ * "alive" when plotted or inspected over time.
  */
 void Vehicle_Update(VehicleState_t *vs, float dt_s);
 
+/**
+ * @brief Update the vehicle model by a whole number of milliseconds.
+ *
+ * Preferred by the firmware: in the Q16.16 build the step is converted
+ * with integer arithmetic only (VEHICLE_Q16_FROM_MS()), whereas
+ * Vehicle_Update() has to convert its float argument.
+ *
+ * @param vs      Pointer to vehicle state.
+ * @param dt_ms   Time step in milliseconds (e.g. 100).
+ */
+void Vehicle_UpdateMs(VehicleState_t *vs, uint32_t dt_ms);
+
+/**
+ * @brief Initialize every vehicle of a fleet (same defaults as Vehicle_Init()).
+ *
+ * @param fleet Fleet descriptor.
+ */
+void Vehicle_InitBatch(const VehicleFleet_t *fleet);
+
+/**
+ * @brief Step every vehicle of a fleet by @p dt_s.
+ *
+ * Always the basic model. With VEHICLE_DYNAMICS=0 it produces
+ * bit-identical results to calling Vehicle_Update() on each vehicle in
+ * turn.
+ *
+ * @param fleet   Fleet descriptor.
+ * @param dt_s    Time step in seconds (e.g. 0.1f).
+ */
+void Vehicle_UpdateBatch(const VehicleFleet_t *fleet, float dt_s);
+
 /**
  * @brief Apply a “driver command” to the model (e.g. target speed).
  *
+ * With VEHICLE_DYNAMICS=1 this sets the controller's set point and the
+ * vehicle accelerates or brakes toward it over the following steps;
+ * otherwise the speed is set directly.
+ *
  * @param vs                 Pointer to vehicle state.
  * @param target_speed_kph   New target speed in km/h (clamped to [0, 200]).
  */
@@ -56,6 +179,10 @@ void Vehicle_SetTargetSpeed(VehicleState_t *vs, float target_speed_kph);
 /**
  * @brief Force state values directly (used from CLI for testing/fault injection).
  *
+ * With VEHICLE_DYNAMICS=1 the target speed is kept (the controller drives
+ * back toward it), a changed speed re-selects the gear, and the next step
+ * derives RPM from speed and gear again.
+ *
  * @param vs         Pointer to vehicle state.
  * @param speed_kph  New speed in km/h.
  * @param rpm        New engine speed in RPM.
@@ -66,4 +193,39 @@ void Vehicle_Force(VehicleState_t *vs,
                    uint16_t rpm,
                    float temp_c);
 
+/**
+ * @brief Current speed in km/h (for display; same value in both builds).
+ */
+float Vehicle_GetSpeedKph(const VehicleState_t *vs);
+
+/**
+ * @brief Current coolant temperature in °C (for display).
+ */
+float Vehicle_GetCoolantC(const VehicleState_t *vs);
+
+/**
+ * @brief Engaged gear (1 .. 6); 0 without VEHICLE_DYNAMICS.
+ */
+uint8_t Vehicle_GetGear(const VehicleState_t *vs);
+
+/**
+ * @brief Controller set point in km/h; the speed without VEHICLE_DYNAMICS.
+ */
+float Vehicle_GetTargetKph(const VehicleState_t *vs);
+
+/**
+ * @brief Throttle in % of full-load torque; 0 without VEHICLE_DYNAMICS.
+ */
+uint8_t Vehicle_GetLoadPct(const VehicleState_t *vs);
+
+/**
+ * @brief Speed in 0.1 km/h, truncated toward zero (CAN telemetry scaling).
+ */
+int32_t Vehicle_GetSpeedKph10(const VehicleState_t *vs);
+
+/**
+ * @brief Coolant temperature in 0.1 °C, truncated toward zero (CAN telemetry scaling).
+ */
+int32_t Vehicle_GetCoolantC10(const VehicleState_t *vs);
+
 #endif /* VEHICLE_H */
@@ -0,0 +1,140 @@
+#ifndef VEHICLE_CMD_H
+#define VEHICLE_CMD_H
+
+#include "main.h"
+#include <stdint.h>
+#include "vehicle.h"
+
+/*
+ * Module: Vehicle command mailbox (vehicle_cmd)
+ *
+ * Role:
+ *   - The only way for other tasks to change the vehicle model. Producers
+ *     (CLI commands, and any task or ISR) post typed commands with
+ *     VehicleCmd_Post(); VehicleTask applies every queued command at the
+ *     start of its step (VehicleCmd_Apply()), before the model update and
+ *     the snapshot publish (vehicle_snap.h). VehicleTask is then the single
+ *     writer of the vehicle state, and readers never see half a command.
+ *   - Commands are applied in the order their slots were reserved, one
+ *     batch per step, so a run is reproducible from its command log: with
+ *     tracing on (`veh trace on`), each applied command is a deferred log
+ *     record with the step it was applied at. Replaying the same commands
+ *     at the same steps with VehicleCmd_Exec() gives the same states bit
+ *     for bit.
+ *
+ * Queue: multi-producer, single-consumer slot ring, lock-free. A producer
+ * reserves a slot with LDREX/STREX, fills it and sets its type last; the
+ * consumer stops at the first slot that is reserved but not yet filled.
+ * A full queue refuses the command (HAL_BUSY) and counts it.
+ *
+ * Values are integers in the units of the CAN command signals (0.1 km/h,
+ * 0.1 °C), so a text log of them replays exactly.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial mailbox: target speed, force, coolant commands.
+ *        - VEHICLE_CMD_APPLY_CYC=0 drops the apply timing.
+ *        - VehicleCmd_Pending() gates the 1 ms apply slot.
+ */
+
+/* --------------------------------------------------------------------------
+ * Configuration
+ * -------------------------------------------------------------------------- */
+
+/* Queued commands; must be a power of two */
+#ifndef VEHICLE_CMD_QUEUE_LEN
+#define VEHICLE_CMD_QUEUE_LEN   16U
+#endif
+
+/* Time each non-empty apply for `veh stats` (two cycle counter reads);
+   0 leaves apply_cyc_max at 0 */
+#ifndef VEHICLE_CMD_APPLY_CYC
+#define VEHICLE_CMD_APPLY_CYC   1
+#endif
+
+/* --------------------------------------------------------------------------
+ * Types
+ * -------------------------------------------------------------------------- */
+
+typedef enum
+{
+    VEHICLE_CMD_NONE         = 0,   /**< Slot free or still being filled     */
+    VEHICLE_CMD_TARGET_SPEED = 1,   /**< kph10                               */
+    VEHICLE_CMD_FORCE        = 2,   /**< kph10, rpm, coolant10               */
+    VEHICLE_CMD_COOLANT      = 3    /**< coolant10; speed and RPM unchanged  */
+} VehicleCmdType_t;
+
+/**
+ * @brief One driver or fault-injection command.
+ */
+typedef struct
+{
+    uint8_t  type;          /**< VehicleCmdType_t                          */
+    uint16_t rpm;           /**< Engine speed in RPM                       */
+    int32_t  kph10;         /**< Speed in 0.1 km/h                         */
+    int32_t  coolant10;     /**< Coolant temperature in 0.1 °C             */
+} VehicleCmd_t;
+
+/**
+ * @brief Mailbox counters.
+ */
+typedef struct
+{
+    uint32_t applied;       /**< Commands applied                          */
+    uint32_t dropped;       /**< Commands refused: queue full              */
+    uint32_t batches;       /**< Steps that applied at least one command   */
+    uint32_t max_batch;     /**< Most commands applied in one step         */
+    uint32_t apply_cyc_max; /**< Longest VehicleCmd_Apply() with commands
+                                 (0 if VEHICLE_CMD_APPLY_CYC=0)             */
+} VehicleCmd_Stats_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Empty the queue and clear the counters.
+ */
+void VehicleCmd_Init(void);
+
+/**
+ * @brief Queue a command for the next vehicle step. Any task or ISR.
+ *
+ * @retval HAL_OK    Queued.
+ * @retval HAL_BUSY  Queue full; the command is dropped and counted.
+ * @retval HAL_ERROR NULL or unknown command type.
+ */
+HAL_StatusTypeDef VehicleCmd_Post(const VehicleCmd_t *cmd);
+
+/**
+ * @brief Apply every queued command to vs, in order. VehicleTask only.
+ *
+ * @param vs   Vehicle state owned by the caller.
+ * @param step Number of the step about to run (for the trace).
+ * @return Commands applied.
+ */
+uint32_t VehicleCmd_Apply(VehicleState_t *vs, uint32_t step);
+
+/**
+ * @brief Nonzero if a command is queued or being posted (ISR-safe).
+ */
+uint32_t VehicleCmd_Pending(void);
+
+/**
+ * @brief Apply one command to vs (the same conversion VehicleCmd_Apply()
+ *        uses; for replaying a command log).
+ */
+void VehicleCmd_Exec(VehicleState_t *vs, const VehicleCmd_t *cmd);
+
+/**
+ * @brief Record each applied command in the deferred log (1) or not (0).
+ */
+void VehicleCmd_SetTrace(uint8_t on);
+
+/**
+ * @brief Copy the mailbox counters.
+ *
+ * @param out Destination.
+ */
+void VehicleCmd_GetStats(VehicleCmd_Stats_t *out);
+
+#endif /* VEHICLE_CMD_H */
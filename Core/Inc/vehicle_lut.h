@@ -0,0 +1,198 @@
+/* Generated by Tools/vehicle_lut/gen_vehicle_lut.py - do not edit. */
+
+#ifndef VEHICLE_LUT_H
+#define VEHICLE_LUT_H
+
+#include "vehicle_map.h"
+
+/*
+ * Module: Vehicle model tables (vehicle_lut)
+ *
+ * Role:
+ *   - Calibration maps of the longitudinal vehicle model in vehicle.c
+ *     (VEHICLE_DYNAMICS=1), precomputed from the vehicle parameters
+ *     in the generator. Curves over one axis share its position, so
+ *     the model searches each axis once per step.
+ *
+ * Vehicle: 1300 kg, Cd 0.32, A 2.2 m^2, Crr 0.012, wheel radius 0.31 m,
+ * final drive 4.10, gears 3.60 / 2.10 / 1.40 / 1.05 / 0.85 / 0.70.
+ */
+
+#define VEHICLE_LUT_GEARS            6U
+#define VEHICLE_LUT_IDLE_RPM         800.0f
+#define VEHICLE_LUT_LIMIT_RPM        7000.0f
+
+/* Coolant heat flow, degC/s */
+#define VEHICLE_LUT_AMBIENT_C        25.0f
+#define VEHICLE_LUT_COOL_PASSIVE     0.0005f       /* x (T - ambient) */
+#define VEHICLE_LUT_COOL_RADIATOR    0.03f         /* x airflow x radiator x (T - ambient) */
+
+/* --------------------------------------------------------------------------
+ * Speed axis: resistance, radiator airflow
+ * -------------------------------------------------------------------------- */
+
+static const float VEHICLE_LUT_SPEED_BP[53] = {   /* km/h */
+             0.0f,          5.0f,         10.0f,         15.0f,         20.0f,         25.0f,
+            30.0f,         35.0f,         40.0f,         45.0f,         50.0f,         55.0f,
+            60.0f,         65.0f,         70.0f,         75.0f,         80.0f,         85.0f,
+            90.0f,         95.0f,        100.0f,        105.0f,        110.0f,        115.0f,
+           120.0f,        125.0f,        130.0f,        135.0f,        140.0f,        145.0f,
+           150.0f,        155.0f,        160.0f,        165.0f,        170.0f,        175.0f,
+           180.0f,        185.0f,        190.0f,        195.0f,        200.0f,        205.0f,
+           210.0f,        215.0f,        220.0f,        225.0f,        230.0f,        235.0f,
+           240.0f,        245.0f,        250.0f,        255.0f,        260.0f,
+};
+
+static const float VEHICLE_LUT_SPEED_INV[52] = {   /* 1 / segment width */
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,          0.2f,          0.2f,
+             0.2f,          0.2f,          0.2f,          0.2f,
+};
+
+static const VehicleMapAxis_t VEHICLE_LUT_SPEED_AXIS = {
+    VEHICLE_LUT_SPEED_BP, VEHICLE_LUT_SPEED_INV, 53U, VEHICLE_MAP_UNIFORM
+};
+
+static const float VEHICLE_LUT_RESIST[53] = {   /* km/h/s, rolling + drag */
+             0.0f,    0.4260484f,    0.4328176f,    0.4440997f,    0.4598946f,    0.4802023f,
+       0.5050228f,    0.5343561f,    0.5682023f,    0.6065612f,     0.649433f,    0.6968176f,
+       0.7487151f,    0.8051253f,    0.8660484f,    0.9314843f,     1.001433f,     1.075895f,
+        1.154869f,     1.238356f,     1.326356f,     1.418869f,     1.515895f,     1.617433f,
+        1.723484f,     1.834048f,     1.949125f,     2.068715f,     2.192818f,     2.321433f,
+        2.454561f,     2.592202f,     2.734356f,     2.881023f,     3.032202f,     3.187895f,
+          3.3481f,     3.512818f,     3.682048f,     3.855792f,     4.034048f,     4.216818f,
+          4.4041f,     4.595895f,     4.792202f,     4.993023f,     5.198356f,     5.408202f,
+        5.622561f,     5.841433f,     6.064818f,     6.292715f,     6.525125f,
+};
+
+static const float VEHICLE_LUT_AIRFLOW[53] = {   /* radiator airflow factor */
+            0.25f,       0.2875f,        0.325f,       0.3625f,          0.4f,       0.4375f,
+           0.475f,       0.5125f,         0.55f,       0.5875f,        0.625f,       0.6625f,
+             0.7f,       0.7375f,        0.775f,       0.8125f,         0.85f,       0.8875f,
+           0.925f,       0.9625f,          1.0f,          1.0f,          1.0f,          1.0f,
+             1.0f,          1.0f,          1.0f,          1.0f,          1.0f,          1.0f,
+             1.0f,          1.0f,          1.0f,          1.0f,          1.0f,          1.0f,
+             1.0f,          1.0f,          1.0f,          1.0f,          1.0f,          1.0f,
+             1.0f,          1.0f,          1.0f,          1.0f,          1.0f,          1.0f,
+             1.0f,          1.0f,          1.0f,          1.0f,          1.0f,
+};
+
+/* --------------------------------------------------------------------------
+ * RPM axis: full-load torque; RPM x load: coolant heat input
+ * -------------------------------------------------------------------------- */
+
+static const float VEHICLE_LUT_RPM_BP[15] = {   /* rpm */
+             0.0f,        800.0f,       1200.0f,       1600.0f,       2000.0f,       2500.0f,
+          3000.0f,       3500.0f,       4000.0f,       4500.0f,       5000.0f,       5500.0f,
+          6000.0f,       6500.0f,       7000.0f,
+};
+
+static const float VEHICLE_LUT_RPM_INV[14] = {   /* 1 / segment width */
+         0.00125f,       0.0025f,       0.0025f,       0.0025f,        0.002f,        0.002f,
+           0.002f,        0.002f,        0.002f,        0.002f,        0.002f,        0.002f,
+           0.002f,        0.002f,
+};
+
+static const VehicleMapAxis_t VEHICLE_LUT_RPM_AXIS = {
+    VEHICLE_LUT_RPM_BP, VEHICLE_LUT_RPM_INV, 15U, VEHICLE_MAP_HINT
+};
+
+static const float VEHICLE_LUT_TORQUE[15] = {   /* N*m, full load */
+            90.0f,        128.0f,        150.0f,        176.0f,        195.0f,        210.0f,
+           220.0f,        225.0f,        225.0f,        220.0f,        210.0f,        195.0f,
+           175.0f,        140.0f,          0.0f,
+};
+
+static const float VEHICLE_LUT_LOAD_BP[5] = {   /* fraction of full-load torque */
+             0.0f,         0.25f,          0.5f,         0.75f,          1.0f,
+};
+
+static const float VEHICLE_LUT_LOAD_INV[4] = {   /* 1 / segment width */
+             4.0f,          4.0f,          4.0f,          4.0f,
+};
+
+static const VehicleMapAxis_t VEHICLE_LUT_LOAD_AXIS = {
+    VEHICLE_LUT_LOAD_BP, VEHICLE_LUT_LOAD_INV, 5U, VEHICLE_MAP_UNIFORM
+};
+
+static const float VEHICLE_LUT_HEAT_Z[75] = {   /* degC/s, [load][rpm] */
+             0.0f,         0.05f,        0.075f,          0.1f,        0.125f,
+         0.15625f,       0.1875f,      0.21875f,         0.25f,      0.28125f,
+          0.3125f,      0.34375f,        0.375f,      0.40625f,       0.4375f,
+             0.0f,     0.157233f,    0.2634956f,    0.3948908f,     0.533407f,
+       0.7060287f,    0.8786504f,     1.043418f,     1.192478f,     1.317976f,
+        1.412057f,     1.466869f,     1.474557f,       1.3592f,       0.4375f,
+             0.0f,    0.2644661f,    0.4519911f,    0.6897817f,    0.9418141f,
+        1.255807f,     1.569801f,     1.868086f,     2.134956f,     2.354701f,
+        2.511615f,     2.589989f,     2.574115f,      2.31215f,       0.4375f,
+             0.0f,    0.3716991f,    0.6404867f,    0.9846725f,     1.350221f,
+        1.805586f,     2.260951f,     2.692754f,     3.077433f,     3.391427f,
+        3.611172f,     3.713108f,     3.673672f,     3.265099f,       0.4375f,
+             0.0f,    0.4789321f,    0.8289822f,     1.279563f,     1.758628f,
+        2.355365f,     2.952102f,     3.517422f,     4.019911f,     4.428152f,
+         4.71073f,     4.836227f,      4.77323f,     4.218049f,       0.4375f,
+};
+
+static const VehicleMap2D_t VEHICLE_LUT_HEAT = {
+    &VEHICLE_LUT_RPM_AXIS, &VEHICLE_LUT_LOAD_AXIS, VEHICLE_LUT_HEAT_Z
+};
+
+/* --------------------------------------------------------------------------
+ * Coolant axis: thermostat opening x fan
+ * -------------------------------------------------------------------------- */
+
+static const float VEHICLE_LUT_TEMP_BP[6] = {   /* degC */
+           -40.0f,         82.0f,         95.0f,        100.0f,        101.0f,        140.0f,
+};
+
+static const float VEHICLE_LUT_TEMP_INV[5] = {   /* 1 / segment width */
+     0.008196721f,   0.07692308f,          0.2f,          1.0f,   0.02564103f,
+};
+
+static const VehicleMapAxis_t VEHICLE_LUT_TEMP_AXIS = {
+    VEHICLE_LUT_TEMP_BP, VEHICLE_LUT_TEMP_INV, 6U, VEHICLE_MAP_HINT
+};
+
+static const float VEHICLE_LUT_RADIATOR_Z[6] = {   /* thermostat opening x fan */
+             0.0f,          0.0f,          1.0f,          1.0f,          2.0f,          2.0f,
+};
+
+static const VehicleMap1D_t VEHICLE_LUT_RADIATOR = {
+    &VEHICLE_LUT_TEMP_AXIS, VEHICLE_LUT_RADIATOR_Z
+};
+
+/* --------------------------------------------------------------------------
+ * Gearbox
+ * -------------------------------------------------------------------------- */
+
+static const float VEHICLE_LUT_RPM_PER_KPH[6] = {   /* per gear */
+        126.2971f,     73.67334f,     49.11556f,     36.83667f,     29.82016f,     24.55778f,
+};
+
+static const float VEHICLE_LUT_ACCEL_PER_NM[6] = {   /* km/h/s per N*m, per gear */
+        0.118666f,   0.06922184f,   0.04614789f,   0.03461092f,   0.02801836f,   0.02307395f,
+};
+
+static const float VEHICLE_LUT_UP_KPH[6] = {   /* upshift speed at zero load, per gear */
+        17.41924f,     29.86155f,     44.79232f,      59.7231f,     73.77559f,     89.58465f,
+};
+
+static const float VEHICLE_LUT_UP_FULL_KPH[6] = {   /* upshift speed at full load, per gear */
+        47.50701f,     81.44059f,     122.1609f,     162.8812f,     201.2062f,     244.3218f,
+};
+
+static const float VEHICLE_LUT_DOWN_KPH[6] = {   /* downshift speed at zero load, per gear */
+        9.501402f,     16.28812f,     24.43218f,     32.57624f,     40.24123f,     48.86435f,
+};
+
+static const float VEHICLE_LUT_DOWN_FULL_KPH[6] = {   /* downshift speed at full load, per gear */
+        21.37815f,     36.64827f,      54.9724f,     73.29653f,     90.54277f,     109.9448f,
+};
+
+#endif /* VEHICLE_LUT_H */
@@ -0,0 +1,245 @@
+#ifndef VEHICLE_MAP_H
+#define VEHICLE_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "vehicle_q16.h"
+
+/*
+ * Module: Calibration maps (vehicle_map)
+ *
+ * Role:
+ *   - 1-D curves and 2-D maps over breakpoint axes, with linear and
+ *     bilinear interpolation, for the model's engine and thermal tables
+ *     (torque curve, radiator curve, heat map). Float and Q16.16 variants.
+ *   - Axis search: each axis carries the method suited to it.
+ *       UNIFORM - evenly spaced breakpoints: index by one multiply.
+ *       HINT    - start from the caller's last segment and step to the
+ *                 neighbour; the input of a model moves little between
+ *                 steps, so this is usually one or two compares. Falls
+ *                 back to a binary search on a jump.
+ *       BINARY  - bisection, log2(n) compares, no state.
+ *
+ * Tables are const and generated at build time (vehicle_lut.h from
+ * Tools/vehicle_lut/gen_vehicle_lut.py): with the breakpoints, every
+ * axis holds the reciprocal of each segment width, so interpolation
+ * does no division. Inputs outside an axis are clamped to its ends.
+ *
+ * A hint is a plain uint16_t owned by the caller (e.g. one per vehicle
+ * and axis); any value is valid, a stale one only costs a search.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial maps: uniform / hint / binary search, float and Q16.16.
+ */
+
+typedef enum
+{
+    VEHICLE_MAP_UNIFORM = 0,   /**< Evenly spaced; inv[0] is 1 / spacing   */
+    VEHICLE_MAP_HINT    = 1,   /**< Last segment first, then binary        */
+    VEHICLE_MAP_BINARY  = 2    /**< Bisection                              */
+} VehicleMapSearch_t;
+
+/** Last segment found on an axis; kept by the caller between lookups. */
+typedef uint16_t VehicleMapHint_t;
+
+/**
+ * @brief Breakpoint axis (float).
+ */
+typedef struct
+{
+    const float *bp;        /**< [n] breakpoints, strictly ascending       */
+    const float *inv;       /**< [n - 1] 1 / (bp[i + 1] - bp[i])           */
+    uint16_t     n;         /**< Breakpoints, >= 2                         */
+    uint8_t      search;    /**< VehicleMapSearch_t                        */
+} VehicleMapAxis_t;
+
+/**
+ * @brief Position on an axis: segment and fraction within it.
+ *
+ * One axis search can serve several tables over the same axis.
+ */
+typedef struct
+{
+    uint16_t i;             /**< Segment, 0 .. n - 2                       */
+    float    f;             /**< Fraction, 0 .. 1                          */
+} VehicleMapPos_t;
+
+/**
+ * @brief 1-D curve: z[i] at x->bp[i].
+ */
+typedef struct
+{
+    const VehicleMapAxis_t *x;
+    const float            *z;   /**< [x->n]                               */
+} VehicleMap1D_t;
+
+/**
+ * @brief 2-D map: z[j * x->n + i] at (x->bp[i], y->bp[j]).
+ */
+typedef struct
+{
+    const VehicleMapAxis_t *x;
+    const VehicleMapAxis_t *y;
+    const float            *z;   /**< [y->n][x->n], row per y breakpoint   */
+} VehicleMap2D_t;
+
+/**
+ * @brief Breakpoint axis (Q16.16).
+ *
+ * inv[i] is 2^32 / (bp[i + 1] - bp[i]) with the width in raw Q16.16
+ * units, so the fraction is one 32 x 32 -> 64-bit multiply.
+ */
+typedef struct
+{
+    const q16_16_t *bp;     /**< [n] breakpoints, strictly ascending       */
+    const uint32_t *inv;    /**< [n - 1] 2^32 / raw segment width          */
+    uint16_t        n;      /**< Breakpoints, >= 2                         */
+    uint8_t         search; /**< VehicleMapSearch_t                        */
+} VehicleMapAxisQ16_t;
+
+typedef struct
+{
+    uint16_t i;             /**< Segment, 0 .. n - 2                       */
+    uint32_t f;             /**< Fraction, Q16.16, 0 .. 65536              */
+} VehicleMapPosQ16_t;
+
+typedef struct
+{
+    const VehicleMapAxisQ16_t *x;
+    const q16_16_t            *z;
+} VehicleMap1DQ16_t;
+
+typedef struct
+{
+    const VehicleMapAxisQ16_t *x;
+    const VehicleMapAxisQ16_t *y;
+    const q16_16_t            *z;
+} VehicleMap2DQ16_t;
+
+/* --------------------------------------------------------------------------
+ * Float API
+ *
+ * The per-lookup path is inline: on the const axes of vehicle_lut.h the
+ * search method folds at compile time, and a hint still in its segment
+ * costs two compares. Binary search and the hint's neighbour / fallback
+ * steps are out of line.
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Segment search by one method, whatever the axis' own.
+ *
+ * For comparing methods; VehicleMap_Find() picks the axis' method.
+ * VehicleMap_FindUniform() is only valid on evenly spaced axes.
+ *
+ * @return Segment i with bp[i] <= x < bp[i + 1], clamped to 0 .. n - 2
+ *         (NaN counts as below the axis).
+ */
+uint16_t VehicleMap_FindBinary(const VehicleMapAxis_t *ax, float x);
+uint16_t VehicleMap_FindHint(const VehicleMapAxis_t *ax, float x,
+                             VehicleMapHint_t *hint);
+uint16_t VehicleMap_FindLinear(const VehicleMapAxis_t *ax, float x);
+
+static inline uint16_t VehicleMap_FindUniform(const VehicleMapAxis_t *ax, float x)
+{
+    const uint16_t last = (uint16_t)(ax->n - 2U);
+
+    if (!(x > ax->bp[0])) return 0U;
+
+    const float k = (x - ax->bp[0]) * ax->inv[0];
+    if (k >= (float)last) return last;
+    return (uint16_t)k;
+}
+
+/**
+ * @brief Segment containing x, with the axis' own search method.
+ *
+ * @param ax   Axis.
+ * @param x    Input; clamped to [bp[0], bp[n - 1]].
+ * @param hint Last segment on this axis (HINT axes; updated). May be NULL.
+ */
+static inline VehicleMapPos_t VehicleMap_Find(const VehicleMapAxis_t *ax, float x,
+                                              VehicleMapHint_t *hint)
+{
+    VehicleMapPos_t p;
+
+    if (ax->search == VEHICLE_MAP_UNIFORM)
+    {
+        p.i = VehicleMap_FindUniform(ax, x);
+    }
+    else if (ax->search == VEHICLE_MAP_HINT && hint != NULL)
+    {
+        p.i = *hint;
+        if (!(p.i + 1U < ax->n && x >= ax->bp[p.i] && x < ax->bp[p.i + 1U]))
+        {
+            p.i = VehicleMap_FindHint(ax, x, hint);
+        }
+    }
+    else
+    {
+        p.i = VehicleMap_FindBinary(ax, x);
+    }
+
+    /* Clamp covers inputs off either end as well as rounding */
+    float f = (x - ax->bp[p.i]) * ax->inv[p.i];
+    if (!(f > 0.0f)) f = 0.0f;
+    if (f > 1.0f)    f = 1.0f;
+    p.f = f;
+    return p;
+}
+
+/**
+ * @brief Value of a 1-D curve at a found position.
+ */
+static inline float VehicleMap_At1D(const float *z, VehicleMapPos_t p)
+{
+    return z[p.i] + (z[p.i + 1U] - z[p.i]) * p.f;
+}
+
+/**
+ * @brief Value of a 2-D map at found positions (bilinear).
+ */
+static inline float VehicleMap_At2D(const VehicleMap2D_t *m, VehicleMapPos_t px,
+                                    VehicleMapPos_t py)
+{
+    const uint32_t nx = m->x->n;
+    const float   *z0 = &m->z[(uint32_t)py.i * nx + px.i];
+    const float   *z1 = z0 + nx;
+
+    const float a = z0[0] + (z0[1] - z0[0]) * px.f;
+    const float b = z1[0] + (z1[1] - z1[0]) * px.f;
+    return a + (b - a) * py.f;
+}
+
+/**
+ * @brief Interpolated value of a 1-D curve at x.
+ */
+static inline float VehicleMap_Lookup1D(const VehicleMap1D_t *m, float x,
+                                        VehicleMapHint_t *hint)
+{
+    return VehicleMap_At1D(m->z, VehicleMap_Find(m->x, x, hint));
+}
+
+/**
+ * @brief Interpolated value of a 2-D map at (x, y).
+ */
+static inline float VehicleMap_Lookup2D(const VehicleMap2D_t *m, float x, float y,
+                                        VehicleMapHint_t *hx, VehicleMapHint_t *hy)
+{
+    return VehicleMap_At2D(m, VehicleMap_Find(m->x, x, hx),
+                           VehicleMap_Find(m->y, y, hy));
+}
+
+/* --------------------------------------------------------------------------
+ * Q16.16 API (same rules; integer-only and bit-exact on every platform)
+ * -------------------------------------------------------------------------- */
+
+VehicleMapPosQ16_t VehicleMap_FindQ16(const VehicleMapAxisQ16_t *ax, q16_16_t x,
+                                      VehicleMapHint_t *hint);
+
+q16_16_t VehicleMap_Lookup1DQ16(const VehicleMap1DQ16_t *m, q16_16_t x,
+                                VehicleMapHint_t *hint);
+
+q16_16_t VehicleMap_Lookup2DQ16(const VehicleMap2DQ16_t *m, q16_16_t x, q16_16_t y,
+                                VehicleMapHint_t *hx, VehicleMapHint_t *hy);
+
+#endif /* VEHICLE_MAP_H */
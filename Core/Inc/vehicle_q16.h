@@ -0,0 +1,88 @@
+#ifndef VEHICLE_Q16_H
+#define VEHICLE_Q16_H
+
+#include <stdint.h>
+
+/*
+ * Module: Fixed-point vehicle model (vehicle_q16)
+ *
+ * Role:
+ *   - The vehicle model of vehicle.c in Q16.16 fixed point: integer-only,
+ *     so it needs no FPU and gives bit-identical results on the Cortex-M4
+ *     and on any host (telemetry replays match exactly).
+ *   - Always compiled. Building with VEHICLE_FIXED_POINT=1 makes
+ *     VehicleState_t and the Vehicle_* API in vehicle.h use it.
+ *
+ * Arithmetic rules (these define the bit-exact behaviour):
+ *   - Values are int32_t with 16 fractional bits.
+ *   - Products are formed in 64 bits and rounded half-up:
+ *       q16_mul(a, b) = (a * b + 2^15) >> 16   (arithmetic shift, as GCC does)
+ *   - Constants are rounded to nearest at compile time (VEHICLE_Q16()).
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial Q16.16 model.
+ */
+
+/** Q16.16 fixed-point value. */
+typedef int32_t q16_16_t;
+
+#define VEHICLE_Q16_ONE        ((q16_16_t)65536)
+
+/** Compile-time Q16.16 constant from a literal, rounded to nearest. */
+#define VEHICLE_Q16(x)         ((q16_16_t)(((x) * 65536.0) + (((x) >= 0) ? 0.5 : -0.5)))
+
+/** Time step in Q16.16 seconds from milliseconds, rounded to nearest. */
+#define VEHICLE_Q16_FROM_MS(ms) ((q16_16_t)((((int64_t)(ms) << 16) + 500) / 1000))
+
+/**
+ * @brief Vehicle state in Q16.16 (same fields and units as VehicleState_t).
+ */
+typedef struct
+{
+    q16_16_t speed_kph;        /**< Vehicle speed in km/h, Q16.16        */
+    uint16_t engine_rpm;       /**< Engine speed in RPM                  */
+    q16_16_t coolant_temp_c;   /**< Coolant temperature in °C, Q16.16    */
+} VehicleStateQ16_t;
+
+/**
+ * @brief Q16.16 multiply, 64-bit intermediate, rounded half-up.
+ */
+static inline q16_16_t q16_mul(q16_16_t a, q16_16_t b)
+{
+    return (q16_16_t)((((int64_t)a * (int64_t)b) + 32768) >> 16);
+}
+
+/**
+ * @brief Initialize to the same defaults as Vehicle_Init().
+ */
+void VehicleQ16_Init(VehicleStateQ16_t *vs);
+
+/**
+ * @brief One model step; the fixed-point twin of Vehicle_Update().
+ *
+ * @param vs    Pointer to vehicle state.
+ * @param dt    Time step in seconds, Q16.16 (e.g. VEHICLE_Q16_FROM_MS(100)).
+ */
+void VehicleQ16_Update(VehicleStateQ16_t *vs, q16_16_t dt);
+
+/**
+ * @brief Set speed, clamped to [0, 200] km/h.
+ */
+void VehicleQ16_SetTargetSpeed(VehicleStateQ16_t *vs, q16_16_t target_speed_kph);
+
+/**
+ * @brief Force state values (clamped like Vehicle_Force()).
+ */
+void VehicleQ16_Force(VehicleStateQ16_t *vs,
+                      q16_16_t speed_kph,
+                      uint16_t rpm,
+                      q16_16_t temp_c);
+
+/**
+ * @brief Telemetry scaling: value * 10, truncated toward zero.
+ *
+ * Matches the (int)(x * 10.0f) conversion of the float build.
+ */
+int32_t VehicleQ16_ToTenths(q16_16_t v);
+
+#endif /* VEHICLE_Q16_H */
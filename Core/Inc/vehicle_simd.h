@@ -0,0 +1,88 @@
+#ifndef VEHICLE_SIMD_H
+#define VEHICLE_SIMD_H
+
+#include "vehicle.h"
+#include <stdint.h>
+
+/*
+ * Module: Vectorized vehicle model kernels (vehicle_simd)
+ *
+ * Role:
+ *   - Branch-free variants of the Vehicle_Update() step for fleets in
+ *     structure-of-arrays layout (VehicleFleet_t). Data-dependent branches
+ *     become compare masks + select, clamp_f() becomes min/max.
+ *   - One kernel per instruction set, selected at run time on the host:
+ *       SSE2 (4 lanes), AVX2 (8 lanes), AVX-512F (16 lanes), NEON (4 lanes).
+ *   - A portable branch-free scalar kernel. This is the Cortex-M4 path: the
+ *     M4's DSP SIMD instructions (SADD16, USAT16, ...) only operate on 8/16-bit
+ *     integers and FPv4-SP is scalar, so for this float model the gain on
+ *     target comes from predicated VCMP/VMOV instead of branches.
+ *
+ * Conformance with the scalar reference (Vehicle_UpdateBatch()):
+ *   Every kernel performs the same IEEE-754 single-precision operations in
+ *   the same order as Vehicle_Update(), so results are bit-identical as long
+ *   as the compiler does not contract a*b+c into a fused multiply-add in one
+ *   path but not the other. Where that can happen (e.g. -mfma, AArch64) the
+ *   documented per-step tolerance is:
+ *     - speed_kph, coolant_temp_c : VEHICLE_SIMD_TOL_ULP units in the last place
+ *     - engine_rpm                : VEHICLE_SIMD_TOL_RPM
+ *   Host/Bench/bench_fleet.c checks all available kernels against it.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial SSE2 / AVX2 / AVX-512F / NEON / branch-free kernels.
+ */
+
+#define VEHICLE_SIMD_TOL_ULP   1U   /**< Max float difference per step, in ULP */
+#define VEHICLE_SIMD_TOL_RPM   1U   /**< Max engine_rpm difference per step    */
+
+/**
+ * @brief Available step kernels.
+ */
+typedef enum
+{
+    VEHICLE_KERNEL_SCALAR = 0,     /**< Vehicle_UpdateBatch() (reference)     */
+    VEHICLE_KERNEL_BRANCHFREE,     /**< Portable select/min/max, 1 lane       */
+    VEHICLE_KERNEL_SSE2,           /**< x86 SSE2, 4 lanes                     */
+    VEHICLE_KERNEL_AVX2,           /**< x86 AVX2, 8 lanes                     */
+    VEHICLE_KERNEL_AVX512,         /**< x86 AVX-512F, 16 lanes                */
+    VEHICLE_KERNEL_NEON,           /**< ARM NEON, 4 lanes                     */
+    VEHICLE_KERNEL_COUNT
+} VehicleKernel_t;
+
+/**
+ * @brief Check whether a kernel was compiled in and is supported by this CPU.
+ *
+ * @retval 1 if available, 0 otherwise.
+ */
+uint8_t Vehicle_KernelAvailable(VehicleKernel_t kernel);
+
+/**
+ * @brief Widest available kernel on this CPU.
+ */
+VehicleKernel_t Vehicle_KernelBest(void);
+
+/**
+ * @brief Short name of a kernel ("sse2", "avx2", ...), for reports.
+ */
+const char *Vehicle_KernelName(VehicleKernel_t kernel);
+
+/**
+ * @brief Step every vehicle of a fleet with the given kernel.
+ *
+ * @param fleet   Fleet descriptor.
+ * @param dt_s    Time step in seconds.
+ * @param kernel  Kernel to use.
+ * @retval 1 if the step ran, 0 if the kernel is not available.
+ */
+uint8_t Vehicle_UpdateBatchKernel(const VehicleFleet_t *fleet, float dt_s,
+                                  VehicleKernel_t kernel);
+
+/**
+ * @brief Step every vehicle of a fleet with the widest available kernel.
+ *
+ * @param fleet   Fleet descriptor.
+ * @param dt_s    Time step in seconds.
+ */
+void Vehicle_UpdateBatchSimd(const VehicleFleet_t *fleet, float dt_s);
+
+#endif /* VEHICLE_SIMD_H */
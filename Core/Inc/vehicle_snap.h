@@ -0,0 +1,71 @@
+#ifndef VEHICLE_SNAP_H
+#define VEHICLE_SNAP_H
+
+#include <stdint.h>
+#include "vehicle.h"
+
+/*
+ * Module: Vehicle state snapshot (vehicle_snap)
+ *
+ * Role:
+ *   - Publishes the vehicle state from its single writer (VehicleTask) to
+ *     any number of readers (CLI, hostlink, ...) without a mutex. Readers
+ *     always get all fields from the same model step.
+ *
+ * Scheme: a sequence counter over two copies (a "latch" seqlock).
+ *   - Publish() bumps seq to odd and writes slot 0, then bumps it to even
+ *     and writes slot 1. It never waits and costs two small copies.
+ *   - Read() copies slot[seq & 1], which the writer is not touching, and
+ *     retries only if seq moved meanwhile.
+ *   A plain seqlock (one copy, readers spin while seq is odd) would hang
+ *   a reader that preempts the writer mid-update on a single core. No
+ *   task reader runs above VehicleTask (osPriorityRealtime) today, but
+ *   the scheme does not rely on that: with two copies a reader that
+ *   preempts the writer finishes on the first pass; it retries only when
+ *   the writer preempted it, and then once per publish.
+ *
+ * No HAL or RTOS dependency: ordering uses GCC's __atomic builtins (DMB on
+ * the Cortex-M4), so the host benchmark runs it on real parallel threads.
+ *
+ * Version history (module-level):
+ *   v2.4 - Initial snapshot: latch seqlock, wait-free writer.
+ */
+
+/**
+ * @brief One published model step.
+ */
+typedef struct
+{
+    VehicleState_t state;   /**< Vehicle state after the step             */
+    uint32_t       step;    /**< Publish count since VehicleSnap_Init()    */
+} VehicleSample_t;
+
+/**
+ * @brief Snapshot shared by one writer and any number of readers.
+ */
+typedef struct
+{
+    uint32_t        seq;       /**< Bumped twice per publish              */
+    VehicleSample_t slot[2];   /**< Readers use slot[seq & 1]             */
+} VehicleSnap_t;
+
+/**
+ * @brief Publish an initial state (step 0). Call before any reader runs.
+ */
+void VehicleSnap_Init(VehicleSnap_t *snap, const VehicleState_t *vs);
+
+/**
+ * @brief Publish a new state. Single writer only; never blocks.
+ */
+void VehicleSnap_Publish(VehicleSnap_t *snap, const VehicleState_t *vs);
+
+/**
+ * @brief Copy the latest published step, consistent across all fields.
+ *
+ * @param snap Snapshot.
+ * @param out  Destination.
+ * @return Number of retries (0 unless a publish overlapped the copy).
+ */
+uint32_t VehicleSnap_Read(const VehicleSnap_t *snap, VehicleSample_t *out);
+
+#endif /* VEHICLE_SNAP_H */
@@ -0,0 +1,261 @@
+/**
+ * @file    can_filter.c
+ * @brief   Compiles ID / ID-range tables into bxCAN filter banks.
+ */
+
+#include "can_filter.h"
+#include <string.h>
+
+#define STD_ID_MAX   0x7FFU
+#define EXT_ID_MAX   0x1FFFFFFFU
+
+/* Entry categories, in packing order within one FIFO */
+enum { CAT_STD_LIST = 0, CAT_STD_MASK, CAT_EXT_LIST, CAT_EXT_MASK, CAT_COUNT };
+
+/* Bank currently being filled */
+typedef struct
+{
+    CAN_FILTER_Plan_t *plan;
+    uint8_t  fifo;
+    uint8_t  cat;
+    uint8_t  used;
+    uint8_t  overflow;
+    uint32_t word[4];
+    uint32_t mask[4];
+    uint8_t  rule[4];
+} CanFilterPacker_t;
+
+static uint8_t cat_slots(uint8_t cat)
+{
+    static const uint8_t slots[CAT_COUNT] = { 4U, 2U, 2U, 1U };
+    return slots[cat];
+}
+
+/* Register layout (RM0390): 16-bit  STDID[10:0] RTR IDE EXID[17:15]
+                             32-bit  STDID/EXID[28:0] IDE RTR 0         */
+static uint32_t word16_std(uint32_t id)       { return (id & STD_ID_MAX) << 5; }
+static uint32_t mask16_std(uint32_t idmask)   { return ((idmask & STD_ID_MAX) << 5) | 0x18U; }
+static uint32_t word32_ext(uint32_t id)       { return ((id & EXT_ID_MAX) << 3) | 0x4U; }
+static uint32_t mask32_ext(uint32_t idmask)   { return ((idmask & EXT_ID_MAX) << 3) | 0x6U; }
+
+static void packer_flush(CanFilterPacker_t *p)
+{
+    CAN_FILTER_Plan_t *plan = p->plan;
+    const uint8_t slots = cat_slots(p->cat);
+
+    if (p->used == 0U)
+    {
+        return;
+    }
+    if (plan->bank_count >= CAN_FILTER_BANKS)
+    {
+        p->overflow = 1U;
+        p->used = 0U;
+        return;
+    }
+
+    /* Unused slots repeat the last entry, so they can never widen the match */
+    for (uint8_t i = p->used; i < slots; i++)
+    {
+        p->word[i] = p->word[p->used - 1U];
+        p->mask[i] = p->mask[p->used - 1U];
+        p->rule[i] = p->rule[p->used - 1U];
+    }
+
+    CAN_FILTER_Bank_t *bk = &plan->bank[plan->bank_count++];
+    bk->fifo      = p->fifo;
+    bk->list_mode = (p->cat == CAT_STD_LIST || p->cat == CAT_EXT_LIST) ? 1U : 0U;
+    bk->scale32   = (p->cat == CAT_EXT_LIST || p->cat == CAT_EXT_MASK) ? 1U : 0U;
+
+    switch (p->cat)
+    {
+        case CAT_STD_LIST:
+            bk->fr1 = p->word[0] | (p->word[1] << 16);
+            bk->fr2 = p->word[2] | (p->word[3] << 16);
+            break;
+        case CAT_STD_MASK:
+            bk->fr1 = p->word[0] | (p->mask[0] << 16);
+            bk->fr2 = p->word[1] | (p->mask[1] << 16);
+            break;
+        case CAT_EXT_LIST:
+            bk->fr1 = p->word[0];
+            bk->fr2 = p->word[1];
+            break;
+        default:
+            bk->fr1 = p->word[0];
+            bk->fr2 = p->mask[0];
+            break;
+    }
+
+    /* FMIs are numbered per FIFO, one per filter, in bank order */
+    for (uint8_t i = 0U; i < slots; i++)
+    {
+        plan->fmi_rule[p->fifo][plan->fmi_count[p->fifo]++] = p->rule[i];
+    }
+    p->used = 0U;
+}
+
+static void packer_add(CanFilterPacker_t *p, uint32_t word, uint32_t mask, uint8_t rule)
+{
+    p->word[p->used] = word;
+    p->mask[p->used] = mask;
+    p->rule[p->used] = rule;
+    if (++p->used == cat_slots(p->cat))
+    {
+        packer_flush(p);
+    }
+}
+
+/* Emit the entries of one rule that belong to the packer's category */
+static void packer_add_rule(CanFilterPacker_t *p, const CAN_FILTER_Rule_t *r, uint8_t idx)
+{
+    const uint8_t  want_list = (p->cat == CAT_STD_LIST || p->cat == CAT_EXT_LIST) ? 1U : 0U;
+    const uint32_t id_max    = r->extended ? EXT_ID_MAX : STD_ID_MAX;
+    uint32_t lo = r->id_first;
+
+    /* Largest aligned power-of-two blocks that fit, lowest first */
+    for (;;)
+    {
+        const uint32_t span = r->id_last - lo;          /* block size - 1 must be <= span */
+        uint32_t size = (lo == 0U) ? (id_max + 1U) : (lo & (0U - lo));
+        while (size - 1U > span)
+        {
+            size >>= 1;
+        }
+
+        if ((size == 1U) == (want_list == 1U))
+        {
+            const uint32_t idmask = ~(size - 1U) & id_max;
+            if (r->extended)
+            {
+                packer_add(p, word32_ext(lo), want_list ? 0U : mask32_ext(idmask), idx);
+            }
+            else
+            {
+                packer_add(p, word16_std(lo), want_list ? 0U : mask16_std(idmask), idx);
+            }
+        }
+
+        if (size - 1U == span)
+        {
+            break;
+        }
+        lo += size;
+    }
+}
+
+HAL_StatusTypeDef CAN_FILTER_Compile(const CAN_FILTER_Rule_t *rules,
+                                     uint32_t count,
+                                     CAN_FILTER_Plan_t *plan)
+{
+    static const uint8_t fifo_order[2] = { CAN_FILTER_FIFO1, CAN_FILTER_FIFO0 };
+    CanFilterPacker_t p;
+
+    if (plan == NULL || (rules == NULL && count != 0U) || count > CAN_FILTER_MAX_RULES)
+    {
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const uint32_t id_max = rules[i].extended ? EXT_ID_MAX : STD_ID_MAX;
+        if (rules[i].id_first > rules[i].id_last || rules[i].id_last > id_max ||
+            (rules[i].fifo != CAN_FILTER_FIFO0 && rules[i].fifo != CAN_FILTER_FIFO1))
+        {
+            return HAL_ERROR;
+        }
+    }
+
+    memset(plan, 0, sizeof(*plan));
+    memset(plan->fmi_rule, CAN_FILTER_NO_RULE, sizeof(plan->fmi_rule));
+    memset(&p, 0, sizeof(p));
+    p.plan = plan;
+
+    for (uint32_t f = 0U; f < 2U; f++)
+    {
+        p.fifo = fifo_order[f];
+        for (uint8_t cat = 0U; cat < CAT_COUNT; cat++)
+        {
+            p.cat = cat;
+            for (uint32_t i = 0U; i < count; i++)
+            {
+                const uint8_t ext = (cat == CAT_EXT_LIST || cat == CAT_EXT_MASK) ? 1U : 0U;
+                if (rules[i].fifo == p.fifo && (rules[i].extended ? 1U : 0U) == ext)
+                {
+                    packer_add_rule(&p, &rules[i], (uint8_t)i);
+                }
+            }
+            packer_flush(&p);
+        }
+    }
+
+    return p.overflow ? HAL_ERROR : HAL_OK;
+}
+
+HAL_StatusTypeDef CAN_FILTER_Apply(CAN_HandleTypeDef *hcan, const CAN_FILTER_Plan_t *plan)
+{
+    CAN_FilterTypeDef cfg;
+    HAL_StatusTypeDef st;
+
+    if (hcan == NULL || plan == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    for (uint32_t b = 0U; b < CAN_FILTER_BANKS; b++)
+    {
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.FilterBank           = b;
+        cfg.SlaveStartFilterBank = CAN_FILTER_BANKS;   /* CAN2 gets bank 27 only */
+
+        if (b < plan->bank_count)
+        {
+            const CAN_FILTER_Bank_t *bk = &plan->bank[b];
+
+            cfg.FilterMode           = bk->list_mode ? CAN_FILTERMODE_IDLIST : CAN_FILTERMODE_IDMASK;
+            cfg.FilterScale          = bk->scale32 ? CAN_FILTERSCALE_32BIT : CAN_FILTERSCALE_16BIT;
+            cfg.FilterFIFOAssignment = bk->fifo;
+            cfg.FilterActivation     = CAN_FILTER_ENABLE;
+
+            if (bk->scale32)
+            {
+                /* FR1 = IdHigh:IdLow, FR2 = MaskIdHigh:MaskIdLow */
+                cfg.FilterIdHigh     = bk->fr1 >> 16;
+                cfg.FilterIdLow      = bk->fr1 & 0xFFFFU;
+                cfg.FilterMaskIdHigh = bk->fr2 >> 16;
+                cfg.FilterMaskIdLow  = bk->fr2 & 0xFFFFU;
+            }
+            else
+            {
+                /* FR1 = MaskIdLow:IdLow, FR2 = MaskIdHigh:IdHigh */
+                cfg.FilterIdLow      = bk->fr1 & 0xFFFFU;
+                cfg.FilterMaskIdLow  = bk->fr1 >> 16;
+                cfg.FilterIdHigh     = bk->fr2 & 0xFFFFU;
+                cfg.FilterMaskIdHigh = bk->fr2 >> 16;
+            }
+        }
+        else
+        {
+            cfg.FilterMode           = CAN_FILTERMODE_IDMASK;
+            cfg.FilterScale          = CAN_FILTERSCALE_32BIT;
+            cfg.FilterFIFOAssignment = CAN_FILTER_FIFO0;
+            cfg.FilterActivation     = CAN_FILTER_DISABLE;
+        }
+
+        st = HAL_CAN_ConfigFilter(hcan, &cfg);
+        if (st != HAL_OK)
+        {
+            return st;
+        }
+    }
+    return HAL_OK;
+}
+
+int32_t CAN_FILTER_RuleForFmi(const CAN_FILTER_Plan_t *plan, uint32_t fifo, uint32_t fmi)
+{
+    if (plan == NULL || fifo > 1U || fmi >= plan->fmi_count[fifo] ||
+        plan->fmi_rule[fifo][fmi] == CAN_FILTER_NO_RULE)
+    {
+        return -1;
+    }
+    return (int32_t)plan->fmi_rule[fifo][fmi];
+}
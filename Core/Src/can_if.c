@@ -8,35 +8,142 @@
  *   v2.0 - FreeRTOS tasks + CAN loopback telemetry.
  *   v2.1 - CAN_IF abstraction, RX queue, logging via CLI.
  *   v2.2 - VehicleState_t model + CAN telemetry encoding.
+ *   v2.4 - Zero-copy SPSC RX ring with thread-flag wakeup.
+ *        - RX ISR drains all of FIFO0 per interrupt, time-stamps each frame.
+ *        - Compiled hardware filters; control IDs via FIFO1 with own ISR/ring.
+ *        - Priority-ordered software TX queue refilled from the TX ISR.
+ *        - Console output through the DMA TX ring (uart_tx); one write per
+ *          log line.
+ *        - Start-up and RX log through the deferred logger (dlog): records,
+ *          not snprintf(), on the RX path.
+ *        - Own CLI commands (log on/off, can stats) via CLI_IF_CMD().
+ *        - Received frames feed the hostlink CAN stream.
+ *        - Legacy RX queue storage is static in the VECU_STATIC_ALLOC profile.
+ *        - Telemetry send and FIFO0 RX callback feed probe histograms.
+ *        - CAN1 RX0, RX1 and TX vectors at one priority: no nested drain.
  */
 
 #include "can_if.h"
+#include "can_filter.h"
+#include "can_db.h"
+#include "cli_if.h"
+#include "hostlink.h"
+#include "cyccnt.h"
+#include "dlog.h"
+#include "rtos_static.h"
+#include "probe.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include <string.h>
 #include <stdio.h>
 
 /* External handles generated by CubeMX */
 extern CAN_HandleTypeDef  hcan1;
-extern UART_HandleTypeDef huart2;
 
-/* --------------------------------------------------------------------------
- * Local helpers
- * -------------------------------------------------------------------------- */
+/* Logging flag: 0 = off, 1 = on (controlled from CLI) */
+static uint8_t s_canLogEnabled = 0;
 
-static void can_uart_print(const char *s)
+#if (CAN_IF_RX_RING_LEN & (CAN_IF_RX_RING_LEN - 1U)) != 0U
+#error "CAN_IF_RX_RING_LEN must be a power of two"
+#endif
+#if (CAN_IF_RX1_RING_LEN & (CAN_IF_RX1_RING_LEN - 1U)) != 0U
+#error "CAN_IF_RX1_RING_LEN must be a power of two"
+#endif
+
+/*
+ * RX rings, one per hardware FIFO: single producer (that FIFO's ISR),
+ * single consumer (the task that calls CAN_IF_RxGet() for it).
+ * Indices run freely and are reduced with the mask; head is written only
+ * by the ISR, tail only by the task, so no lock is needed. The ISR fills
+ * slots before publishing head, and the task reads a slot before
+ * publishing tail (__DMB between the two in each case).
+ *
+ * All three CAN1 vectors run the full HAL_CAN_IRQHandler(), which serves
+ * every pending source, so either FIFO may be drained from any of them.
+ * They share one NVIC preemption priority (stm32f4xx_hal_msp.c): none can
+ * preempt another, and each ring keeps a single producer at a time.
+ */
+typedef struct
 {
-    HAL_UART_Transmit(&huart2, (uint8_t *)s, strlen(s), HAL_MAX_DELAY);
-}
+    CAN_IF_Msg_t          *slot;
+    uint32_t               mask;
+    volatile uint32_t      head;
+    volatile uint32_t      tail;
+    volatile osThreadId_t  consumer;
+    CAN_IF_RxStats_t       stats;
+} CanRxRing_t;
+
+static CAN_IF_Msg_t s_rx0Slots[CAN_IF_RX_RING_LEN];
+static CAN_IF_Msg_t s_rx1Slots[CAN_IF_RX1_RING_LEN];
+
+static CanRxRing_t s_rx[2] = {
+    { s_rx0Slots, CAN_IF_RX_RING_LEN - 1U,  0U, 0U, NULL, { 0 } },
+    { s_rx1Slots, CAN_IF_RX1_RING_LEN - 1U, 0U, 0U, NULL, { 0 } },
+};
 
-/* Logging flag: 0 = off, 1 = on (controlled from CLI) */
-static uint8_t s_canLogEnabled = 0;
+/*
+ * Default RX filter table: control IDs go to FIFO1 (own ISR, ring and
+ * task), everything else is accepted into FIFO0 as before. FIFO1 banks
+ * are placed first, so the control range wins over the catch-all.
+ */
+static const CAN_FILTER_Rule_t s_defaultFilters[] = {
+    { CAN_IF_CTRL_ID_FIRST, CAN_IF_CTRL_ID_LAST, 0U, CAN_FILTER_FIFO1 },
+    { 0x000U,               0x7FFU,              0U, CAN_FILTER_FIFO0 },
+    { 0x00000000U,          0x1FFFFFFFU,         1U, CAN_FILTER_FIFO0 },
+};
 
+/* Filter plan currently programmed (FMI -> rule lookup) */
+static CAN_FILTER_Plan_t s_filterPlan;
+
+/*
+ * TX scheduler: frames wait in a binary min-heap ordered like bus
+ * arbitration (lowest ID first, equal IDs in send order). The three
+ * mailboxes are refilled from the TX-mailbox-empty interrupt. If every
+ * mailbox holds a frame that would lose arbitration to the head of the
+ * queue, the worst one is aborted and requeued, so a low ID never waits
+ * behind higher IDs (priority inversion). State is shared between tasks
+ * and the CAN ISRs (HAL_CAN_IRQHandler serves TX flags from every CAN
+ * vector), so it is only touched with interrupts masked.
+ */
+#define CAN_TX_MAILBOXES   3U
+
+typedef struct
+{
+    uint32_t key;        /* arbitration key, lower wins (can_tx_key)  */
+    uint32_t seq;        /* send order, keeps equal keys FIFO         */
+    uint32_t id;
+    uint8_t  ide;
+    uint8_t  dlc;
+    uint8_t  data[8];
+} CanTxFrame_t;
+
+typedef enum { TX_FREE = 0, TX_LOADED, TX_ABORTING } CanTxState_t;
+
+#if CAN_IF_TX_QUEUE
+/* Room for the queue plus the mailbox frames an abort puts back */
+static CanTxFrame_t     s_txHeap[CAN_IF_TX_QUEUE_LEN + CAN_TX_MAILBOXES];
+static uint32_t         s_txCount;
+static uint32_t         s_txSeq;
+static CanTxFrame_t     s_txMailbox[CAN_TX_MAILBOXES];
+#endif
+static volatile uint8_t s_txState[CAN_TX_MAILBOXES];
+static CAN_IF_TxStats_t s_txStats;
+
+#if CAN_IF_RX_QUEUE
 /* RX message queue handle */
 static osMessageQueueId_t s_canRxQueue = NULL;
 
+/* RX queue: up to 8 pending CAN messages; storage from heap_4 or from
+   rtos_static.h in the static allocation profile */
+#define CAN_IF_RXQ_LEN  8U
+RTOS_STATIC_QUEUE(s_canRxQueueMem, CAN_IF_RXQ_LEN, sizeof(CAN_IF_Msg_t));
+
 /* RX queue attributes (optional name for debugging) */
 static const osMessageQueueAttr_t s_canRxQueueAttr = {
-    .name = "CAN_RX_Queue"
+    .name = "CAN_RX_Queue",
+    RTOS_STATIC_QUEUE_MEM(s_canRxQueueMem)
 };
+#endif
 
 /* --------------------------------------------------------------------------
  * Initialization
@@ -45,75 +152,71 @@ static const osMessageQueueAttr_t s_canRxQueueAttr = {
 HAL_StatusTypeDef CAN_IF_Init(void)
 {
     HAL_StatusTypeDef status;
-    CAN_FilterTypeDef sFilterConfig;
-    char dbg[128];
-
-    /* Configure a simple "accept all" filter into FIFO0 */
-    memset(&sFilterConfig, 0, sizeof(sFilterConfig));
-
-    sFilterConfig.FilterBank           = 0;
-    sFilterConfig.FilterMode           = CAN_FILTERMODE_IDMASK;
-    sFilterConfig.FilterScale          = CAN_FILTERSCALE_32BIT;
-    sFilterConfig.FilterIdHigh         = 0x0000;
-    sFilterConfig.FilterIdLow          = 0x0000;
-    sFilterConfig.FilterMaskIdHigh     = 0x0000;
-    sFilterConfig.FilterMaskIdLow      = 0x0000;
-    sFilterConfig.FilterFIFOAssignment = CAN_FILTER_FIFO0;
-    sFilterConfig.FilterActivation     = ENABLE;
-    sFilterConfig.SlaveStartFilterBank = 14;
-
-    status = HAL_CAN_ConfigFilter(&hcan1, &sFilterConfig);
-    snprintf(dbg, sizeof(dbg),
-             "CAN_IF: ConfigFilter status=%ld err=0x%08lX\r\n",
-             (long)status, (unsigned long)hcan1.ErrorCode);
-    can_uart_print(dbg);
+
+    /* Control IDs into FIFO1, everything else into FIFO0 */
+    status = CAN_IF_ConfigFilters(s_defaultFilters,
+                                  sizeof(s_defaultFilters) / sizeof(s_defaultFilters[0]));
+    DLOG3(DLOG_CAN_FILTERS, status, s_filterPlan.bank_count, hcan1.ErrorCode);
     if (status != HAL_OK)
     {
         return status;
     }
 
+    /* Empty RX rings before any RX interrupt can fire */
+    for (uint32_t f = 0U; f < 2U; f++)
+    {
+        s_rx[f].head = 0U;
+        s_rx[f].tail = 0U;
+        memset(&s_rx[f].stats, 0, sizeof(s_rx[f].stats));
+        s_rx[f].stats.lat_min_cyc = UINT32_MAX;
+    }
+
+    /* Empty TX queue and mailbox shadows */
+#if CAN_IF_TX_QUEUE
+    s_txCount = 0U;
+    s_txSeq   = 0U;
+#endif
+    memset((void *)s_txState, TX_FREE, sizeof(s_txState));
+    memset(&s_txStats, 0, sizeof(s_txStats));
+
     /* Start CAN peripheral (must be in LOOPBACK mode for one-board demo) */
     status = HAL_CAN_Start(&hcan1);
-    snprintf(dbg, sizeof(dbg),
-             "CAN_IF: Start status=%ld state=%lu err=0x%08lX\r\n",
-             (long)status,
-             (unsigned long)hcan1.State,
-             (unsigned long)hcan1.ErrorCode);
-    can_uart_print(dbg);
+    DLOG3(DLOG_CAN_START, status, hcan1.State, hcan1.ErrorCode);
     if (status != HAL_OK)
     {
         return status;
     }
 
     /* Enable CAN interrupts we care about:
-       - RX FIFO0 message pending (for RX path)
+       - RX FIFO0 / FIFO1 message pending (bulk / control RX paths)
+       - TX mailbox empty (refills the mailboxes from the TX queue)
        - Error notifications for debugging
-       (TX mailboxes empty is not required for operation, only for notification)
     */
     status = HAL_CAN_ActivateNotification(
                  &hcan1,
                  CAN_IT_RX_FIFO0_MSG_PENDING |
+                 CAN_IT_RX_FIFO1_MSG_PENDING |
+                 CAN_IT_TX_MAILBOX_EMPTY |
                  CAN_IT_BUSOFF |
                  CAN_IT_ERROR |
                  CAN_IT_LAST_ERROR_CODE |
                  CAN_IT_ERROR_WARNING);
 
-    snprintf(dbg, sizeof(dbg),
-             "CAN_IF: ActivateNotification status=%ld err=0x%08lX\r\n",
-             (long)status, (unsigned long)hcan1.ErrorCode);
-    can_uart_print(dbg);
+    DLOG2(DLOG_CAN_NOTIFY, status, hcan1.ErrorCode);
     if (status != HAL_OK)
     {
         return status;
     }
 
-    /* Create RX message queue: up to 8 pending CAN messages */
-    s_canRxQueue = osMessageQueueNew(8, sizeof(CAN_IF_Msg_t), &s_canRxQueueAttr);
+#if CAN_IF_RX_QUEUE
+    /* Create RX message queue */
+    s_canRxQueue = osMessageQueueNew(CAN_IF_RXQ_LEN, sizeof(CAN_IF_Msg_t), &s_canRxQueueAttr);
     if (s_canRxQueue == NULL)
     {
-        can_uart_print("CAN_IF: Failed to create RX queue\r\n");
+        DLOG0(DLOG_CAN_RXQ_FAIL);
         return HAL_ERROR;
     }
+#endif
 
     return HAL_OK;
 }
@@ -124,63 +227,274 @@ HAL_StatusTypeDef CAN_IF_Init(void)
 
 HAL_StatusTypeDef CAN_IF_SendTelemetry(const VehicleState_t *vs)
 {
+    PROBE_SCOPE(PROBE_CAN_TELEMETRY);
+
     if (vs == NULL)
     {
         return HAL_ERROR;
     }
 
-    CAN_TxHeaderTypeDef txHeader;
-    uint8_t  data[8] = {0};
+    CAN_DB_VehicleTelemetry_t tlm;
+    uint8_t data[CAN_DB_VEHICLE_TELEMETRY_DLC];
+
+    /* Raw values in the units of the signal database (Tools/can_db/vecu.dbc):
+       speed and coolant in 0.1 steps, rpm in 1 rpm */
+    tlm.speed        = (uint16_t)Vehicle_GetSpeedKph10(vs);
+    tlm.engine_rpm   = vs->engine_rpm;
+    tlm.coolant_temp = (int16_t)Vehicle_GetCoolantC10(vs);
+    CAN_DB_VehicleTelemetry_Pack(data, &tlm);
+
+    return CAN_IF_Send(CAN_DB_VEHICLE_TELEMETRY_ID, CAN_DB_VEHICLE_TELEMETRY_IDE,
+                       data, CAN_DB_VEHICLE_TELEMETRY_DLC);
+}
+
+/* --------------------------------------------------------------------------
+ * TX scheduler
+ * -------------------------------------------------------------------------- */
+
+/* Bus arbitration order: the 11 base-ID bits first, then a standard frame
+   before an extended one with the same base (SRR/IDE), then the 18
+   extension bits. */
+static uint32_t can_tx_key(uint32_t id, uint8_t ide)
+{
+    if (ide)
+    {
+        return (((id >> 18) & 0x7FFU) << 19) | (1UL << 18) | (id & 0x3FFFFU);
+    }
+    return (id & 0x7FFU) << 19;
+}
+
+/* Load one frame into a free mailbox; returns the mailbox index or -1 */
+static int32_t can_tx_load(const CanTxFrame_t *f)
+{
+    CAN_TxHeaderTypeDef hdr;
     uint32_t mailbox;
-    HAL_StatusTypeDef st;
 
-    memset(&txHeader, 0, sizeof(txHeader));
+    hdr.StdId = f->ide ? 0U : f->id;
+    hdr.ExtId = f->ide ? f->id : 0U;
+    hdr.IDE   = f->ide ? CAN_ID_EXT : CAN_ID_STD;
+    hdr.RTR   = CAN_RTR_DATA;
+    hdr.DLC   = f->dlc;
+    hdr.TransmitGlobalTime = DISABLE;
 
-    /* Pack vehicle state:
-       - speed_kph * 10 (uint16)
-       - engine_rpm (uint16)
-       - coolant_temp_c * 10 (int16)
-    */
-    uint16_t speed10 = (uint16_t)(vs->speed_kph * 10.0f);
-    int16_t  temp10  = (int16_t)(vs->coolant_temp_c * 10.0f);
+    if (HAL_CAN_AddTxMessage(&hcan1, &hdr, f->data, &mailbox) != HAL_OK)
+    {
+        return -1;
+    }
+    return (int32_t)(mailbox >> 1);   /* CAN_TX_MAILBOX0/1/2 = 1/2/4 */
+}
 
-    data[0] = (uint8_t)(speed10 >> 8);
-    data[1] = (uint8_t)(speed10 & 0xFF);
+#if CAN_IF_TX_QUEUE
+static int can_tx_before(const CanTxFrame_t *a, const CanTxFrame_t *b)
+{
+    return (a->key != b->key) ? (a->key < b->key) : ((int32_t)(a->seq - b->seq) < 0);
+}
 
-    data[2] = (uint8_t)(vs->engine_rpm >> 8);
-    data[3] = (uint8_t)(vs->engine_rpm & 0xFF);
+static void can_tx_push(const CanTxFrame_t *f)
+{
+    uint32_t i = s_txCount++;
 
-    data[4] = (uint8_t)(temp10 >> 8);
-    data[5] = (uint8_t)(temp10 & 0xFF);
+    while (i > 0U)
+    {
+        uint32_t parent = (i - 1U) / 2U;
+        if (!can_tx_before(f, &s_txHeap[parent]))
+        {
+            break;
+        }
+        s_txHeap[i] = s_txHeap[parent];
+        i = parent;
+    }
+    s_txHeap[i] = *f;
+}
 
-    txHeader.StdId = 0x100U;
-    txHeader.ExtId = 0U;
-    txHeader.IDE   = CAN_ID_STD;
-    txHeader.RTR   = CAN_RTR_DATA;
-    txHeader.DLC   = 6U;
-    txHeader.TransmitGlobalTime = DISABLE;
+static void can_tx_pop(void)
+{
+    const CanTxFrame_t last = s_txHeap[--s_txCount];
+    uint32_t i = 0U;
 
-    st = HAL_CAN_AddTxMessage(&hcan1, &txHeader, data, &mailbox);
+    for (;;)
+    {
+        uint32_t child = 2U * i + 1U;
+        if (child >= s_txCount)
+        {
+            break;
+        }
+        if (child + 1U < s_txCount && can_tx_before(&s_txHeap[child + 1U], &s_txHeap[child]))
+        {
+            child++;
+        }
+        if (!can_tx_before(&s_txHeap[child], &last))
+        {
+            break;
+        }
+        s_txHeap[i] = s_txHeap[child];
+        i = child;
+    }
+    s_txHeap[i] = last;
+}
 
-    if (st != HAL_OK)
+/* Move queued frames into mailboxes; called with interrupts masked */
+static void can_tx_pump(void)
+{
+    while (s_txCount != 0U)
     {
-        /* Debug TX path: show state, error code and mailbox free level */
-        char buf[160];
-        uint32_t free = HAL_CAN_GetTxMailboxesFreeLevel(&hcan1);
-        snprintf(buf, sizeof(buf),
-                 "TX FAIL: st=%ld state=%lu err=0x%08lX free=%lu\r\n",
-                 (long)st,
-                 (unsigned long)hcan1.State,
-                 (unsigned long)hcan1.ErrorCode,
-                 (unsigned long)free);
-        HAL_UART_Transmit(&huart2, (uint8_t *)buf, strlen(buf), HAL_MAX_DELAY);
+        const CanTxFrame_t *top = &s_txHeap[0];
+        int32_t victim = -1;
+        uint32_t free = 0U;
+
+        for (uint32_t i = 0U; i < CAN_TX_MAILBOXES; i++)
+        {
+            if (s_txState[i] == TX_FREE)
+            {
+                free++;
+                continue;
+            }
+            if (s_txMailbox[i].key == top->key)
+            {
+                return;   /* bxCAN would not keep equal IDs in order */
+            }
+            if (s_txState[i] == TX_LOADED &&
+                (victim < 0 || s_txMailbox[i].key > s_txMailbox[victim].key))
+            {
+                victim = (int32_t)i;
+            }
+        }
+
+        if (free != 0U)
+        {
+            int32_t mb = can_tx_load(top);
+            if (mb < 0 || mb >= (int32_t)CAN_TX_MAILBOXES)
+            {
+                return;
+            }
+            s_txMailbox[mb] = *top;
+            s_txState[mb]   = TX_LOADED;
+            can_tx_pop();
+            continue;
+        }
+
+        /* All busy: make room if the head beats the worst pending frame */
+        if (victim >= 0 && top->key < s_txMailbox[victim].key)
+        {
+            s_txState[victim] = TX_ABORTING;
+            (void)HAL_CAN_AbortTxRequest(&hcan1, CAN_TX_MAILBOX0 << victim);
+            s_txStats.preempted++;
+        }
+        return;
+    }
+}
+#endif /* CAN_IF_TX_QUEUE */
+
+HAL_StatusTypeDef CAN_IF_Send(uint32_t id, uint8_t ide, const uint8_t *data, uint8_t dlc)
+{
+    if (dlc > 8U || (data == NULL && dlc != 0U) || id > (ide ? 0x1FFFFFFFUL : 0x7FFUL))
+    {
+        return HAL_ERROR;
+    }
+
+    CanTxFrame_t f;
+    HAL_StatusTypeDef st = HAL_OK;
+
+    f.key = can_tx_key(id, ide);
+    f.id  = id;
+    f.ide = ide ? 1U : 0U;
+    f.dlc = dlc;
+    memset(f.data, 0, sizeof(f.data));
+    if (dlc != 0U)
+    {
+        memcpy(f.data, data, dlc);
+    }
+
+    /* Mask interrupts up to configMAX_SYSCALL_INTERRUPT_PRIORITY; valid
+       from tasks and from ISRs */
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+
+#if CAN_IF_TX_QUEUE
+    if (s_txCount >= CAN_IF_TX_QUEUE_LEN)
+    {
+        s_txStats.rejected++;
+        st = HAL_BUSY;
+    }
+    else
+    {
+        f.seq = s_txSeq++;
+        can_tx_push(&f);
+        s_txStats.queued++;
+        if (s_txCount > s_txStats.high_water)
+        {
+            s_txStats.high_water = s_txCount;
+        }
+        can_tx_pump();
+    }
+#else
+    /* Former path: straight into a mailbox, refused when all three are full */
+    int32_t mb = can_tx_load(&f);
+    if (mb < 0 || mb >= (int32_t)CAN_TX_MAILBOXES)
+    {
+        s_txStats.rejected++;
+        st = HAL_BUSY;
+    }
+    else
+    {
+        s_txState[mb] = TX_LOADED;
+        s_txStats.queued++;
     }
+#endif
 
+    taskEXIT_CRITICAL_FROM_ISR(irq);
     return st;
 }
 
+void CAN_IF_GetTxStats(CAN_IF_TxStats_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+    *out = s_txStats;
+#if CAN_IF_TX_QUEUE
+    out->pending = s_txCount;
+#endif
+    for (uint32_t i = 0U; i < CAN_TX_MAILBOXES; i++)
+    {
+        out->pending += (s_txState[i] != TX_FREE) ? 1U : 0U;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+}
+
+/* A mailbox is empty again: sent, aborted, or failed */
+static void can_tx_done(uint32_t mb, uint8_t sent)
+{
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+
+    if (mb < CAN_TX_MAILBOXES && s_txState[mb] != TX_FREE)
+    {
+        if (sent)
+        {
+            s_txStats.sent++;
+        }
+#if CAN_IF_TX_QUEUE
+        else if (s_txState[mb] == TX_ABORTING)
+        {
+            can_tx_push(&s_txMailbox[mb]);   /* keeps its place (seq) */
+        }
+#endif
+        else
+        {
+            s_txStats.errors++;
+        }
+        s_txState[mb] = TX_FREE;
+#if CAN_IF_TX_QUEUE
+        can_tx_pump();
+#endif
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+}
+
 /* --------------------------------------------------------------------------
- * Logging control / queue accessor
+ * Logging control
  * -------------------------------------------------------------------------- */
 
 void CAN_IF_SetLogging(uint8_t enable)
@@ -188,15 +502,163 @@ void CAN_IF_SetLogging(uint8_t enable)
     s_canLogEnabled = (enable ? 1U : 0U);
 }
 
-osMessageQueueId_t CAN_IF_GetRxQueueHandle(void)
+/* --------------------------------------------------------------------------
+ * RX ring consumer side (CanRxTask)
+ * -------------------------------------------------------------------------- */
+
+static void can_rx_account(CanRxRing_t *r, const CAN_IF_Msg_t *msg)
+{
+    uint32_t lat = CYCCNT_Read() - msg->rx_cyc;
+
+    r->stats.processed++;
+    r->stats.lat_sum_cyc += lat;
+    if (lat < r->stats.lat_min_cyc) r->stats.lat_min_cyc = lat;
+    if (lat > r->stats.lat_max_cyc) r->stats.lat_max_cyc = lat;
+}
+
+const CAN_IF_Msg_t *CAN_IF_RxGet(uint32_t fifo, uint32_t timeout)
+{
+    if (fifo > CAN_RX_FIFO1)
+    {
+        return NULL;
+    }
+    CanRxRing_t *r = &s_rx[fifo];
+
+#if CAN_IF_RX_QUEUE
+    if (fifo == CAN_RX_FIFO0)
+    {
+        if (s_canRxQueue == NULL ||
+            osMessageQueueGet(s_canRxQueue, &r->slot[0], NULL, timeout) != osOK)
+        {
+            return NULL;
+        }
+        can_rx_account(r, &r->slot[0]);
+        return &r->slot[0];
+    }
+#endif
+
+    if (r->consumer == NULL)
+    {
+        r->consumer = osThreadGetId();
+    }
+
+    for (;;)
+    {
+        const uint32_t tail = r->tail;
+
+        if (r->head != tail)
+        {
+            __DMB();   /* slot contents are valid once head is seen */
+            CAN_IF_Msg_t *msg = &r->slot[tail & r->mask];
+            can_rx_account(r, msg);
+            return msg;
+        }
+
+        /* Empty: the ISR sets the flag on its next empty -> non-empty push */
+        uint32_t flags = osThreadFlagsWait(CAN_IF_RX_FLAG, osFlagsWaitAny, timeout);
+        if ((flags & osFlagsError) != 0U)
+        {
+            return NULL;
+        }
+    }
+}
+
+void CAN_IF_RxRelease(uint32_t fifo)
+{
+    if (fifo > CAN_RX_FIFO1)
+    {
+        return;
+    }
+    CanRxRing_t *r = &s_rx[fifo];
+
+#if CAN_IF_RX_QUEUE
+    if (fifo == CAN_RX_FIFO0)
+    {
+        return;
+    }
+#endif
+    if (r->head == r->tail)
+    {
+        return;
+    }
+    __DMB();   /* finish reading the slot before the ISR may reuse it */
+    r->tail = r->tail + 1U;
+}
+
+void CAN_IF_GetRxStats(uint32_t fifo, CAN_IF_RxStats_t *out)
+{
+    if (out == NULL || fifo > CAN_RX_FIFO1)
+    {
+        return;
+    }
+    *out = s_rx[fifo].stats;
+}
+
+/* --------------------------------------------------------------------------
+ * Hardware filters
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef CAN_IF_ConfigFilters(const CAN_FILTER_Rule_t *rules, uint32_t count)
+{
+    static CAN_FILTER_Plan_t plan;   /* too big for the start-up stack */
+    HAL_StatusTypeDef st;
+
+    st = CAN_FILTER_Compile(rules, count, &plan);
+    if (st != HAL_OK)
+    {
+        return st;
+    }
+
+    st = CAN_FILTER_Apply(&hcan1, &plan);
+    if (st == HAL_OK)
+    {
+        s_filterPlan = plan;
+    }
+    return st;
+}
+
+int32_t CAN_IF_RxRule(const CAN_IF_Msg_t *msg)
 {
-    return s_canRxQueue;
+    if (msg == NULL)
+    {
+        return -1;
+    }
+    return CAN_FILTER_RuleForFmi(&s_filterPlan, msg->fifo, msg->fmi);
 }
 
 /* --------------------------------------------------------------------------
  * RX message processing (called from RTOS task)
  * -------------------------------------------------------------------------- */
 
+/* Log decoded signals for messages in the signal database (can_db.h) */
+static void can_log_decode(const CAN_IF_Msg_t *msg)
+{
+    if (msg->ide)
+    {
+        return;
+    }
+
+    if (msg->id == CAN_DB_VEHICLE_TELEMETRY_ID && msg->dlc >= CAN_DB_VEHICLE_TELEMETRY_DLC)
+    {
+        CAN_DB_VehicleTelemetry_t t;
+        CAN_DB_VehicleTelemetry_Unpack(&t, msg->data);
+        DLOG3(DLOG_CAN_TELEMETRY, t.speed, t.engine_rpm, (int32_t)t.coolant_temp);
+    }
+    else if (msg->id == CAN_DB_VEHICLE_COMMAND_ID && msg->dlc >= CAN_DB_VEHICLE_COMMAND_DLC)
+    {
+        CAN_DB_VehicleCommand_t c;
+        CAN_DB_VehicleCommand_Unpack(&c, msg->data);
+        DLOG4(DLOG_CAN_COMMAND, c.cmd_mode, c.target_speed,
+              (int32_t)c.accel_limit * 5,   /* 0.5 kph/s steps */
+              c.alive_counter);
+    }
+}
+
+__weak void CAN_IF_RxFrameCallback(const CAN_IF_Msg_t *msg)
+{
+    (void)msg;
+}
+
 void CAN_IF_ProcessRxMsg(const CAN_IF_Msg_t *msg)
 {
     if (msg == NULL)
@@ -204,31 +666,98 @@ void CAN_IF_ProcessRxMsg(const CAN_IF_Msg_t *msg)
         return;
     }
 
+    CAN_IF_RxFrameCallback(msg);
+    HOSTLINK_CanFrame(msg);   /* binary CAN stream, if subscribed */
+
     if (!s_canLogEnabled)
     {
         return;
     }
 
-    char buf[128];
-    int len = snprintf(buf, sizeof(buf),
-                       "CAN RX: ID=0x%03lX DLC=%u Data=",
-                       (unsigned long)msg->id,
-                       (unsigned int)msg->dlc);
-    HAL_UART_Transmit(&huart2, (uint8_t *)buf, len, HAL_MAX_DELAY);
+    /* Raw record only; LogTask (or the host) turns it into the text line */
+    uint32_t w[2];
+    memcpy(w, msg->data, sizeof(w));
+    DLOG5(msg->ide ? DLOG_CAN_RX_EXT : DLOG_CAN_RX_STD,
+          msg->id, msg->dlc, msg->dlc, w[0], w[1]);
 
-    for (uint8_t i = 0; i < msg->dlc; i++)
-    {
-        len = snprintf(buf, sizeof(buf), "%02X ", msg->data[i]);
-        HAL_UART_Transmit(&huart2, (uint8_t *)buf, len, HAL_MAX_DELAY);
-    }
-    can_uart_print("\r\n");
+    can_log_decode(msg);
 }
 
 /* --------------------------------------------------------------------------
  * HAL callbacks
  * -------------------------------------------------------------------------- */
 
-/* RX FIFO0 pending: called in interrupt context */
+/*
+ * Drain everything a hardware FIFO holds in one interrupt into its ring:
+ * at high bus load this saves an entry/exit per frame and keeps the 3-deep
+ * FIFO from overrunning while the task runs. The batch is published with
+ * one head update and at most one wakeup.
+ */
+static void can_rx_drain(CAN_HandleTypeDef *hcan, uint32_t fifo)
+{
+    CanRxRing_t *r = &s_rx[fifo];
+    CAN_RxHeaderTypeDef rxHeader;
+    const uint32_t tail  = r->tail;
+    const uint32_t first = r->head;
+    uint32_t head = first;
+
+    while (HAL_CAN_GetRxFifoFillLevel(hcan, fifo) != 0U)
+    {
+        if (head - tail > r->mask)
+        {
+            /* Ring full: still pop the hardware FIFO, then drop the frame */
+            uint8_t scratch[8];
+            (void)HAL_CAN_GetRxMessage(hcan, fifo, &rxHeader, scratch);
+            r->stats.dropped++;
+            continue;
+        }
+
+        /* Write straight into the slot; nothing is copied again afterwards */
+        CAN_IF_Msg_t *slot = &r->slot[head & r->mask];
+        if (HAL_CAN_GetRxMessage(hcan, fifo, &rxHeader, slot->data) != HAL_OK)
+        {
+            break;
+        }
+        slot->ide    = (rxHeader.IDE == CAN_ID_EXT) ? 1U : 0U;
+        slot->id     = slot->ide ? rxHeader.ExtId : rxHeader.StdId;
+        slot->dlc    = (uint8_t)rxHeader.DLC;
+        slot->fifo   = (uint8_t)fifo;
+        slot->fmi    = (uint8_t)rxHeader.FilterMatchIndex;
+        slot->rx_cyc = CYCCNT_Read();
+        head++;
+    }
+
+    if (head == first)
+    {
+        return;
+    }
+
+    __DMB();   /* publish the whole batch with one head update */
+    r->head = head;
+
+    const uint32_t batch = head - first;
+    r->stats.received += batch;
+    r->stats.batches++;
+    if (batch > r->stats.batch_max)
+    {
+        r->stats.batch_max = batch;
+    }
+    if (head - tail > r->stats.high_water)
+    {
+        r->stats.high_water = head - tail;
+    }
+
+    /* Only the empty -> non-empty transition needs a wakeup: the task
+       drains until empty before it waits again. */
+    osThreadId_t consumer = r->consumer;
+    if (first == tail && consumer != NULL)
+    {
+        (void)osThreadFlagsSet(consumer, CAN_IF_RX_FLAG);
+        r->stats.wakeups++;
+    }
+}
+
+/* RX FIFO0 pending (bulk traffic): called in interrupt context */
 void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
 {
     if (hcan->Instance != CAN1)
@@ -236,7 +765,12 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
         return;
     }
 
+    /* Any CAN1 vector may get here; they do not nest (see the RX rings) */
+    PROBE_SCOPE(PROBE_CAN_RX_ISR);
+
+#if CAN_IF_RX_QUEUE
     CAN_RxHeaderTypeDef rxHeader;
+    CanRxRing_t *r = &s_rx[CAN_RX_FIFO0];
     uint8_t data[8];
 
     if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &rxHeader, data) != HAL_OK)
@@ -250,30 +784,151 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
     }
 
     CAN_IF_Msg_t msg;
-    msg.id  = rxHeader.StdId;
-    msg.dlc = rxHeader.DLC;
+    msg.ide  = (rxHeader.IDE == CAN_ID_EXT) ? 1U : 0U;
+    msg.id   = msg.ide ? rxHeader.ExtId : rxHeader.StdId;
+    msg.dlc  = rxHeader.DLC;
+    msg.fifo = CAN_RX_FIFO0;
+    msg.fmi  = (uint8_t)rxHeader.FilterMatchIndex;
     memset(msg.data, 0, sizeof(msg.data));
     memcpy(msg.data, data, rxHeader.DLC);
+    msg.rx_cyc = CYCCNT_Read();
 
     /* Drop on full queue rather than blocking in ISR */
-    (void)osMessageQueuePut(s_canRxQueue, &msg, 0, 0);
+    if (osMessageQueuePut(s_canRxQueue, &msg, 0, 0) == osOK)
+    {
+        uint32_t n = osMessageQueueGetCount(s_canRxQueue);
+
+        r->stats.received++;
+        if (n > r->stats.high_water)
+        {
+            r->stats.high_water = n;
+        }
+    }
+    else
+    {
+        r->stats.dropped++;
+    }
+#else
+    can_rx_drain(hcan, CAN_RX_FIFO0);
+#endif /* CAN_IF_RX_QUEUE */
+}
+
+/* RX FIFO1 pending (control IDs): own FIFO, ring and task, at the NVIC
+   priority of FIFO0, so a FIFO0 drain in progress can delay it */
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+    if (hcan->Instance != CAN1)
+    {
+        return;
+    }
+
+    can_rx_drain(hcan, CAN_RX_FIFO1);
 }
 
-/* Optional TX-complete callbacks.
-   Not required for freeing mailboxes (hardware does that),
-   but useful if you want to add debug prints later.
-*/
+/* TX mailbox empty: confirm the frame and refill from the TX queue */
 void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-    (void)hcan;
+    if (hcan->Instance == CAN1) can_tx_done(0U, 1U);
 }
 
 void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-    (void)hcan;
+    if (hcan->Instance == CAN1) can_tx_done(1U, 1U);
 }
 
 void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-    (void)hcan;
+    if (hcan->Instance == CAN1) can_tx_done(2U, 1U);
 }
+
+void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan)
+{
+    if (hcan->Instance == CAN1) can_tx_done(0U, 0U);
+}
+
+void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan)
+{
+    if (hcan->Instance == CAN1) can_tx_done(1U, 0U);
+}
+
+void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan)
+{
+    if (hcan->Instance == CAN1) can_tx_done(2U, 0U);
+}
+
+/*
+ * The HAL reports a mailbox that ended with arbitration lost or a transmit
+ * error (possible when an abort hits a frame being retried) through the
+ * error callback rather than the abort callback. Free the mailbox here too.
+ */
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan)
+{
+    static const uint32_t txErr[CAN_TX_MAILBOXES] = {
+        HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_TERR0,
+        HAL_CAN_ERROR_TX_ALST1 | HAL_CAN_ERROR_TX_TERR1,
+        HAL_CAN_ERROR_TX_ALST2 | HAL_CAN_ERROR_TX_TERR2,
+    };
+
+    if (hcan->Instance != CAN1)
+    {
+        return;
+    }
+    for (uint32_t i = 0U; i < CAN_TX_MAILBOXES; i++)
+    {
+        if ((hcan->ErrorCode & txErr[i]) != 0U)
+        {
+            hcan->ErrorCode &= ~txErr[i];
+            can_tx_done(i, 0U);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_log_on(const CLI_IF_Args_t *args)
+{
+    (void)args;
+    CAN_IF_SetLogging(1);
+    CLI_IF_Print("CAN logging ENABLED\r\n");
+}
+
+static void cmd_log_off(const CLI_IF_Args_t *args)
+{
+    (void)args;
+    CAN_IF_SetLogging(0);
+    CLI_IF_Print("CAN logging DISABLED\r\n");
+}
+
+static void cmd_can_stats(const CLI_IF_Args_t *args)
+{
+    char buf[160];
+    CAN_IF_RxStats_t rx;
+    CAN_IF_TxStats_t tx;
+
+    (void)args;
+    for (uint32_t f = 0U; f < 2U; f++)
+    {
+        CAN_IF_GetRxStats(f, &rx);
+        snprintf(buf, sizeof(buf),
+                 "RX FIFO%lu: rx=%lu drop=%lu done=%lu hw=%lu\r\n",
+                 (unsigned long)f, (unsigned long)rx.received,
+                 (unsigned long)rx.dropped, (unsigned long)rx.processed,
+                 (unsigned long)rx.high_water);
+        CLI_IF_Print(buf);
+    }
+    CAN_IF_GetTxStats(&tx);
+    snprintf(buf, sizeof(buf),
+             "TX:       queued=%lu sent=%lu busy=%lu preempt=%lu err=%lu"
+             " hw=%lu pending=%lu\r\n",
+             (unsigned long)tx.queued, (unsigned long)tx.sent,
+             (unsigned long)tx.rejected, (unsigned long)tx.preempted,
+             (unsigned long)tx.errors, (unsigned long)tx.high_water,
+             (unsigned long)tx.pending);
+    CLI_IF_Print(buf);
+}
+
+CLI_IF_CMD(log_on,    "log on",    "", cmd_log_on,    "enable CAN RX logging");
+CLI_IF_CMD(log_off,   "log off",   "", cmd_log_off,   "disable CAN RX logging");
+CLI_IF_CMD(can_stats, "can stats", "", cmd_can_stats, "show CAN RX/TX counters");
@@ -3,31 +3,70 @@
  * @brief   Minimal UART CLI implementation for Mini ECU.
  *
  * Responsibilities:
- *   - Interrupt-driven RX into a ring buffer.
- *   - Simple line editor + parser.
- *   - Commands for vehicle state and CAN logging.
+ *   - Circular-DMA RX into a ring buffer; the IDLE-line and half/full
+ *     transfer events publish whole bursts and wake the CLI task.
+ *   - Simple line editor; table-driven dispatch of the commands that
+ *     modules register with CLI_IF_CMD() (hash lookup, schema-checked
+ *     arguments, generated help).
+ *   - Output (including echo) through the shared DMA TX ring (uart_tx).
+ *   - Built-in commands: help, cli stats.
  */
 
 #include "cli_if.h"
-#include "can_if.h"
+#include "uart_tx.h"
+#include "probe.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include <string.h>
 #include <stdio.h>
-#include <stdlib.h>   /* atof */
-#include "vehicle.h"  /* VehicleState_t */
+#include <stdlib.h>   /* strtoul, strtof, qsort */
 
-extern VehicleState_t g_vehicle;   /* defined in main.c */
+/* Static references to UART and vehicle snapshot */
+static UART_HandleTypeDef  *s_cliUart     = NULL;
+static const VehicleSnap_t *s_vehicleSnap = NULL;
 
-/* Static references to UART and vehicle state */
-static UART_HandleTypeDef *s_cliUart = NULL;
-static VehicleState_t     *s_vehicle = NULL;
+#if (CLI_IF_RX_LEN & (CLI_IF_RX_LEN - 1U)) != 0U
+#error "CLI_IF_RX_LEN must be a power of two"
+#endif
 
-/* RX byte buffer for interrupt-driven receive */
-static uint8_t s_rxByte;
+#define CLI_RX_MASK   (CLI_IF_RX_LEN - 1U)
 
-/* Ring buffer for received characters (from ISR to main context) */
-static volatile uint8_t  s_cliBuf[64];
-static volatile uint8_t  s_cliHead = 0;
-static volatile uint8_t  s_cliTail = 0;
+/*
+ * RX ring (from ISR/DMA to task context). Head and tail are free-running
+ * byte counts; byte n lives at s_rxBuf[(n - s_rxBase) & CLI_RX_MASK].
+ * With DMA the buffer is the DMA target itself: the ISR only moves s_rxHead
+ * up to the DMA write position. s_rxBase moves when reception restarts at
+ * the start of the buffer after a line error.
+ */
+static volatile uint8_t  s_rxBuf[CLI_IF_RX_LEN];
+static volatile uint32_t s_rxHead = 0;
+static volatile uint32_t s_rxTail = 0;
+static volatile uint32_t s_rxBase = 0;
+
+#if CLI_IF_RX_DMA
+static uint32_t s_rxPos;          /* DMA write position at the last event */
+#else
+static uint8_t  s_rxByte;         /* one-byte interrupt-driven receive    */
+#endif
+
+#if (CLI_IF_HASH_SLOTS & (CLI_IF_HASH_SLOTS - 1U)) != 0U || CLI_IF_HASH_SLOTS > 65536U
+#error "CLI_IF_HASH_SLOTS must be a power of two, at most 65536"
+#endif
+
+#define CLI_HASH_MASK   (CLI_IF_HASH_SLOTS - 1U)
+#define CLI_MAX_CMDS    (CLI_IF_HASH_SLOTS / 2U)   /* load factor <= 1/2 */
+
+/* Command index, built by CLI_IF_Init() */
+static uint16_t s_hash[CLI_IF_HASH_SLOTS];   /* descriptor index + 1, 0 = free */
+static uint16_t s_order[CLI_MAX_CMDS];       /* descriptor indices by name     */
+static uint32_t s_cmdCount;
+
+/* Raw input receiver; NULL = line editor */
+static volatile CLI_IF_RxHook_t s_rxHook = NULL;
+
+/* Task woken by the RX ISR (set by the first CLI_IF_WaitRx() call) */
+static volatile osThreadId_t s_cliTask = NULL;
+static CLI_IF_Stats_t        s_stats;
 
 /* --------------------------------------------------------------------------
  * Local helpers
@@ -36,110 +75,327 @@ static volatile uint8_t  s_cliTail = 0;
 static void cli_uart_print(const char *s)
 {
     if (s_cliUart == NULL) return;
-    HAL_UART_Transmit(s_cliUart, (uint8_t *)s, strlen(s), HAL_MAX_DELAY);
+    (void)UART_TX_Print(s);
 }
 
+/* ISR side: publish count bytes, wake the task on empty -> non-empty */
+static void cli_rx_publish(uint32_t count)
+{
+    const uint32_t head = s_rxHead;
+
+    s_stats.rx_bytes += count;
+    __DMB();   /* bytes before index */
+    s_rxHead = head + count;
+
+#if CLI_IF_POLL_MS == 0U
+    osThreadId_t task = s_cliTask;
+    if (head == s_rxTail && task != NULL)
+    {
+        (void)osThreadFlagsSet(task, CLI_IF_RX_FLAG);
+    }
+#endif
+}
+
+#if CLI_IF_RX_DMA
+static void cli_rx_start(void)
+{
+    s_rxPos = 0U;
+    (void)HAL_UARTEx_ReceiveToIdle_DMA(s_cliUart, (uint8_t *)s_rxBuf, CLI_IF_RX_LEN);
+}
+
+/* Publish everything the DMA has written since the last event. The
+   position comes from NDTR rather than the event's Size, so events that
+   are handled late or out of order still add up. */
+static void cli_rx_dma_sync(void)
+{
+    const uint32_t pos = (CLI_IF_RX_LEN - __HAL_DMA_GET_COUNTER(s_cliUart->hdmarx)) & CLI_RX_MASK;
+    const uint32_t count = (pos - s_rxPos) & CLI_RX_MASK;
+
+    s_rxPos = pos;
+    if (count != 0U)
+    {
+        cli_rx_publish(count);
+    }
+}
+#else
+/* ISR side: store one byte */
 static void cli_push(uint8_t c)
 {
-    uint8_t next = (uint8_t)((s_cliHead + 1U) % sizeof(s_cliBuf));
-    if (next != s_cliTail)
+    const uint32_t head = s_rxHead;
+
+    if (head - s_rxTail >= CLI_IF_RX_LEN)
     {
-        s_cliBuf[s_cliHead] = c;
-        s_cliHead = next;
+        s_stats.rx_bytes++;
+        s_stats.rx_dropped++;
+        return;
     }
-    /* If full, silently drop */
+    s_rxBuf[(head - s_rxBase) & CLI_RX_MASK] = c;
+    cli_rx_publish(1U);
 }
+#endif
 
-/* Local line-based parser */
-static void cli_handle_char(uint8_t c)
+/* Task side: first unread byte index, after dropping what the ISR side has
+   overwritten or discarded. Returns the head to drain up to. */
+static uint32_t cli_rx_claim(uint32_t *tail, uint32_t *base)
 {
-    static char line[32];
-    static uint8_t idx = 0;
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+    const uint32_t head = s_rxHead;
+    uint32_t t = s_rxTail;
 
-    if (c == '\r' || c == '\n')
+    *base = s_rxBase;
+    if ((int32_t)(*base - t) > 0)
     {
-        if (idx == 0)
+        s_stats.rx_dropped += *base - t;   /* discarded by an error restart */
+        t = *base;
+    }
+    if (head - t > CLI_IF_RX_LEN)
+    {
+        s_stats.rx_dropped += head - t - CLI_IF_RX_LEN;   /* DMA lapped us */
+        t = head - CLI_IF_RX_LEN;
+    }
+    s_rxTail = t;
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+
+    *tail = t;
+    return head;
+}
+
+/* --------------------------------------------------------------------------
+ * Command table
+ * -------------------------------------------------------------------------- */
+
+/* Linker-collected descriptors (CLI_IF_CMD; see STM32F446RETX_FLASH.ld) */
+extern const CLI_IF_Cmd_t __start_cli_cmds[];
+extern const CLI_IF_Cmd_t __stop_cli_cmds[];
+
+/* FNV-1a over "w1", or "w1 w2" without building the string */
+static uint32_t cli_hash(const char *w1, const char *w2)
+{
+    uint32_t h = 2166136261U;
+
+    for (; *w1 != '\0'; w1++)
+    {
+        h = (h ^ (uint8_t)*w1) * 16777619U;
+    }
+    if (w2 != NULL)
+    {
+        h = (h ^ (uint8_t)' ') * 16777619U;
+        for (; *w2 != '\0'; w2++)
         {
-            cli_uart_print("\r\n> ");
-            return;
+            h = (h ^ (uint8_t)*w2) * 16777619U;
         }
+    }
+    return h;
+}
 
-        line[idx] = '\0';
-        idx = 0;
+static int cli_name_eq(const char *name, const char *w1, const char *w2)
+{
+    while (*w1 != '\0')
+    {
+        if (*name++ != *w1++)
+        {
+            return 0;
+        }
+    }
+    if (w2 == NULL)
+    {
+        return *name == '\0';
+    }
+    return (*name == ' ') && (strcmp(name + 1, w2) == 0);
+}
 
-        /* --- Command decoding --- */
+/* Linear probing; the table is at most half full, so probes stay short */
+static const CLI_IF_Cmd_t *cli_lookup(const char *w1, const char *w2)
+{
+    uint32_t slot = cli_hash(w1, w2) & CLI_HASH_MASK;
+    uint16_t idx;
 
-        if ((strcmp(line, "h") == 0) || (strcmp(line, "help") == 0))
+    while ((idx = s_hash[slot]) != 0U)
+    {
+        const CLI_IF_Cmd_t *cmd = &__start_cli_cmds[idx - 1U];
+        if (cli_name_eq(cmd->name, w1, w2))
         {
-            cli_uart_print("\r\nCommands:\r\n");
-            cli_uart_print("  help          - show this help\r\n");
-            cli_uart_print("  status        - show basic vehicle state\r\n");
-            cli_uart_print("  veh status    - show detailed vehicle state\r\n");
-            cli_uart_print("  veh speed X   - set target speed to X km/h\r\n");
-            cli_uart_print("  veh cool-hot  - inject coolant overheat\r\n");
-            cli_uart_print("  log on        - enable CAN RX logging\r\n");
-            cli_uart_print("  log off       - disable CAN RX logging\r\n> ");
+            return cmd;
         }
-        else if (strcmp(line, "status") == 0)
+        slot = (slot + 1U) & CLI_HASH_MASK;
+    }
+    return NULL;
+}
+
+static int cli_order_cmp(const void *a, const void *b)
+{
+    return strcmp(__start_cli_cmds[*(const uint16_t *)a].name,
+                  __start_cli_cmds[*(const uint16_t *)b].name);
+}
+
+/* Index the descriptor table once; problems are reported on the console */
+static void cli_index_build(void)
+{
+    const uint32_t total = (uint32_t)(__stop_cli_cmds - __start_cli_cmds);
+    char buf[96];
+
+    memset(s_hash, 0, sizeof(s_hash));
+    s_cmdCount = 0U;
+
+    for (uint32_t i = 0U; i < total; i++)
+    {
+        const CLI_IF_Cmd_t *cmd = &__start_cli_cmds[i];
+
+        if (cli_lookup(cmd->name, NULL) != NULL)
         {
-            if (s_vehicle)
-            {
-                char buf[128];
-                snprintf(buf, sizeof(buf),
-                         "\r\nSpeed:   %.1f km/h\r\n"
-                         "RPM:     %u\r\n"
-                         "Coolant: %.1f C\r\n> ",
-                         s_vehicle->speed_kph,
-                         s_vehicle->engine_rpm,
-                         s_vehicle->coolant_temp_c);
-                cli_uart_print(buf);
-            }
-            else
-            {
-                cli_uart_print("\r\n[ERR] No vehicle bound to CLI\r\n> ");
-            }
+            snprintf(buf, sizeof(buf), "[CLI] duplicate command '%s' ignored\r\n", cmd->name);
+            cli_uart_print(buf);
+            continue;
+        }
+        if (s_cmdCount == CLI_MAX_CMDS)
+        {
+            snprintf(buf, sizeof(buf), "[CLI] %lu commands, index holds %lu; raise CLI_IF_HASH_SLOTS\r\n",
+                     (unsigned long)total, (unsigned long)CLI_MAX_CMDS);
+            cli_uart_print(buf);
+            break;
+        }
+
+        uint32_t slot = cli_hash(cmd->name, NULL) & CLI_HASH_MASK;
+        while (s_hash[slot] != 0U)
+        {
+            slot = (slot + 1U) & CLI_HASH_MASK;
+        }
+        s_hash[slot] = (uint16_t)(i + 1U);
+        s_order[s_cmdCount++] = (uint16_t)i;
+    }
+    qsort(s_order, s_cmdCount, sizeof(s_order[0]), cli_order_cmp);
+}
+
+/* --------------------------------------------------------------------------
+ * Dispatcher
+ * -------------------------------------------------------------------------- */
+
+/* Split at spaces in place; returns max + 1 if there are more words */
+static uint32_t cli_split(char *line, char **word, uint32_t max)
+{
+    uint32_t n = 0U;
+
+    for (;;)
+    {
+        while (*line == ' ')
+        {
+            line++;
         }
-        else if (strcmp(line, "log on") == 0)
+        if (*line == '\0')
         {
-            CAN_IF_SetLogging(1);
-            cli_uart_print("\r\nCAN logging ENABLED\r\n> ");
+            return n;
         }
-        else if (strcmp(line, "log off") == 0)
+        if (n == max)
         {
-            CAN_IF_SetLogging(0);
-            cli_uart_print("\r\nCAN logging DISABLED\r\n> ");
+            return max + 1U;
         }
-        else if (strcmp(line, "veh status") == 0)
+        word[n++] = line;
+        while (*line != '\0' && *line != ' ')
         {
-            char buf[128];
-            snprintf(buf, sizeof(buf),
-                     "\r\nVehicle:\r\n"
-                     "  Speed   : %.1f km/h\r\n"
-                     "  RPM     : %u\r\n"
-                     "  Coolant : %.1f C\r\n> ",
-                     g_vehicle.speed_kph,
-                     g_vehicle.engine_rpm,
-                     g_vehicle.coolant_temp_c);
-            cli_uart_print(buf);
+            line++;
         }
-        else if (strncmp(line, "veh speed ", 10) == 0)
+        if (*line == '\0')
         {
-            float v = atof(&line[10]);  /* very simple parsing; assumes valid input */
-            Vehicle_SetTargetSpeed(&g_vehicle, v);
-            cli_uart_print("\r\nOK: speed updated\r\n> ");
+            return n;
         }
-        else if (strcmp(line, "veh cool-hot") == 0)
+        *line++ = '\0';
+    }
+}
+
+/* Convert words per the schema; 0 on a count or type mismatch */
+static int cli_parse_args(const CLI_IF_Cmd_t *cmd, char *const *word, uint32_t n,
+                          CLI_IF_Args_t *out)
+{
+    const char *s = cmd->args;
+
+    out->argc = 0U;
+    for (;;)
+    {
+        while (*s == ' ')
         {
-            /* Quick “overheat” demo */
-            Vehicle_Force(&g_vehicle,
-                          g_vehicle.speed_kph,
-                          g_vehicle.engine_rpm,
-                          115.0f);
-            cli_uart_print("\r\nInjected: coolant overheat\r\n> ");
+            s++;
         }
-        else
+        if (*s == '\0')
         {
-            cli_uart_print("\r\nUnknown command. Try 'help'.\r\n> ");
+            break;
+        }
+        if (out->argc == n || out->argc == CLI_IF_MAX_ARGS)
+        {
+            return 0;
+        }
+
+        const char *w = word[out->argc];
+        CLI_IF_Arg_t *a = &out->argv[out->argc];
+        char *end;
+
+        switch (*s)
+        {
+            case 'u': a->u = (uint32_t)strtoul(w, &end, 0);  break;
+            case 'i': a->i = (int32_t)strtol(w, &end, 10);   break;
+            case 'f': a->f = strtof(w, &end);                break;
+            default:  a->s = w; end = (char *)w + strlen(w); break;
+        }
+        if (end == w || *end != '\0')
+        {
+            return 0;
+        }
+        out->argc++;
+
+        while (*s != '\0' && *s != ' ')
+        {
+            s++;   /* rest of "type:name" */
+        }
+    }
+    return out->argc == n;
+}
+
+/* "veh speed <kph>" */
+static void cli_usage(const CLI_IF_Cmd_t *cmd, char *buf, size_t size)
+{
+    size_t len = (size_t)snprintf(buf, size, "%s", cmd->name);
+    const char *s = cmd->args;
+
+    while (len < size)
+    {
+        while (*s == ' ')
+        {
+            s++;
+        }
+        if (*s == '\0')
+        {
+            break;
+        }
+        const char *name = (s[1] == ':') ? s + 2 : s + 1;
+        const size_t nlen = strcspn(name, " ");
+        len += (size_t)snprintf(&buf[len], size - len, " <%.*s>", (int)nlen, name);
+        s = name + nlen;
+    }
+}
+
+/* Local line editor: echo, then run the line on Enter */
+static void cli_handle_char(uint8_t c)
+{
+    static char line[CLI_IF_LINE_LEN];
+    static uint8_t idx = 0;
+    PROBE_SCOPE(PROBE_CLI_CHAR);
+
+    if (c == '\r' || c == '\n')
+    {
+        if (idx == 0)
+        {
+            cli_uart_print("\r\n> ");
+            return;
+        }
+
+        line[idx] = '\0';
+        idx = 0;
+        s_stats.lines++;
+
+        cli_uart_print("\r\n");
+        CLI_IF_Exec(line);
+        if (s_rxHook == NULL)
+        {
+            cli_uart_print("> ");   /* not after a switch to a binary protocol */
         }
     }
     else
@@ -151,52 +407,263 @@ static void cli_handle_char(uint8_t c)
             /* Echo */
             if (s_cliUart)
             {
-                HAL_UART_Transmit(s_cliUart, &c, 1, HAL_MAX_DELAY);
+                (void)UART_TX_Write(&c, 1U);
             }
         }
         /* else: line overflow, extra chars ignored */
     }
 }
 
+/* --------------------------------------------------------------------------
+ * Built-in commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_help(const CLI_IF_Args_t *args)
+{
+    char usage[40];
+    char buf[160];
+
+    (void)args;
+    CLI_IF_Print("Commands:\r\n");
+    for (uint32_t i = 0U; i < s_cmdCount; i++)
+    {
+        const CLI_IF_Cmd_t *cmd = &__start_cli_cmds[s_order[i]];
+        if (cmd->help == NULL)
+        {
+            continue;
+        }
+        cli_usage(cmd, usage, sizeof(usage));
+        const int len = snprintf(buf, sizeof(buf), "  %-16s - %s\r\n", usage, cmd->help);
+
+        /* A long list would overrun the TX ring: wait for it to drain */
+        while (len > 0 && UART_TX_Free() < (uint32_t)len)
+        {
+            osDelay(1U);
+        }
+        CLI_IF_Print(buf);
+    }
+}
+
+static void cmd_cli_stats(const CLI_IF_Args_t *args)
+{
+    char buf[256];
+    CLI_IF_Stats_t st;
+
+    (void)args;
+    CLI_IF_GetStats(&st);
+    snprintf(buf, sizeof(buf),
+             "CLI RX: bytes=%lu dropped=%lu events=%lu idle=%lu lines=%lu"
+             "\r\n        ore=%lu fe=%lu ne=%lu wakeups=%lu idle_wakeups=%lu\r\n",
+             (unsigned long)st.rx_bytes, (unsigned long)st.rx_dropped,
+             (unsigned long)st.rx_events, (unsigned long)st.rx_idle,
+             (unsigned long)st.lines, (unsigned long)st.rx_overrun,
+             (unsigned long)st.rx_framing, (unsigned long)st.rx_noise,
+             (unsigned long)st.wakeups, (unsigned long)st.idle_wakeups);
+    CLI_IF_Print(buf);
+}
+
+CLI_IF_CMD(help,      "help",      "", cmd_help,      "show this help");
+CLI_IF_CMD(help_h,    "h",         "", cmd_help,      NULL);
+CLI_IF_CMD(cli_stats, "cli stats", "", cmd_cli_stats, "show CLI RX counters");
+
 /* --------------------------------------------------------------------------
  * Public API
  * -------------------------------------------------------------------------- */
 
-void CLI_IF_Init(UART_HandleTypeDef *huart, VehicleState_t *vehicle)
+void CLI_IF_Init(UART_HandleTypeDef *huart, const VehicleSnap_t *snap)
 {
-    s_cliUart  = huart;
-    s_vehicle  = vehicle;
-    s_cliHead  = 0;
-    s_cliTail  = 0;
+    s_cliUart     = huart;
+    s_vehicleSnap = snap;
+    s_rxHead   = 0;
+    s_rxTail   = 0;
+    s_rxBase   = 0;
+
+    cli_index_build();
 
     if (s_cliUart)
     {
-        /* Start RX interrupt */
+#if CLI_IF_RX_DMA
+        cli_rx_start();
+#else
         HAL_UART_Receive_IT(s_cliUart, &s_rxByte, 1);
+#endif
         cli_uart_print("\r\nCLI ready. Type 'help' and press Enter.\r\n> ");
     }
 }
 
 void CLI_IF_Task(void)
 {
-    /* Drain ring buffer and feed the line parser */
-    while (s_cliTail != s_cliHead)
+    uint32_t tail;
+    uint32_t base;
+    const uint32_t head = cli_rx_claim(&tail, &base);
+
+    /* Drain ring buffer and feed the line parser (or the RX hook) */
+    while (tail != head)
+    {
+        const uint8_t c = s_rxBuf[(tail - base) & CLI_RX_MASK];
+        const CLI_IF_RxHook_t hook = s_rxHook;
+
+        s_rxTail = ++tail;
+        if (hook != NULL)
+        {
+            hook(c);
+        }
+        else
+        {
+            cli_handle_char(c);
+        }
+    }
+}
+
+void CLI_IF_WaitRx(uint32_t timeout)
+{
+#if CLI_IF_POLL_MS == 0U
+    if (s_cliTask == NULL)
+    {
+        s_cliTask = osThreadGetId();
+    }
+    if (s_rxTail == s_rxHead)
+    {
+        /* A byte pushed after the check leaves the flag set: no lost wakeup */
+        (void)osThreadFlagsWait(CLI_IF_RX_FLAG, osFlagsWaitAny, timeout);
+    }
+#else
+    (void)timeout;
+    osDelay(CLI_IF_POLL_MS);
+#endif
+
+    s_stats.wakeups++;
+    if (s_rxTail == s_rxHead)
+    {
+        s_stats.idle_wakeups++;
+    }
+}
+
+void CLI_IF_GetStats(CLI_IF_Stats_t *out)
+{
+    if (out != NULL)
+    {
+        *out = s_stats;
+    }
+}
+
+const CLI_IF_Cmd_t *CLI_IF_Find(const char *name)
+{
+    return (name != NULL) ? cli_lookup(name, NULL) : NULL;
+}
+
+void CLI_IF_Exec(char *line)
+{
+    char *word[CLI_IF_MAX_ARGS + 2U];
+    const uint32_t n = cli_split(line, word, CLI_IF_MAX_ARGS + 2U);
+    const CLI_IF_Cmd_t *cmd = NULL;
+    uint32_t first = 2U;
+    CLI_IF_Args_t args;
+
+    if (n == 0U)
+    {
+        return;
+    }
+    if (n >= 2U)
+    {
+        cmd = cli_lookup(word[0], word[1]);
+    }
+    if (cmd == NULL)
+    {
+        cmd = cli_lookup(word[0], NULL);
+        first = 1U;
+    }
+    if (cmd == NULL)
     {
-        uint8_t c = s_cliBuf[s_cliTail];
-        s_cliTail = (uint8_t)((s_cliTail + 1U) % sizeof(s_cliBuf));
-        cli_handle_char(c);
+        cli_uart_print("Unknown command. Try 'help'.\r\n");
+        return;
     }
+    if (n > CLI_IF_MAX_ARGS + 2U || !cli_parse_args(cmd, &word[first], n - first, &args))
+    {
+        char usage[48];
+        cli_usage(cmd, usage, sizeof(usage));
+        cli_uart_print("Usage: ");
+        cli_uart_print(usage);
+        cli_uart_print("\r\n");
+        return;
+    }
+    cmd->handler(&args);
+}
+
+void CLI_IF_Print(const char *s)
+{
+    cli_uart_print(s);
+}
+
+const VehicleSnap_t *CLI_IF_GetVehicleSnap(void)
+{
+    return s_vehicleSnap;
+}
+
+void CLI_IF_SetRxHook(CLI_IF_RxHook_t hook)
+{
+    s_rxHook = hook;
 }
 
 /* --------------------------------------------------------------------------
  * HAL Weak callback override – lives in this module now
  * -------------------------------------------------------------------------- */
 
+#if CLI_IF_RX_DMA
+/* Half transfer, transfer complete (buffer wrap) or IDLE line */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    (void)Size;
+    if (huart == s_cliUart)
+    {
+        s_stats.rx_events++;
+        if (HAL_UARTEx_GetRxEventType(huart) == HAL_UART_RXEVENT_IDLE)
+        {
+            s_stats.rx_idle++;
+        }
+        cli_rx_dma_sync();
+    }
+}
+#else
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
     if (huart == s_cliUart)
     {
+        s_stats.rx_events++;
         cli_push(s_rxByte);
         HAL_UART_Receive_IT(s_cliUart, &s_rxByte, 1);
     }
 }
+#endif
+
+/* The HAL ends a DMA reception on any line error (and an interrupt
+   reception on overrun): count it and start again. A TX DMA error ends
+   the DMA reception too; uart_tx.c restarts the transmission. */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    UART_TX_ErrorCallback(huart);
+
+    if (huart != s_cliUart)
+    {
+        return;
+    }
+
+    const uint32_t err = HAL_UART_GetError(huart);
+    if ((err & HAL_UART_ERROR_ORE) != 0U) s_stats.rx_overrun++;
+    if ((err & HAL_UART_ERROR_FE) != 0U)  s_stats.rx_framing++;
+    if ((err & (HAL_UART_ERROR_NE | HAL_UART_ERROR_PE)) != 0U) s_stats.rx_noise++;
+
+    if (huart->RxState != HAL_UART_STATE_READY)
+    {
+        return;   /* reception still running */
+    }
+#if CLI_IF_RX_DMA
+    /* DMA restarts at the start of the buffer: input not yet read by the
+       task is discarded (counted as dropped), the error hit it anyway */
+    cli_rx_dma_sync();
+    s_rxBase = s_rxHead;
+    cli_rx_start();
+#else
+    HAL_UART_Receive_IT(s_cliUart, &s_rxByte, 1);
+#endif
+}
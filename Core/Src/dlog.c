@@ -0,0 +1,254 @@
+/**
+ * @file    dlog.c
+ * @brief   Deferred binary logger: MPSC slot ring drained by LogTask.
+ *
+ * A call site used to build its line with snprintf() (once per CAN data
+ * byte for the RX log) before handing it to the UART. Now it stores the
+ * raw arguments and moves on; formatting happens in LogTask, below the
+ * application tasks, or on the host.
+ */
+
+#include "dlog.h"
+#include "cyccnt.h"
+#include "uart_tx.h"
+#include "cli_if.h"
+#include <string.h>
+#include <stdio.h>
+
+#if (DLOG_RING_LEN & (DLOG_RING_LEN - 1U)) != 0U
+#error "DLOG_RING_LEN must be a power of two"
+#endif
+
+#define DLOG_MASK        (DLOG_RING_LEN - 1U)
+
+/* Slot header: 0 = free or still being filled, else published */
+#define DLOG_HDR_VALID   0x80000000U
+#define DLOG_HDR(id, n)  (DLOG_HDR_VALID | ((uint32_t)(id) << 8) | (uint32_t)(n))
+
+typedef struct
+{
+    volatile uint32_t hdr;
+    uint32_t          ts;
+    uint32_t          arg[DLOG_MAX_ARGS];
+} DlogSlot_t;
+
+static DlogSlot_t        s_slot[DLOG_RING_LEN];
+static volatile uint32_t s_head;      /* next slot to reserve (producers) */
+static volatile uint32_t s_tail;      /* next slot to drain (consumer)    */
+static volatile uint32_t s_dropped;
+static DLOG_Mode_t       s_mode = DLOG_MODE_TEXT;
+static DLOG_Stats_t      s_stats;     /* consumer-side counters           */
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+static void dlog_count_drop(void)
+{
+    uint32_t v;
+    do
+    {
+        v = __LDREXW(&s_dropped);
+    } while (__STREXW(v + 1U, &s_dropped) != 0U);
+}
+
+/* Published record at the tail into rec; 0 if there is none yet */
+static uint32_t dlog_peek(DLOG_Record_t *rec)
+{
+    const uint32_t tail = s_tail;
+
+    if (tail == s_head)
+    {
+        return 0U;
+    }
+
+    const DlogSlot_t *slot = &s_slot[tail & DLOG_MASK];
+    const uint32_t hdr = slot->hdr;
+    if (hdr == 0U)
+    {
+        return 0U;   /* reserved, producer still filling it */
+    }
+    __DMB();         /* header before payload */
+
+    rec->id    = (uint16_t)(hdr >> 8);
+    rec->nargs = (uint8_t)(hdr & 0xFFU);
+    rec->ts    = slot->ts;
+    memcpy(rec->arg, slot->arg, sizeof(uint32_t) * rec->nargs);
+    return 1U;
+}
+
+static void dlog_release(void)
+{
+    s_slot[s_tail & DLOG_MASK].hdr = 0U;
+    __DMB();         /* slot free before producers can see the new tail */
+    s_tail = s_tail + 1U;
+}
+
+/* Encode or format one record; returns its length in buf */
+static uint32_t dlog_render(const DLOG_Record_t *rec, uint8_t *buf, uint32_t size)
+{
+    if (s_mode == DLOG_MODE_BINARY)
+    {
+        return DLOG_Encode(buf, rec);
+    }
+    return DLOG_Format((char *)buf, size, rec);
+}
+
+/* --------------------------------------------------------------------------
+ * Producer side
+ * -------------------------------------------------------------------------- */
+
+void DLOG_Write(DLOG_FmtId_t id, uint32_t nargs, const uint32_t *args)
+{
+    const uint32_t ts = CYCCNT_Read();
+    uint32_t head;
+
+    if (nargs > DLOG_MAX_ARGS)
+    {
+        nargs = DLOG_MAX_ARGS;
+    }
+
+    /* Reserve a slot; a task or ISR that got in between makes STREX fail */
+    do
+    {
+        head = __LDREXW(&s_head);
+        if (head - s_tail >= DLOG_RING_LEN)
+        {
+            __CLREX();
+            dlog_count_drop();
+            return;
+        }
+    } while (__STREXW(head + 1U, &s_head) != 0U);
+
+    DlogSlot_t *slot = &s_slot[head & DLOG_MASK];
+    slot->ts = ts;
+    for (uint32_t i = 0U; i < nargs; i++)
+    {
+        slot->arg[i] = args[i];
+    }
+    __DMB();         /* payload before header */
+    slot->hdr = DLOG_HDR(id, nargs);
+}
+
+/* --------------------------------------------------------------------------
+ * Consumer side
+ * -------------------------------------------------------------------------- */
+
+void DLOG_Init(void)
+{
+    memset(s_slot, 0, sizeof(s_slot));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_head    = 0U;
+    s_tail    = 0U;
+    s_dropped = 0U;
+}
+
+void DLOG_SetMode(DLOG_Mode_t mode)
+{
+    s_mode = mode;
+}
+
+DLOG_Mode_t DLOG_GetMode(void)
+{
+    return s_mode;
+}
+
+uint32_t DLOG_Process(void)
+{
+    DLOG_Record_t rec;
+    uint8_t buf[DLOG_TEXT_MAX];
+    uint32_t sent = 0U;
+
+    const uint32_t backlog = s_head - s_tail;
+    if (backlog > s_stats.high_water)
+    {
+        s_stats.high_water = backlog;
+    }
+    /* Mode re-read per record: a switch to hold stops the drain at once */
+    while (s_mode != DLOG_MODE_HOLD && dlog_peek(&rec))
+    {
+        const uint32_t len = dlog_render(&rec, buf, sizeof(buf));
+
+        /* Leave the record in place until the UART can take all of it */
+        if (len > UART_TX_Free())
+        {
+            s_stats.stalls++;
+            break;
+        }
+        (void)UART_TX_Write(buf, len);
+        dlog_release();
+        s_stats.emitted++;
+        sent++;
+    }
+    return sent;
+}
+
+void DLOG_Flush(void)
+{
+    DLOG_Record_t rec;
+    uint8_t buf[DLOG_TEXT_MAX];
+
+    while (dlog_peek(&rec))
+    {
+        const uint32_t len = dlog_render(&rec, buf, sizeof(buf));
+        if (len > UART_TX_Free())
+        {
+            UART_TX_Flush();
+        }
+        (void)UART_TX_Write(buf, len);
+        dlog_release();
+        s_stats.emitted++;
+    }
+}
+
+void DLOG_GetStats(DLOG_Stats_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    *out = s_stats;
+    out->dropped = s_dropped;
+    out->written = s_head;
+    out->pending = s_head - s_tail;
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_log_text(const CLI_IF_Args_t *args)
+{
+    (void)args;
+    DLOG_SetMode(DLOG_MODE_TEXT);
+    CLI_IF_Print("Log output: text\r\n");
+}
+
+static void cmd_log_bin(const CLI_IF_Args_t *args)
+{
+    (void)args;
+    CLI_IF_Print("Log output: binary\r\n");   /* before the switch */
+    DLOG_SetMode(DLOG_MODE_BINARY);
+}
+
+static void cmd_log_stats(const CLI_IF_Args_t *args)
+{
+    char buf[160];
+    DLOG_Stats_t st;
+
+    (void)args;
+    DLOG_GetStats(&st);
+    snprintf(buf, sizeof(buf),
+             "LOG: mode=%s written=%lu dropped=%lu emitted=%lu stalls=%lu"
+             " hw=%lu pending=%lu\r\n",
+             (DLOG_GetMode() == DLOG_MODE_BINARY) ? "bin" :
+             (DLOG_GetMode() == DLOG_MODE_HOLD)   ? "hold" : "text",
+             (unsigned long)st.written, (unsigned long)st.dropped,
+             (unsigned long)st.emitted, (unsigned long)st.stalls,
+             (unsigned long)st.high_water, (unsigned long)st.pending);
+    CLI_IF_Print(buf);
+}
+
+CLI_IF_CMD(log_text,  "log text",  "", cmd_log_text,  "format log records on the ECU");
+CLI_IF_CMD(log_bin,   "log bin",   "", cmd_log_bin,   "send binary log records (dlog_decode)");
+CLI_IF_CMD(log_stats, "log stats", "", cmd_log_stats, "show deferred log counters");
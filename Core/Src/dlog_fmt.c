@@ -0,0 +1,306 @@
+/**
+ * @file    dlog_fmt.c
+ * @brief   Deferred log catalog: text formatting and binary record codec.
+ *
+ * No HAL or RTOS dependency: also built into the host decoder.
+ */
+
+#include "dlog_fmt.h"
+#include <stdio.h>
+
+#define DLOG_FMT_STRING(name, nargs, fmt)  fmt,
+#define DLOG_FMT_NARGS(name, nargs, fmt)   (uint8_t)(nargs),
+
+static const char *const s_fmt[DLOG_FMT_COUNT] = { DLOG_CATALOG(DLOG_FMT_STRING) };
+static const uint8_t     s_nargs[DLOG_FMT_COUNT] = { DLOG_CATALOG(DLOG_FMT_NARGS) };
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    char    *buf;
+    size_t   size;
+    uint32_t len;     /* characters that fit, excluding the NUL */
+} DlogOut_t;
+
+static void out_char(DlogOut_t *o, char c)
+{
+    if ((size_t)o->len + 1U < o->size)
+    {
+        o->buf[o->len++] = c;
+    }
+}
+
+/* Unsigned value in the given base, right-aligned in width */
+static void out_uint(DlogOut_t *o, uint32_t v, uint32_t base, int upper,
+                     uint32_t width, char pad, int neg)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[12];
+    uint32_t n = 0U;
+
+    do
+    {
+        tmp[n++] = digits[v % base];
+        v /= base;
+    } while (v != 0U);
+
+    uint32_t total = n + (neg ? 1U : 0U);
+    if (neg && pad == '0')
+    {
+        out_char(o, '-');
+    }
+    for (; total < width; total++)
+    {
+        out_char(o, pad);
+    }
+    if (neg && pad != '0')
+    {
+        out_char(o, '-');
+    }
+    while (n > 0U)
+    {
+        out_char(o, tmp[--n]);
+    }
+}
+
+/* Fixed point with prec decimals: integer part, '.', zero-padded fraction */
+static void out_fixed(DlogOut_t *o, uint32_t mag, int neg, uint32_t prec, uint32_t width)
+{
+    uint32_t scale = 1U;
+    for (uint32_t i = 0U; i < prec; i++)
+    {
+        scale *= 10U;
+    }
+
+    /* Width covers the whole field: integer part gets what is left */
+    const uint32_t frac_w = prec + 1U;
+    out_uint(o, mag / scale, 10U, 0, (width > frac_w) ? width - frac_w : 0U, ' ', neg);
+    out_char(o, '.');
+    out_uint(o, mag % scale, 10U, 0, prec, '0', 0);
+}
+
+static void out_hex_bytes(DlogOut_t *o, uint32_t count, uint32_t lo, uint32_t hi)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    if (count > 8U)
+    {
+        count = 8U;
+    }
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        const uint8_t b = (uint8_t)(((i < 4U) ? lo : hi) >> (8U * (i & 3U)));
+        out_char(o, hex[b >> 4]);
+        out_char(o, hex[b & 0x0FU]);
+        out_char(o, ' ');
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+const char *DLOG_FmtString(uint32_t id)
+{
+    return (id < DLOG_FMT_COUNT) ? s_fmt[id] : NULL;
+}
+
+uint32_t DLOG_FmtArgs(uint32_t id)
+{
+    return (id < DLOG_FMT_COUNT) ? s_nargs[id] : 0U;
+}
+
+uint32_t DLOG_Format(char *buf, size_t size, const DLOG_Record_t *rec)
+{
+    DlogOut_t o = { buf, size, 0U };
+    const char *f;
+    uint32_t a = 0U;
+
+    if (buf == NULL || size == 0U || rec == NULL)
+    {
+        return 0U;
+    }
+
+    f = DLOG_FmtString(rec->id);
+    if (f == NULL || rec->nargs != s_nargs[rec->id])
+    {
+        int n = snprintf(buf, size, "[dlog] bad record: id=%u nargs=%u\r\n",
+                         (unsigned int)rec->id, (unsigned int)rec->nargs);
+        return (n < 0) ? 0U : (((size_t)n < size) ? (uint32_t)n : (uint32_t)(size - 1U));
+    }
+
+/* Next argument; the catalog guarantees the count, this guards typos */
+#define NEXT_ARG()  ((a < rec->nargs) ? rec->arg[a++] : 0U)
+
+    for (; *f != '\0'; f++)
+    {
+        if (*f != '%')
+        {
+            out_char(&o, *f);
+            continue;
+        }
+
+        char pad = ' ';
+        uint32_t width = 0U;
+        uint32_t prec = 0U;
+        int star = 0;
+
+        f++;
+        if (*f == '0')
+        {
+            pad = '0';
+            f++;
+        }
+        if (*f == '*')
+        {
+            star = 1;
+            f++;
+        }
+        while (*f >= '0' && *f <= '9')
+        {
+            width = width * 10U + (uint32_t)(*f++ - '0');
+        }
+        if (*f == '.')
+        {
+            f++;
+            while (*f >= '0' && *f <= '9')
+            {
+                prec = prec * 10U + (uint32_t)(*f++ - '0');
+            }
+        }
+
+        switch (*f)
+        {
+            case 'u':
+            {
+                const uint32_t v = NEXT_ARG();
+                if (prec != 0U)
+                {
+                    out_fixed(&o, v, 0, prec, width);
+                }
+                else
+                {
+                    out_uint(&o, v, 10U, 0, width, pad, 0);
+                }
+                break;
+            }
+            case 'd':
+            {
+                const int32_t  v   = (int32_t)NEXT_ARG();
+                const uint32_t mag = (v < 0) ? (0U - (uint32_t)v) : (uint32_t)v;
+                if (prec != 0U)
+                {
+                    out_fixed(&o, mag, v < 0, prec, width);
+                }
+                else
+                {
+                    out_uint(&o, mag, 10U, 0, width, pad, v < 0);
+                }
+                break;
+            }
+            case 'x':
+            case 'X':
+                out_uint(&o, NEXT_ARG(), 16U, *f == 'X', width, pad, 0);
+                break;
+            case 'c':
+                out_char(&o, (char)NEXT_ARG());
+                break;
+            case 'H':
+                if (star)
+                {
+                    const uint32_t count = NEXT_ARG();
+                    const uint32_t lo    = NEXT_ARG();
+                    const uint32_t hi    = NEXT_ARG();
+                    out_hex_bytes(&o, count, lo, hi);
+                }
+                break;
+            case '%':
+                out_char(&o, '%');
+                break;
+            case '\0':
+                f--;   /* lone '%' at the end */
+                break;
+            default:
+                out_char(&o, '%');
+                out_char(&o, *f);
+                break;
+        }
+    }
+
+#undef NEXT_ARG
+
+    buf[o.len] = '\0';
+    return o.len;
+}
+
+uint32_t DLOG_Encode(uint8_t *out, const DLOG_Record_t *rec)
+{
+    const uint32_t n = (rec->nargs <= DLOG_MAX_ARGS) ? rec->nargs : DLOG_MAX_ARGS;
+    uint32_t len = 0U;
+    uint8_t sum = 0U;
+
+    out[len++] = (uint8_t)DLOG_SYNC;
+    out[len++] = (uint8_t)n;
+    out[len++] = (uint8_t)(rec->id);
+    out[len++] = (uint8_t)(rec->id >> 8);
+    for (uint32_t b = 0U; b < 4U; b++)
+    {
+        out[len++] = (uint8_t)(rec->ts >> (8U * b));
+    }
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        for (uint32_t b = 0U; b < 4U; b++)
+        {
+            out[len++] = (uint8_t)(rec->arg[i] >> (8U * b));
+        }
+    }
+    for (uint32_t i = 1U; i < len; i++)
+    {
+        sum = (uint8_t)(sum + out[i]);
+    }
+    out[len++] = (uint8_t)(0U - sum);
+    return len;
+}
+
+int DLOG_Decode(const uint8_t *buf, size_t len, DLOG_Record_t *rec)
+{
+    uint8_t sum = 0U;
+
+    if (len < 2U)
+    {
+        return (len == 1U && buf[0] == DLOG_SYNC) ? 0 : -1;
+    }
+    if (buf[0] != DLOG_SYNC || buf[1] > DLOG_MAX_ARGS)
+    {
+        return -1;
+    }
+
+    const size_t total = 9U + 4U * (size_t)buf[1];
+    if (len < total)
+    {
+        return 0;
+    }
+    for (size_t i = 1U; i < total; i++)
+    {
+        sum = (uint8_t)(sum + buf[i]);
+    }
+    if (sum != 0U)
+    {
+        return -1;
+    }
+
+    rec->nargs = buf[1];
+    rec->id    = (uint16_t)(buf[2] | ((uint16_t)buf[3] << 8));
+    rec->ts    = (uint32_t)buf[4] | ((uint32_t)buf[5] << 8) |
+                 ((uint32_t)buf[6] << 16) | ((uint32_t)buf[7] << 24);
+    for (uint32_t i = 0U; i < rec->nargs; i++)
+    {
+        const uint8_t *p = &buf[8U + 4U * i];
+        rec->arg[i] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                      ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    return (int)total;
+}
@@ -55,5 +55,23 @@
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
+#if VECU_STATIC_ALLOC
+/* Static allocation profile (rtos_static.h): heap_4.c is not built and
+   nothing may allocate. The CMSIS-RTOS2 wrapper still refers to the heap
+   (osTimerNew, osMemoryPoolNew, ...); reaching it is a bug, so it fails
+   loudly instead of handing out memory. */
+void *pvPortMalloc(size_t xWantedSize)
+{
+  (void)xWantedSize;
+  configASSERT(0);
+  return NULL;
+}
+
+void vPortFree(void *pv)
+{
+  configASSERT(pv == NULL);
+}
+#endif
+
 /* USER CODE END Application */
 
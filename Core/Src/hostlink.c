@@ -0,0 +1,437 @@
+/**
+ * @file    hostlink.c
+ * @brief   Binary host protocol on the CLI UART: framed commands and
+ *          subscribed vehicle / CAN streams.
+ *
+ * `status` costs ~60 bytes of text and a round trip per sample, which caps
+ * a polling host at a few Hz. Here the host subscribes once and the ECU
+ * pushes ~24-byte frames at the requested rate until the UART is full.
+ *
+ * Frames come from three tasks (CliTask replies, LinkTask vehicle samples,
+ * CanRxTask/CanCtrlTask CAN frames). Each one is numbered, encoded and
+ * written with the scheduler locked, so sequence numbers go out in order
+ * and frames never interleave; interrupts stay enabled.
+ */
+
+#include "hostlink.h"
+#include "cli_if.h"
+#include "uart_tx.h"
+#include "dlog.h"
+#include "rtstats.h"
+#include <stdio.h>
+
+_Static_assert(sizeof(HOSTLINK_Stats_t) == 4U * HOSTLINK_STATS_WORDS,
+               "STATS_REPLY layout");
+_Static_assert(RTSTATS_NAME_LEN == HOSTLINK_TOP_NAME_LEN, "TOP_REPLY layout");
+_Static_assert(1U + HOSTLINK_TOP_LEN <= HOSTLINK_MAX_PAYLOAD, "TOP_REPLY size");
+
+typedef struct
+{
+    volatile uint8_t  on;
+    volatile uint16_t period_ms;
+    volatile uint32_t gen;      /* bumped by SUBSCRIBE: restart seq       */
+    uint32_t          gen_seen; /* producer side                          */
+    uint32_t          seq;
+    uint32_t          last;     /* vehicle: next due tick; CAN: last sent */
+} HostlinkStream_t;
+
+static const VehicleSnap_t  *s_vehicleSnap = NULL;
+static volatile uint8_t      s_active;
+static HostlinkStream_t      s_stream[HOSTLINK_STREAM_COUNT];
+static HOSTLINK_Decoder_t    s_dec;
+static DLOG_Mode_t           s_dlogMode;    /* restored on TEXT */
+static volatile osThreadId_t s_linkTask = NULL;
+static HOSTLINK_Stats_t      s_stats;
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+/* Encode and queue one frame; caller holds the kernel lock */
+static void hostlink_send_locked(const uint8_t *payload, uint32_t len)
+{
+    uint8_t frame[HOSTLINK_MAX_FRAME];
+    const uint32_t n = HOSTLINK_Encode(frame, payload, len);
+
+    /* Whole frames only, whatever the UART TX overflow policy */
+    if (n == 0U || UART_TX_Free() < n || UART_TX_Write(frame, n) != n)
+    {
+        s_stats.tx_dropped++;
+        return;
+    }
+    s_stats.tx_frames++;
+}
+
+static void hostlink_send(const uint8_t *payload, uint32_t len)
+{
+    const int32_t lock = osKernelLock();
+    hostlink_send_locked(payload, len);
+    (void)osKernelRestoreLock(lock);
+}
+
+static void hostlink_ack(uint8_t type, HOSTLINK_Status_t status)
+{
+    const uint8_t p[3] = { HOSTLINK_MSG_ACK, type, (uint8_t)status };
+    hostlink_send(p, sizeof(p));
+}
+
+static void hostlink_wake(void)
+{
+    const osThreadId_t task = s_linkTask;
+    if (task != NULL)
+    {
+        (void)osThreadFlagsSet(task, HOSTLINK_WAKE_FLAG);
+    }
+}
+
+static void hostlink_unsubscribe_all(void)
+{
+    for (uint32_t i = 0U; i < HOSTLINK_STREAM_COUNT; i++)
+    {
+        s_stream[i].on = 0U;
+    }
+}
+
+static HOSTLINK_Status_t hostlink_subscribe(const uint8_t *p, uint32_t len)
+{
+    if (len != 4U)
+    {
+        return HOSTLINK_BAD_LENGTH;
+    }
+    const uint8_t  id     = p[1];
+    const uint16_t period = HOSTLINK_GetU16(&p[2]);
+
+    if (id >= HOSTLINK_STREAM_COUNT)
+    {
+        return HOSTLINK_BAD_STREAM;
+    }
+    if (id == HOSTLINK_STREAM_VEHICLE && period == 0U)
+    {
+        return HOSTLINK_BAD_PERIOD;
+    }
+    return HOSTLINK_OK;
+}
+
+/* TOP: one TOP_REPLY frame per snapshot line */
+static void hostlink_send_top(void)
+{
+    static RTSTATS_Snapshot_t snap;     /* CliTask only; too big for its stack */
+    uint8_t r[1U + HOSTLINK_TOP_LEN];
+
+    RTSTATS_GetSnapshot(&snap);
+    const uint32_t n = (snap.windows == 0U) ? 0U : snap.n;
+    uint32_t i = 0U;
+
+    do
+    {
+        memset(r, 0, sizeof(r));
+        r[0] = HOSTLINK_MSG_TOP_REPLY;
+        r[1] = (uint8_t)i;
+        r[2] = (uint8_t)n;
+        HOSTLINK_PutU16(&r[3], snap.load_x100);
+        if (i < n)
+        {
+            const RTSTATS_Entry_t *e = &snap.e[i];
+            r[5] = e->kind;
+            r[6] = e->prio;
+            HOSTLINK_PutU16(&r[7],  e->win_x100);
+            HOSTLINK_PutU16(&r[9],  e->total_x100);
+            HOSTLINK_PutU32(&r[11], e->win_cyc);
+            HOSTLINK_PutU32(&r[15], e->calls);
+            HOSTLINK_PutU32(&r[19], e->cyc_max);
+            memcpy(&r[23], e->name, HOSTLINK_TOP_NAME_LEN);
+        }
+        hostlink_send(r, sizeof(r));
+        i++;
+    } while (i < n);
+}
+
+static void hostlink_leave(void)
+{
+    hostlink_unsubscribe_all();
+    s_active = 0U;
+    DLOG_SetMode(s_dlogMode);
+    CLI_IF_SetRxHook(NULL);
+    CLI_IF_Print("Text mode\r\n> ");
+}
+
+/* One valid frame from the host (CliTask) */
+static void hostlink_handle(const uint8_t *p, uint32_t len)
+{
+    const uint8_t type = p[0];
+    HOSTLINK_Status_t st = HOSTLINK_OK;
+
+    switch (type)
+    {
+        case HOSTLINK_MSG_PING:
+            st = (len == 1U) ? HOSTLINK_OK : HOSTLINK_BAD_LENGTH;
+            break;
+
+        case HOSTLINK_MSG_SUBSCRIBE:
+            st = hostlink_subscribe(p, len);
+            if (st == HOSTLINK_OK)
+            {
+                /* ACK goes out before the first sample of the stream */
+                hostlink_ack(type, st);
+                HostlinkStream_t *s = &s_stream[p[1]];
+                s->period_ms = HOSTLINK_GetU16(&p[2]);
+                s->gen++;
+                s->on = 1U;
+                hostlink_wake();
+                return;
+            }
+            break;
+
+        case HOSTLINK_MSG_UNSUBSCRIBE:
+            if (len != 2U)
+            {
+                st = HOSTLINK_BAD_LENGTH;
+            }
+            else if (p[1] == HOSTLINK_STREAM_ALL)
+            {
+                hostlink_unsubscribe_all();
+            }
+            else if (p[1] < HOSTLINK_STREAM_COUNT)
+            {
+                s_stream[p[1]].on = 0U;
+            }
+            else
+            {
+                st = HOSTLINK_BAD_STREAM;
+            }
+            break;
+
+        case HOSTLINK_MSG_STATS:
+            if (len == 1U)
+            {
+                uint8_t r[1U + 4U * HOSTLINK_STATS_WORDS];
+                uint32_t w[HOSTLINK_STATS_WORDS];
+                HOSTLINK_Stats_t stats;
+
+                HOSTLINK_GetStats(&stats);
+                memcpy(w, &stats, sizeof(w));
+                r[0] = HOSTLINK_MSG_STATS_REPLY;
+                for (uint32_t i = 0U; i < HOSTLINK_STATS_WORDS; i++)
+                {
+                    HOSTLINK_PutU32(&r[1U + 4U * i], w[i]);
+                }
+                hostlink_send(r, sizeof(r));
+                return;
+            }
+            st = HOSTLINK_BAD_LENGTH;
+            break;
+
+        case HOSTLINK_MSG_TOP:
+            if (len == 1U)
+            {
+                hostlink_send_top();
+                return;
+            }
+            st = HOSTLINK_BAD_LENGTH;
+            break;
+
+        case HOSTLINK_MSG_TEXT:
+            if (len == 1U)
+            {
+                hostlink_ack(type, HOSTLINK_OK);
+                hostlink_leave();
+                return;
+            }
+            st = HOSTLINK_BAD_LENGTH;
+            break;
+
+        default:
+            st = HOSTLINK_BAD_TYPE;
+            break;
+    }
+    hostlink_ack(type, st);
+}
+
+/* CLI RX hook: every byte received in binary mode */
+static void hostlink_rx(uint8_t c)
+{
+    const uint8_t *payload;
+    uint32_t len;
+    const int r = HOSTLINK_DecodeByte(&s_dec, c, &payload, &len);
+
+    if (r > 0)
+    {
+        s_stats.rx_frames++;
+        hostlink_handle(payload, len);
+    }
+    else if (r < 0)
+    {
+        s_stats.rx_errors++;
+    }
+}
+
+static void hostlink_send_vehicle(uint32_t tick)
+{
+    HostlinkStream_t *s = &s_stream[HOSTLINK_STREAM_VEHICLE];
+    uint8_t p[1U + HOSTLINK_VEHICLE_LEN];
+    VehicleSample_t vs;
+
+    (void)VehicleSnap_Read(s_vehicleSnap, &vs);
+    p[0] = HOSTLINK_MSG_VEHICLE;
+    HOSTLINK_PutU32(&p[1],  s->seq++);
+    HOSTLINK_PutU32(&p[5],  tick);
+    HOSTLINK_PutF32(&p[9],  Vehicle_GetSpeedKph(&vs.state));
+    HOSTLINK_PutU16(&p[13], vs.state.engine_rpm);
+    HOSTLINK_PutF32(&p[15], Vehicle_GetCoolantC(&vs.state));
+    s_stats.vehicle++;
+    hostlink_send(p, sizeof(p));
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+void HOSTLINK_Init(const VehicleSnap_t *snap)
+{
+    s_vehicleSnap = snap;
+    s_active  = 0U;
+    hostlink_unsubscribe_all();
+}
+
+void HOSTLINK_Enter(void)
+{
+    static const uint8_t delim = HOSTLINK_DELIM;
+
+    hostlink_unsubscribe_all();
+    HOSTLINK_DecoderInit(&s_dec, 0U);   /* skip to the host's first delimiter */
+
+    s_dlogMode = DLOG_GetMode();
+    DLOG_SetMode(DLOG_MODE_HOLD);
+    (void)UART_TX_Write(&delim, 1U);
+    CLI_IF_SetRxHook(hostlink_rx);
+    s_active = 1U;
+}
+
+uint8_t HOSTLINK_IsActive(void)
+{
+    return s_active;
+}
+
+uint32_t HOSTLINK_Poll(void)
+{
+    HostlinkStream_t *s = &s_stream[HOSTLINK_STREAM_VEHICLE];
+
+    if (!s_active || !s->on || s_vehicleSnap == NULL)
+    {
+        return osWaitForever;
+    }
+
+    const uint32_t now    = osKernelGetTickCount();
+    const uint32_t period = s->period_ms;
+
+    if (s->gen != s->gen_seen)
+    {
+        s->gen_seen = s->gen;
+        s->seq      = 0U;
+        s->last     = now;
+    }
+    if ((int32_t)(now - s->last) >= 0)
+    {
+        hostlink_send_vehicle(now);
+        s->last += period;
+
+        /* Ran late by whole periods: skip them rather than burst */
+        if ((int32_t)(now - s->last) >= 0)
+        {
+            const uint32_t missed = (now - s->last) / period + 1U;
+            s_stats.late += missed;
+            s->last += missed * period;
+        }
+    }
+    return s->last - now;
+}
+
+void HOSTLINK_Wait(uint32_t timeout)
+{
+    if (s_linkTask == NULL)
+    {
+        s_linkTask = osThreadGetId();
+    }
+    (void)osThreadFlagsWait(HOSTLINK_WAKE_FLAG, osFlagsWaitAny, timeout);
+}
+
+void HOSTLINK_CanFrame(const CAN_IF_Msg_t *msg)
+{
+    HostlinkStream_t *s = &s_stream[HOSTLINK_STREAM_CAN];
+    uint8_t p[1U + HOSTLINK_CAN_LEN_MIN + 8U];
+
+    if (!s_active || !s->on || msg == NULL)
+    {
+        return;
+    }
+
+    /* Two CAN tasks feed the stream: number and send as one step */
+    const int32_t lock = osKernelLock();
+    const uint32_t now = osKernelGetTickCount();
+    const uint8_t  dlc = (msg->dlc > 8U) ? 8U : msg->dlc;
+
+    if (s->gen != s->gen_seen)
+    {
+        s->gen_seen = s->gen;
+        s->seq      = 0U;
+        s->last     = now - s->period_ms;
+    }
+    if (s->period_ms != 0U && (now - s->last) < s->period_ms)
+    {
+        s_stats.can_skipped++;
+        (void)osKernelRestoreLock(lock);
+        return;
+    }
+    s->last = now;
+
+    p[0] = HOSTLINK_MSG_CAN;
+    HOSTLINK_PutU32(&p[1], s->seq++);
+    HOSTLINK_PutU32(&p[5], now);
+    HOSTLINK_PutU32(&p[9], msg->id | (msg->ide ? 0x80000000U : 0U));
+    p[13] = dlc;
+    p[14] = msg->fifo;
+    memcpy(&p[15], msg->data, dlc);
+    s_stats.can++;
+    hostlink_send_locked(p, 1U + HOSTLINK_CAN_LEN_MIN + dlc);
+
+    (void)osKernelRestoreLock(lock);
+}
+
+void HOSTLINK_GetStats(HOSTLINK_Stats_t *out)
+{
+    if (out != NULL)
+    {
+        *out = s_stats;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_link_bin(const CLI_IF_Args_t *args)
+{
+    (void)args;
+    CLI_IF_Print("Binary mode (hostlink); a TEXT frame returns\r\n");
+    HOSTLINK_Enter();
+}
+
+static void cmd_link_stats(const CLI_IF_Args_t *args)
+{
+    char buf[160];
+    HOSTLINK_Stats_t st;
+
+    (void)args;
+    HOSTLINK_GetStats(&st);
+    snprintf(buf, sizeof(buf),
+             "LINK: rx=%lu err=%lu tx=%lu dropped=%lu vehicle=%lu can=%lu"
+             " skipped=%lu late=%lu\r\n",
+             (unsigned long)st.rx_frames, (unsigned long)st.rx_errors,
+             (unsigned long)st.tx_frames, (unsigned long)st.tx_dropped,
+             (unsigned long)st.vehicle, (unsigned long)st.can,
+             (unsigned long)st.can_skipped, (unsigned long)st.late);
+    CLI_IF_Print(buf);
+}
+
+CLI_IF_CMD(link_bin,   "link bin",   "", cmd_link_bin,   "binary host protocol (hostlink_client)");
+CLI_IF_CMD(link_stats, "link stats", "", cmd_link_stats, "show binary link counters");
@@ -0,0 +1,142 @@
+/**
+ * @file    hostlink_proto.c
+ * @brief   Binary host protocol: CRC-16 and COBS frame codec.
+ *
+ * No HAL or RTOS dependency: also built into the host client.
+ */
+
+#include "hostlink_proto.h"
+
+/* CRC-16/CCITT-FALSE, one nibble per lookup: 32 bytes of table */
+static const uint16_t s_crcNibble[16] = {
+    0x0000U, 0x1021U, 0x2042U, 0x3063U, 0x4084U, 0x50A5U, 0x60C6U, 0x70E7U,
+    0x8108U, 0x9129U, 0xA14AU, 0xB16BU, 0xC18CU, 0xD1ADU, 0xE1CEU, 0xF1EFU,
+};
+
+uint16_t HOSTLINK_Crc16(const uint8_t *data, uint32_t len)
+{
+    uint16_t crc = 0xFFFFU;
+
+    for (uint32_t i = 0U; i < len; i++)
+    {
+        crc = (uint16_t)((crc << 4) ^ s_crcNibble[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ s_crcNibble[(crc >> 12) ^ (data[i] & 0x0FU)]);
+    }
+    return crc;
+}
+
+uint32_t HOSTLINK_Encode(uint8_t *out, const uint8_t *payload, uint32_t len)
+{
+    uint8_t crc[2];
+    uint32_t code_at = 0U;    /* position of the current COBS code byte */
+    uint32_t o = 1U;
+    uint8_t code = 1U;
+
+    if (len == 0U || len > HOSTLINK_MAX_PAYLOAD)
+    {
+        return 0U;
+    }
+    HOSTLINK_PutU16(crc, HOSTLINK_Crc16(payload, len));
+
+    for (uint32_t i = 0U; i < len + 2U; i++)
+    {
+        const uint8_t c = (i < len) ? payload[i] : crc[i - len];
+
+        if (c != 0U)
+        {
+            out[o++] = c;
+            code++;
+        }
+        if (c == 0U || code == 0xFFU)
+        {
+            out[code_at] = code;
+            code_at = o++;
+            code = 1U;
+        }
+    }
+    out[code_at] = code;
+    out[o++] = HOSTLINK_DELIM;
+    return o;
+}
+
+void HOSTLINK_DecoderInit(HOSTLINK_Decoder_t *d, uint8_t synced)
+{
+    d->len      = 0U;
+    d->overflow = 0U;
+    d->synced   = synced;
+}
+
+/* COBS-decode buf[0..len) in place; returns the decoded length, or -1 */
+static int hostlink_unstuff(uint8_t *buf, uint32_t len)
+{
+    uint32_t i = 0U;
+    uint32_t o = 0U;
+
+    while (i < len)
+    {
+        const uint8_t code = buf[i++];
+
+        if (code == 0U || i - 1U + code > len)
+        {
+            return -1;
+        }
+        for (uint32_t k = 1U; k < code; k++)
+        {
+            buf[o++] = buf[i++];
+        }
+        if (code != 0xFFU && i < len)
+        {
+            buf[o++] = 0U;
+        }
+    }
+    return (int)o;
+}
+
+int HOSTLINK_DecodeByte(HOSTLINK_Decoder_t *d, uint8_t c,
+                        const uint8_t **payload, uint32_t *len)
+{
+    if (c != HOSTLINK_DELIM)
+    {
+        if (d->len < sizeof(d->buf))
+        {
+            d->buf[d->len++] = c;
+        }
+        else
+        {
+            d->overflow = 1U;
+        }
+        return 0;
+    }
+
+    /* End of frame */
+    const uint32_t n = d->len;
+    const uint8_t bad = d->overflow;
+    const uint8_t synced = d->synced;
+
+    d->len      = 0U;
+    d->overflow = 0U;
+    d->synced   = 1U;
+
+    if (!synced || (n == 0U && !bad))
+    {
+        return 0;    /* leading noise, or an empty frame */
+    }
+    if (bad)
+    {
+        return -1;
+    }
+
+    const int m = hostlink_unstuff(d->buf, n);
+    if (m < 3 || (uint32_t)m > HOSTLINK_MAX_PAYLOAD + 2U)
+    {
+        return -1;
+    }
+    const uint32_t plen = (uint32_t)m - 2U;
+    if (HOSTLINK_Crc16(d->buf, plen) != HOSTLINK_GetU16(&d->buf[plen]))
+    {
+        return -1;
+    }
+    *payload = d->buf;
+    *len = plen;
+    return 1;
+}
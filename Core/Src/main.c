@@ -25,8 +25,19 @@
 #include <string.h>
 #include <stdio.h>
 #include "vehicle.h"
+#include "vehicle_snap.h"
+#include "vehicle_cmd.h"
 #include "can_if.h"
 #include "cli_if.h"
+#include "cyccnt.h"
+#include "uart_tx.h"
+#include "dlog.h"
+#include "hostlink.h"
+#include "sched_tt.h"
+#include "rtstats.h"
+#include "memmon.h"
+#include "rtos_static.h"
+#include "probe.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -45,6 +56,12 @@
  *   v2.0 - FreeRTOS tasks + CAN loopback telemetry.
  *   v2.1 - CAN_IF abstraction, RX queue, CLI-controlled logging.
  *   v2.2 - VehicleState model + CLI control + CAN telemetry integration.
+ *   v2.4 - Time-triggered 1 / 10 / 100 ms schedule on a TIM6 tick (sched_tt.h).
+ *        - Per-task / per-interrupt CPU time from the DWT counter (rtstats.h).
+ *        - Stack / heap peaks and a right-sizing plan (memmon.h).
+ *        - Static allocation profile for every RTOS object (rtos_static.h).
+ *        - Cycle-count histograms of the model step (probe.h).
+ *        - The 1 ms command slot only wakes VehicleTask when a command waits.
  */
 /* USER CODE END PD */
 
@@ -57,6 +74,8 @@
 CAN_HandleTypeDef hcan1;
 
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
 
 /* Definitions for defaultTask (kept for CubeMX compatibility, currently unused) */
 osThreadId_t defaultTaskHandle;
@@ -67,37 +86,81 @@ const osThreadAttr_t defaultTask_attributes = {
 };
 /* USER CODE BEGIN PV */
 
-/* Global vehicle state shared between tasks */
+/* Global vehicle state: owned by VehicleTask. Other tasks post commands
+   (vehicle_cmd.h) and read the snapshot below. */
 VehicleState_t g_vehicle;
 
+/* Published copy of g_vehicle: written by VehicleTask only, read by
+   everyone else (vehicle_snap.h) */
+VehicleSnap_t g_vehicleSnap;
+
 /* RTOS task handles */
 static osThreadId_t vehicleTaskHandle;
 static osThreadId_t cliTaskHandle;
 static osThreadId_t canRxTaskHandle;
+static osThreadId_t canCtrlTaskHandle;
+static osThreadId_t logTaskHandle;
+static osThreadId_t linkTaskHandle;
 
-/* RTOS task attributes */
+/* RTOS task attributes; stacks and control blocks from heap_4 or, in the
+   static allocation profile, from rtos_static.h buffers */
+RTOS_STATIC_TASK(canRxTask, 256 * 4);
 static const osThreadAttr_t canRxTask_attributes = {
   .name       = "CanRxTask",
   .priority   = osPriorityBelowNormal,
-  .stack_size = 256 * 4
+  RTOS_STATIC_TASK_MEM(canRxTask)
+};
+
+/* Control frames (FIFO1) preempt bulk RX and the CLI; only the schedule
+   (VehicleTask) runs above them. No control frame is acted on yet: they
+   are logged, decoded and forwarded like bulk frames */
+RTOS_STATIC_TASK(canCtrlTask, 256 * 4);
+static const osThreadAttr_t canCtrlTask_attributes = {
+  .name       = "CanCtrlTask",
+  .priority   = osPriorityHigh,
+  RTOS_STATIC_TASK_MEM(canCtrlTask)
 };
 
+/* Runs the time-triggered schedule: above every event-driven task, so
+   frames start on the tick; a frame takes tens of microseconds */
+RTOS_STATIC_TASK(vehicleTask, 256 * 4);
 static const osThreadAttr_t vehicleTask_attributes = {
   .name       = "VehicleTask",
-  .priority   = osPriorityNormal,
-  .stack_size = 256 * 4
+  .priority   = osPriorityRealtime,
+  RTOS_STATIC_TASK_MEM(vehicleTask)
 };
 
+RTOS_STATIC_TASK(cliTask, 256 * 4);
 static const osThreadAttr_t cliTask_attributes = {
   .name       = "CliTask",
   .priority   = osPriorityAboveNormal,
-  .stack_size = 256 * 4
+  RTOS_STATIC_TASK_MEM(cliTask)
+};
+
+/* Formats deferred log records; below everything else that has work */
+RTOS_STATIC_TASK(logTask, 384 * 4);
+static const osThreadAttr_t logTask_attributes = {
+  .name       = "LogTask",
+  .priority   = osPriorityLow,
+  RTOS_STATIC_TASK_MEM(logTask)
 };
+
+/* Binary host protocol: vehicle samples at the subscribed rate */
+RTOS_STATIC_TASK(linkTask, 256 * 4);
+static const osThreadAttr_t linkTask_attributes = {
+  .name       = "LinkTask",
+  .priority   = osPriorityBelowNormal,
+  RTOS_STATIC_TASK_MEM(linkTask)
+};
+
+/* Model steps run by VehicleTask; numbers the command trace */
+static uint32_t s_vehicleStep;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_CAN1_Init(void);
 static void MX_USART2_UART_Init(void);
 void StartDefaultTask(void *argument);
@@ -106,15 +169,36 @@ void StartDefaultTask(void *argument);
 static void VehicleTask(void *argument);
 static void CliTask(void *argument);
 static void CanRxTask(void *argument);
+static void CanCtrlTask(void *argument);
+static void LogTask(void *argument);
+static void LinkTask(void *argument);
 static void uart_print(const char *s);
+static void job_vehicle_cmd(uint32_t dt_ms);
+static void job_vehicle_model(uint32_t dt_ms);
+static void job_can_telemetry(uint32_t dt_ms);
+static void job_rtstats(uint32_t dt_ms);
+static void job_memmon(uint32_t dt_ms);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
+/* Time-triggered schedule, run by VehicleTask (sched_tt.h). In a frame the
+   slots run in table order: commands land before the model step. The
+   offsets of the 100 ms slots keep them off the model's frames. `cmd` is
+   gated: VehicleTask is woken for it only when a command is queued. */
+static const SCHED_Slot_t s_schedule[] = {
+  /* name         job                 rate               offset  gate */
+  { "cmd",        job_vehicle_cmd,    SCHED_RATE_1MS,    0U,     VehicleCmd_Pending },
+  { "model",      job_vehicle_model,  SCHED_RATE_10MS,   0U,     NULL },
+  { "telemetry",  job_can_telemetry,  SCHED_RATE_100MS,  5U,     NULL },
+  { "rtstats",    job_rtstats,        SCHED_RATE_100MS,  7U,     NULL },
+  { "memmon",     job_memmon,         SCHED_RATE_100MS,  3U,     NULL },
+};
+
 static void uart_print(const char *s)
 {
-  HAL_UART_Transmit(&huart2, (uint8_t *)s, strlen(s), HAL_MAX_DELAY);
+  (void)UART_TX_Print(s);
 }
 
 /* USER CODE END 0 */
@@ -127,6 +211,8 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
+  /* Still on the reset stack: mark the rest of it for `mem` */
+  MEMMON_PaintMsp();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -141,47 +227,89 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  CYCCNT_Init();
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_CAN1_Init();
   MX_USART2_UART_Init();
   /* USER CODE BEGIN 2 */
+  /* All console output goes through the DMA TX ring from here on */
+  if (UART_TX_Init(&huart2) != HAL_OK)
+  {
+    Error_Handler();
+  }
   uart_print("\r\n=== Mini ECU – CAN + RTOS Telemetry Node ===\r\n");
 
+  /* Deferred log ring; LogTask prints the records once the scheduler runs */
+  DLOG_Init();
+
   /* Initialize vehicle model */
   Vehicle_Init(&g_vehicle);
+  VehicleSnap_Init(&g_vehicleSnap, &g_vehicle);
+  VehicleCmd_Init();
 
-  /* Initialize CAN interface (filters, start, queue, notifications) */
+  /* Schedule table; VehicleTask starts the TIM6 tick */
+  if (SCHED_Init(s_schedule, sizeof(s_schedule) / sizeof(s_schedule[0])) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* Initialize CAN interface (filters, start, RX ring, notifications) */
   if (CAN_IF_Init() != HAL_OK)
   {
+    DLOG_Flush();
     uart_print("CAN_IF_Init FAILED, halting\r\n");
+    UART_TX_Flush();
     Error_Handler();
   }
 
   /* Initialize CLI interface (starts UART RX internally) */
-  CLI_IF_Init(&huart2, &g_vehicle);
+  CLI_IF_Init(&huart2, &g_vehicleSnap);
+
+  /* Binary host protocol on the same UART (`link bin`) */
+  HOSTLINK_Init(&g_vehicleSnap);
 
   uart_print("Init complete, creating RTOS tasks...\r\n");
 
   /* Initialize the RTOS kernel */
   osKernelInitialize();
 
-  /* Create VehicleTask: updates model + sends telemetry */
+  /* Create VehicleTask: runs the schedule (commands, model, telemetry) */
   vehicleTaskHandle = osThreadNew(VehicleTask, NULL, &vehicleTask_attributes);
 
-  /* Create CliTask: runs CLI_IF_Task() in a loop */
+  /* Create CliTask: runs CLI_IF_Task() whenever input arrives */
   cliTaskHandle = osThreadNew(CliTask, NULL, &cliTask_attributes);
 
-  /* Create CAN RX task: consumes messages from CAN_IF RX queue */
+  /* Create CAN RX task: consumes frames from the CAN_IF RX ring */
   canRxTaskHandle = osThreadNew(CanRxTask, NULL, &canRxTask_attributes);
 
+  /* Create CAN control task: consumes FIFO1 (control IDs) */
+  canCtrlTaskHandle = osThreadNew(CanCtrlTask, NULL, &canCtrlTask_attributes);
+
+  /* Create LogTask: formats and sends deferred log records */
+  logTaskHandle = osThreadNew(LogTask, NULL, &logTask_attributes);
+
+  /* Create LinkTask: sends subscribed vehicle samples in binary mode */
+  linkTaskHandle = osThreadNew(LinkTask, NULL, &linkTask_attributes);
+
+  /* Stack peaks for `mem` / `mem plan` */
+  (void)MEMMON_AddTask(vehicleTaskHandle, &vehicleTask_attributes);
+  (void)MEMMON_AddTask(cliTaskHandle, &cliTask_attributes);
+  (void)MEMMON_AddTask(canRxTaskHandle, &canRxTask_attributes);
+  (void)MEMMON_AddTask(canCtrlTaskHandle, &canCtrlTask_attributes);
+  (void)MEMMON_AddTask(logTaskHandle, &logTask_attributes);
+  (void)MEMMON_AddTask(linkTaskHandle, &linkTask_attributes);
+
   /* Start the RTOS scheduler (never returns) */
   osKernelStart();
 
   /* We should never reach here */
+  DLOG_Flush();
   uart_print("ERROR: osKernelStart returned!\r\n");
+  UART_TX_Flush();
 
   /* USER CODE END 2 */
 
@@ -309,6 +437,25 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream5_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -349,32 +496,62 @@ static void MX_GPIO_Init(void)
 /* USER CODE BEGIN 4 */
 
 /**
-  * @brief Task that updates the vehicle model and sends CAN telemetry.
+  * @brief Task that runs the time-triggered schedule (s_schedule): vehicle
+  *        commands every 1 ms, the model every 10 ms, CAN telemetry every
+  *        100 ms. It owns g_vehicle.
   */
 static void VehicleTask(void *argument)
 {
   (void)argument;
 
-  const uint32_t period_ms = 100U;
-  uint32_t last_wake = osKernelGetTickCount();
+  SCHED_Run();
+}
 
-  for (;;)
+/* 1 ms, when commands are queued: apply them */
+static void job_vehicle_cmd(uint32_t dt_ms)
+{
+  (void)dt_ms;
+  (void)VehicleCmd_Apply(&g_vehicle, s_vehicleStep + 1U);
+}
+
+/* 10 ms: model step over the scheduled time, then publish it */
+static void job_vehicle_model(uint32_t dt_ms)
+{
+  s_vehicleStep++;
   {
-    /* 0.1 s step */
-    Vehicle_Update(&g_vehicle, 0.1f);
+    PROBE_SCOPE(PROBE_VEHICLE_UPDATE);
+    Vehicle_UpdateMs(&g_vehicle, dt_ms);
+  }
+  VehicleSnap_Publish(&g_vehicleSnap, &g_vehicle);
+}
 
-    /* Broadcast telemetry on CAN */
-    (void)CAN_IF_SendTelemetry(&g_vehicle);
+/* 100 ms: broadcast the last published step on CAN */
+static void job_can_telemetry(uint32_t dt_ms)
+{
+  VehicleSample_t sample;
 
-    last_wake += period_ms;
-    (void)osDelayUntil(last_wake);
-  }
+  (void)dt_ms;
+  (void)VehicleSnap_Read(&g_vehicleSnap, &sample);
+  (void)CAN_IF_SendTelemetry(&sample.state);
+}
+
+/* 100 ms: run-time stats window bookkeeping (a new `top` every second) */
+static void job_rtstats(uint32_t dt_ms)
+{
+  RTSTATS_Update(dt_ms);
+}
+
+/* 100 ms: stack / heap low-water check (once a second) */
+static void job_memmon(uint32_t dt_ms)
+{
+  MEMMON_Update(dt_ms);
 }
 
 /**
   * @brief Task that runs the CLI interface.
   *
-  * CLI_IF_Task() drains the ring buffer and parses commands.
+  * Sleeps until the UART RX interrupt signals input, then CLI_IF_Task()
+  * drains the ring buffer and parses commands.
   */
 static void CliTask(void *argument)
 {
@@ -382,42 +559,79 @@ static void CliTask(void *argument)
 
   for (;;)
   {
+    CLI_IF_WaitRx(osWaitForever);
     CLI_IF_Task();
-    /* Small delay to yield CPU; CLI_IF_Task is non-blocking */
-    osDelay(10);
   }
 }
 
 /**
-  * @brief Task that waits for CAN frames and lets CAN_IF process them.
+  * @brief Task that waits for CAN frames (FIFO0) and lets CAN_IF process them.
   */
 static void CanRxTask(void *argument)
 {
   (void)argument;
 
-  osMessageQueueId_t q = CAN_IF_GetRxQueueHandle();
-  if (q == NULL)
+  for (;;)
   {
-    uart_print("CanRxTask: RX queue is NULL!\r\n");
-    /* Loop with delay rather than crashing */
-    for (;;)
+    /* Wait for the next frame; it is used in place in the RX ring */
+    const CAN_IF_Msg_t *msg = CAN_IF_RxGet(CAN_RX_FIFO0, osWaitForever);
+    if (msg != NULL)
     {
-      osDelay(1000);
+      /* Let CAN interface layer handle/log the message */
+      CAN_IF_ProcessRxMsg(msg);
+      CAN_IF_RxRelease(CAN_RX_FIFO0);
     }
   }
+}
+
+/**
+  * @brief Task that handles control frames routed to FIFO1 by the filters.
+  */
+static void CanCtrlTask(void *argument)
+{
+  (void)argument;
 
   for (;;)
   {
-    CAN_IF_Msg_t msg;
-    /* Wait forever for next CAN message */
-    if (osMessageQueueGet(q, &msg, NULL, osWaitForever) == osOK)
+    const CAN_IF_Msg_t *msg = CAN_IF_RxGet(CAN_RX_FIFO1, osWaitForever);
+    if (msg != NULL)
     {
-      /* Let CAN interface layer handle/log the message */
-      CAN_IF_ProcessRxMsg(&msg);
+      CAN_IF_ProcessRxMsg(msg);
+      CAN_IF_RxRelease(CAN_RX_FIFO1);
     }
   }
 }
 
+/**
+  * @brief Task that turns deferred log records (dlog) into console output.
+  */
+static void LogTask(void *argument)
+{
+  (void)argument;
+
+  for (;;)
+  {
+    (void)DLOG_Process();
+    osDelay(DLOG_DRAIN_MS);
+  }
+}
+
+/**
+  * @brief Task that sends hostlink vehicle samples at the subscribed rate.
+  *
+  * Sleeps until the next sample is due, or until a subscription change
+  * wakes it; without a subscription it does not run at all.
+  */
+static void LinkTask(void *argument)
+{
+  (void)argument;
+
+  for (;;)
+  {
+    HOSTLINK_Wait(HOSTLINK_Poll());
+  }
+}
+
 /* USER CODE END 4 */
 
 /* USER CODE BEGIN Header_StartDefaultTask */
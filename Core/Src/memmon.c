@@ -0,0 +1,357 @@
+/**
+ * @file    memmon.c
+ * @brief   Memory monitor: peak stack use per task, heap_4 peak and main
+ *          stack (MSP) depth; `mem` and `mem plan`.
+ */
+
+#include "memmon.h"
+#include "cli_if.h"
+#include "dlog.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include <stdio.h>
+
+#define MEMMON_PAINT        0xA5A5A5A5UL    /* same byte as the kernel's stack fill */
+#define MEMMON_PAINT_GUARD  64U             /* left unpainted below the caller's SP */
+
+typedef struct
+{
+    TaskHandle_t handle;
+    const char  *name;
+    uint32_t     size;
+    uint8_t      on_heap;
+    uint8_t      warned;
+} MemmonTask_t;
+
+static MemmonTask_t s_task[MEMMON_MAX_TASKS];
+static uint32_t     s_tasks;
+static uint8_t      s_sysAdded;     /* idle and timer tasks */
+#if MEMMON_STACKS
+static uint8_t      s_mspWarned;
+#endif
+#if configSUPPORT_DYNAMIC_ALLOCATION
+static uint8_t      s_heapWarned;
+#endif
+static uint32_t     s_elapsedMs;
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+#if MEMMON_STACKS
+/* Main stack region reserved by the linker script */
+static uint32_t *memmon_msp_bottom(void)
+{
+    extern uint8_t  _estack;            /* linker script */
+    extern uint32_t _Min_Stack_Size;    /* linker script; its address is the size */
+
+    return (uint32_t *)((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size);
+}
+
+static uint32_t memmon_msp_size(void)
+{
+    extern uint32_t _Min_Stack_Size;
+
+    return (uint32_t)&_Min_Stack_Size;
+}
+
+static uint32_t memmon_msp_peak(void)
+{
+    const uint32_t *p = memmon_msp_bottom();
+    const uint32_t *const top = (const uint32_t *)((const uint8_t *)p + memmon_msp_size());
+
+    while (p < top && *p == MEMMON_PAINT)
+    {
+        p++;
+    }
+    return (uint32_t)((const uint8_t *)top - (const uint8_t *)p);
+}
+
+static uint32_t memmon_task_peak(const MemmonTask_t *t)
+{
+    const uint32_t free_bytes =
+        (uint32_t)uxTaskGetStackHighWaterMark(t->handle) * (uint32_t)sizeof(StackType_t);
+
+    return (free_bytes < t->size) ? t->size - free_bytes : 0U;
+}
+#endif /* MEMMON_STACKS */
+
+static void memmon_add(TaskHandle_t h, const char *name, uint32_t size, uint8_t on_heap)
+{
+    if (h == NULL || s_tasks >= MEMMON_MAX_TASKS)
+    {
+        return;
+    }
+    MemmonTask_t *t = &s_task[s_tasks];
+    t->handle  = h;
+    t->name    = name;
+    t->size    = size;
+    t->on_heap = on_heap;
+    t->warned  = 0U;
+    s_tasks++;
+}
+
+#if MEMMON_STACKS || configSUPPORT_DYNAMIC_ALLOCATION
+/* Peak plus margin, rounded up */
+static uint32_t memmon_plan(uint32_t peak, uint32_t round)
+{
+    uint32_t margin = peak * MEMMON_MARGIN_PCT / 100U;
+
+    if (margin < MEMMON_MARGIN_MIN)
+    {
+        margin = MEMMON_MARGIN_MIN;
+    }
+    return (peak + margin + round - 1U) / round * round;
+}
+#endif
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+static uint32_t memmon_heap_peak(void)
+{
+    const uint32_t min_free = (uint32_t)xPortGetMinimumEverFreeHeapSize();
+
+    return (min_free < configTOTAL_HEAP_SIZE) ? (uint32_t)configTOTAL_HEAP_SIZE - min_free : 0U;
+}
+#endif
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+void MEMMON_PaintMsp(void)
+{
+#if MEMMON_STACKS
+    uint32_t *p = memmon_msp_bottom();
+    uint32_t *const stop = (uint32_t *)((__get_MSP() - MEMMON_PAINT_GUARD) & ~3UL);
+
+    while (p < stop)
+    {
+        *p++ = MEMMON_PAINT;
+    }
+#endif
+}
+
+HAL_StatusTypeDef MEMMON_AddTask(osThreadId_t id, const osThreadAttr_t *attr)
+{
+    if (id == NULL || attr == NULL || s_tasks >= MEMMON_MAX_TASKS)
+    {
+        return HAL_ERROR;
+    }
+    const uint32_t size = (attr->stack_size != 0U)
+                        ? attr->stack_size
+                        : (uint32_t)configMINIMAL_STACK_SIZE * (uint32_t)sizeof(StackType_t);
+
+    memmon_add((TaskHandle_t)id, attr->name, size, (attr->stack_mem == NULL) ? 1U : 0U);
+    return HAL_OK;
+}
+
+void MEMMON_Update(uint32_t dt_ms)
+{
+    if (!s_sysAdded)
+    {
+        /* Created by the scheduler, from the static buffers in cmsis_os2.c */
+        const TaskHandle_t idle  = xTaskGetIdleTaskHandle();
+        const TaskHandle_t timer = xTimerGetTimerDaemonTaskHandle();
+        const int32_t lock = osKernelLock();
+        memmon_add(idle, pcTaskGetName(idle),
+                   (uint32_t)configMINIMAL_STACK_SIZE * (uint32_t)sizeof(StackType_t), 0U);
+        memmon_add(timer, pcTaskGetName(timer),
+                   (uint32_t)configTIMER_TASK_STACK_DEPTH * (uint32_t)sizeof(StackType_t), 0U);
+        s_sysAdded = 1U;
+        (void)osKernelRestoreLock(lock);
+    }
+
+    s_elapsedMs += dt_ms;
+    if (s_elapsedMs < MEMMON_PERIOD_MS)
+    {
+        return;
+    }
+    s_elapsedMs = 0U;
+
+#if MEMMON_STACKS
+    for (uint32_t i = 0U; i < s_tasks; i++)
+    {
+        MemmonTask_t *t = &s_task[i];
+        const uint32_t peak = memmon_task_peak(t);
+
+        if (!t->warned && t->size - peak < MEMMON_WARN_BYTES)
+        {
+            t->warned = 1U;
+            DLOG3(DLOG_MEM_STACK_LOW, i, t->size - peak, t->size);
+        }
+    }
+
+    const uint32_t msp = memmon_msp_peak();
+    if (!s_mspWarned && memmon_msp_size() - msp < MEMMON_WARN_BYTES)
+    {
+        s_mspWarned = 1U;
+        DLOG2(DLOG_MEM_MSP_LOW, memmon_msp_size() - msp, memmon_msp_size());
+    }
+#endif
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    const uint32_t heap_min_free = (uint32_t)xPortGetMinimumEverFreeHeapSize();
+    if (!s_heapWarned && heap_min_free < MEMMON_WARN_BYTES)
+    {
+        s_heapWarned = 1U;
+        DLOG2(DLOG_MEM_HEAP_LOW, heap_min_free, (uint32_t)configTOTAL_HEAP_SIZE);
+    }
+#endif
+}
+
+void MEMMON_GetReport(MEMMON_Report_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+
+    /* The table only grows, and entries are complete before n counts them */
+    const uint32_t n = s_tasks;
+    int32_t heap_delta = 0;     /* planned minus current heap stacks */
+
+    out->n = n;
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        const MemmonTask_t *t = &s_task[i];
+        MEMMON_Task_t *r = &out->task[i];
+
+        r->name    = t->name;
+        r->size    = t->size;
+        r->on_heap = t->on_heap;
+#if MEMMON_STACKS
+        r->peak    = memmon_task_peak(t);
+        r->plan    = memmon_plan(r->peak, MEMMON_STACK_ROUND);
+        if (r->plan < MEMMON_STACK_MIN)
+        {
+            r->plan = MEMMON_STACK_MIN;
+        }
+#else
+        r->peak    = 0U;
+        r->plan    = t->size;
+#endif
+        if (r->on_heap)
+        {
+            heap_delta += (int32_t)r->plan - (int32_t)r->size;
+        }
+    }
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    out->heap_size = (uint32_t)configTOTAL_HEAP_SIZE;
+    out->heap_free = (uint32_t)xPortGetFreeHeapSize();
+    out->heap_peak = memmon_heap_peak();
+    const int32_t heap_need = (int32_t)out->heap_peak + heap_delta;
+    out->heap_plan = memmon_plan((heap_need > 0) ? (uint32_t)heap_need : 0U, MEMMON_HEAP_ROUND);
+#else
+    (void)heap_delta;           /* static allocation profile: no heap */
+    out->heap_size = 0U;
+    out->heap_free = 0U;
+    out->heap_peak = 0U;
+    out->heap_plan = 0U;
+#endif
+
+#if MEMMON_STACKS
+    out->msp_size = memmon_msp_size();
+    out->msp_peak = memmon_msp_peak();
+    out->msp_plan = memmon_plan(out->msp_peak, MEMMON_HEAP_ROUND);
+#else
+    out->msp_size = 0U;
+    out->msp_peak = 0U;
+    out->msp_plan = 0U;
+#endif
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static MEMMON_Report_t s_rep;   /* CliTask only; too big for its stack */
+
+static void cmd_mem(const CLI_IF_Args_t *args)
+{
+    char buf[96];
+
+    (void)args;
+    MEMMON_GetReport(&s_rep);
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    snprintf(buf, sizeof(buf), "MEM: heap %lu B, in use %lu now, %lu peak\r\n",
+             (unsigned long)s_rep.heap_size,
+             (unsigned long)(s_rep.heap_size - s_rep.heap_free),
+             (unsigned long)s_rep.heap_peak);
+    CLI_IF_Print(buf);
+#else
+    snprintf(buf, sizeof(buf), "MEM: no heap (VECU_STATIC_ALLOC), %lu static tasks\r\n",
+             (unsigned long)s_rep.n);
+    CLI_IF_Print(buf);
+#endif
+#if MEMMON_STACKS
+    CLI_IF_Print("  stack            size   peak   free\r\n");
+    for (uint32_t i = 0U; i < s_rep.n; i++)
+    {
+        const MEMMON_Task_t *t = &s_rep.task[i];
+        snprintf(buf, sizeof(buf), "  %-14s  %5lu  %5lu  %5lu%s\r\n",
+                 t->name, (unsigned long)t->size, (unsigned long)t->peak,
+                 (unsigned long)(t->size - t->peak), t->on_heap ? "" : "  (static)");
+        CLI_IF_Print(buf);
+    }
+    snprintf(buf, sizeof(buf), "  %-14s  %5lu  %5lu  %5lu  (interrupts)\r\n", "MSP",
+             (unsigned long)s_rep.msp_size, (unsigned long)s_rep.msp_peak,
+             (unsigned long)(s_rep.msp_size - s_rep.msp_peak));
+    CLI_IF_Print(buf);
+#else
+    CLI_IF_Print("  stacks not measured (MEMMON_STACKS=0)\r\n");
+#endif
+}
+
+static void cmd_mem_plan(const CLI_IF_Args_t *args)
+{
+    char buf[96];
+    int32_t freed = 0;
+
+    (void)args;
+    MEMMON_GetReport(&s_rep);
+
+    snprintf(buf, sizeof(buf), "MEM PLAN: peak + %u %% (at least %u B)\r\n",
+             (unsigned)MEMMON_MARGIN_PCT, (unsigned)MEMMON_MARGIN_MIN);
+    CLI_IF_Print(buf);
+#if MEMMON_STACKS
+    for (uint32_t i = 0U; i < s_rep.n; i++)
+    {
+        const MEMMON_Task_t *t = &s_rep.task[i];
+
+        if (t->on_heap)
+        {
+            snprintf(buf, sizeof(buf), "  %-14s  .stack_size = %lu,  /* now %lu */\r\n",
+                     t->name, (unsigned long)t->plan, (unsigned long)t->size);
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf), "  %-14s  %lu words  /* static, now %lu */\r\n",
+                     t->name, (unsigned long)(t->plan / sizeof(StackType_t)),
+                     (unsigned long)(t->size / sizeof(StackType_t)));
+            freed += (int32_t)t->size - (int32_t)t->plan;
+        }
+        CLI_IF_Print(buf);
+    }
+#endif
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    snprintf(buf, sizeof(buf), "  #define configTOTAL_HEAP_SIZE ((size_t)%lu)  /* now %lu */\r\n",
+             (unsigned long)s_rep.heap_plan, (unsigned long)s_rep.heap_size);
+    CLI_IF_Print(buf);
+    freed += (int32_t)s_rep.heap_size - (int32_t)s_rep.heap_plan;
+#endif
+#if MEMMON_STACKS
+    snprintf(buf, sizeof(buf), "  _Min_Stack_Size = 0x%lX;  /* now 0x%lX */\r\n",
+             (unsigned long)s_rep.msp_plan, (unsigned long)s_rep.msp_size);
+    CLI_IF_Print(buf);
+    freed += (int32_t)s_rep.msp_size - (int32_t)s_rep.msp_plan;
+#endif
+    snprintf(buf, sizeof(buf), "  RAM freed: %ld B\r\n", (long)freed);
+    CLI_IF_Print(buf);
+}
+
+CLI_IF_CMD(mem,      "mem",      "", cmd_mem,      "show stack and heap peaks");
+CLI_IF_CMD(mem_plan, "mem plan", "", cmd_mem_plan, "recommend stack and heap sizes");
@@ -0,0 +1,173 @@
+/**
+ * @file    probe.c
+ * @brief   Hot-path latency probes: log2 histograms of cycle counts;
+ *          `probe`, `probe hist` and `probe reset`.
+ */
+
+#include "probe.h"
+
+#if PROBE_ENABLE
+
+#include "cli_if.h"
+#include <stdio.h>
+#include <string.h>
+
+PROBE_Acc_t g_probe[PROBE_COUNT];
+
+static const char *const s_probeName[PROBE_COUNT] = {
+    "veh_update", "can_tlm", "can_rx_isr", "cli_char"
+};
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+/* Upper edge of the bin that holds the pct-th percentile, capped at max */
+static uint32_t probe_percentile(const PROBE_Stats_t *s, uint32_t pct)
+{
+    /* Rank of the percentile, 1-based, rounded up */
+    const uint64_t rank = ((uint64_t)s->calls * pct + 99U) / 100U;
+    uint64_t seen = 0U;
+
+    for (uint32_t b = 0U; b < PROBE_BINS; b++)
+    {
+        seen += s->hist[b];
+        if (seen >= rank)
+        {
+            const uint32_t edge = (b < 31U) ? ((2UL << b) - 1U) : UINT32_MAX;
+            return (edge < s->max) ? edge : s->max;
+        }
+    }
+    return s->max;
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+void PROBE_Clear(PROBE_Acc_t *a)
+{
+    a->calls = 0U;
+    a->min   = 0U;
+    a->max   = 0U;
+    a->sum   = 0U;
+    (void)memset(a->hist, 0, sizeof(a->hist));
+    a->reset = 0U;
+}
+
+HAL_StatusTypeDef PROBE_GetStats(PROBE_Id_t id, PROBE_Stats_t *out)
+{
+    if ((uint32_t)id >= PROBE_COUNT || out == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    const PROBE_Acc_t *a = &g_probe[id];
+    uint32_t total = 0U;
+
+    out->name = s_probeName[id];
+    if (a->reset != 0U)
+    {
+        /* Cleared, but its writer has not run since */
+        static const PROBE_Acc_t zero = { 0 };
+        a = &zero;
+    }
+    out->min   = a->min;
+    out->max   = a->max;
+    const uint64_t sum = a->sum;
+    for (uint32_t b = 0U; b < PROBE_BINS; b++)
+    {
+        out->hist[b] = a->hist[b];
+        total += out->hist[b];
+    }
+
+    /* The writer may have run during the copy: trust the histogram */
+    out->calls = total;
+    out->mean  = (total != 0U) ? (uint32_t)(sum / total) : 0U;
+    out->p50   = probe_percentile(out, 50U);
+    out->p99   = probe_percentile(out, 99U);
+    return HAL_OK;
+}
+
+void PROBE_Reset(void)
+{
+    for (uint32_t i = 0U; i < PROBE_COUNT; i++)
+    {
+        g_probe[i].reset = 1U;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_probe(const CLI_IF_Args_t *args)
+{
+    PROBE_Stats_t st;
+    char buf[128];
+
+    (void)args;
+    CLI_IF_Print("PROBE: cycles       calls      min     mean      p50      p99      max\r\n");
+    for (uint32_t i = 0U; i < PROBE_COUNT; i++)
+    {
+        (void)PROBE_GetStats((PROBE_Id_t)i, &st);
+        snprintf(buf, sizeof(buf),
+                 "  %-12s %10lu %8lu %8lu %8lu %8lu %8lu  (max %lu us)\r\n",
+                 st.name, (unsigned long)st.calls, (unsigned long)st.min,
+                 (unsigned long)st.mean, (unsigned long)st.p50,
+                 (unsigned long)st.p99, (unsigned long)st.max,
+                 (unsigned long)CYCCNT_ToUs(st.max));
+        CLI_IF_Print(buf);
+    }
+}
+
+static void cmd_probe_hist(const CLI_IF_Args_t *args)
+{
+    PROBE_Stats_t st;
+    char buf[96];
+    uint32_t i;
+
+    for (i = 0U; i < PROBE_COUNT; i++)
+    {
+        if (strcmp(args->argv[0].s, s_probeName[i]) == 0)
+        {
+            break;
+        }
+    }
+    if (i == PROBE_COUNT)
+    {
+        CLI_IF_Print("PROBE: unknown probe (see `probe`)\r\n");
+        return;
+    }
+
+    (void)PROBE_GetStats((PROBE_Id_t)i, &st);
+    snprintf(buf, sizeof(buf), "PROBE %s: %lu calls\r\n",
+             st.name, (unsigned long)st.calls);
+    CLI_IF_Print(buf);
+    for (uint32_t b = 0U; b < PROBE_BINS; b++)
+    {
+        if (st.hist[b] == 0U)
+        {
+            continue;
+        }
+        snprintf(buf, sizeof(buf), "  %10lu .. %10lu cyc  %10lu  %3lu %%\r\n",
+                 (unsigned long)((b == 0U) ? 0U : (1UL << b)),
+                 (unsigned long)((b < 31U) ? ((2UL << b) - 1U) : UINT32_MAX),
+                 (unsigned long)st.hist[b],
+                 (unsigned long)((uint64_t)st.hist[b] * 100U / st.calls));
+        CLI_IF_Print(buf);
+    }
+}
+
+static void cmd_probe_reset(const CLI_IF_Args_t *args)
+{
+    (void)args;
+    PROBE_Reset();
+    CLI_IF_Print("PROBE: counters cleared\r\n");
+}
+
+CLI_IF_CMD(probe,       "probe",       "",       cmd_probe,       "show hot-path cycle counts (min/mean/p50/p99/max)");
+CLI_IF_CMD(probe_hist,  "probe hist",  "s:name", cmd_probe_hist,  "show the log2 histogram of one probe");
+CLI_IF_CMD(probe_reset, "probe reset", "",       cmd_probe_reset, "clear probe counters");
+
+#endif /* PROBE_ENABLE */
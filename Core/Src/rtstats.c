@@ -0,0 +1,316 @@
+/**
+ * @file    rtstats.c
+ * @brief   Run-time statistics: per-task and per-interrupt CPU time from
+ *          the DWT cycle counter, windowed and cumulative; `top`.
+ */
+
+#include "rtstats.h"
+#include "cli_if.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#if (configGENERATE_RUN_TIME_STATS != 1) || (configUSE_TRACE_FACILITY != 1)
+#error "rtstats needs configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY"
+#endif
+
+_Static_assert(configMAX_TASK_NAME_LEN <= RTSTATS_NAME_LEN, "task name length");
+
+typedef struct
+{
+    TaskHandle_t handle;
+    const char  *name;      /* in the TCB; valid while the task lives */
+    uint8_t      prio;
+    uint32_t     last;      /* kernel counter at the last sample */
+    uint32_t     win;
+    uint64_t     total;
+    uint8_t      seen;
+} RtstatsTask_t;
+
+typedef struct
+{
+    uint32_t last_calls;
+    uint32_t last_cyc;
+    uint32_t win_calls;
+    uint32_t win;
+    uint64_t total;
+} RtstatsIsr_t;
+
+static const char *const s_isrName[RTSTATS_ISRS] = {
+    "CAN1_RX0", "CAN1_RX1", "USART2", "TIM6"
+};
+
+RTSTATS_IsrAcc_t g_rtstatsIsr[RTSTATS_ISRS];
+
+static TaskStatus_t       s_status[RTSTATS_MAX_TASKS];
+static RtstatsTask_t      s_task[RTSTATS_MAX_TASKS];
+static uint32_t           s_tasks;
+static RtstatsIsr_t       s_isr[RTSTATS_ISRS];
+static uint32_t           s_lastTotal;      /* kernel total at the last sample */
+static uint32_t           s_winCyc;
+static uint64_t           s_totalCyc;
+static uint32_t           s_elapsedMs;
+static uint8_t            s_based;          /* baseline taken */
+static RTSTATS_Snapshot_t s_snap;           /* published; readers lock */
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+static uint16_t rtstats_x100(uint64_t part, uint64_t whole)
+{
+    if (whole == 0U)
+    {
+        return 0U;
+    }
+    const uint64_t v = (part * 10000U + whole / 2U) / whole;
+    return (uint16_t)((v > 10000U) ? 10000U : v);
+}
+
+static RtstatsTask_t *rtstats_find(TaskHandle_t h)
+{
+    for (uint32_t i = 0U; i < s_tasks; i++)
+    {
+        if (s_task[i].handle == h)
+        {
+            return &s_task[i];
+        }
+    }
+    return NULL;
+}
+
+/* Kernel counters -> per-task window and totals */
+static void rtstats_sample_tasks(uint32_t n)
+{
+    uint8_t known[RTSTATS_MAX_TASKS] = { 0U };
+
+    for (uint32_t i = 0U; i < s_tasks; i++)
+    {
+        s_task[i].seen = 0U;
+    }
+    for (uint32_t k = 0U; k < n; k++)
+    {
+        const TaskStatus_t *ts = &s_status[k];
+        RtstatsTask_t *t = rtstats_find(ts->xHandle);
+
+        if (t != NULL)
+        {
+            t->win    = ts->ulRunTimeCounter - t->last;
+            t->last   = ts->ulRunTimeCounter;
+            t->total += t->win;
+            t->prio   = (uint8_t)ts->uxCurrentPriority;
+            t->seen   = 1U;
+            known[k]  = 1U;
+        }
+    }
+
+    /* Drop deleted tasks, then add new ones: their time so far is not in
+       any window */
+    uint32_t j = 0U;
+    for (uint32_t i = 0U; i < s_tasks; i++)
+    {
+        if (s_task[i].seen != 0U)
+        {
+            s_task[j++] = s_task[i];
+        }
+    }
+    s_tasks = j;
+
+    for (uint32_t k = 0U; k < n; k++)
+    {
+        if (known[k] == 0U)
+        {
+            RtstatsTask_t *t = &s_task[s_tasks++];
+            t->handle = s_status[k].xHandle;
+            t->name   = s_status[k].pcTaskName;
+            t->prio   = (uint8_t)s_status[k].uxCurrentPriority;
+            t->last   = s_status[k].ulRunTimeCounter;
+            t->win    = 0U;
+            t->total  = 0U;
+            t->seen   = 1U;
+        }
+    }
+}
+
+static void rtstats_sample_isrs(void)
+{
+    for (uint32_t i = 0U; i < RTSTATS_ISRS; i++)
+    {
+        RtstatsIsr_t *s = &s_isr[i];
+        const uint32_t calls = g_rtstatsIsr[i].calls;
+        const uint32_t cyc   = g_rtstatsIsr[i].cyc;
+
+        s->win_calls  = calls - s->last_calls;
+        s->win        = cyc - s->last_cyc;
+        s->last_calls = calls;
+        s->last_cyc   = cyc;
+        s->total     += s_based ? s->win : 0U;
+    }
+}
+
+static void rtstats_publish(void)
+{
+    uint8_t  order[RTSTATS_MAX_TASKS];
+    uint32_t idle_win = 0U;
+    const TaskHandle_t idle = xTaskGetIdleTaskHandle();
+
+    /* Busiest task first (insertion sort; a dozen entries) */
+    for (uint32_t i = 0U; i < s_tasks; i++)
+    {
+        uint32_t j = i;
+        while (j > 0U && s_task[order[j - 1U]].win < s_task[i].win)
+        {
+            order[j] = order[j - 1U];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+
+    const int32_t lock = osKernelLock();
+
+    s_snap.windows++;
+    s_snap.win_cyc   = s_winCyc;
+    s_snap.total_cyc = s_totalCyc;
+    s_snap.n         = 0U;
+
+    for (uint32_t i = 0U; i < s_tasks; i++)
+    {
+        const RtstatsTask_t *t = &s_task[order[i]];
+        RTSTATS_Entry_t *e = &s_snap.e[s_snap.n++];
+
+        (void)strncpy(e->name, t->name, RTSTATS_NAME_LEN - 1U);
+        e->name[RTSTATS_NAME_LEN - 1U] = '\0';
+        e->kind       = RTSTATS_KIND_TASK;
+        e->prio       = t->prio;
+        e->win_cyc    = t->win;
+        e->total_cyc  = t->total;
+        e->win_x100   = rtstats_x100(t->win, s_winCyc);
+        e->total_x100 = rtstats_x100(t->total, s_totalCyc);
+        e->calls      = 0U;
+        e->cyc_max    = 0U;
+        if (t->handle == idle)
+        {
+            idle_win = t->win;
+        }
+    }
+
+    for (uint32_t i = 0U; i < RTSTATS_ISRS; i++)
+    {
+        const RtstatsIsr_t *s = &s_isr[i];
+        RTSTATS_Entry_t *e = &s_snap.e[s_snap.n++];
+
+        (void)strncpy(e->name, s_isrName[i], RTSTATS_NAME_LEN - 1U);
+        e->name[RTSTATS_NAME_LEN - 1U] = '\0';
+        e->kind       = RTSTATS_KIND_ISR;
+        e->prio       = 0U;
+        e->win_cyc    = s->win;
+        e->total_cyc  = s->total;
+        e->win_x100   = rtstats_x100(s->win, s_winCyc);
+        e->total_x100 = rtstats_x100(s->total, s_totalCyc);
+        e->calls      = s->win_calls;
+        e->cyc_max    = g_rtstatsIsr[i].cyc_max;
+    }
+    s_snap.load_x100 = (uint16_t)(10000U - rtstats_x100(idle_win, s_winCyc));
+
+    (void)osKernelRestoreLock(lock);
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+void RTSTATS_Update(uint32_t dt_ms)
+{
+    if (s_based)
+    {
+        s_elapsedMs += dt_ms;
+        if (s_elapsedMs < RTSTATS_WINDOW_MS)
+        {
+            return;
+        }
+        s_elapsedMs = 0U;
+    }
+
+    uint32_t total = 0U;
+    const uint32_t n = (uint32_t)uxTaskGetSystemState(s_status, RTSTATS_MAX_TASKS, &total);
+
+    s_winCyc     = total - s_lastTotal;
+    s_lastTotal  = total;
+    s_totalCyc  += s_based ? s_winCyc : 0U;
+    rtstats_sample_tasks(n);
+    rtstats_sample_isrs();
+
+    if (!s_based)
+    {
+        s_based = 1U;
+        return;
+    }
+    rtstats_publish();
+}
+
+void RTSTATS_GetSnapshot(RTSTATS_Snapshot_t *out)
+{
+    if (out != NULL)
+    {
+        const int32_t lock = osKernelLock();
+        *out = s_snap;
+        (void)osKernelRestoreLock(lock);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_top(const CLI_IF_Args_t *args)
+{
+    static RTSTATS_Snapshot_t snap;     /* CliTask only; too big for its stack */
+    char buf[128];
+
+    (void)args;
+    RTSTATS_GetSnapshot(&snap);
+    if (snap.windows == 0U)
+    {
+        CLI_IF_Print("TOP: no window yet\r\n");
+        return;
+    }
+
+    snprintf(buf, sizeof(buf),
+             "TOP: %lu ms window, CPU load %u.%02u %%, %lu s of data\r\n",
+             (unsigned long)RTSTATS_WINDOW_MS,
+             (unsigned)(snap.load_x100 / 100U), (unsigned)(snap.load_x100 % 100U),
+             (unsigned long)(snap.windows * RTSTATS_WINDOW_MS / 1000U));
+    CLI_IF_Print(buf);
+    CLI_IF_Print("  name              prio   win %  total %     win cyc\r\n");
+
+    for (uint32_t i = 0U; i < snap.n; i++)
+    {
+        const RTSTATS_Entry_t *e = &snap.e[i];
+
+        if (e->kind == RTSTATS_KIND_TASK)
+        {
+            snprintf(buf, sizeof(buf),
+                     "  %-16s  %4u  %3u.%02u   %3u.%02u  %10lu\r\n",
+                     e->name, (unsigned)e->prio,
+                     (unsigned)(e->win_x100 / 100U), (unsigned)(e->win_x100 % 100U),
+                     (unsigned)(e->total_x100 / 100U), (unsigned)(e->total_x100 % 100U),
+                     (unsigned long)e->win_cyc);
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf),
+                     "  isr %-12s     -  %3u.%02u   %3u.%02u  %10lu"
+                     "  calls=%lu max=%lu cyc\r\n",
+                     e->name,
+                     (unsigned)(e->win_x100 / 100U), (unsigned)(e->win_x100 % 100U),
+                     (unsigned)(e->total_x100 / 100U), (unsigned)(e->total_x100 % 100U),
+                     (unsigned long)e->win_cyc, (unsigned long)e->calls,
+                     (unsigned long)e->cyc_max);
+        }
+        CLI_IF_Print(buf);
+    }
+}
+
+CLI_IF_CMD(top, "top", "", cmd_top, "show CPU time per task and interrupt");
@@ -0,0 +1,377 @@
+/**
+ * @file    sched_tt.c
+ * @brief   Time-triggered scheduler: TIM6 1 ms tick and a cyclic executive
+ *          over a static table of 1 / 10 / 100 ms slots.
+ *
+ * The table is expanded at init into one bitmask of due slots per frame of
+ * the schedule cycle, so a frame costs a table lookup and a loop over its
+ * own slots. Gated slots are left out of the frames the timer wakes the
+ * task for unless their ready() hook reports work. Statistics are written
+ * only by the scheduler task; `sched` reads them from CliTask without a
+ * lock, so a line may mix two frames.
+ */
+
+#include "sched_tt.h"
+#include "cyccnt.h"
+#include "cli_if.h"
+#include "dlog.h"
+#include "cmsis_os.h"
+#include <stdio.h>
+
+_Static_assert(SCHED_MAX_SLOTS <= 32U, "one due bit per slot");
+
+static const uint32_t s_periodMs[SCHED_RATES] = { 1U, 10U, 100U };
+
+static const SCHED_Slot_t   *s_table;
+static uint32_t              s_n;
+static uint32_t              s_due[SCHED_HYPER_MS];   /* bit i: slot i due */
+static uint32_t              s_last[SCHED_MAX_SLOTS]; /* frame of last run */
+static uint32_t              s_begun;                 /* bit i: has run    */
+static uint32_t              s_gated;                 /* bit i: has ready() */
+static SCHED_SlotStats_t     s_slot[SCHED_MAX_SLOTS];
+static SCHED_Stats_t         s_stats;
+static volatile uint32_t     s_ticks;
+static uint32_t              s_frame;                 /* last frame handled */
+static volatile uint8_t      s_resetReq;
+static volatile osThreadId_t s_thread = NULL;
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+/* TIM6 counts at 1 MHz and updates every SCHED_TICK_MS */
+static void sched_timer_start(void)
+{
+    uint32_t timclk = HAL_RCC_GetPCLK1Freq();
+
+    /* APB1 timers run at twice PCLK1 when the bus is divided */
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+    {
+        timclk *= 2U;
+    }
+
+    __HAL_RCC_TIM6_CLK_ENABLE();
+    TIM6->CR1  = 0U;
+    TIM6->PSC  = timclk / 1000000U - 1U;
+    TIM6->ARR  = 1000U * SCHED_TICK_MS - 1U;
+    TIM6->CNT  = 0U;
+    TIM6->EGR  = TIM_EGR_UG;        /* load PSC now, not at the first wrap */
+    TIM6->SR   = 0U;
+    TIM6->DIER = TIM_DIER_UIE;
+
+    HAL_NVIC_SetPriority(TIM6_DAC_IRQn, SCHED_TIM_IRQ_PRIO, 0U);
+    HAL_NVIC_EnableIRQ(TIM6_DAC_IRQn);
+    TIM6->CR1  = TIM_CR1_CEN;
+}
+
+static void sched_clear(void)
+{
+    const SCHED_Stats_t zero = { 0 };
+
+    for (uint32_t i = 0U; i < s_n; i++)
+    {
+        const SCHED_SlotStats_t z = { 0 };
+        s_slot[i] = z;
+    }
+    s_stats = zero;
+}
+
+/* Slots released in frame idx: the due ones, less gated ones with no work */
+static uint32_t sched_released(uint32_t idx)
+{
+    uint32_t due   = s_due[idx];
+    uint32_t gated = due & s_gated;
+
+    while (gated != 0U)
+    {
+        const uint32_t i = (uint32_t)__builtin_ctz(gated);
+
+        gated &= gated - 1U;
+        if (s_table[i].ready() == 0U)
+        {
+            due &= ~(1UL << i);
+        }
+    }
+    return due;
+}
+
+/* Frame f was not run: count its ungated releases as skipped */
+static void sched_skip(uint32_t f)
+{
+    const uint32_t due = s_due[f % SCHED_HYPER_MS] & ~s_gated;
+
+    if (due == 0U)
+    {
+        return;   /* nothing was due: the task was not woken for it */
+    }
+    for (uint32_t i = 0U; i < s_n; i++)
+    {
+        if ((due & (1UL << i)) != 0U)
+        {
+            SCHED_RateStats_t *r = &s_stats.rate[s_table[i].rate];
+            s_slot[i].skipped++;
+            r->releases++;
+            r->skipped++;
+        }
+    }
+    s_stats.frames_skipped++;
+}
+
+static void sched_run_slot(uint32_t i, uint32_t f)
+{
+    const SCHED_Slot_t *sl     = &s_table[i];
+    const uint32_t      period = s_periodMs[sl->rate];
+    SCHED_SlotStats_t  *st     = &s_slot[i];
+    SCHED_RateStats_t  *r      = &s_stats.rate[sl->rate];
+    const uint32_t      bit    = 1UL << i;
+
+    /* dt: frames since the previous run; one period for the first */
+    const uint32_t dt = ((s_begun & bit) != 0U) ? (f - s_last[i]) : period;
+    s_begun  |= bit;
+    s_last[i] = f;
+
+    const uint32_t c0 = CYCCNT_Read();
+    sl->job(dt * SCHED_TICK_MS);
+    const uint32_t cyc = CYCCNT_Read() - c0;
+
+    st->runs++;
+    st->cyc_last = cyc;
+    st->cyc_sum += cyc;
+    if (cyc > st->cyc_max)
+    {
+        st->cyc_max = cyc;
+    }
+    r->releases++;
+
+    /* Deadline: the slot's next release */
+    if ((s_ticks - f) >= period)
+    {
+        r->overruns++;
+        DLOG3(DLOG_SCHED_OVERRUN, f, i, CYCCNT_ToUs(cyc));
+    }
+}
+
+static void sched_frame(uint32_t f)
+{
+    const uint32_t idx = f % SCHED_HYPER_MS;
+    const uint32_t due = sched_released(idx);
+
+    if (due == 0U)
+    {
+        return;
+    }
+    const uint32_t c0  = CYCCNT_Read();
+
+    for (uint32_t i = 0U; i < s_n; i++)
+    {
+        if ((due & (1UL << i)) != 0U)
+        {
+            sched_run_slot(i, f);
+        }
+    }
+
+    const uint32_t cyc = CYCCNT_Read() - c0;
+    if (cyc > s_stats.frame_cyc_max)
+    {
+        s_stats.frame_cyc_max = cyc;
+        s_stats.frame_max_at  = (uint8_t)idx;
+    }
+    s_stats.frames++;
+    if (s_ticks != f)
+    {
+        s_stats.frames_late++;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef SCHED_Init(const SCHED_Slot_t *table, uint32_t n)
+{
+    if (table == NULL || n == 0U || n > SCHED_MAX_SLOTS)
+    {
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        if (table[i].job == NULL || table[i].rate >= SCHED_RATES ||
+            table[i].offset_ms >= s_periodMs[table[i].rate])
+        {
+            return HAL_ERROR;
+        }
+    }
+
+    s_table = table;
+    s_n     = n;
+    s_begun = 0U;
+    s_gated = 0U;
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        if (table[i].ready != NULL)
+        {
+            s_gated |= 1UL << i;
+        }
+    }
+    for (uint32_t t = 0U; t < SCHED_HYPER_MS; t++)
+    {
+        s_due[t] = 0U;
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            if ((t % s_periodMs[table[i].rate]) == table[i].offset_ms)
+            {
+                s_due[t] |= 1UL << i;
+            }
+        }
+    }
+    sched_clear();
+    return HAL_OK;
+}
+
+void SCHED_Run(void)
+{
+    s_thread = osThreadGetId();
+    s_frame  = s_ticks;
+    sched_timer_start();
+
+    for (;;)
+    {
+        (void)osThreadFlagsWait(SCHED_FLAG_TICK, osFlagsWaitAny, osWaitForever);
+
+        if (s_resetReq != 0U)
+        {
+            sched_clear();
+            s_resetReq = 0U;
+        }
+
+        const uint32_t now = s_ticks;
+        if (now == s_frame)
+        {
+            continue;
+        }
+
+        /* Behind by more than one frame: drop all but the newest */
+        while ((now - s_frame) > 1U)
+        {
+            s_frame++;
+            sched_skip(s_frame);
+        }
+        s_frame = now;
+        sched_frame(now);
+    }
+}
+
+void SCHED_TimerIRQHandler(void)
+{
+    if ((TIM6->SR & TIM_SR_UIF) == 0U)
+    {
+        return;
+    }
+    TIM6->SR = ~(uint32_t)TIM_SR_UIF; /* rc_w0: write 0 to clear */
+
+    const uint32_t t = s_ticks + 1U;
+
+    s_ticks = t;
+    if (s_thread != NULL && sched_released(t % SCHED_HYPER_MS) != 0U)
+    {
+        (void)osThreadFlagsSet(s_thread, SCHED_FLAG_TICK);
+    }
+}
+
+uint32_t SCHED_PeriodMs(uint32_t rate)
+{
+    return (rate < SCHED_RATES) ? s_periodMs[rate] : 0U;
+}
+
+void SCHED_GetStats(SCHED_Stats_t *out)
+{
+    if (out != NULL)
+    {
+        *out       = s_stats;
+        out->ticks = s_ticks;
+    }
+}
+
+HAL_StatusTypeDef SCHED_GetSlot(uint32_t i, const SCHED_Slot_t **slot,
+                                SCHED_SlotStats_t *stats)
+{
+    if (i >= s_n)
+    {
+        return HAL_ERROR;
+    }
+    if (slot != NULL)
+    {
+        *slot = &s_table[i];
+    }
+    if (stats != NULL)
+    {
+        *stats = s_slot[i];
+    }
+    return HAL_OK;
+}
+
+void SCHED_ResetStats(void)
+{
+    /* Cleared by the scheduler task at its next frame */
+    s_resetReq = 1U;
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_sched(const CLI_IF_Args_t *args)
+{
+    char buf[160];
+    SCHED_Stats_t st;
+
+    (void)args;
+    SCHED_GetStats(&st);
+    snprintf(buf, sizeof(buf),
+             "SCHED: ticks=%lu frames=%lu skipped=%lu late=%lu"
+             " busiest=frame %u %lu us\r\n",
+             (unsigned long)st.ticks, (unsigned long)st.frames,
+             (unsigned long)st.frames_skipped, (unsigned long)st.frames_late,
+             (unsigned)st.frame_max_at,
+             (unsigned long)CYCCNT_ToUs(st.frame_cyc_max));
+    CLI_IF_Print(buf);
+
+    for (uint32_t r = 0U; r < SCHED_RATES; r++)
+    {
+        snprintf(buf, sizeof(buf),
+                 "  %3lu ms: releases=%lu overruns=%lu skipped=%lu\r\n",
+                 (unsigned long)s_periodMs[r],
+                 (unsigned long)st.rate[r].releases,
+                 (unsigned long)st.rate[r].overruns,
+                 (unsigned long)st.rate[r].skipped);
+        CLI_IF_Print(buf);
+    }
+
+    for (uint32_t i = 0U; i < s_n; i++)
+    {
+        const SCHED_Slot_t *sl;
+        SCHED_SlotStats_t   ss;
+
+        (void)SCHED_GetSlot(i, &sl, &ss);
+        const uint32_t mean = (ss.runs != 0U) ? (uint32_t)(ss.cyc_sum / ss.runs) : 0U;
+        snprintf(buf, sizeof(buf),
+                 "  %-10s %3lu ms +%-2u runs=%lu skipped=%lu"
+                 " cyc last=%lu mean=%lu max=%lu (max %lu us)\r\n",
+                 sl->name, (unsigned long)s_periodMs[sl->rate],
+                 (unsigned)sl->offset_ms, (unsigned long)ss.runs,
+                 (unsigned long)ss.skipped, (unsigned long)ss.cyc_last,
+                 (unsigned long)mean, (unsigned long)ss.cyc_max,
+                 (unsigned long)CYCCNT_ToUs(ss.cyc_max));
+        CLI_IF_Print(buf);
+    }
+}
+
+static void cmd_sched_reset(const CLI_IF_Args_t *args)
+{
+    (void)args;
+    SCHED_ResetStats();
+    CLI_IF_Print("SCHED: counters cleared\r\n");
+}
+
+CLI_IF_CMD(sched,       "sched",       "", cmd_sched,       "show schedule, overruns and job times");
+CLI_IF_CMD(sched_reset, "sched reset", "", cmd_sched_reset, "clear scheduler counters");
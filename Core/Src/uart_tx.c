@@ -0,0 +1,300 @@
+/**
+ * @file    uart_tx.c
+ * @brief   Non-blocking console output: byte ring drained by UART TX DMA.
+ *
+ * Producers append under a short interrupt mask (index update + memcpy of
+ * one message); the DMA engine sends the oldest contiguous chunk and the
+ * TX complete callback starts the next one. At 115200 baud a 60-byte log
+ * line used to cost the caller ~5 ms of busy-waiting; now it costs the
+ * copy.
+ */
+
+#include "uart_tx.h"
+#include "cyccnt.h"
+#include "cli_if.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+#include <stdio.h>
+
+#if (UART_TX_RING_LEN & (UART_TX_RING_LEN - 1U)) != 0U
+#error "UART_TX_RING_LEN must be a power of two"
+#endif
+
+#define UART_TX_MASK   (UART_TX_RING_LEN - 1U)
+
+static UART_HandleTypeDef *s_uart;
+static UART_TX_Policy_t    s_policy = UART_TX_DROP_MSG;
+static UART_TX_Stats_t     s_stats;
+
+#if UART_TX_DMA
+static uint8_t  s_ring[UART_TX_RING_LEN];
+static uint32_t s_head;      /* next byte written by a producer      */
+static uint32_t s_tail;      /* first byte not yet confirmed sent    */
+static uint32_t s_dmaLen;    /* bytes from s_tail handed to the DMA  */
+#endif
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+#if UART_TX_DMA
+/* Start the next DMA chunk if the UART is idle; interrupts masked */
+static void uart_tx_kick(void)
+{
+    if (s_dmaLen != 0U || s_head == s_tail || s_uart == NULL)
+    {
+        return;
+    }
+
+    const uint32_t off = s_tail & UART_TX_MASK;
+    uint32_t len = s_head - s_tail;
+
+    /* One contiguous chunk; the wrapped part follows from the callback */
+    if (off + len > UART_TX_RING_LEN)
+    {
+        len = UART_TX_RING_LEN - off;
+    }
+    if (len > 0xFFFFU)
+    {
+        len = 0xFFFFU;
+    }
+
+    if (HAL_UART_Transmit_DMA(s_uart, &s_ring[off], (uint16_t)len) == HAL_OK)
+    {
+        s_dmaLen = len;
+        s_stats.dma_starts++;
+    }
+}
+#endif
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef UART_TX_Init(UART_HandleTypeDef *huart)
+{
+    if (huart == NULL)
+    {
+        return HAL_ERROR;
+    }
+#if UART_TX_DMA
+    if (huart->hdmatx == NULL)
+    {
+        return HAL_ERROR;
+    }
+    s_head   = 0U;
+    s_tail   = 0U;
+    s_dmaLen = 0U;
+#endif
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_uart = huart;
+    return HAL_OK;
+}
+
+uint32_t UART_TX_Write(const void *data, uint32_t len)
+{
+    const uint32_t t0 = CYCCNT_Read();
+    uint32_t n = len;
+
+    if (s_uart == NULL || data == NULL || len == 0U)
+    {
+        return 0U;
+    }
+
+#if UART_TX_DMA
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+
+    const uint32_t space = UART_TX_RING_LEN - (s_head - s_tail);
+    if (n > space)
+    {
+        n = (s_policy == UART_TX_TRUNCATE) ? space : 0U;
+        s_stats.dropped_msgs++;
+        s_stats.dropped_bytes += len - n;
+    }
+
+    /* Copy in at most two pieces (around the wrap) */
+    const uint32_t off   = s_head & UART_TX_MASK;
+    const uint32_t first = (n < UART_TX_RING_LEN - off) ? n : (UART_TX_RING_LEN - off);
+    memcpy(&s_ring[off], data, first);
+    memcpy(&s_ring[0], (const uint8_t *)data + first, n - first);
+    s_head += n;
+
+    if (s_head - s_tail > s_stats.high_water)
+    {
+        s_stats.high_water = s_head - s_tail;
+    }
+    uart_tx_kick();
+
+    const uint32_t cyc = CYCCNT_Read() - t0;
+    s_stats.writes++;
+    s_stats.bytes += n;
+    s_stats.write_cyc_sum += cyc;
+    if (cyc > s_stats.write_cyc_max)
+    {
+        s_stats.write_cyc_max = cyc;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+#else
+    /* Former path: busy-wait until the last byte is in the shift register */
+    if (HAL_UART_Transmit(s_uart, (const uint8_t *)data, (uint16_t)len, HAL_MAX_DELAY) != HAL_OK)
+    {
+        n = 0U;
+    }
+
+    const uint32_t cyc = CYCCNT_Read() - t0;
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+    s_stats.writes++;
+    s_stats.bytes += n;
+    if (n != len)
+    {
+        s_stats.dropped_msgs++;
+        s_stats.dropped_bytes += len - n;
+    }
+    s_stats.write_cyc_sum += cyc;
+    if (cyc > s_stats.write_cyc_max)
+    {
+        s_stats.write_cyc_max = cyc;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+#endif
+
+    return n;
+}
+
+uint32_t UART_TX_Print(const char *s)
+{
+    return (s != NULL) ? UART_TX_Write(s, (uint32_t)strlen(s)) : 0U;
+}
+
+uint32_t UART_TX_Free(void)
+{
+#if UART_TX_DMA
+    return UART_TX_RING_LEN - (s_head - s_tail);
+#else
+    return UINT32_MAX;
+#endif
+}
+
+void UART_TX_SetPolicy(UART_TX_Policy_t policy)
+{
+    s_policy = policy;
+}
+
+void UART_TX_GetStats(UART_TX_Stats_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+    *out = s_stats;
+#if UART_TX_DMA
+    out->pending = s_head - s_tail;
+#endif
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+}
+
+void UART_TX_Flush(void)
+{
+#if UART_TX_DMA
+    if (s_uart == NULL)
+    {
+        return;
+    }
+
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+
+    if (s_dmaLen != 0U)
+    {
+        /* Whatever the DMA has not fetched yet is sent below */
+        (void)HAL_UART_AbortTransmit(s_uart);
+        s_tail  += s_dmaLen - __HAL_DMA_GET_COUNTER(s_uart->hdmatx);
+        s_dmaLen = 0U;
+    }
+    while (s_head != s_tail)
+    {
+        const uint32_t off = s_tail & UART_TX_MASK;
+        uint32_t len = s_head - s_tail;
+        if (off + len > UART_TX_RING_LEN)
+        {
+            len = UART_TX_RING_LEN - off;
+        }
+        (void)HAL_UART_Transmit(s_uart, &s_ring[off], (uint16_t)len, HAL_MAX_DELAY);
+        s_tail += len;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+#endif
+}
+
+/* --------------------------------------------------------------------------
+ * HAL callbacks (USART TC interrupt after the DMA transfer, DMA error)
+ * -------------------------------------------------------------------------- */
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+#if UART_TX_DMA
+    if (huart != s_uart)
+    {
+        return;
+    }
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+    s_tail  += s_dmaLen;
+    s_dmaLen = 0U;
+    uart_tx_kick();
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+#else
+    (void)huart;
+#endif
+}
+
+void UART_TX_ErrorCallback(UART_HandleTypeDef *huart)
+{
+#if UART_TX_DMA
+    if (huart != s_uart)
+    {
+        return;
+    }
+    UBaseType_t irq = taskENTER_CRITICAL_FROM_ISR();
+    /* A transfer error stops the stream and the HAL ends the transmission
+       (gState READY) without a TX complete. A FIFO error alone leaves the
+       stream running, and its TX complete still follows. */
+    if (s_dmaLen != 0U && huart->gState == HAL_UART_STATE_READY &&
+        HAL_DMA_GetState(huart->hdmatx) != HAL_DMA_STATE_BUSY)
+    {
+        /* As UART_TX_Flush(): what the DMA fetched counts as sent */
+        s_tail  += s_dmaLen - __HAL_DMA_GET_COUNTER(huart->hdmatx);
+        s_dmaLen = 0U;
+        s_stats.tx_errors++;
+        uart_tx_kick();
+    }
+    taskEXIT_CRITICAL_FROM_ISR(irq);
+#else
+    (void)huart;
+#endif
+}
+
+/* --------------------------------------------------------------------------
+ * CLI commands
+ * -------------------------------------------------------------------------- */
+
+static void cmd_uart_stats(const CLI_IF_Args_t *args)
+{
+    char buf[160];
+    UART_TX_Stats_t st;
+
+    (void)args;
+    UART_TX_GetStats(&st);
+    snprintf(buf, sizeof(buf),
+             "UART TX: writes=%lu bytes=%lu dropped=%lu/%lu B dma=%lu err=%lu"
+             " hw=%lu B pending=%lu B\r\n",
+             (unsigned long)st.writes, (unsigned long)st.bytes,
+             (unsigned long)st.dropped_msgs, (unsigned long)st.dropped_bytes,
+             (unsigned long)st.dma_starts, (unsigned long)st.tx_errors,
+             (unsigned long)st.high_water, (unsigned long)st.pending);
+    CLI_IF_Print(buf);
+}
+
+CLI_IF_CMD(uart_stats, "uart stats", "", cmd_uart_stats, "show console TX counters");
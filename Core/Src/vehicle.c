@@ -6,6 +6,22 @@
 #include "vehicle.h"
 #include <stddef.h>
 
+#if VEHICLE_DYNAMICS
+#include "vehicle_lut.h"
+
+/* Target-speed controller: demanded acceleration in km/h/s */
+#define VEHICLE_DYN_KP           1.0f    /* per km/h of speed error           */
+#define VEHICLE_DYN_KI           0.2f    /* per km/h of error per second      */
+#define VEHICLE_DYN_INT_MAX      3.0f    /* integrator clamp                  */
+#define VEHICLE_DYN_ACCEL_MAX   10.0f    /* about 2.8 m/s^2                   */
+#define VEHICLE_DYN_BRAKE_MAX   15.0f    /* about 4.2 m/s^2                   */
+#define VEHICLE_DYN_STOP_KPH     0.1f    /* below this with target 0: held    */
+
+/* Gearbox: no further shift this long after one (the load, and with it
+   the shift points, jumps with the ratio) */
+#define VEHICLE_DYN_SHIFT_HOLD_S 1.0f
+#endif
+
 static float clamp_f(float v, float min, float max)
 {
     if (v < min) return min;
@@ -13,60 +29,342 @@ static float clamp_f(float v, float min, float max)
     return v;
 }
 
-void Vehicle_Init(VehicleState_t *vs)
-{
-    if (vs == NULL) return;
-
-    vs->speed_kph      = 0.0f;
-    vs->engine_rpm     = 800;    /* idle */
-    vs->coolant_temp_c = 30.0f;  /* “cold” engine */
-}
-
-void Vehicle_Update(VehicleState_t *vs, float dt_s)
+/*
+ * One model step on plain values. Shared by Vehicle_Update() and
+ * Vehicle_UpdateBatch() so both produce bit-identical results.
+ */
+static inline void vehicle_step(float *speed_kph,
+                                uint16_t *engine_rpm,
+                                float *coolant_temp_c,
+                                float dt_s)
 {
-    if (vs == NULL) return;
-    if (dt_s <= 0.0f) return;
+    float speed = *speed_kph;
+    float temp  = *coolant_temp_c;
+    uint16_t rpm;
 
     /* Super simple “physics” just so things move a bit */
 
     /* Let speed slowly decay if > 0 (friction) */
-    if (vs->speed_kph > 0.1f)
+    if (speed > 0.1f)
     {
-        vs->speed_kph -= 1.0f * dt_s;   /* 1 km/h per second */
-        if (vs->speed_kph < 0.0f)
+        speed -= 1.0f * dt_s;   /* 1 km/h per second */
+        if (speed < 0.0f)
         {
-            vs->speed_kph = 0.0f;
+            speed = 0.0f;
         }
     }
 
     /* RPM loosely tied to speed (fake gear)
        idle at 800, add ~50 RPM per km/h
     */
-    float target_rpm = 800.0f + vs->speed_kph * 50.0f;
-    float rpm_f      = (float)vs->engine_rpm;
+    float target_rpm = 800.0f + speed * 50.0f;
+    float rpm_f      = (float)*engine_rpm;
 
     /* Simple first-order lag towards target */
     rpm_f += (target_rpm - rpm_f) * 0.5f * dt_s;
-    vs->engine_rpm = (uint16_t)clamp_f(rpm_f, 600.0f, 6000.0f);
+    rpm = (uint16_t)clamp_f(rpm_f, 600.0f, 6000.0f);
 
     /* Coolant temp: warm up slowly toward 90°C, cool slightly when stopped */
-    if (vs->speed_kph > 1.0f || vs->engine_rpm > 1500)
+    if (speed > 1.0f || rpm > 1500)
     {
-        vs->coolant_temp_c += 2.0f * dt_s;   /* warm up */
+        temp += 2.0f * dt_s;   /* warm up */
     }
     else
     {
-        vs->coolant_temp_c -= 0.2f * dt_s;   /* cool a bit */
+        temp -= 0.2f * dt_s;   /* cool a bit */
     }
-    vs->coolant_temp_c = clamp_f(vs->coolant_temp_c, 20.0f, 110.0f);
+
+    *speed_kph      = speed;
+    *engine_rpm     = rpm;
+    *coolant_temp_c = clamp_f(temp, 20.0f, 110.0f);
+}
+
+void Vehicle_InitBatch(const VehicleFleet_t *fleet)
+{
+    if (fleet == NULL) return;
+
+    for (uint32_t i = 0; i < fleet->count; i++)
+    {
+        fleet->speed_kph[i]      = 0.0f;
+        fleet->engine_rpm[i]     = 800;
+        fleet->coolant_temp_c[i] = 30.0f;
+    }
+}
+
+void Vehicle_UpdateBatch(const VehicleFleet_t *fleet, float dt_s)
+{
+    if (fleet == NULL) return;
+    if (dt_s <= 0.0f) return;
+
+    float    *restrict speed = fleet->speed_kph;
+    uint16_t *restrict rpm   = fleet->engine_rpm;
+    float    *restrict temp  = fleet->coolant_temp_c;
+
+    for (uint32_t i = 0; i < fleet->count; i++)
+    {
+        vehicle_step(&speed[i], &rpm[i], &temp[i], dt_s);
+    }
+}
+
+#if VEHICLE_FIXED_POINT
+
+/*
+ * Q16.16 build: VehicleState_t is VehicleStateQ16_t and the per-vehicle API
+ * forwards to vehicle_q16.c. Float arguments are converted once at the API
+ * boundary (round to nearest, saturated).
+ */
+static q16_16_t q16_from_f(float v)
+{
+    if (v >  32767.0f) v =  32767.0f;
+    if (v < -32768.0f) v = -32768.0f;
+    return (q16_16_t)(v * 65536.0f + ((v >= 0.0f) ? 0.5f : -0.5f));
+}
+
+void Vehicle_Init(VehicleState_t *vs)
+{
+    VehicleQ16_Init(vs);
+}
+
+void Vehicle_Update(VehicleState_t *vs, float dt_s)
+{
+    if (dt_s <= 0.0f) return;
+
+    VehicleQ16_Update(vs, q16_from_f(dt_s));
+}
+
+void Vehicle_UpdateMs(VehicleState_t *vs, uint32_t dt_ms)
+{
+    VehicleQ16_Update(vs, VEHICLE_Q16_FROM_MS(dt_ms));
 }
 
 void Vehicle_SetTargetSpeed(VehicleState_t *vs, float target_speed_kph)
+{
+    VehicleQ16_SetTargetSpeed(vs, q16_from_f(target_speed_kph));
+}
+
+void Vehicle_Force(VehicleState_t *vs,
+                   float speed_kph,
+                   uint16_t rpm,
+                   float temp_c)
+{
+    VehicleQ16_Force(vs, q16_from_f(speed_kph), rpm, q16_from_f(temp_c));
+}
+
+float Vehicle_GetSpeedKph(const VehicleState_t *vs)
+{
+    return (float)vs->speed_kph / 65536.0f;
+}
+
+float Vehicle_GetCoolantC(const VehicleState_t *vs)
+{
+    return (float)vs->coolant_temp_c / 65536.0f;
+}
+
+int32_t Vehicle_GetSpeedKph10(const VehicleState_t *vs)
+{
+    return VehicleQ16_ToTenths(vs->speed_kph);
+}
+
+int32_t Vehicle_GetCoolantC10(const VehicleState_t *vs)
+{
+    return VehicleQ16_ToTenths(vs->coolant_temp_c);
+}
+
+uint8_t Vehicle_GetGear(const VehicleState_t *vs)
+{
+    (void)vs;
+    return 0U;
+}
+
+float Vehicle_GetTargetKph(const VehicleState_t *vs)
+{
+    return Vehicle_GetSpeedKph(vs);
+}
+
+uint8_t Vehicle_GetLoadPct(const VehicleState_t *vs)
+{
+    (void)vs;
+    return 0U;
+}
+
+#else /* float build */
+
+#if VEHICLE_DYNAMICS
+
+/* Lowest gear that would not upshift at light load at this speed */
+static uint8_t vehicle_gear_for(float speed_kph)
+{
+    uint8_t g = 0U;
+
+    while (g + 1U < VEHICLE_LUT_GEARS && speed_kph >= VEHICLE_LUT_UP_KPH[g])
+    {
+        g++;
+    }
+    return (uint8_t)(g + 1U);
+}
+
+/*
+ * One step of the longitudinal model: three axis searches (speed, RPM,
+ * coolant) shared by five maps, at most one gear change. The RPM and
+ * coolant searches start from the vehicle's own hints.
+ */
+static void vehicle_dyn_step(VehicleState_t *vs, float dt_s)
+{
+    const float    speed = vs->speed_kph;
+    const float    temp  = vs->coolant_temp_c;
+    const uint32_t g     = (uint32_t)vs->gear - 1U;
+    int8_t         sat   = 0;     /* +1 / -1: demand limited high / low */
+
+    const VehicleMapPos_t at_speed = VehicleMap_Find(&VEHICLE_LUT_SPEED_AXIS, speed, NULL);
+    const float resist = VehicleMap_At1D(VEHICLE_LUT_RESIST, at_speed);
+
+    /* PI controller on speed error: net acceleration the driver asks for */
+    const float err = vs->target_kph - speed;
+    float accel = VEHICLE_DYN_KP * err + vs->pi_int;
+    if (accel > VEHICLE_DYN_ACCEL_MAX)
+    {
+        accel = VEHICLE_DYN_ACCEL_MAX;
+        sat   = 1;
+    }
+    else if (accel < -VEHICLE_DYN_BRAKE_MAX)
+    {
+        accel = -VEHICLE_DYN_BRAKE_MAX;
+        sat   = -1;
+    }
+
+    /* Engine speed from the wheels; the clutch slips below idle */
+    float rpm = speed * VEHICLE_LUT_RPM_PER_KPH[g];
+    rpm = clamp_f(rpm, VEHICLE_LUT_IDLE_RPM, VEHICLE_LUT_LIMIT_RPM);
+
+    /* Tractive demand = wanted acceleration + resistance fed forward.
+       Positive: engine torque, limited by the full-load curve in this
+       gear. Negative: wheel brakes. */
+    const VehicleMapPos_t at_rpm = VehicleMap_Find(&VEHICLE_LUT_RPM_AXIS, rpm, &vs->hint_rpm);
+    const float torque_max = VehicleMap_At1D(VEHICLE_LUT_TORQUE, at_rpm);
+    const float drive_max  = torque_max * VEHICLE_LUT_ACCEL_PER_NM[g];
+    float drive = accel + resist;
+    float load  = 0.0f;
+    if (drive > drive_max)
+    {
+        drive = drive_max;
+        sat   = 1;
+    }
+    if (drive > 0.0f)
+    {
+        load = drive / drive_max;
+    }
+
+    /* Integrate unless that would push further into a limit (anti-windup) */
+    if (!((sat > 0 && err > 0.0f) || (sat < 0 && err < 0.0f)))
+    {
+        vs->pi_int = clamp_f(vs->pi_int + VEHICLE_DYN_KI * err * dt_s,
+                             -VEHICLE_DYN_INT_MAX, VEHICLE_DYN_INT_MAX);
+    }
+
+    const float net = drive - resist;
+    float speed_new = speed + net * dt_s;
+    if (speed_new < VEHICLE_DYN_STOP_KPH && vs->target_kph < VEHICLE_DYN_STOP_KPH)
+    {
+        speed_new  = 0.0f;     /* stopped: brakes hold, controller at rest */
+        vs->pi_int = 0.0f;
+    }
+    else if (speed_new < 0.0f)
+    {
+        speed_new = 0.0f;
+    }
+
+    /* Gear: shift points move from the light- to the full-load schedule */
+    const float up   = VEHICLE_LUT_UP_KPH[g] +
+                       (VEHICLE_LUT_UP_FULL_KPH[g] - VEHICLE_LUT_UP_KPH[g]) * load;
+    const float down = VEHICLE_LUT_DOWN_KPH[g] +
+                       (VEHICLE_LUT_DOWN_FULL_KPH[g] - VEHICLE_LUT_DOWN_KPH[g]) * load;
+    uint32_t gear = g;
+    if (vs->shift_hold_s > 0.0f)
+    {
+        vs->shift_hold_s -= dt_s;
+    }
+    else if (gear + 1U < VEHICLE_LUT_GEARS && speed_new > up)
+    {
+        gear++;
+    }
+    else if (gear > 0U && speed_new < down)
+    {
+        gear--;
+    }
+    if (gear != g)
+    {
+        vs->shift_hold_s = VEHICLE_DYN_SHIFT_HOLD_S;
+    }
+
+    /* Coolant: engine heat (RPM x load map) against the radiator, whose
+       conductance depends on airflow and thermostat / fan */
+    const float heat = VehicleMap_At2D(&VEHICLE_LUT_HEAT, at_rpm,
+                                       VehicleMap_Find(&VEHICLE_LUT_LOAD_AXIS, load, NULL));
+    const float cond = VEHICLE_LUT_COOL_PASSIVE + VEHICLE_LUT_COOL_RADIATOR *
+        VehicleMap_At1D(VEHICLE_LUT_AIRFLOW, at_speed) *
+        VehicleMap_Lookup1D(&VEHICLE_LUT_RADIATOR, temp, &vs->hint_temp);
+    const float temp_new = temp + (heat - cond * (temp - VEHICLE_LUT_AMBIENT_C)) * dt_s;
+
+    rpm = clamp_f(speed_new * VEHICLE_LUT_RPM_PER_KPH[gear],
+                  VEHICLE_LUT_IDLE_RPM, VEHICLE_LUT_LIMIT_RPM);
+
+    vs->speed_kph      = speed_new;
+    vs->engine_rpm     = (uint16_t)rpm;
+    vs->coolant_temp_c = clamp_f(temp_new, -40.0f, 140.0f);
+    vs->accel_kph_s    = net;
+    vs->gear           = (uint8_t)(gear + 1U);
+    vs->load_pct       = (uint8_t)(load * 100.0f + 0.5f);
+}
+
+#endif /* VEHICLE_DYNAMICS */
+
+void Vehicle_Init(VehicleState_t *vs)
+{
+    if (vs == NULL) return;
+
+    vs->speed_kph      = 0.0f;
+    vs->engine_rpm     = 800;    /* idle */
+    vs->coolant_temp_c = 30.0f;  /* “cold” engine */
+#if VEHICLE_DYNAMICS
+    vs->target_kph     = 0.0f;
+    vs->pi_int         = 0.0f;
+    vs->accel_kph_s    = 0.0f;
+    vs->gear           = 1U;
+    vs->load_pct       = 0U;
+    vs->shift_hold_s   = 0.0f;
+    vs->hint_rpm       = 0U;
+    vs->hint_temp      = 0U;
+#endif
+}
+
+void Vehicle_Update(VehicleState_t *vs, float dt_s)
 {
     if (vs == NULL) return;
+    if (dt_s <= 0.0f) return;
+
+#if VEHICLE_DYNAMICS
+    vehicle_dyn_step(vs, dt_s);
+#else
+    vehicle_step(&vs->speed_kph, &vs->engine_rpm, &vs->coolant_temp_c, dt_s);
+#endif
+}
 
-    /* For now just snap to target; later we can add acceleration limits. */
+void Vehicle_UpdateMs(VehicleState_t *vs, uint32_t dt_ms)
+{
+    /* Correctly rounded: 100 ms gives exactly 0.1f */
+    Vehicle_Update(vs, (float)dt_ms / 1000.0f);
+}
+
+void Vehicle_SetTargetSpeed(VehicleState_t *vs, float target_speed_kph)
+{
+    if (vs == NULL) return;
+
+#if VEHICLE_DYNAMICS
+    vs->target_kph = clamp_f(target_speed_kph, 0.0f, 200.0f);
+#else
+    /* Basic model: snap to target */
     vs->speed_kph = clamp_f(target_speed_kph, 0.0f, 200.0f);
+#endif
 }
 
 void Vehicle_Force(VehicleState_t *vs,
@@ -76,7 +374,66 @@ void Vehicle_Force(VehicleState_t *vs,
 {
     if (vs == NULL) return;
 
-    vs->speed_kph      = clamp_f(speed_kph, 0.0f, 300.0f);
+    speed_kph = clamp_f(speed_kph, 0.0f, 300.0f);
+#if VEHICLE_DYNAMICS
+    if (speed_kph != vs->speed_kph)
+    {
+        vs->gear         = vehicle_gear_for(speed_kph);
+        vs->shift_hold_s = 0.0f;
+    }
+#endif
+    vs->speed_kph      = speed_kph;
     vs->engine_rpm     = (uint16_t)clamp_f((float)rpm, 0.0f, 8000.0f);
     vs->coolant_temp_c = clamp_f(temp_c,  -40.0f, 140.0f);
 }
+
+float Vehicle_GetSpeedKph(const VehicleState_t *vs)
+{
+    return vs->speed_kph;
+}
+
+float Vehicle_GetCoolantC(const VehicleState_t *vs)
+{
+    return vs->coolant_temp_c;
+}
+
+uint8_t Vehicle_GetGear(const VehicleState_t *vs)
+{
+#if VEHICLE_DYNAMICS
+    return vs->gear;
+#else
+    (void)vs;
+    return 0U;
+#endif
+}
+
+float Vehicle_GetTargetKph(const VehicleState_t *vs)
+{
+#if VEHICLE_DYNAMICS
+    return vs->target_kph;
+#else
+    return vs->speed_kph;
+#endif
+}
+
+uint8_t Vehicle_GetLoadPct(const VehicleState_t *vs)
+{
+#if VEHICLE_DYNAMICS
+    return vs->load_pct;
+#else
+    (void)vs;
+    return 0U;
+#endif
+}
+
+int32_t Vehicle_GetSpeedKph10(const VehicleState_t *vs)
+{
+    return (int32_t)(vs->speed_kph * 10.0f);
+}
+
+int32_t Vehicle_GetCoolantC10(const VehicleState_t *vs)
+{
+    return (int32_t)(vs->coolant_temp_c * 10.0f);
+}
+
+#endif /* VEHICLE_FIXED_POINT */
@@ -0,0 +1,183 @@
+/**
+ * @file    vehicle_cli.c
+ * @brief   CLI commands for the virtual vehicle (status, veh ...).
+ *
+ * Registered with CLI_IF_CMD(). Status commands read the snapshot bound
+ * by CLI_IF_Init(), so all fields come from one model step even if
+ * VehicleTask runs meanwhile. Control commands never touch the model:
+ * they post to the command mailbox (vehicle_cmd.h), and VehicleTask
+ * applies them at the start of its next step.
+ */
+
+#include "cli_if.h"
+#include "vehicle.h"
+#include "vehicle_snap.h"
+#include "vehicle_cmd.h"
+#include "cyccnt.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Latest published step; 0 after telling the user there is none */
+static uint8_t vehicle_cli_sample(VehicleSample_t *out)
+{
+    const VehicleSnap_t *snap = CLI_IF_GetVehicleSnap();
+
+    if (snap == NULL)
+    {
+        CLI_IF_Print("[ERR] No vehicle bound to CLI\r\n");
+        return 0U;
+    }
+    (void)VehicleSnap_Read(snap, out);
+    return 1U;
+}
+
+/* Queue a command for VehicleTask; 0 after reporting a full queue */
+static uint8_t vehicle_cli_post(const VehicleCmd_t *cmd)
+{
+    if (VehicleCmd_Post(cmd) != HAL_OK)
+    {
+        CLI_IF_Print("[ERR] Vehicle command queue full\r\n");
+        return 0U;
+    }
+    return 1U;
+}
+
+/* Value in tenths, rounded to nearest (command units) */
+static int32_t vehicle_cli_tenths(float v)
+{
+    if (v >  100000.0f) v =  100000.0f;
+    if (v < -100000.0f) v = -100000.0f;
+    return (int32_t)(v * 10.0f + ((v >= 0.0f) ? 0.5f : -0.5f));
+}
+
+static void cmd_status(const CLI_IF_Args_t *args)
+{
+    VehicleSample_t vs;
+    char buf[128];
+
+    (void)args;
+    if (!vehicle_cli_sample(&vs))
+    {
+        return;
+    }
+    snprintf(buf, sizeof(buf),
+             "Speed:   %.1f km/h\r\n"
+             "RPM:     %u\r\n"
+             "Coolant: %.1f C\r\n",
+             Vehicle_GetSpeedKph(&vs.state),
+             vs.state.engine_rpm,
+             Vehicle_GetCoolantC(&vs.state));
+    CLI_IF_Print(buf);
+}
+
+static void cmd_veh_status(const CLI_IF_Args_t *args)
+{
+    VehicleSample_t vs;
+    char buf[128];
+
+    (void)args;
+    if (!vehicle_cli_sample(&vs))
+    {
+        return;
+    }
+#if VEHICLE_DYNAMICS
+    snprintf(buf, sizeof(buf),
+             "Vehicle:\r\n"
+             "  Speed   : %.1f km/h (target %.1f)\r\n"
+             "  RPM     : %u (gear %u, load %u%%)\r\n"
+             "  Coolant : %.1f C\r\n",
+             Vehicle_GetSpeedKph(&vs.state),
+             Vehicle_GetTargetKph(&vs.state),
+             vs.state.engine_rpm,
+             Vehicle_GetGear(&vs.state),
+             Vehicle_GetLoadPct(&vs.state),
+             Vehicle_GetCoolantC(&vs.state));
+#else
+    snprintf(buf, sizeof(buf),
+             "Vehicle:\r\n"
+             "  Speed   : %.1f km/h\r\n"
+             "  RPM     : %u\r\n"
+             "  Coolant : %.1f C\r\n",
+             Vehicle_GetSpeedKph(&vs.state),
+             vs.state.engine_rpm,
+             Vehicle_GetCoolantC(&vs.state));
+#endif
+    CLI_IF_Print(buf);
+}
+
+static void cmd_veh_speed(const CLI_IF_Args_t *args)
+{
+    const VehicleCmd_t cmd = {
+        .type  = VEHICLE_CMD_TARGET_SPEED,
+        .kph10 = vehicle_cli_tenths(args->argv[0].f),
+    };
+
+    if (vehicle_cli_post(&cmd))
+    {
+        CLI_IF_Print("OK: speed updated\r\n");
+    }
+}
+
+static void cmd_veh_cool_hot(const CLI_IF_Args_t *args)
+{
+    /* Quick “overheat” demo */
+    const VehicleCmd_t cmd = {
+        .type      = VEHICLE_CMD_COOLANT,
+        .coolant10 = 1150,
+    };
+
+    (void)args;
+    if (vehicle_cli_post(&cmd))
+    {
+        CLI_IF_Print("Injected: coolant overheat\r\n");
+    }
+}
+
+static void cmd_veh_trace(const CLI_IF_Args_t *args)
+{
+    const char *arg = args->argv[0].s;
+
+    if (strcmp(arg, "on") == 0)
+    {
+        VehicleCmd_SetTrace(1U);
+        CLI_IF_Print("Vehicle command trace ENABLED\r\n");
+    }
+    else if (strcmp(arg, "off") == 0)
+    {
+        VehicleCmd_SetTrace(0U);
+        CLI_IF_Print("Vehicle command trace DISABLED\r\n");
+    }
+    else
+    {
+        CLI_IF_Print("Usage: veh trace <on|off>\r\n");
+    }
+}
+
+static void cmd_veh_stats(const CLI_IF_Args_t *args)
+{
+    VehicleCmd_Stats_t st;
+    VehicleSample_t vs;
+    char buf[160];
+
+    (void)args;
+    if (!vehicle_cli_sample(&vs))
+    {
+        return;
+    }
+    VehicleCmd_GetStats(&st);
+    snprintf(buf, sizeof(buf),
+             "VEH: step=%lu applied=%lu dropped=%lu batches=%lu max_batch=%lu"
+             " apply_max=%lu cyc (%lu us)\r\n",
+             (unsigned long)vs.step, (unsigned long)st.applied,
+             (unsigned long)st.dropped, (unsigned long)st.batches,
+             (unsigned long)st.max_batch, (unsigned long)st.apply_cyc_max,
+             (unsigned long)CYCCNT_ToUs(st.apply_cyc_max));
+    CLI_IF_Print(buf);
+}
+
+CLI_IF_CMD(status,       "status",       "",       cmd_status,       "show basic vehicle state");
+CLI_IF_CMD(veh_status,   "veh status",   "",       cmd_veh_status,   "show detailed vehicle state");
+CLI_IF_CMD(veh_speed,    "veh speed",    "f:kph",  cmd_veh_speed,    "set target speed in km/h");
+CLI_IF_CMD(veh_cool_hot, "veh cool-hot", "",       cmd_veh_cool_hot, "inject coolant overheat");
+CLI_IF_CMD(veh_trace,    "veh trace",    "s:mode", cmd_veh_trace,    "log applied vehicle commands (on|off)");
+CLI_IF_CMD(veh_stats,    "veh stats",    "",       cmd_veh_stats,    "show vehicle command counters");
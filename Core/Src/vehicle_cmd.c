@@ -0,0 +1,203 @@
+/**
+ * @file    vehicle_cmd.c
+ * @brief   Vehicle command mailbox: MPSC slot ring applied by VehicleTask.
+ */
+
+#include "vehicle_cmd.h"
+#include "cyccnt.h"
+#include "dlog.h"
+#include <string.h>
+
+#if (VEHICLE_CMD_QUEUE_LEN & (VEHICLE_CMD_QUEUE_LEN - 1U)) != 0U
+#error "VEHICLE_CMD_QUEUE_LEN must be a power of two"
+#endif
+
+#define VEHICLE_CMD_MASK   (VEHICLE_CMD_QUEUE_LEN - 1U)
+
+typedef struct
+{
+    volatile uint8_t type;   /* VEHICLE_CMD_NONE until the producer is done */
+    uint16_t         rpm;
+    int32_t          kph10;
+    int32_t          coolant10;
+} VehicleCmdSlot_t;
+
+static VehicleCmdSlot_t   s_slot[VEHICLE_CMD_QUEUE_LEN];
+static volatile uint32_t  s_head;      /* next slot to reserve (producers) */
+static volatile uint32_t  s_tail;      /* next slot to apply (VehicleTask) */
+static volatile uint32_t  s_dropped;
+static volatile uint8_t   s_trace;
+static VehicleCmd_Stats_t s_stats;     /* consumer-side counters           */
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+static void vehicle_cmd_count_drop(void)
+{
+    uint32_t v;
+    do
+    {
+        v = __LDREXW(&s_dropped);
+    } while (__STREXW(v + 1U, &s_dropped) != 0U);
+}
+
+static void vehicle_cmd_trace(const VehicleCmd_t *cmd, uint32_t step)
+{
+    switch (cmd->type)
+    {
+    case VEHICLE_CMD_TARGET_SPEED:
+        DLOG2(DLOG_VEH_TARGET, step, cmd->kph10);
+        break;
+    case VEHICLE_CMD_FORCE:
+        DLOG4(DLOG_VEH_FORCE, step, cmd->kph10, cmd->rpm, cmd->coolant10);
+        break;
+    case VEHICLE_CMD_COOLANT:
+        DLOG2(DLOG_VEH_COOLANT, step, cmd->coolant10);
+        break;
+    default:
+        break;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Producer side
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef VehicleCmd_Post(const VehicleCmd_t *cmd)
+{
+    uint32_t head;
+
+    if (cmd == NULL || cmd->type == VEHICLE_CMD_NONE || cmd->type > VEHICLE_CMD_COOLANT)
+    {
+        return HAL_ERROR;
+    }
+
+    /* Reserve a slot; a task or ISR that got in between makes STREX fail */
+    do
+    {
+        head = __LDREXW(&s_head);
+        if (head - s_tail >= VEHICLE_CMD_QUEUE_LEN)
+        {
+            __CLREX();
+            vehicle_cmd_count_drop();
+            return HAL_BUSY;
+        }
+    } while (__STREXW(head + 1U, &s_head) != 0U);
+
+    VehicleCmdSlot_t *slot = &s_slot[head & VEHICLE_CMD_MASK];
+    slot->rpm       = cmd->rpm;
+    slot->kph10     = cmd->kph10;
+    slot->coolant10 = cmd->coolant10;
+    __DMB();         /* payload before type */
+    slot->type = cmd->type;
+    return HAL_OK;
+}
+
+/* --------------------------------------------------------------------------
+ * Consumer side
+ * -------------------------------------------------------------------------- */
+
+void VehicleCmd_Init(void)
+{
+    memset(s_slot, 0, sizeof(s_slot));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_head    = 0U;
+    s_tail    = 0U;
+    s_dropped = 0U;
+}
+
+void VehicleCmd_Exec(VehicleState_t *vs, const VehicleCmd_t *cmd)
+{
+    switch (cmd->type)
+    {
+    case VEHICLE_CMD_TARGET_SPEED:
+        Vehicle_SetTargetSpeed(vs, (float)cmd->kph10 / 10.0f);
+        break;
+    case VEHICLE_CMD_FORCE:
+        Vehicle_Force(vs, (float)cmd->kph10 / 10.0f, cmd->rpm,
+                      (float)cmd->coolant10 / 10.0f);
+        break;
+    case VEHICLE_CMD_COOLANT:
+        Vehicle_Force(vs, Vehicle_GetSpeedKph(vs), vs->engine_rpm,
+                      (float)cmd->coolant10 / 10.0f);
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t VehicleCmd_Apply(VehicleState_t *vs, uint32_t step)
+{
+    const uint32_t head = s_head;     /* commands posted from here on wait */
+    const uint32_t tail = s_tail;
+    uint32_t n = 0U;
+
+    if (tail == head)
+    {
+        return 0U;   /* the usual case: nothing to time */
+    }
+
+#if VEHICLE_CMD_APPLY_CYC
+    const uint32_t t0 = CYCCNT_Read();
+#endif
+
+    /* Published slots in order, up to one a producer is still filling */
+    while (tail + n != head && s_slot[(tail + n) & VEHICLE_CMD_MASK].type != VEHICLE_CMD_NONE)
+    {
+        n++;
+    }
+    if (n == 0U)
+    {
+        return 0U;
+    }
+    __DMB();         /* types before payloads */
+
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        VehicleCmdSlot_t *slot = &s_slot[(tail + i) & VEHICLE_CMD_MASK];
+        const VehicleCmd_t cmd = {
+            .type      = slot->type,
+            .rpm       = slot->rpm,
+            .kph10     = slot->kph10,
+            .coolant10 = slot->coolant10,
+        };
+
+        slot->type = VEHICLE_CMD_NONE;
+        VehicleCmd_Exec(vs, &cmd);
+        if (s_trace)
+        {
+            vehicle_cmd_trace(&cmd, step);
+        }
+    }
+
+    __DMB();         /* slots free before producers can see the new tail */
+    s_tail = tail + n;
+
+    s_stats.applied += n;
+    s_stats.batches++;
+    if (n > s_stats.max_batch)       s_stats.max_batch = n;
+#if VEHICLE_CMD_APPLY_CYC
+    const uint32_t cyc = CYCCNT_Read() - t0;
+    if (cyc > s_stats.apply_cyc_max) s_stats.apply_cyc_max = cyc;
+#endif
+    return n;
+}
+
+uint32_t VehicleCmd_Pending(void)
+{
+    return (s_head != s_tail) ? 1U : 0U;
+}
+
+void VehicleCmd_SetTrace(uint8_t on)
+{
+    s_trace = on ? 1U : 0U;
+}
+
+void VehicleCmd_GetStats(VehicleCmd_Stats_t *out)
+{
+    if (out == NULL) return;
+
+    *out = s_stats;
+    out->dropped = s_dropped;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file    vehicle_map.c
+ * @brief   Calibration maps: axis search and 1-D / 2-D interpolation.
+ */
+
+#include "vehicle_map.h"
+#include <stddef.h>
+
+/* --------------------------------------------------------------------------
+ * Float axis search
+ * -------------------------------------------------------------------------- */
+
+/*
+ * Every search returns i in 0 .. n - 2 with bp[i] <= x < bp[i + 1] for
+ * inputs inside the axis, 0 below it and n - 2 at or above its end
+ * (NaN counts as below). The uniform search, VehicleMap_Find() and the
+ * interpolation are inline in vehicle_map.h.
+ */
+
+uint16_t VehicleMap_FindBinary(const VehicleMapAxis_t *ax, float x)
+{
+    uint16_t lo = 0U;
+    uint16_t hi = (uint16_t)(ax->n - 1U);
+
+    if (!(x > ax->bp[0])) return 0U;
+    if (x >= ax->bp[hi])  return (uint16_t)(hi - 1U);
+
+    /* bp[lo] <= x < bp[hi] */
+    while (hi - lo > 1U)
+    {
+        const uint16_t mid = (uint16_t)((lo + hi) >> 1);
+        if (x < ax->bp[mid])
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid;
+        }
+    }
+    return lo;
+}
+
+uint16_t VehicleMap_FindHint(const VehicleMapAxis_t *ax, float x,
+                             VehicleMapHint_t *hint)
+{
+    const uint16_t last = (uint16_t)(ax->n - 2U);
+    uint16_t i = *hint;
+
+    if (i > last) i = last;
+
+    if (!(x >= ax->bp[i]))
+    {
+        /* Moved down: previous segment, else search */
+        i = (i > 0U && x >= ax->bp[i - 1U]) ? (uint16_t)(i - 1U)
+                                            : VehicleMap_FindBinary(ax, x);
+    }
+    else if (x >= ax->bp[i + 1U] && i < last)
+    {
+        /* Moved up: next segment, else search */
+        i = (x < ax->bp[i + 2U]) ? (uint16_t)(i + 1U)
+                                 : VehicleMap_FindBinary(ax, x);
+    }
+    *hint = i;
+    return i;
+}
+
+uint16_t VehicleMap_FindLinear(const VehicleMapAxis_t *ax, float x)
+{
+    const uint16_t last = (uint16_t)(ax->n - 2U);
+    uint16_t i = 0U;
+
+    while (i < last && x >= ax->bp[i + 1U])
+    {
+        i++;
+    }
+    return i;
+}
+
+/* --------------------------------------------------------------------------
+ * Q16.16
+ * -------------------------------------------------------------------------- */
+
+static uint16_t vehicle_map_binary_q16(const VehicleMapAxisQ16_t *ax, q16_16_t x)
+{
+    uint16_t lo = 0U;
+    uint16_t hi = (uint16_t)(ax->n - 1U);
+
+    while (hi - lo > 1U)
+    {
+        const uint16_t mid = (uint16_t)((lo + hi) >> 1);
+        if (x < ax->bp[mid])
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid;
+        }
+    }
+    return lo;
+}
+
+VehicleMapPosQ16_t VehicleMap_FindQ16(const VehicleMapAxisQ16_t *ax, q16_16_t x,
+                                      VehicleMapHint_t *hint)
+{
+    const uint16_t last = (uint16_t)(ax->n - 2U);
+    VehicleMapPosQ16_t p;
+    uint16_t i;
+
+    if (x <= ax->bp[0])
+    {
+        p.i = 0U;
+        p.f = 0U;
+        return p;
+    }
+    if (x >= ax->bp[last + 1U])
+    {
+        p.i = last;
+        p.f = 65536U;
+        return p;
+    }
+
+    switch (ax->search)
+    {
+    case VEHICLE_MAP_UNIFORM:
+        i = (uint16_t)(((uint64_t)(uint32_t)(x - ax->bp[0]) * ax->inv[0]) >> 32);
+        if (i > last) i = last;
+        break;
+    case VEHICLE_MAP_HINT:
+        if (hint == NULL)
+        {
+            i = vehicle_map_binary_q16(ax, x);
+            break;
+        }
+        i = (*hint > last) ? last : *hint;
+        if (x < ax->bp[i])
+        {
+            i = (i > 0U && x >= ax->bp[i - 1U]) ? (uint16_t)(i - 1U)
+                                                : vehicle_map_binary_q16(ax, x);
+        }
+        else if (x >= ax->bp[i + 1U])
+        {
+            i = (x < ax->bp[i + 2U]) ? (uint16_t)(i + 1U)
+                                     : vehicle_map_binary_q16(ax, x);
+        }
+        *hint = i;
+        break;
+    default:
+        i = vehicle_map_binary_q16(ax, x);
+        break;
+    }
+
+    uint32_t f = (uint32_t)(((uint64_t)(uint32_t)(x - ax->bp[i]) * ax->inv[i]) >> 16);
+    if (f > 65536U) f = 65536U;
+    p.i = i;
+    p.f = f;
+    return p;
+}
+
+static q16_16_t vehicle_map_lerp_q16(q16_16_t a, q16_16_t b, uint32_t f)
+{
+    return a + q16_mul(b - a, (q16_16_t)f);
+}
+
+q16_16_t VehicleMap_Lookup1DQ16(const VehicleMap1DQ16_t *m, q16_16_t x,
+                                VehicleMapHint_t *hint)
+{
+    const VehicleMapPosQ16_t p = VehicleMap_FindQ16(m->x, x, hint);
+
+    return vehicle_map_lerp_q16(m->z[p.i], m->z[p.i + 1U], p.f);
+}
+
+q16_16_t VehicleMap_Lookup2DQ16(const VehicleMap2DQ16_t *m, q16_16_t x, q16_16_t y,
+                                VehicleMapHint_t *hx, VehicleMapHint_t *hy)
+{
+    const VehicleMapPosQ16_t px = VehicleMap_FindQ16(m->x, x, hx);
+    const VehicleMapPosQ16_t py = VehicleMap_FindQ16(m->y, y, hy);
+    const uint32_t  nx = m->x->n;
+    const q16_16_t *z0 = &m->z[(uint32_t)py.i * nx + px.i];
+    const q16_16_t *z1 = z0 + nx;
+
+    const q16_16_t a = vehicle_map_lerp_q16(z0[0], z0[1], px.f);
+    const q16_16_t b = vehicle_map_lerp_q16(z1[0], z1[1], px.f);
+    return vehicle_map_lerp_q16(a, b, py.f);
+}
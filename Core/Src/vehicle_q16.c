@@ -0,0 +1,96 @@
+/**
+ * @file    vehicle_q16.c
+ * @brief   Q16.16 fixed-point twin of the vehicle model in vehicle.c.
+ *
+ * Integer-only: every operation is defined by vehicle_q16.h, so the same
+ * inputs give the same bits on the Cortex-M4 and on the host.
+ */
+
+#include "vehicle_q16.h"
+#include <stddef.h>
+
+static q16_16_t clamp_q(q16_16_t v, q16_16_t min, q16_16_t max)
+{
+    if (v < min) return min;
+    if (v > max) return max;
+    return v;
+}
+
+void VehicleQ16_Init(VehicleStateQ16_t *vs)
+{
+    if (vs == NULL) return;
+
+    vs->speed_kph      = 0;
+    vs->engine_rpm     = 800;                 /* idle */
+    vs->coolant_temp_c = VEHICLE_Q16(30.0);   /* “cold” engine */
+}
+
+void VehicleQ16_Update(VehicleStateQ16_t *vs, q16_16_t dt)
+{
+    if (vs == NULL) return;
+    if (dt <= 0) return;
+
+    q16_16_t speed = vs->speed_kph;
+    q16_16_t temp  = vs->coolant_temp_c;
+
+    /* Friction: 1 km/h per second while moving */
+    if (speed > VEHICLE_Q16(0.1))
+    {
+        speed -= dt;
+        if (speed < 0)
+        {
+            speed = 0;
+        }
+    }
+
+    /* RPM: idle 800 + 50 per km/h, first-order lag. 64-bit so any
+       uint16_t rpm and the full speed range stay in range. */
+    int64_t target_rpm = (int64_t)VEHICLE_Q16(800.0) + (int64_t)speed * 50;
+    int64_t rpm_q      = (int64_t)vs->engine_rpm << 16;
+    int64_t err        = target_rpm - rpm_q;
+    int64_t half_err   = ((err * VEHICLE_Q16(0.5)) + 32768) >> 16;
+
+    rpm_q += ((half_err * dt) + 32768) >> 16;
+    if (rpm_q < VEHICLE_Q16(600.0))  rpm_q = VEHICLE_Q16(600.0);
+    if (rpm_q > VEHICLE_Q16(6000.0)) rpm_q = VEHICLE_Q16(6000.0);
+    uint16_t rpm = (uint16_t)(rpm_q >> 16);
+
+    /* Coolant: warm up while driving / revving, cool slowly otherwise */
+    if (speed > VEHICLE_Q16_ONE || rpm > 1500)
+    {
+        temp += q16_mul(VEHICLE_Q16(2.0), dt);
+    }
+    else
+    {
+        temp -= q16_mul(VEHICLE_Q16(0.2), dt);
+    }
+
+    vs->speed_kph      = speed;
+    vs->engine_rpm     = rpm;
+    vs->coolant_temp_c = clamp_q(temp, VEHICLE_Q16(20.0), VEHICLE_Q16(110.0));
+}
+
+void VehicleQ16_SetTargetSpeed(VehicleStateQ16_t *vs, q16_16_t target_speed_kph)
+{
+    if (vs == NULL) return;
+
+    vs->speed_kph = clamp_q(target_speed_kph, 0, VEHICLE_Q16(200.0));
+}
+
+void VehicleQ16_Force(VehicleStateQ16_t *vs,
+                      q16_16_t speed_kph,
+                      uint16_t rpm,
+                      q16_16_t temp_c)
+{
+    if (vs == NULL) return;
+
+    vs->speed_kph      = clamp_q(speed_kph, 0, VEHICLE_Q16(300.0));
+    vs->engine_rpm     = (rpm > 8000U) ? 8000U : rpm;
+    vs->coolant_temp_c = clamp_q(temp_c, VEHICLE_Q16(-40.0), VEHICLE_Q16(140.0));
+}
+
+int32_t VehicleQ16_ToTenths(q16_16_t v)
+{
+    /* C division truncates toward zero, like a float -> int conversion */
+    return (int32_t)(((int64_t)v * 10) / 65536);
+}
@@ -0,0 +1,380 @@
+/**
+ * @file    vehicle_simd.c
+ * @brief   Branch-free and SIMD kernels for the vehicle model step.
+ *
+ * Each kernel is a transcription of vehicle_step() in vehicle.c:
+ *
+ *   dec    = max(speed - dt, 0)
+ *   speed  = (speed > 0.1)               ? dec  : speed
+ *   rpm_f  = rpm + ((800 + speed*50 - rpm) * 0.5) * dt
+ *   rpm    = (uint16_t)min(max(rpm_f, 600), 6000)
+ *   temp  += (speed > 1.0 | rpm > 1500)  ? 2*dt : -(0.2*dt)
+ *   temp   = min(max(temp, 20), 110)
+ *
+ * The operand order of max/min matches clamp_f() on equal inputs, and
+ * "temp - x" is computed as "temp + (-x)", which IEEE-754 defines to be the
+ * same value.
+ */
+
+#include "vehicle_simd.h"
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VEHICLE_HAVE_X86 1
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VEHICLE_HAVE_NEON 1
+#endif
+
+/* Per-call constants, shared by all kernels */
+typedef struct
+{
+    float dt;
+    float warm;      /* +2.0 * dt  */
+    float cool;      /* -(0.2 * dt) */
+} VehicleStepConst_t;
+
+static VehicleStepConst_t step_const(float dt_s)
+{
+    VehicleStepConst_t k;
+
+    k.dt   = dt_s;
+    k.warm = 2.0f * dt_s;
+    k.cool = -(0.2f * dt_s);
+    return k;
+}
+
+/* --------------------------------------------------------------------------
+ * Portable branch-free kernel (also the tail loop of the SIMD kernels)
+ * -------------------------------------------------------------------------- */
+
+static inline float max_f(float a, float b) { return (a > b) ? a : b; }
+static inline float min_f(float a, float b) { return (a < b) ? a : b; }
+
+static inline void step_branchfree(float *speed_kph, uint16_t *engine_rpm,
+                                   float *coolant_temp_c, const VehicleStepConst_t *k)
+{
+    float speed = *speed_kph;
+    float dec   = max_f(0.0f, speed - k->dt);
+
+    speed = (speed > 0.1f) ? dec : speed;
+
+    float rpm_f = (float)*engine_rpm;
+    float target_rpm = 800.0f + speed * 50.0f;
+    rpm_f += (target_rpm - rpm_f) * 0.5f * k->dt;
+
+    uint16_t rpm = (uint16_t)min_f(max_f(rpm_f, 600.0f), 6000.0f);
+    uint32_t warm = (uint32_t)(speed > 1.0f) | (uint32_t)(rpm > 1500U);
+    float temp = *coolant_temp_c + (warm ? k->warm : k->cool);
+
+    *speed_kph      = speed;
+    *engine_rpm     = rpm;
+    *coolant_temp_c = min_f(max_f(temp, 20.0f), 110.0f);
+}
+
+static void kernel_branchfree(const VehicleFleet_t *f, uint32_t start,
+                              const VehicleStepConst_t *k)
+{
+    for (uint32_t i = start; i < f->count; i++)
+    {
+        step_branchfree(&f->speed_kph[i], &f->engine_rpm[i], &f->coolant_temp_c[i], k);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * x86: SSE2 (baseline on x86-64), AVX2, AVX-512F
+ * -------------------------------------------------------------------------- */
+
+#if defined(VEHICLE_HAVE_X86)
+
+__attribute__((target("sse2")))
+static void kernel_sse2(const VehicleFleet_t *f, const VehicleStepConst_t *k)
+{
+    const __m128  vdt   = _mm_set1_ps(k->dt);
+    const __m128  vzero = _mm_setzero_ps();
+    const __m128  v01   = _mm_set1_ps(0.1f);
+    const __m128  v1    = _mm_set1_ps(1.0f);
+    const __m128  v50   = _mm_set1_ps(50.0f);
+    const __m128  v800  = _mm_set1_ps(800.0f);
+    const __m128  vhalf = _mm_set1_ps(0.5f);
+    const __m128  vrmin = _mm_set1_ps(600.0f);
+    const __m128  vrmax = _mm_set1_ps(6000.0f);
+    const __m128  vtmin = _mm_set1_ps(20.0f);
+    const __m128  vtmax = _mm_set1_ps(110.0f);
+    const __m128  vwarm = _mm_set1_ps(k->warm);
+    const __m128  vcool = _mm_set1_ps(k->cool);
+    const __m128i v1500 = _mm_set1_epi32(1500);
+    uint32_t i = 0;
+
+    for (; i + 4U <= f->count; i += 4U)
+    {
+        __m128 s   = _mm_loadu_ps(&f->speed_kph[i]);
+        __m128 dec = _mm_max_ps(vzero, _mm_sub_ps(s, vdt));
+        __m128 m   = _mm_cmpgt_ps(s, v01);
+        s = _mm_or_ps(_mm_and_ps(m, dec), _mm_andnot_ps(m, s));
+
+        __m128i r16 = _mm_loadl_epi64((const __m128i *)&f->engine_rpm[i]);
+        __m128  rf  = _mm_cvtepi32_ps(_mm_unpacklo_epi16(r16, _mm_setzero_si128()));
+        __m128  tgt = _mm_add_ps(v800, _mm_mul_ps(s, v50));
+        rf = _mm_add_ps(rf, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(tgt, rf), vhalf), vdt));
+        __m128i ri = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(rf, vrmin), vrmax));
+
+        __m128 w = _mm_or_ps(_mm_cmpgt_ps(s, v1), _mm_castsi128_ps(_mm_cmpgt_epi32(ri, v1500)));
+        __m128 t = _mm_loadu_ps(&f->coolant_temp_c[i]);
+        t = _mm_add_ps(t, _mm_or_ps(_mm_and_ps(w, vwarm), _mm_andnot_ps(w, vcool)));
+        t = _mm_min_ps(_mm_max_ps(t, vtmin), vtmax);
+
+        _mm_storeu_ps(&f->speed_kph[i], s);
+        _mm_storel_epi64((__m128i *)&f->engine_rpm[i], _mm_packs_epi32(ri, ri));
+        _mm_storeu_ps(&f->coolant_temp_c[i], t);
+    }
+    kernel_branchfree(f, i, k);
+}
+
+__attribute__((target("avx2")))
+static void kernel_avx2(const VehicleFleet_t *f, const VehicleStepConst_t *k)
+{
+    const __m256  vdt   = _mm256_set1_ps(k->dt);
+    const __m256  vzero = _mm256_setzero_ps();
+    const __m256  v01   = _mm256_set1_ps(0.1f);
+    const __m256  v1    = _mm256_set1_ps(1.0f);
+    const __m256  v50   = _mm256_set1_ps(50.0f);
+    const __m256  v800  = _mm256_set1_ps(800.0f);
+    const __m256  vhalf = _mm256_set1_ps(0.5f);
+    const __m256  vrmin = _mm256_set1_ps(600.0f);
+    const __m256  vrmax = _mm256_set1_ps(6000.0f);
+    const __m256  vtmin = _mm256_set1_ps(20.0f);
+    const __m256  vtmax = _mm256_set1_ps(110.0f);
+    const __m256  vwarm = _mm256_set1_ps(k->warm);
+    const __m256  vcool = _mm256_set1_ps(k->cool);
+    const __m256i v1500 = _mm256_set1_epi32(1500);
+    uint32_t i = 0;
+
+    for (; i + 8U <= f->count; i += 8U)
+    {
+        __m256 s   = _mm256_loadu_ps(&f->speed_kph[i]);
+        __m256 dec = _mm256_max_ps(vzero, _mm256_sub_ps(s, vdt));
+        s = _mm256_blendv_ps(s, dec, _mm256_cmp_ps(s, v01, _CMP_GT_OQ));
+
+        __m128i r16 = _mm_loadu_si128((const __m128i *)&f->engine_rpm[i]);
+        __m256  rf  = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(r16));
+        __m256  tgt = _mm256_add_ps(v800, _mm256_mul_ps(s, v50));
+        rf = _mm256_add_ps(rf, _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(tgt, rf), vhalf), vdt));
+        __m256i ri = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(rf, vrmin), vrmax));
+
+        __m256 w = _mm256_or_ps(_mm256_cmp_ps(s, v1, _CMP_GT_OQ),
+                                _mm256_castsi256_ps(_mm256_cmpgt_epi32(ri, v1500)));
+        __m256 t = _mm256_loadu_ps(&f->coolant_temp_c[i]);
+        t = _mm256_add_ps(t, _mm256_blendv_ps(vcool, vwarm, w));
+        t = _mm256_min_ps(_mm256_max_ps(t, vtmin), vtmax);
+
+        _mm256_storeu_ps(&f->speed_kph[i], s);
+        _mm_storeu_si128((__m128i *)&f->engine_rpm[i],
+                         _mm_packs_epi32(_mm256_castsi256_si128(ri),
+                                         _mm256_extracti128_si256(ri, 1)));
+        _mm256_storeu_ps(&f->coolant_temp_c[i], t);
+    }
+    kernel_branchfree(f, i, k);
+}
+
+__attribute__((target("avx512f")))
+static void kernel_avx512(const VehicleFleet_t *f, const VehicleStepConst_t *k)
+{
+    const __m512  vdt   = _mm512_set1_ps(k->dt);
+    const __m512  vzero = _mm512_setzero_ps();
+    const __m512  v01   = _mm512_set1_ps(0.1f);
+    const __m512  v1    = _mm512_set1_ps(1.0f);
+    const __m512  v50   = _mm512_set1_ps(50.0f);
+    const __m512  v800  = _mm512_set1_ps(800.0f);
+    const __m512  vhalf = _mm512_set1_ps(0.5f);
+    const __m512  vrmin = _mm512_set1_ps(600.0f);
+    const __m512  vrmax = _mm512_set1_ps(6000.0f);
+    const __m512  vtmin = _mm512_set1_ps(20.0f);
+    const __m512  vtmax = _mm512_set1_ps(110.0f);
+    const __m512  vwarm = _mm512_set1_ps(k->warm);
+    const __m512  vcool = _mm512_set1_ps(k->cool);
+    const __m512i v1500 = _mm512_set1_epi32(1500);
+    uint32_t i = 0;
+
+    for (; i + 16U <= f->count; i += 16U)
+    {
+        __m512 s   = _mm512_loadu_ps(&f->speed_kph[i]);
+        __m512 dec = _mm512_max_ps(vzero, _mm512_sub_ps(s, vdt));
+        s = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(s, v01, _CMP_GT_OQ), s, dec);
+
+        __m256i r16 = _mm256_loadu_si256((const __m256i *)&f->engine_rpm[i]);
+        __m512  rf  = _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(r16));
+        __m512  tgt = _mm512_add_ps(v800, _mm512_mul_ps(s, v50));
+        rf = _mm512_add_ps(rf, _mm512_mul_ps(_mm512_mul_ps(_mm512_sub_ps(tgt, rf), vhalf), vdt));
+        __m512i ri = _mm512_cvttps_epi32(_mm512_min_ps(_mm512_max_ps(rf, vrmin), vrmax));
+
+        __mmask16 w = _mm512_cmp_ps_mask(s, v1, _CMP_GT_OQ) |
+                      _mm512_cmpgt_epi32_mask(ri, v1500);
+        __m512 t = _mm512_loadu_ps(&f->coolant_temp_c[i]);
+        t = _mm512_add_ps(t, _mm512_mask_blend_ps(w, vcool, vwarm));
+        t = _mm512_min_ps(_mm512_max_ps(t, vtmin), vtmax);
+
+        _mm512_storeu_ps(&f->speed_kph[i], s);
+        _mm256_storeu_si256((__m256i *)&f->engine_rpm[i], _mm512_cvtepi32_epi16(ri));
+        _mm512_storeu_ps(&f->coolant_temp_c[i], t);
+    }
+    kernel_branchfree(f, i, k);
+}
+
+#endif /* VEHICLE_HAVE_X86 */
+
+/* --------------------------------------------------------------------------
+ * ARM NEON (Cortex-A / AArch64 hosts)
+ * -------------------------------------------------------------------------- */
+
+#if defined(VEHICLE_HAVE_NEON)
+
+static void kernel_neon(const VehicleFleet_t *f, const VehicleStepConst_t *k)
+{
+    const float32x4_t vdt   = vdupq_n_f32(k->dt);
+    const float32x4_t vzero = vdupq_n_f32(0.0f);
+    const float32x4_t v01   = vdupq_n_f32(0.1f);
+    const float32x4_t v1    = vdupq_n_f32(1.0f);
+    const float32x4_t v50   = vdupq_n_f32(50.0f);
+    const float32x4_t v800  = vdupq_n_f32(800.0f);
+    const float32x4_t vhalf = vdupq_n_f32(0.5f);
+    const float32x4_t vrmin = vdupq_n_f32(600.0f);
+    const float32x4_t vrmax = vdupq_n_f32(6000.0f);
+    const float32x4_t vtmin = vdupq_n_f32(20.0f);
+    const float32x4_t vtmax = vdupq_n_f32(110.0f);
+    const float32x4_t vwarm = vdupq_n_f32(k->warm);
+    const float32x4_t vcool = vdupq_n_f32(k->cool);
+    const uint32x4_t  v1500 = vdupq_n_u32(1500U);
+    uint32_t i = 0;
+
+    for (; i + 4U <= f->count; i += 4U)
+    {
+        float32x4_t s   = vld1q_f32(&f->speed_kph[i]);
+        float32x4_t d   = vsubq_f32(s, vdt);
+        float32x4_t dec = vbslq_f32(vcgtq_f32(vzero, d), vzero, d);
+        s = vbslq_f32(vcgtq_f32(s, v01), dec, s);
+
+        float32x4_t rf  = vcvtq_f32_u32(vmovl_u16(vld1_u16(&f->engine_rpm[i])));
+        float32x4_t tgt = vaddq_f32(v800, vmulq_f32(s, v50));
+        rf = vaddq_f32(rf, vmulq_f32(vmulq_f32(vsubq_f32(tgt, rf), vhalf), vdt));
+        rf = vbslq_f32(vcltq_f32(rf, vrmin), vrmin, rf);
+        rf = vbslq_f32(vcgtq_f32(rf, vrmax), vrmax, rf);
+        uint32x4_t ri = vcvtq_u32_f32(rf);
+
+        uint32x4_t  w = vorrq_u32(vcgtq_f32(s, v1), vcgtq_u32(ri, v1500));
+        float32x4_t t = vaddq_f32(vld1q_f32(&f->coolant_temp_c[i]), vbslq_f32(w, vwarm, vcool));
+        t = vbslq_f32(vcltq_f32(t, vtmin), vtmin, t);
+        t = vbslq_f32(vcgtq_f32(t, vtmax), vtmax, t);
+
+        vst1q_f32(&f->speed_kph[i], s);
+        vst1_u16(&f->engine_rpm[i], vmovn_u32(ri));
+        vst1q_f32(&f->coolant_temp_c[i], t);
+    }
+    kernel_branchfree(f, i, k);
+}
+
+#endif /* VEHICLE_HAVE_NEON */
+
+/* --------------------------------------------------------------------------
+ * Dispatch
+ * -------------------------------------------------------------------------- */
+
+uint8_t Vehicle_KernelAvailable(VehicleKernel_t kernel)
+{
+    switch (kernel)
+    {
+    case VEHICLE_KERNEL_SCALAR:
+    case VEHICLE_KERNEL_BRANCHFREE:
+        return 1U;
+#if defined(VEHICLE_HAVE_X86)
+    case VEHICLE_KERNEL_SSE2:
+        return __builtin_cpu_supports("sse2") ? 1U : 0U;
+    case VEHICLE_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2") ? 1U : 0U;
+    case VEHICLE_KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f") ? 1U : 0U;
+#endif
+#if defined(VEHICLE_HAVE_NEON)
+    case VEHICLE_KERNEL_NEON:
+        return 1U;
+#endif
+    default:
+        return 0U;
+    }
+}
+
+VehicleKernel_t Vehicle_KernelBest(void)
+{
+    static const VehicleKernel_t order[] = {
+        VEHICLE_KERNEL_AVX512, VEHICLE_KERNEL_AVX2, VEHICLE_KERNEL_NEON, VEHICLE_KERNEL_SSE2,
+    };
+
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        if (Vehicle_KernelAvailable(order[i]))
+        {
+            return order[i];
+        }
+    }
+    return VEHICLE_KERNEL_BRANCHFREE;
+}
+
+const char *Vehicle_KernelName(VehicleKernel_t kernel)
+{
+    static const char *const names[VEHICLE_KERNEL_COUNT] = {
+        "scalar", "branchfree", "sse2", "avx2", "avx512", "neon",
+    };
+
+    return ((uint32_t)kernel < VEHICLE_KERNEL_COUNT) ? names[kernel] : "?";
+}
+
+uint8_t Vehicle_UpdateBatchKernel(const VehicleFleet_t *fleet, float dt_s,
+                                  VehicleKernel_t kernel)
+{
+    if (!Vehicle_KernelAvailable(kernel)) return 0U;
+    if (fleet == NULL) return 1U;
+    if (dt_s <= 0.0f) return 1U;
+
+    const VehicleStepConst_t k = step_const(dt_s);
+
+    switch (kernel)
+    {
+    case VEHICLE_KERNEL_SCALAR:
+        Vehicle_UpdateBatch(fleet, dt_s);
+        break;
+#if defined(VEHICLE_HAVE_X86)
+    case VEHICLE_KERNEL_SSE2:
+        kernel_sse2(fleet, &k);
+        break;
+    case VEHICLE_KERNEL_AVX2:
+        kernel_avx2(fleet, &k);
+        break;
+    case VEHICLE_KERNEL_AVX512:
+        kernel_avx512(fleet, &k);
+        break;
+#endif
+#if defined(VEHICLE_HAVE_NEON)
+    case VEHICLE_KERNEL_NEON:
+        kernel_neon(fleet, &k);
+        break;
+#endif
+    default:
+        kernel_branchfree(fleet, 0U, &k);
+        break;
+    }
+    return 1U;
+}
+
+void Vehicle_UpdateBatchSimd(const VehicleFleet_t *fleet, float dt_s)
+{
+    static VehicleKernel_t s_best = VEHICLE_KERNEL_COUNT;
+
+    if (s_best == VEHICLE_KERNEL_COUNT)
+    {
+        s_best = Vehicle_KernelBest();
+    }
+    (void)Vehicle_UpdateBatchKernel(fleet, dt_s, s_best);
+}
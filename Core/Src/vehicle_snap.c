@@ -0,0 +1,64 @@
+/**
+ * @file    vehicle_snap.c
+ * @brief   Vehicle state snapshot: latch seqlock, one writer, many readers.
+ */
+
+#include "vehicle_snap.h"
+#include <stddef.h>
+
+/*
+ * Move readers to slot[seq & 1]: the slot writes so far become visible
+ * before seq does, and seq before any later slot write.
+ */
+static inline void vehicle_snap_latch(VehicleSnap_t *snap, uint32_t seq)
+{
+    __atomic_store_n(&snap->seq, seq, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void VehicleSnap_Init(VehicleSnap_t *snap, const VehicleState_t *vs)
+{
+    if (snap == NULL || vs == NULL) return;
+
+    snap->slot[0].state = *vs;
+    snap->slot[0].step  = 0U;
+    snap->slot[1]       = snap->slot[0];
+    vehicle_snap_latch(snap, 0U);
+}
+
+void VehicleSnap_Publish(VehicleSnap_t *snap, const VehicleState_t *vs)
+{
+    if (snap == NULL || vs == NULL) return;
+
+    /* Only the writer changes seq and the slots: plain reads are enough */
+    const uint32_t seq  = snap->seq;
+    const uint32_t step = snap->slot[0].step + 1U;
+
+    vehicle_snap_latch(snap, seq + 1U);     /* readers -> slot 1 */
+    snap->slot[0].state = *vs;
+    snap->slot[0].step  = step;
+
+    vehicle_snap_latch(snap, seq + 2U);     /* readers -> slot 0 */
+    snap->slot[1].state = *vs;
+    snap->slot[1].step  = step;
+}
+
+uint32_t VehicleSnap_Read(const VehicleSnap_t *snap, VehicleSample_t *out)
+{
+    uint32_t retries = 0U;
+
+    for (;;)
+    {
+        const uint32_t seq = __atomic_load_n(&snap->seq, __ATOMIC_ACQUIRE);
+
+        *out = snap->slot[seq & 1U];
+
+        /* The copy completes before seq is checked again */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&snap->seq, __ATOMIC_RELAXED) == seq)
+        {
+            return retries;
+        }
+        retries++;
+    }
+}
@@ -5,40 +5,88 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Core/Src/can_filter.c \
 ../Core/Src/can_if.c \
 ../Core/Src/cli_if.c \
+../Core/Src/dlog.c \
+../Core/Src/dlog_fmt.c \
 ../Core/Src/freertos.c \
+../Core/Src/hostlink.c \
+../Core/Src/hostlink_proto.c \
 ../Core/Src/main.c \
+../Core/Src/memmon.c \
+../Core/Src/probe.c \
+../Core/Src/rtstats.c \
+../Core/Src/sched_tt.c \
 ../Core/Src/stm32f4xx_hal_msp.c \
 ../Core/Src/stm32f4xx_it.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
 ../Core/Src/system_stm32f4xx.c \
-../Core/Src/vehicle.c 
+../Core/Src/uart_tx.c \
+../Core/Src/vehicle.c \
+../Core/Src/vehicle_cli.c \
+../Core/Src/vehicle_cmd.c \
+../Core/Src/vehicle_map.c \
+../Core/Src/vehicle_q16.c \
+../Core/Src/vehicle_simd.c \
+../Core/Src/vehicle_snap.c 
 
 OBJS += \
+./Core/Src/can_filter.o \
 ./Core/Src/can_if.o \
 ./Core/Src/cli_if.o \
+./Core/Src/dlog.o \
+./Core/Src/dlog_fmt.o \
 ./Core/Src/freertos.o \
+./Core/Src/hostlink.o \
+./Core/Src/hostlink_proto.o \
 ./Core/Src/main.o \
+./Core/Src/memmon.o \
+./Core/Src/probe.o \
+./Core/Src/rtstats.o \
+./Core/Src/sched_tt.o \
 ./Core/Src/stm32f4xx_hal_msp.o \
 ./Core/Src/stm32f4xx_it.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
 ./Core/Src/system_stm32f4xx.o \
-./Core/Src/vehicle.o 
+./Core/Src/uart_tx.o \
+./Core/Src/vehicle.o \
+./Core/Src/vehicle_cli.o \
+./Core/Src/vehicle_cmd.o \
+./Core/Src/vehicle_map.o \
+./Core/Src/vehicle_q16.o \
+./Core/Src/vehicle_simd.o \
+./Core/Src/vehicle_snap.o 
 
 C_DEPS += \
+./Core/Src/can_filter.d \
 ./Core/Src/can_if.d \
 ./Core/Src/cli_if.d \
+./Core/Src/dlog.d \
+./Core/Src/dlog_fmt.d \
 ./Core/Src/freertos.d \
+./Core/Src/hostlink.d \
+./Core/Src/hostlink_proto.d \
 ./Core/Src/main.d \
+./Core/Src/memmon.d \
+./Core/Src/probe.d \
+./Core/Src/rtstats.d \
+./Core/Src/sched_tt.d \
 ./Core/Src/stm32f4xx_hal_msp.d \
 ./Core/Src/stm32f4xx_it.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
 ./Core/Src/system_stm32f4xx.d \
-./Core/Src/vehicle.d 
+./Core/Src/uart_tx.d \
+./Core/Src/vehicle.d \
+./Core/Src/vehicle_cli.d \
+./Core/Src/vehicle_cmd.d \
+./Core/Src/vehicle_map.d \
+./Core/Src/vehicle_q16.d \
+./Core/Src/vehicle_simd.d \
+./Core/Src/vehicle_snap.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -48,7 +96,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/can_if.cyclo ./Core/Src/can_if.d ./Core/Src/can_if.o ./Core/Src/can_if.su ./Core/Src/cli_if.cyclo ./Core/Src/cli_if.d ./Core/Src/cli_if.o ./Core/Src/cli_if.su ./Core/Src/freertos.cyclo ./Core/Src/freertos.d ./Core/Src/freertos.o ./Core/Src/freertos.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/vehicle.cyclo ./Core/Src/vehicle.d ./Core/Src/vehicle.o ./Core/Src/vehicle.su
+	-$(RM) ./Core/Src/can_filter.cyclo ./Core/Src/can_filter.d ./Core/Src/can_filter.o ./Core/Src/can_filter.su ./Core/Src/can_if.cyclo ./Core/Src/can_if.d ./Core/Src/can_if.o ./Core/Src/can_if.su ./Core/Src/cli_if.cyclo ./Core/Src/cli_if.d ./Core/Src/cli_if.o ./Core/Src/cli_if.su ./Core/Src/dlog.cyclo ./Core/Src/dlog.d ./Core/Src/dlog.o ./Core/Src/dlog.su ./Core/Src/dlog_fmt.cyclo ./Core/Src/dlog_fmt.d ./Core/Src/dlog_fmt.o ./Core/Src/dlog_fmt.su ./Core/Src/freertos.cyclo ./Core/Src/freertos.d ./Core/Src/freertos.o ./Core/Src/freertos.su ./Core/Src/hostlink.cyclo ./Core/Src/hostlink.d ./Core/Src/hostlink.o ./Core/Src/hostlink.su ./Core/Src/hostlink_proto.cyclo ./Core/Src/hostlink_proto.d ./Core/Src/hostlink_proto.o ./Core/Src/hostlink_proto.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/memmon.cyclo ./Core/Src/memmon.d ./Core/Src/memmon.o ./Core/Src/memmon.su ./Core/Src/probe.cyclo ./Core/Src/probe.d ./Core/Src/probe.o ./Core/Src/probe.su ./Core/Src/rtstats.cyclo ./Core/Src/rtstats.d ./Core/Src/rtstats.o ./Core/Src/rtstats.su ./Core/Src/sched_tt.cyclo ./Core/Src/sched_tt.d ./Core/Src/sched_tt.o ./Core/Src/sched_tt.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/uart_tx.cyclo ./Core/Src/uart_tx.d ./Core/Src/uart_tx.o ./Core/Src/uart_tx.su ./Core/Src/vehicle.cyclo ./Core/Src/vehicle.d ./Core/Src/vehicle.o ./Core/Src/vehicle.su ./Core/Src/vehicle_cli.cyclo ./Core/Src/vehicle_cli.d ./Core/Src/vehicle_cli.o ./Core/Src/vehicle_cli.su ./Core/Src/vehicle_cmd.cyclo ./Core/Src/vehicle_cmd.d ./Core/Src/vehicle_cmd.o ./Core/Src/vehicle_cmd.su ./Core/Src/vehicle_map.cyclo ./Core/Src/vehicle_map.d ./Core/Src/vehicle_map.o ./Core/Src/vehicle_map.su ./Core/Src/vehicle_q16.cyclo ./Core/Src/vehicle_q16.d ./Core/Src/vehicle_q16.o ./Core/Src/vehicle_q16.su ./Core/Src/vehicle_simd.cyclo ./Core/Src/vehicle_simd.d ./Core/Src/vehicle_simd.o ./Core/Src/vehicle_simd.su ./Core/Src/vehicle_snap.cyclo ./Core/Src/vehicle_snap.d ./Core/Src/vehicle_snap.o ./Core/Src/vehicle_snap.su
 
 .PHONY: clean-Core-2f-Src
 
@@ -0,0 +1,439 @@
+/**
+ * @file    bench_cancodec.c
+ * @brief   Generated CAN signal codec (can_db.h): conformance and cost.
+ *
+ * 1. Golden frames: known signal values against hand-checked payloads,
+ *    including the 0x100 telemetry example from CAN_PROTOCOL.md.
+ * 2. Round trip: random raw values -> Pack -> Unpack give the same values,
+ *    and random payloads -> Unpack -> Pack give the same signal bits.
+ * 3. Reference: every generated Pack / Unpack is compared with a generic,
+ *    bit-by-bit codec driven by the CAN_DB_Signals descriptor table (DBC
+ *    start bit / length / byte order / sign).
+ * 4. Physical: Decode(Encode(x)) is within half a step of x inside
+ *    [min, max], and saturates outside.
+ * 5. Cost: ns per frame for the generated Pack / Unpack, the bitwise
+ *    reference, and the hand-written telemetry packing it replaced.
+ *
+ * Usage: bench_cancodec [frames]     (default 1000000)
+ * Exit status is non-zero if any check fails.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CAN_DB_DESCRIPTORS
+#include "can_db.h"
+
+#define ROUND_TRIPS   200000U
+
+static uint32_t s_fail;
+static uint32_t s_rng = 12345U;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        if (s_fail < 10U)
+        {
+            printf("  FAIL: %s\n", what);
+        }
+        s_fail++;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Reference codec: one bit at a time, from the descriptor table
+ * -------------------------------------------------------------------------- */
+
+/* Message bit position (byte * 8 + bit) of signal bit k, k = 0 is the LSB */
+static uint32_t ref_bit_pos(const CAN_DB_SignalDesc_t *d, uint32_t k)
+{
+    if (d->intel)
+    {
+        return d->start + k;
+    }
+
+    /* Motorola: start is the MSB; walk down towards the LSB */
+    uint32_t p = d->start;
+    for (uint32_t i = d->length - 1U; i > k; i--)
+    {
+        p = ((p % 8U) == 0U) ? (p + 15U) : (p - 1U);
+    }
+    return p;
+}
+
+static int64_t ref_get(const CAN_DB_SignalDesc_t *d, const uint8_t *data)
+{
+    uint64_t raw = 0U;
+
+    for (uint32_t k = 0U; k < d->length; k++)
+    {
+        const uint32_t p = ref_bit_pos(d, k);
+        raw |= (uint64_t)((data[p / 8U] >> (p % 8U)) & 1U) << k;
+    }
+    if (d->is_signed && ((raw >> (d->length - 1U)) & 1U))
+    {
+        raw |= ~0ULL << d->length;
+    }
+    return (int64_t)raw;
+}
+
+static void ref_set(const CAN_DB_SignalDesc_t *d, uint8_t *data, int64_t value)
+{
+    for (uint32_t k = 0U; k < d->length; k++)
+    {
+        const uint32_t p = ref_bit_pos(d, k);
+        const uint8_t  bit = (uint8_t)(1U << (p % 8U));
+
+        if (((uint64_t)value >> k) & 1U)
+        {
+            data[p / 8U] |= bit;
+        }
+        else
+        {
+            data[p / 8U] &= (uint8_t)~bit;
+        }
+    }
+}
+
+/* Random raw value that fits the signal */
+static int64_t ref_random(const CAN_DB_SignalDesc_t *d)
+{
+    uint64_t v = ((uint64_t)rng_next() << 32) | rng_next();
+
+    v &= (d->length == 64U) ? ~0ULL : ((1ULL << d->length) - 1U);
+    if (d->is_signed && ((v >> (d->length - 1U)) & 1U))
+    {
+        v |= ~0ULL << d->length;
+    }
+    return (int64_t)v;
+}
+
+/* --------------------------------------------------------------------------
+ * Per-message glue: struct <-> raw values in descriptor order
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    const char *name;
+    uint32_t    id;
+    uint32_t    dlc;
+    void      (*pack)(uint8_t *data, const int64_t *raw);
+    void      (*unpack)(int64_t *raw, const uint8_t *data);
+} MsgGlue_t;
+
+static void tlm_pack(uint8_t *data, const int64_t *raw)
+{
+    CAN_DB_VehicleTelemetry_t m;
+
+    m.speed        = (uint16_t)raw[0];
+    m.engine_rpm   = (uint16_t)raw[1];
+    m.coolant_temp = (int16_t)raw[2];
+    CAN_DB_VehicleTelemetry_Pack(data, &m);
+}
+
+static void tlm_unpack(int64_t *raw, const uint8_t *data)
+{
+    CAN_DB_VehicleTelemetry_t m;
+
+    CAN_DB_VehicleTelemetry_Unpack(&m, data);
+    raw[0] = m.speed;
+    raw[1] = m.engine_rpm;
+    raw[2] = m.coolant_temp;
+}
+
+static void cmd_pack(uint8_t *data, const int64_t *raw)
+{
+    CAN_DB_VehicleCommand_t m;
+
+    m.target_speed  = (uint16_t)raw[0];
+    m.cmd_mode      = (uint8_t)raw[1];
+    m.alive_counter = (uint8_t)raw[2];
+    m.accel_limit   = (int8_t)raw[3];
+    CAN_DB_VehicleCommand_Pack(data, &m);
+}
+
+static void cmd_unpack(int64_t *raw, const uint8_t *data)
+{
+    CAN_DB_VehicleCommand_t m;
+
+    CAN_DB_VehicleCommand_Unpack(&m, data);
+    raw[0] = m.target_speed;
+    raw[1] = m.cmd_mode;
+    raw[2] = m.alive_counter;
+    raw[3] = m.accel_limit;
+}
+
+static const MsgGlue_t s_msgs[] = {
+    { "VehicleTelemetry", CAN_DB_VEHICLE_TELEMETRY_ID, CAN_DB_VEHICLE_TELEMETRY_DLC,
+      tlm_pack, tlm_unpack },
+    { "VehicleCommand",   CAN_DB_VEHICLE_COMMAND_ID,   CAN_DB_VEHICLE_COMMAND_DLC,
+      cmd_pack, cmd_unpack },
+};
+
+#define MSG_COUNT   (sizeof(s_msgs) / sizeof(s_msgs[0]))
+#define MAX_SIGNALS 8U
+
+/* Descriptors of one message, in the order of its struct fields */
+static uint32_t msg_signals(uint32_t id, const CAN_DB_SignalDesc_t **out)
+{
+    uint32_t n = 0U;
+
+    for (uint32_t i = 0U; i < CAN_DB_SIGNAL_COUNT && n < MAX_SIGNALS; i++)
+    {
+        if (CAN_DB_Signals[i].msg_id == id)
+        {
+            out[n++] = &CAN_DB_Signals[i];
+        }
+    }
+    return n;
+}
+
+/* --------------------------------------------------------------------------
+ * Checks
+ * -------------------------------------------------------------------------- */
+
+static void check_golden(void)
+{
+    static const uint8_t tlm_expect[6] = { 0x01, 0xC4, 0x06, 0x18, 0x02, 0xD4 };
+    static const uint8_t neg_expect[6] = { 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF6 };
+    static const uint8_t cmd_expect[3] = { 0xD2, 0x54, 0xF6 };
+    CAN_DB_VehicleTelemetry_t t = { 452U, 1560U, 724 };
+    CAN_DB_VehicleCommand_t   c = { 1234U, CAN_DB_VEHICLE_COMMAND_CMD_MODE_SET_TARGET_SPEED, 9U, -3 };
+    uint8_t data[8];
+
+    /* 45.2 km/h, 1560 rpm, 72.4 C: big-endian, as sent since v2.2 */
+    CAN_DB_VehicleTelemetry_Pack(data, &t);
+    check(memcmp(data, tlm_expect, sizeof(tlm_expect)) == 0, "telemetry golden frame");
+
+    t.speed = 0U;
+    t.engine_rpm = 0U;
+    t.coolant_temp = -10;                                       /* -1.0 C */
+    CAN_DB_VehicleTelemetry_Pack(data, &t);
+    check(memcmp(data, neg_expect, sizeof(neg_expect)) == 0, "telemetry negative coolant");
+
+    /* 123.4 km/h, mode 1, alive 9, accel limit -1.5 km/h/s (raw -3) */
+    CAN_DB_VehicleCommand_Pack(data, &c);
+    check(memcmp(data, cmd_expect, sizeof(cmd_expect)) == 0, "command golden frame");
+
+    memset(&c, 0, sizeof(c));
+    CAN_DB_VehicleCommand_Unpack(&c, cmd_expect);
+    check(c.target_speed == 1234U && c.cmd_mode == 1U && c.alive_counter == 9U &&
+          c.accel_limit == -3, "command golden unpack");
+}
+
+static void check_round_trip(void)
+{
+    for (uint32_t m = 0U; m < MSG_COUNT; m++)
+    {
+        const MsgGlue_t *g = &s_msgs[m];
+        const CAN_DB_SignalDesc_t *sig[MAX_SIGNALS];
+        const uint32_t n = msg_signals(g->id, sig);
+        char what[96];
+
+        for (uint32_t it = 0U; it < ROUND_TRIPS; it++)
+        {
+            int64_t raw[MAX_SIGNALS];
+            int64_t back[MAX_SIGNALS];
+            uint8_t gen[8];
+            uint8_t ref[8];
+            uint8_t rnd[8];
+
+            /* raw -> Pack: same bytes as the reference; -> Unpack: same raw */
+            memset(ref, 0, sizeof(ref));
+            for (uint32_t s = 0U; s < n; s++)
+            {
+                raw[s] = ref_random(sig[s]);
+                ref_set(sig[s], ref, raw[s]);
+            }
+            memset(gen, 0xA5, sizeof(gen));
+            g->pack(gen, raw);
+            g->unpack(back, gen);
+
+            snprintf(what, sizeof(what), "%s pack vs reference", g->name);
+            check(memcmp(gen, ref, g->dlc) == 0, what);
+            snprintf(what, sizeof(what), "%s pack/unpack round trip", g->name);
+            check(memcmp(raw, back, n * sizeof(raw[0])) == 0, what);
+
+            /* random payload -> Unpack: same raw as the reference; -> Pack:
+               same bits wherever a signal is defined */
+            for (uint32_t b = 0U; b < 8U; b++)
+            {
+                rnd[b] = (uint8_t)rng_next();
+            }
+            g->unpack(back, rnd);
+            memset(ref, 0, sizeof(ref));
+            for (uint32_t s = 0U; s < n; s++)
+            {
+                snprintf(what, sizeof(what), "%s unpack vs reference", g->name);
+                check(back[s] == ref_get(sig[s], rnd), what);
+                ref_set(sig[s], ref, ref_get(sig[s], rnd));
+            }
+            g->pack(gen, back);
+            snprintf(what, sizeof(what), "%s unpack/pack round trip", g->name);
+            check(memcmp(gen, ref, g->dlc) == 0, what);
+        }
+        printf("  %-18s: %u signals, %u round trips each way\n",
+               g->name, (unsigned)n, (unsigned)ROUND_TRIPS);
+    }
+}
+
+static void check_physical(void)
+{
+    /* Sweep each signal across and beyond its range */
+    for (float v = -50.0f; v <= 7000.0f; v += 0.37f)
+    {
+        const float spd = CAN_DB_VehicleTelemetry_Speed_Decode(
+                              CAN_DB_VehicleTelemetry_Speed_Encode(v));
+        const float tmp = CAN_DB_VehicleTelemetry_CoolantTemp_Decode(
+                              CAN_DB_VehicleTelemetry_CoolantTemp_Encode(v - 3500.0f));
+        const float tgt = CAN_DB_VehicleCommand_TargetSpeed_Decode(
+                              CAN_DB_VehicleCommand_TargetSpeed_Encode(v / 10.0f));
+
+        check(fabsf(spd - fminf(fmaxf(v, 0.0f), 6553.5f)) <= 0.05f + 1e-3f * fabsf(v),
+              "Speed encode/decode");
+        check(fabsf(tmp - fminf(fmaxf(v - 3500.0f, -3276.8f), 3276.7f)) <=
+              0.05f + 1e-3f * fabsf(v), "CoolantTemp encode/decode");
+        check(fabsf(tgt - fminf(fmaxf(v / 10.0f, 0.0f), 409.5f)) <= 0.05f + 1e-4f * fabsf(v),
+              "TargetSpeed encode/decode");
+    }
+    for (float v = -40.0f; v <= 40.0f; v += 0.125f)
+    {
+        const float acc = CAN_DB_VehicleCommand_AccelLimit_Decode(
+                              CAN_DB_VehicleCommand_AccelLimit_Encode(v));
+        check(fabsf(acc - fminf(fmaxf(v, -16.0f), 15.5f)) <= 0.25f, "AccelLimit encode/decode");
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Cost
+ * -------------------------------------------------------------------------- */
+
+/* The hand-written packing CAN_IF_SendTelemetry() used before can_db.h */
+static void legacy_pack(uint8_t data[8], const CAN_DB_VehicleTelemetry_t *m)
+{
+    data[0] = (uint8_t)(m->speed >> 8);
+    data[1] = (uint8_t)(m->speed & 0xFF);
+    data[2] = (uint8_t)(m->engine_rpm >> 8);
+    data[3] = (uint8_t)(m->engine_rpm & 0xFF);
+    data[4] = (uint8_t)((uint16_t)m->coolant_temp >> 8);
+    data[5] = (uint8_t)((uint16_t)m->coolant_temp & 0xFF);
+}
+
+static void legacy_unpack(CAN_DB_VehicleTelemetry_t *m, const uint8_t data[8])
+{
+    m->speed        = (uint16_t)((data[0] << 8) | data[1]);
+    m->engine_rpm   = (uint16_t)((data[2] << 8) | data[3]);
+    m->coolant_temp = (int16_t)((data[4] << 8) | data[5]);
+}
+
+#define FRAME_SET  1024U
+
+static void bench(uint32_t frames)
+{
+    static CAN_DB_VehicleTelemetry_t in[FRAME_SET];
+    static uint8_t buf[FRAME_SET][8];
+    const CAN_DB_SignalDesc_t *sig[MAX_SIGNALS];
+    const uint32_t n = msg_signals(CAN_DB_VEHICLE_TELEMETRY_ID, sig);
+    volatile uint32_t sink;
+    uint32_t acc = 0U;
+    double t0;
+
+    for (uint32_t i = 0U; i < FRAME_SET; i++)
+    {
+        in[i].speed        = (uint16_t)rng_next();
+        in[i].engine_rpm   = (uint16_t)rng_next();
+        in[i].coolant_temp = (int16_t)rng_next();
+    }
+
+    printf("  %u frames (VehicleTelemetry), ns per frame:\n", (unsigned)frames);
+
+#define TIME_LOOP(label, body)                                               \
+    do                                                                       \
+    {                                                                        \
+        t0 = now_ns();                                                       \
+        for (uint32_t f = 0U; f < frames; f++)                               \
+        {                                                                    \
+            const uint32_t i = f & (FRAME_SET - 1U);                         \
+            body;                                                            \
+        }                                                                    \
+        printf("    %-26s %6.2f\n", label, (now_ns() - t0) / frames);        \
+    } while (0)
+
+    TIME_LOOP("pack   generated", CAN_DB_VehicleTelemetry_Pack(buf[i], &in[i]));
+    acc ^= buf[frames & (FRAME_SET - 1U)][1];
+    TIME_LOOP("pack   hand-written", legacy_pack(buf[i], &in[i]));
+    acc ^= buf[frames & (FRAME_SET - 1U)][3];
+    TIME_LOOP("pack   bitwise reference", {
+        memset(buf[i], 0, 8U);
+        ref_set(sig[0], buf[i], in[i].speed);
+        ref_set(sig[1], buf[i], in[i].engine_rpm);
+        ref_set(sig[2], buf[i], in[i].coolant_temp);
+    });
+    acc ^= buf[frames & (FRAME_SET - 1U)][5];
+
+    TIME_LOOP("unpack generated", {
+        CAN_DB_VehicleTelemetry_t m;
+        CAN_DB_VehicleTelemetry_Unpack(&m, buf[i]);
+        acc += m.speed ^ m.engine_rpm ^ (uint16_t)m.coolant_temp;
+    });
+    TIME_LOOP("unpack hand-written", {
+        CAN_DB_VehicleTelemetry_t m;
+        legacy_unpack(&m, buf[i]);
+        acc += m.speed ^ m.engine_rpm ^ (uint16_t)m.coolant_temp;
+    });
+    TIME_LOOP("unpack bitwise reference", {
+        for (uint32_t s = 0U; s < n; s++)
+        {
+            acc += (uint32_t)ref_get(sig[s], buf[i]);
+        }
+    });
+#undef TIME_LOOP
+
+    sink = acc;
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = 1000000U;
+
+    if (argc > 1)
+    {
+        frames = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    printf("bench_cancodec: can_db.h generated codec, %u signals\n",
+           (unsigned)CAN_DB_SIGNAL_COUNT);
+    check_golden();
+    check_round_trip();
+    check_physical();
+    bench(frames);
+
+    if (s_fail != 0U)
+    {
+        printf("bench_cancodec: %u check(s) FAILED\n", (unsigned)s_fail);
+        return 1;
+    }
+    printf("bench_cancodec: all checks passed\n");
+    return 0;
+}
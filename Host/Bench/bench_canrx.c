@@ -0,0 +1,254 @@
+/**
+ * @file    bench_canrx.c
+ * @brief   CAN RX path benchmark: ISR-to-task latency and sustained rate.
+ *
+ * Boots the full firmware and offers CAN frames to FIFO0 from a host
+ * thread, then reports the CAN_IF RX counters (can_if.h):
+ *
+ *   flood  - frames are injected as fast as FIFO0 accepts them; measures
+ *            the maximum sustained frames/s through ISR + CanRxTask.
+ *   paced  - one frame at a time, the next only after CanRxTask has taken
+ *            the previous one; measures ISR-to-task latency without
+ *            queueing delay. Runs in real time (the idle task would
+ *            otherwise advance virtual time between frames).
+ *   burst  - like paced, but three frames back to back (a full FIFO0),
+ *            so the batch drain in the RX ISR shows up.
+ *
+ * Every payload carries the injection time (cyccnt.h) in bytes 4..7. An
+ * override of CAN_IF_RxFrameCallback() turns it into the end-to-end
+ * latency: injection into FIFO0 -> CanRxTask, FIFO waiting time included.
+ *
+ * In flood mode every 16th frame uses a control ID (CAN_IF_CTRL_ID_FIRST..
+ * LAST), which the default filter table routes to FIFO1 / CanCtrlTask, so
+ * the control path is measured under full bulk load. Each frame's FIFO and
+ * matching rule are checked against the table; a misrouted frame makes the
+ * benchmark exit with status 1.
+ *
+ * Built twice: bench_canrx (SPSC ring, the default RX path) and
+ * bench_canrx_queue (CAN_IF_RX_QUEUE=1, the former 8-deep osMessageQueue).
+ * Latencies are host wall-clock time (Host/Inc/cyccnt.h).
+ *
+ * Usage: bench_canrx [run_ms] [flood|paced|burst]   (default 5000 flood)
+ *        VECU_HOST_SPEED=0 for free-running virtual time (recommended
+ *        for flood).
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "main.h"
+#include "can_if.h"
+#include "cyccnt.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+typedef enum { LOAD_FLOOD, LOAD_PACED, LOAD_BURST } Load_t;
+
+static const char *const s_loadName[] = { "flood", "paced", "burst" };
+
+static uint32_t        s_runMs = 5000U;
+static Load_t          s_load  = LOAD_FLOOD;
+static struct timespec s_wallStart;
+
+#define BULK_ID   0x200U
+#define CTRL_ID   0x080U
+#define CTRL_EVERY 16U
+
+/* End-to-end latency per FIFO, each written by that FIFO's task only */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} E2e_t;
+
+static E2e_t    s_e2e[2] = { { 0U, UINT32_MAX, 0U, 0U }, { 0U, UINT32_MAX, 0U, 0U } };
+static uint32_t s_misrouted;
+
+void CAN_IF_RxFrameCallback(const CAN_IF_Msg_t *msg)
+{
+    const uint32_t ctrl = (msg->id >= CAN_IF_CTRL_ID_FIRST &&
+                           msg->id <= CAN_IF_CTRL_ID_LAST) ? 1U : 0U;
+    uint32_t sent;
+
+    /* Default table: rule 0 = control range -> FIFO1, rule 1 = other std IDs */
+    if (msg->ide || msg->fifo != ctrl || CAN_IF_RxRule(msg) != (ctrl ? 0 : 1))
+    {
+        s_misrouted++;
+    }
+
+    if (msg->dlc < 8U || msg->fifo > 1U)
+    {
+        return;
+    }
+    memcpy(&sent, &msg->data[4], sizeof(sent));
+
+    E2e_t *e = &s_e2e[msg->fifo];
+    uint32_t lat = CYCCNT_Read() - sent;
+    e->count++;
+    e->sum += lat;
+    if (lat < e->min) e->min = lat;
+    if (lat > e->max) e->max = lat;
+}
+
+static void uart_null_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)data;
+    (void)len;
+    (void)ctx;
+}
+
+static void inject(uint8_t data[8], uint32_t *n, uint32_t id)
+{
+    uint32_t now = CYCCNT_Read();
+
+    data[0] = (uint8_t)(*n)++;
+    memcpy(&data[4], &now, sizeof(now));
+    (void)HOST_CAN_InjectFrameBlocking(id, 8U, data);
+}
+
+static void *can_feeder(void *arg)
+{
+    uint8_t data[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+    uint32_t n = 0U;
+
+    (void)arg;
+    for (;;)
+    {
+        if (s_load == LOAD_FLOOD)
+        {
+            inject(data, &n, ((n % CTRL_EVERY) == 0U) ? CTRL_ID : BULK_ID);
+            continue;
+        }
+
+        CAN_IF_RxStats_t st;
+        CAN_IF_GetRxStats(CAN_RX_FIFO0, &st);
+        const uint32_t target = st.processed + ((s_load == LOAD_BURST) ? 3U : 1U);
+        for (uint32_t i = (s_load == LOAD_BURST) ? 3U : 1U; i > 0U; i--)
+        {
+            inject(data, &n, BULK_ID);
+        }
+        do
+        {
+            sched_yield();
+            CAN_IF_GetRxStats(CAN_RX_FIFO0, &st);
+        } while ((int32_t)(st.processed - target) < 0);
+    }
+    return NULL;
+}
+
+static double wall_ms_since(const struct timespec *t0)
+{
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (double)(t1.tv_sec - t0->tv_sec) * 1e3 +
+           (double)(t1.tv_nsec - t0->tv_nsec) / 1e6;
+}
+
+static double cyc_to_us(double cycles)
+{
+    return cycles * 1e6 / (double)SystemCoreClock;
+}
+
+static void print_latency(const char *label, uint32_t n, uint32_t min,
+                          uint64_t sum, uint32_t max)
+{
+    if (n != 0U)
+    {
+        printf("  %-19s: min %.2f us  avg %.2f us  max %.2f us\n", label,
+               cyc_to_us(min), cyc_to_us((double)sum / n), cyc_to_us(max));
+    }
+}
+
+/* Runs from the tick that ends the simulation */
+static void report(void)
+{
+    CAN_IF_RxStats_t st;
+    CAN_IF_RxStats_t st1;
+    HOST_CAN_Stats_t hw;
+    const double wall = wall_ms_since(&s_wallStart);
+
+    CAN_IF_GetRxStats(CAN_RX_FIFO0, &st);
+    CAN_IF_GetRxStats(CAN_RX_FIFO1, &st1);
+    HOST_CAN_GetStats(&hw);
+
+    printf("bench_canrx: %s RX path, %s load, %lu ms simulated in %.1f ms wall\n",
+           CAN_IF_RX_QUEUE ? "osMessageQueue(8)" : "SPSC ring",
+           s_loadName[s_load], (unsigned long)s_runMs, wall);
+    printf("  frames processed   : %lu (%.0f /s wall)\n",
+           (unsigned long)st.processed, st.processed / (wall / 1000.0));
+    printf("  frames dropped     : %lu (FIFO0 overruns %lu)\n",
+           (unsigned long)st.dropped, (unsigned long)hw.rx_overruns[0]);
+    if (!CAN_IF_RX_QUEUE)
+    {
+        printf("  ISR batches        : %lu (%.2f frames each, max %lu)\n",
+               (unsigned long)st.batches,
+               st.batches ? (double)st.received / st.batches : 0.0,
+               (unsigned long)st.batch_max);
+        printf("  task wakeups       : %lu (%.2f per frame)\n", (unsigned long)st.wakeups,
+               st.processed ? (double)st.wakeups / st.processed : 0.0);
+    }
+    printf("  peak backlog       : %lu\n", (unsigned long)st.high_water);
+    print_latency("ISR->task latency", st.processed, st.lat_min_cyc,
+                  st.lat_sum_cyc, st.lat_max_cyc);
+    print_latency("FIFO->task latency", s_e2e[0].count, s_e2e[0].min,
+                  s_e2e[0].sum, s_e2e[0].max);
+
+    if (st1.received != 0U)
+    {
+        printf("  FIFO1 (control)    : %lu processed, %lu dropped, %lu overruns, "
+               "peak backlog %lu\n",
+               (unsigned long)st1.processed, (unsigned long)st1.dropped,
+               (unsigned long)hw.rx_overruns[1], (unsigned long)st1.high_water);
+        print_latency("FIFO1 ISR->task", st1.processed, st1.lat_min_cyc,
+                      st1.lat_sum_cyc, st1.lat_max_cyc);
+        print_latency("FIFO1 FIFO->task", s_e2e[1].count, s_e2e[1].min,
+                      s_e2e[1].sum, s_e2e[1].max);
+    }
+
+    if (s_misrouted != 0U)
+    {
+        printf("  FAIL: %lu frames with wrong FIFO / filter rule\n",
+               (unsigned long)s_misrouted);
+        HOST_PORT_Exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t feeder;
+
+    if (argc > 1)
+    {
+        s_runMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    for (int l = 0; argc > 2 && l < 3; l++)
+    {
+        if (strcmp(argv[2], s_loadName[l]) == 0)
+        {
+            s_load = (Load_t)l;
+        }
+    }
+
+    HOST_UART_SetTxSink(USART2, uart_null_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_PORT_StopAfter(s_runMs, report);
+    if (s_load != LOAD_FLOOD)
+    {
+        HOST_PORT_SetTimeScale(1U);
+    }
+
+    pthread_create(&feeder, NULL, can_feeder, NULL);
+    pthread_detach(feeder);
+
+    clock_gettime(CLOCK_MONOTONIC, &s_wallStart);
+    return vecu_firmware_main();
+}
@@ -0,0 +1,257 @@
+/**
+ * @file    bench_cantx.c
+ * @brief   CAN TX path benchmark: priority order and enqueue-to-bus latency.
+ *
+ * Boots the full firmware with extra sender tasks, one per traffic class,
+ * all sending through CAN_IF_Send():
+ *
+ *   ctrl   - ID 0x080, one frame every 20 ms, above-normal task priority.
+ *   bulkN  - IDs 0x300 / 0x310 / 0x320, each a burst of 2 frames every
+ *            50 ms (all three at once), low task priority.
+ *   diag   - extended ID 0x18DAF110, one frame every 20 ms.
+ *
+ * Together with the firmware's own telemetry frame this loads the bus
+ * (31.25 kbit/s with the HSI clock tree in main.c, about 3.5 ms per 8-byte
+ * frame) to roughly 85 %. A ctrl frame is always sent 2 ms after a bulk
+ * burst, while all three mailboxes hold bulk frames, so the TX queue has
+ * to preempt one of them.
+ *
+ * Each payload carries the class sequence number (bytes 0..3) and the tick
+ * it was handed to CAN_IF_Send() (bytes 4..7). A TX tap on the bxCAN model
+ * (HOST_CAN_SetTxTap) sees every frame as it leaves a mailbox and records,
+ * per class:
+ *   - enqueue-to-bus latency in ticks (1 ms)
+ *   - frames out of order within the class
+ *   - priority inversions: a frame put on the bus while a frame with a
+ *     lower ID had been waiting for 2 ticks or more.
+ *
+ * Built twice: bench_cantx (priority TX queue, the default) and
+ * bench_cantx_direct (CAN_IF_TX_QUEUE=0, frames straight into a mailbox).
+ * With the queue, any inversion, reordering or rejected ctrl frame makes
+ * the benchmark exit with status 1.
+ *
+ * Usage: bench_cantx [run_ms]   (default 5000)
+ *        VECU_HOST_SPEED=0 for free-running virtual time (recommended).
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "can_if.h"
+#include "cmsis_os2.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+#define CLASS_COUNT   5U
+#define PEND_LEN      64U   /* enqueue ticks of unsent frames, per class */
+#define INVERSION_TICKS 2U
+
+typedef struct
+{
+    const char   *name;
+    uint32_t      id;
+    uint8_t       ide;
+    osPriority_t  prio;
+    uint32_t      period_ms;
+    uint32_t      phase_ms;
+    uint32_t      burst;
+
+    /* Sender task */
+    atomic_uint   enq;              /* frames accepted by CAN_IF_Send()  */
+    uint32_t      pend[PEND_LEN];   /* enqueue tick by sequence number   */
+    uint32_t      rejected;
+
+    /* TX tap */
+    atomic_uint   sent;
+    uint32_t      reordered;
+    uint32_t      inversions;
+    uint32_t      lat_min;
+    uint32_t      lat_max;
+    uint64_t      lat_sum;
+} TxClass_t;
+
+/* Ordered by bus priority (lowest arbitration key first) */
+static TxClass_t s_class[CLASS_COUNT] = {
+    { .name = "ctrl", .id = 0x080U,      .ide = 0U, .prio = osPriorityAboveNormal,
+      .period_ms = 20U, .phase_ms = 2U, .burst = 1U, .lat_min = UINT32_MAX },
+    { .name = "bulk0", .id = 0x300U,     .ide = 0U, .prio = osPriorityLow,
+      .period_ms = 50U, .phase_ms = 0U, .burst = 2U, .lat_min = UINT32_MAX },
+    { .name = "bulk1", .id = 0x310U,     .ide = 0U, .prio = osPriorityLow,
+      .period_ms = 50U, .phase_ms = 0U, .burst = 2U, .lat_min = UINT32_MAX },
+    { .name = "bulk2", .id = 0x320U,     .ide = 0U, .prio = osPriorityLow,
+      .period_ms = 50U, .phase_ms = 0U, .burst = 2U, .lat_min = UINT32_MAX },
+    { .name = "diag", .id = 0x18DAF110U, .ide = 1U, .prio = osPriorityBelowNormal,
+      .period_ms = 20U, .phase_ms = 15U, .burst = 1U, .lat_min = UINT32_MAX },
+};
+
+static uint32_t s_runMs = 5000U;
+
+static void uart_null_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)data;
+    (void)len;
+    (void)ctx;
+}
+
+static void sender_task(void *argument)
+{
+    TxClass_t *c = (TxClass_t *)argument;
+    uint32_t wake = osKernelGetTickCount() + c->phase_ms;
+    uint8_t data[8];
+
+    for (;;)
+    {
+        (void)osDelayUntil(wake);
+        wake += c->period_ms;
+
+        for (uint32_t i = 0U; i < c->burst; i++)
+        {
+            const uint32_t seq  = atomic_load(&c->enq);
+            const uint32_t tick = osKernelGetTickCount();
+
+            /* Do not overrun the tap's bookkeeping; the TX queue is shorter */
+            if (seq - atomic_load(&c->sent) >= PEND_LEN)
+            {
+                c->rejected++;
+                continue;
+            }
+            memcpy(&data[0], &seq, sizeof(seq));
+            memcpy(&data[4], &tick, sizeof(tick));
+            c->pend[seq % PEND_LEN] = tick;
+
+            if (CAN_IF_Send(c->id, c->ide, data, 8U) == HAL_OK)
+            {
+                atomic_store(&c->enq, seq + 1U);
+            }
+            else
+            {
+                c->rejected++;
+            }
+        }
+    }
+}
+
+/* Every frame leaving a mailbox, in simulated interrupt context */
+static void tx_tap(const CAN_TxHeaderTypeDef *hdr, const uint8_t data[8], void *ctx)
+{
+    const uint32_t id  = (hdr->IDE == CAN_ID_EXT) ? hdr->ExtId : hdr->StdId;
+    const uint32_t now = HAL_GetTick();
+    uint32_t k;
+    uint32_t seq;
+    uint32_t tick;
+
+    (void)ctx;
+    for (k = 0U; k < CLASS_COUNT; k++)
+    {
+        if (s_class[k].id == id && s_class[k].ide == (hdr->IDE == CAN_ID_EXT))
+        {
+            break;
+        }
+    }
+    if (k == CLASS_COUNT)
+    {
+        return;   /* firmware telemetry */
+    }
+
+    TxClass_t *c = &s_class[k];
+    memcpy(&seq, &data[0], sizeof(seq));
+    memcpy(&tick, &data[4], sizeof(tick));
+
+    if (seq != atomic_load(&c->sent))
+    {
+        c->reordered++;
+    }
+    atomic_store(&c->sent, seq + 1U);
+
+    const uint32_t lat = now - tick;
+    c->lat_sum += lat;
+    if (lat < c->lat_min) c->lat_min = lat;
+    if (lat > c->lat_max) c->lat_max = lat;
+
+    /* Oldest unsent frame of each higher-priority class */
+    for (uint32_t h = 0U; h < k; h++)
+    {
+        const uint32_t sent = atomic_load(&s_class[h].sent);
+        if (atomic_load(&s_class[h].enq) != sent &&
+            now - s_class[h].pend[sent % PEND_LEN] >= INVERSION_TICKS)
+        {
+            c->inversions++;
+            break;
+        }
+    }
+}
+
+/* Runs from the tick that ends the simulation */
+static void report(void)
+{
+    CAN_IF_TxStats_t st;
+    uint32_t fail = 0U;
+
+    CAN_IF_GetTxStats(&st);
+
+    printf("bench_cantx: %s TX path, %lu ms\n",
+           CAN_IF_TX_QUEUE ? "priority queue" : "direct mailbox",
+           (unsigned long)s_runMs);
+    printf("  %-6s %8s %8s %8s %9s %9s %9s %6s\n", "class", "sent", "rejected",
+           "reorder", "lat min", "lat avg", "lat max", "inv");
+    for (uint32_t k = 0U; k < CLASS_COUNT; k++)
+    {
+        const TxClass_t *c = &s_class[k];
+        const uint32_t sent = atomic_load(&c->sent);
+
+        printf("  %-6s %8lu %8lu %8lu %6lu ms %6.2f ms %6lu ms %6lu\n", c->name,
+               (unsigned long)sent, (unsigned long)c->rejected,
+               (unsigned long)c->reordered,
+               (unsigned long)(sent ? c->lat_min : 0U),
+               sent ? (double)c->lat_sum / sent : 0.0,
+               (unsigned long)c->lat_max, (unsigned long)c->inversions);
+        fail += c->reordered + c->inversions;
+    }
+    printf("  CAN_IF: queued %lu  sent %lu  busy %lu  preempted %lu  errors %lu"
+           "  peak queue %lu\n",
+           (unsigned long)st.queued, (unsigned long)st.sent,
+           (unsigned long)st.rejected, (unsigned long)st.preempted,
+           (unsigned long)st.errors, (unsigned long)st.high_water);
+
+    fail += s_class[0].rejected;
+    if (CAN_IF_TX_QUEUE && fail != 0U)
+    {
+        printf("  FAIL: priority order violated or ctrl frames rejected\n");
+        HOST_PORT_Exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        s_runMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    HOST_UART_SetTxSink(USART2, uart_null_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_CAN_SetTxTap(tx_tap, NULL);
+    HOST_PORT_StopAfter(s_runMs, report);
+
+    /* Created before the firmware's own tasks; they run once main()
+       starts the scheduler, after CAN_IF_Init(). Lowest bus priority first:
+       equal-priority tasks start in creation order, so the bulk IDs reach
+       the mailboxes highest ID first and fill all three. */
+    osKernelInitialize();
+    for (uint32_t k = CLASS_COUNT; k-- > 0U; )
+    {
+        const osThreadAttr_t attr = {
+            .name       = s_class[k].name,
+            .stack_size = 256U * 4U,
+            .priority   = s_class[k].prio,
+        };
+        (void)osThreadNew(sender_task, &s_class[k], &attr);
+    }
+
+    return vecu_firmware_main();
+}
@@ -0,0 +1,186 @@
+/**
+ * @file    bench_cli.c
+ * @brief   CLI input path benchmark: keystroke-to-echo latency and wakeups.
+ *
+ * Boots the full firmware and types on the console UART from a host task:
+ * a key every 37 ms (so key presses fall at every phase of a 10 ms poll),
+ * 20 keys per line, then Enter. The UART sink time-stamps each echoed key.
+ * Reported:
+ *
+ *   - keystroke-to-echo latency in ticks (1 ms): key put on the RX line
+ *     -> RX interrupt -> CliTask -> echo through the TX ring -> last bit
+ *     on the TX line. The host USART model moves bytes once per tick, so
+ *     the floor is 1-2 ticks either way.
+ *   - CliTask wakeups per second, and how many found no input. Each one
+ *     is a context switch to and from a task above normal priority.
+ *   - host CPU time per wall-clock second for the whole process
+ *     (getrusage), meaningful with VECU_HOST_SPEED=1 (the default here).
+ *
+ * Built twice: bench_cli (RX interrupt wakes CliTask, the default) and
+ * bench_cli_poll (CLI_IF_POLL_MS=10, the former 10 ms polling loop). The
+ * event-driven build exits with status 1 if a key was not echoed, or if
+ * CliTask woke up without input more than once per line.
+ *
+ * Usage: bench_cli [run_ms]   (default 5000)
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "main.h"
+#include "cli_if.h"
+#include "cmsis_os2.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+#define KEY_PERIOD_MS   37U
+#define KEYS_PER_LINE   20U
+#define KEY             'x'     /* not in any CLI reply */
+#define PEND_LEN        64U
+
+static uint32_t        s_runMs = 5000U;
+static uint32_t        s_pend[PEND_LEN];   /* inject tick per key */
+static atomic_uint     s_typed;
+static atomic_uint     s_echoed;
+static uint32_t        s_latMin = UINT32_MAX;
+static uint32_t        s_latMax;
+static uint64_t        s_latSum;
+static uint32_t        s_hist[12];         /* 0..10 ticks, then more */
+static struct timespec s_wall0;
+static struct rusage   s_ru0;
+
+/* Console output: only the echoed keys are of interest */
+static void uart_echo_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    const uint32_t now = HAL_GetTick();
+
+    (void)ctx;
+    for (uint16_t i = 0U; i < len; i++)
+    {
+        if (data[i] != KEY)
+        {
+            continue;
+        }
+        const uint32_t seq = atomic_load(&s_echoed);
+        if (seq == atomic_load(&s_typed))
+        {
+            continue;   /* not ours */
+        }
+        const uint32_t lat = now - s_pend[seq % PEND_LEN];
+        s_latSum += lat;
+        if (lat < s_latMin) s_latMin = lat;
+        if (lat > s_latMax) s_latMax = lat;
+        s_hist[(lat < 11U) ? lat : 11U]++;
+        atomic_store(&s_echoed, seq + 1U);
+    }
+}
+
+static void typist_task(void *argument)
+{
+    static const uint8_t key = KEY;
+    static const uint8_t enter = '\r';
+    uint32_t wake = osKernelGetTickCount() + 100U;   /* after the banner */
+    uint32_t col = 0U;
+
+    (void)argument;
+    for (;;)
+    {
+        (void)osDelayUntil(wake);
+        wake += KEY_PERIOD_MS;
+
+        if (col == KEYS_PER_LINE)
+        {
+            (void)HOST_UART_InjectRx(USART2, &enter, 1U);
+            col = 0U;
+            continue;
+        }
+        const uint32_t seq = atomic_load(&s_typed);
+        s_pend[seq % PEND_LEN] = osKernelGetTickCount();
+        atomic_store(&s_typed, seq + 1U);
+        (void)HOST_UART_InjectRx(USART2, &key, 1U);
+        col++;
+    }
+}
+
+/* Runs from the tick that ends the simulation */
+static void report(void)
+{
+    CLI_IF_Stats_t st;
+    struct timespec wall1;
+    struct rusage ru1;
+
+    CLI_IF_GetStats(&st);
+    clock_gettime(CLOCK_MONOTONIC, &wall1);
+    getrusage(RUSAGE_SELF, &ru1);
+
+    const uint32_t typed  = atomic_load(&s_typed);
+    const uint32_t echoed = atomic_load(&s_echoed);
+    const uint32_t lines  = typed / KEYS_PER_LINE;
+    const double   wall   = (double)(wall1.tv_sec - s_wall0.tv_sec) +
+                            (double)(wall1.tv_nsec - s_wall0.tv_nsec) * 1e-9;
+    const double   cpu    = (double)(ru1.ru_utime.tv_sec - s_ru0.ru_utime.tv_sec) +
+                            (double)(ru1.ru_stime.tv_sec - s_ru0.ru_stime.tv_sec) +
+                            (double)(ru1.ru_utime.tv_usec - s_ru0.ru_utime.tv_usec) * 1e-6 +
+                            (double)(ru1.ru_stime.tv_usec - s_ru0.ru_stime.tv_usec) * 1e-6;
+
+    printf("bench_cli: %s, %lu ms\n",
+           CLI_IF_POLL_MS ? "10 ms polling" : "RX interrupt wakes CliTask",
+           (unsigned long)s_runMs);
+    printf("  keys typed %lu  echoed %lu  RX bytes %lu  RX dropped %lu\n",
+           (unsigned long)typed, (unsigned long)echoed,
+           (unsigned long)st.rx_bytes, (unsigned long)st.rx_dropped);
+    printf("  key->echo: min %lu  avg %.2f  max %lu ticks\n",
+           (unsigned long)(echoed ? s_latMin : 0U),
+           echoed ? (double)s_latSum / echoed : 0.0, (unsigned long)s_latMax);
+    printf("  histogram (ticks):");
+    for (uint32_t i = 0U; i < 12U; i++)
+    {
+        if (s_hist[i] != 0U)
+        {
+            printf(" %s%lu:%lu", (i == 11U) ? ">" : "", (unsigned long)((i == 11U) ? 10U : i),
+                   (unsigned long)s_hist[i]);
+        }
+    }
+    printf("\n");
+    printf("  CliTask wakeups %lu (%.1f /s), %lu without input\n",
+           (unsigned long)st.wakeups, 1000.0 * st.wakeups / s_runMs,
+           (unsigned long)st.idle_wakeups);
+    printf("  host CPU %.1f %% of %.2f s wall\n", 100.0 * cpu / wall, wall);
+
+    /* One spurious wakeup per line at most: the reply may trail the '\r' */
+    if (!CLI_IF_POLL_MS && (typed - echoed > 1U || st.idle_wakeups > lines + 1U))
+    {
+        printf("  FAIL: lost echo or idle wakeups\n");
+        HOST_PORT_Exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        s_runMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    HOST_UART_SetTxSink(USART2, uart_echo_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_PORT_StopAfter(s_runMs, report);
+    clock_gettime(CLOCK_MONOTONIC, &s_wall0);
+    getrusage(RUSAGE_SELF, &s_ru0);
+
+    osKernelInitialize();
+    const osThreadAttr_t attr = {
+        .name       = "typist",
+        .stack_size = 256U * 4U,
+        .priority   = osPriorityLow,
+    };
+    (void)osThreadNew(typist_task, NULL, &attr);
+
+    return vecu_firmware_main();
+}
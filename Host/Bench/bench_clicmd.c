@@ -0,0 +1,217 @@
+/**
+ * @file    bench_clicmd.c
+ * @brief   CLI dispatcher: routing conformance and lookup cost vs table size.
+ *
+ * Links the firmware objects with SYN_COUNT extra commands registered here
+ * through CLI_IF_CMD() ("bench 00" .. "bench bf", one u32 argument each,
+ * no help line), so the descriptor table holds a few hundred entries. The
+ * kernel is not started: CLI_IF_Init() only indexes the table, and
+ * CLI_IF_Exec() runs handlers in the calling thread.
+ *
+ * 1. Conformance: CLI_IF_Find() returns the right descriptor for every
+ *    command in the table and NULL for names not in it; CLI_IF_Exec()
+ *    calls the right handler with the parsed argument, and no handler for
+ *    unknown commands or arguments that do not match the schema.
+ * 2. Cost per lookup, read from the TSC on x86 (nanoseconds elsewhere),
+ *    for every command name:
+ *      hash    - CLI_IF_Find()
+ *      linear  - strcmp() over the descriptor table, the cost model of the
+ *                former if/else chain
+ *    Reported as mean and worst case over the table. The hash stays flat
+ *    as commands are added; the linear scan grows with the table.
+ *
+ * Usage: bench_clicmd [reps]   (default 2000)
+ * Exit status is 1 if any lookup or dispatch is wrong.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#include "cli_if.h"
+
+extern const CLI_IF_Cmd_t __start_cli_cmds[];
+extern const CLI_IF_Cmd_t __stop_cli_cmds[];
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* --------------------------------------------------------------------------
+ * Synthetic commands: 12 x 16 of them
+ * -------------------------------------------------------------------------- */
+
+static uint32_t s_hit;     /* id of the last synthetic handler run, + 1 */
+static uint32_t s_arg;
+
+#define SYN(a, b)                                                          \
+    static void syn_##a##b(const CLI_IF_Args_t *args)                      \
+    {                                                                      \
+        s_hit = 0x##a##b##U + 1U;                                          \
+        s_arg = args->argv[0].u;                                           \
+    }                                                                      \
+    CLI_IF_CMD(syn_##a##b, "bench " #a #b, "u:value", syn_##a##b, NULL)
+
+#define SYN16(hi)                                                          \
+    SYN(hi, 0); SYN(hi, 1); SYN(hi, 2); SYN(hi, 3); SYN(hi, 4); SYN(hi, 5); \
+    SYN(hi, 6); SYN(hi, 7); SYN(hi, 8); SYN(hi, 9); SYN(hi, a); SYN(hi, b); \
+    SYN(hi, c); SYN(hi, d); SYN(hi, e); SYN(hi, f)
+
+SYN16(0); SYN16(1); SYN16(2); SYN16(3); SYN16(4); SYN16(5);
+SYN16(6); SYN16(7); SYN16(8); SYN16(9); SYN16(a); SYN16(b);
+
+#define SYN_COUNT   (12U * 16U)
+
+/* --------------------------------------------------------------------------
+ * Conformance
+ * -------------------------------------------------------------------------- */
+
+static uint32_t s_fail;
+
+static void check(int ok, const char *what, const char *detail)
+{
+    if (!ok)
+    {
+        printf("  FAIL: %s: %s\n", what, detail);
+        s_fail++;
+    }
+}
+
+/* Run one line; returns the synthetic handler that ran (+ 1), or 0 */
+static uint32_t exec(const char *text)
+{
+    char line[CLI_IF_LINE_LEN];
+
+    snprintf(line, sizeof(line), "%s", text);
+    s_hit = 0U;
+    s_arg = 0U;
+    CLI_IF_Exec(line);
+    return s_hit;
+}
+
+static void conformance(uint32_t total)
+{
+    static const char *const missing[] = {
+        "", "bench", "bench c0", "bench 0", "bench 000", "bench0", "help x", "veh",
+    };
+    char line[CLI_IF_LINE_LEN];
+
+    for (uint32_t i = 0U; i < total; i++)
+    {
+        const CLI_IF_Cmd_t *cmd = &__start_cli_cmds[i];
+        check(CLI_IF_Find(cmd->name) == cmd, "find", cmd->name);
+    }
+    for (uint32_t i = 0U; i < sizeof(missing) / sizeof(missing[0]); i++)
+    {
+        check(CLI_IF_Find(missing[i]) == NULL, "find (not a command)", missing[i]);
+    }
+
+    for (uint32_t id = 0U; id < SYN_COUNT; id++)
+    {
+        snprintf(line, sizeof(line), "  bench %02lx   %lu ", (unsigned long)id,
+                 (unsigned long)(id * 7U));
+        check(exec(line) == id + 1U && s_arg == id * 7U, "exec", line);
+    }
+    check(exec("bench 2a 0x10") == 0x2aU + 1U && s_arg == 16U, "exec", "hex argument");
+    check(exec("bench 2a") == 0U, "exec (missing argument)", "bench 2a");
+    check(exec("bench 2a 1 2") == 0U, "exec (extra argument)", "bench 2a 1 2");
+    check(exec("bench 2a 12z") == 0U, "exec (bad argument)", "bench 2a 12z");
+    check(exec("bench c0 1") == 0U, "exec (unknown)", "bench c0 1");
+    check(exec("bench 1 2 3 4 5 6 7 8 9") == 0U, "exec (too many words)", "bench 1 ...");
+}
+
+/* --------------------------------------------------------------------------
+ * Lookup cost
+ * -------------------------------------------------------------------------- */
+
+static const CLI_IF_Cmd_t *find_linear(const char *name)
+{
+    for (const CLI_IF_Cmd_t *cmd = __start_cli_cmds; cmd < __stop_cli_cmds; cmd++)
+    {
+        if (strcmp(cmd->name, name) == 0)
+        {
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+typedef const CLI_IF_Cmd_t *(*Finder_t)(const char *name);
+
+static void measure(const char *label, Finder_t find, uint32_t total, uint32_t reps)
+{
+    volatile uintptr_t sink = 0U;
+    double sum = 0.0;
+    double worst = 0.0;
+
+    for (uint32_t i = 0U; i < total; i++)
+    {
+        const char *name = __start_cli_cmds[i].name;
+        const uint64_t t0 = ticks();
+        for (uint32_t r = 0U; r < reps; r++)
+        {
+            sink += (uintptr_t)find(name);
+        }
+        const double per = (double)(ticks() - t0) / reps;
+        sum += per;
+        if (per > worst)
+        {
+            worst = per;
+        }
+    }
+    (void)sink;
+    printf("  %-7s mean %7.1f  worst %7.1f " BENCH_UNIT "/lookup\n",
+           label, sum / total, worst);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reps = 2000U;
+
+    if (argc > 1)
+    {
+        reps = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (reps == 0U)
+    {
+        reps = 1U;
+    }
+
+    CLI_IF_Init(NULL, NULL);   /* no console: index only */
+
+    const uint32_t total = (uint32_t)(__stop_cli_cmds - __start_cli_cmds);
+
+    printf("bench_clicmd: %lu commands (%lu firmware + %lu synthetic), %lu hash slots\n",
+           (unsigned long)total, (unsigned long)(total - SYN_COUNT),
+           (unsigned long)SYN_COUNT, (unsigned long)CLI_IF_HASH_SLOTS);
+    printf("  table %lu B const, index %lu B RAM\n",
+           (unsigned long)(total * sizeof(CLI_IF_Cmd_t)),
+           (unsigned long)(CLI_IF_HASH_SLOTS * 2U + CLI_IF_HASH_SLOTS / 2U * 2U));
+
+    conformance(total);
+    measure("hash", CLI_IF_Find, total, reps);
+    measure("linear", find_linear, total, reps);
+
+    if (s_fail != 0U)
+    {
+        printf("  %lu failures\n", (unsigned long)s_fail);
+        return 1;
+    }
+    printf("  routing OK\n");
+    return 0;
+}
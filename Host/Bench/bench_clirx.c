@@ -0,0 +1,220 @@
+/**
+ * @file    bench_clirx.c
+ * @brief   CLI receive path benchmark: sustained input at high baud rates.
+ *
+ * Boots the full firmware, raises the console UART to a high baud rate and
+ * feeds CLI command lines on the RX line from a host task:
+ *
+ *   - first half of the run: back to back, at the full line rate;
+ *   - second half: bursts of BURST_LINES lines every BURST_MS ms, so the
+ *     line also goes idle between bursts;
+ *   - last 200 ms: nothing, so the CLI can catch up; then one injected
+ *     framing error followed by a final line, to check that reception
+ *     recovers.
+ *
+ * Reported: bytes and lines sent vs received and parsed, RX drops and UART
+ * errors, RX interrupts (events) per KiB, IDLE events and CliTask wakeups.
+ *
+ * Runs in virtual time unless VECU_HOST_SPEED is set: at wall-clock pace a
+ * host scheduling hiccup of a few ms lets the line model run on while
+ * CliTask is not running at all, which on target its priority rules out.
+ *
+ * The baud rate is a host-model setting only: the host USART moves
+ * baud/10 bytes per ms whatever the clock tree. On the target, USART2 runs
+ * from the 8 MHz APB1 clock and tops out well below 921600 baud.
+ *
+ * Built twice: bench_clirx (circular DMA with IDLE events, the default) and
+ * bench_clirx_it (CLI_IF_RX_DMA=0, the former interrupt per byte). The DMA
+ * build exits with status 1 if any byte was dropped or any line was not
+ * parsed.
+ *
+ * Usage: bench_clirx [run_ms] [baud]   (default 3000 921600)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "cli_if.h"
+#include "cmsis_os2.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+extern UART_HandleTypeDef huart2;
+
+#define START_MS      100U     /* after the banner */
+#define QUIET_MS      200U     /* no input at the end of the run */
+#define BURST_LINES   16U
+#define BURST_MS      4U
+
+static const char *const s_script[] = {
+    "veh speed 40\r",
+    "veh speed 60\r",
+};
+#define SCRIPT_LEN    (sizeof(s_script) / sizeof(s_script[0]))
+
+static uint32_t        s_runMs = 3000U;
+static uint32_t        s_baud  = 921600U;
+static uint32_t        s_sentBytes;
+static uint32_t        s_sentLines;
+static uint32_t        s_lines0;          /* lines parsed before the feed */
+
+/* Console output is not checked; keep stdout quiet */
+static void uart_null_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)data;
+    (void)len;
+    (void)ctx;
+}
+
+/* Queue as much of the script as the RX line takes; stops after max lines */
+static void feed(uint32_t *line, uint32_t *col, uint32_t max_lines)
+{
+    uint32_t done = 0U;
+
+    while (done < max_lines)
+    {
+        const char *s = s_script[*line % SCRIPT_LEN];
+        const size_t left = strlen(s) - *col;
+        const size_t n = HOST_UART_InjectRx(USART2, (const uint8_t *)&s[*col], left);
+
+        s_sentBytes += (uint32_t)n;
+        if (n < left)
+        {
+            *col += (uint32_t)n;
+            return;   /* line buffer full: continue next tick */
+        }
+        *col = 0U;
+        (*line)++;
+        s_sentLines++;
+        done++;
+    }
+}
+
+static void feeder_task(void *argument)
+{
+    const uint32_t t0    = osKernelGetTickCount();
+    const uint32_t half  = t0 + START_MS + (s_runMs - START_MS - QUIET_MS) / 2U;
+    const uint32_t quiet = t0 + s_runMs - QUIET_MS;
+    uint32_t line = 0U;
+    uint32_t col  = 0U;
+    CLI_IF_Stats_t st;
+
+    (void)argument;
+    (void)osDelay(START_MS);
+    huart2.Init.BaudRate = s_baud;
+    CLI_IF_GetStats(&st);
+    s_lines0 = st.lines;
+
+    /* Back to back: keep the host line buffer topped up */
+    while (osKernelGetTickCount() < half)
+    {
+        feed(&line, &col, UINT32_MAX);
+        (void)osDelay(1U);
+    }
+
+    /* Bursts with idle gaps */
+    uint32_t wake = osKernelGetTickCount();
+    while (osKernelGetTickCount() < quiet - BURST_MS)
+    {
+        uint32_t queued = 0U;
+        while (col != 0U || queued < BURST_LINES)
+        {
+            const uint32_t before = s_sentLines;
+            feed(&line, &col, BURST_LINES - queued);
+            queued += s_sentLines - before;
+            if (col != 0U || queued < BURST_LINES)
+            {
+                (void)osDelay(1U);
+            }
+        }
+        wake += BURST_MS;
+        (void)osDelayUntil(wake);
+    }
+
+    /* Let the CLI drain, then a byte with a framing error and one more line */
+    (void)osDelay(QUIET_MS / 2U);
+    HOST_UART_InjectError(USART2, HAL_UART_ERROR_FE);
+    (void)HOST_UART_InjectRx(USART2, (const uint8_t *)"\r", 1U);   /* lost */
+    (void)osDelay(5U);
+    feed(&line, &col, 1U);
+
+    for (;;)
+    {
+        (void)osDelay(1000U);
+    }
+}
+
+/* Runs from the tick that ends the simulation */
+static void report(void)
+{
+    CLI_IF_Stats_t st;
+
+    CLI_IF_GetStats(&st);
+
+    const uint32_t lines = st.lines - s_lines0;
+    const uint32_t bytes = s_sentBytes + 1U;   /* + the errored byte */
+
+    printf("bench_clirx: %s, %lu ms, %lu baud\n",
+           CLI_IF_RX_DMA ? "circular DMA + IDLE" : "interrupt per byte",
+           (unsigned long)s_runMs, (unsigned long)s_baud);
+    printf("  sent %lu bytes / %lu lines  received %lu bytes  parsed %lu lines\n",
+           (unsigned long)bytes, (unsigned long)s_sentLines,
+           (unsigned long)st.rx_bytes, (unsigned long)lines);
+    printf("  dropped %lu  ore %lu  fe %lu  ne %lu\n",
+           (unsigned long)st.rx_dropped, (unsigned long)st.rx_overrun,
+           (unsigned long)st.rx_framing, (unsigned long)st.rx_noise);
+    printf("  RX interrupts %lu (%.1f per KiB), %lu IDLE, %.1f bytes each\n",
+           (unsigned long)st.rx_events,
+           st.rx_bytes ? 1024.0 * st.rx_events / st.rx_bytes : 0.0,
+           (unsigned long)st.rx_idle,
+           st.rx_events ? (double)st.rx_bytes / st.rx_events : 0.0);
+    printf("  CliTask wakeups %lu, %lu without input\n",
+           (unsigned long)st.wakeups, (unsigned long)st.idle_wakeups);
+
+    /* The errored byte never reaches the ring */
+    if (CLI_IF_RX_DMA &&
+        (st.rx_dropped != 0U || st.rx_overrun != 0U || st.rx_framing != 1U ||
+         lines != s_sentLines || st.rx_bytes + 1U < bytes))
+    {
+        printf("  FAIL: input lost\n");
+        HOST_PORT_Exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        s_runMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        s_baud = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (s_runMs < START_MS + QUIET_MS + 100U)
+    {
+        s_runMs = START_MS + QUIET_MS + 100U;
+    }
+
+    if (getenv("VECU_HOST_SPEED") == NULL)
+    {
+        HOST_PORT_SetTimeScale(0U);
+    }
+    HOST_UART_SetTxSink(USART2, uart_null_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_PORT_StopAfter(s_runMs, report);
+
+    osKernelInitialize();
+    const osThreadAttr_t attr = {
+        .name       = "feeder",
+        .stack_size = 256U * 4U,
+        .priority   = osPriorityLow,
+    };
+    (void)osThreadNew(feeder_task, NULL, &attr);
+
+    return vecu_firmware_main();
+}
@@ -0,0 +1,471 @@
+/**
+ * @file    bench_dlog.c
+ * @brief   Deferred logger: output conformance and cycles per log call.
+ *
+ * Links dlog.c and dlog_fmt.c on their own, with the console UART replaced
+ * by a capture buffer (UART_TX_* below), so only the logger is measured.
+ * CLI_IF_Print() is stubbed for the logger's own CLI commands, which the
+ * bench does not run.
+ *
+ * 1. Conformance: random CAN frames (standard and extended IDs, DLC 0..8,
+ *    telemetry and command frames with random payloads) and the CAN_IF
+ *    start-up messages are logged the way can_if.c records them. The text
+ *    from DLOG_Process() in text mode, and from DLOG_Decode() +
+ *    DLOG_Format() on a binary-mode capture, must both match the
+ *    snprintf() lines the former CAN_IF_ProcessRxMsg() printed (kept below
+ *    as the reference) byte for byte.
+ * 2. Cost per call site, read from the TSC on x86 (nanoseconds elsewhere):
+ *      snprintf  - the former RX log line: header + one snprintf per data
+ *                  byte + decode line, into a buffer
+ *      dlog      - the same frame as records (DLOG5 + decode record)
+ *      DLOG0     - smallest record
+ *    and the deferred cost per record in DLOG_Process() (text / binary).
+ *    On the Cortex-M4 the same loops can be timed with DWT->CYCCNT.
+ *
+ * Usage: bench_dlog [frames]   (default 200000)
+ * Exit status is non-zero if any line differs from the reference.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#include "can_db.h"
+#include "dlog.h"
+#include "uart_tx.h"
+#include "cli_if.h"
+
+/* cyccnt.h on the host scales the monotonic clock to the core clock */
+uint32_t SystemCoreClock = 16000000U;
+
+#define BATCH       32U          /* records per timed batch (< DLOG_RING_LEN) */
+#define CAPTURE_LEN (64U * 1024U)
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t s_rng = 1U;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1664525U + 1013904223U;
+    return s_rng >> 8;
+}
+
+/* --------------------------------------------------------------------------
+ * Console UART stand-in: everything written lands in s_cap
+ * -------------------------------------------------------------------------- */
+
+static uint8_t  s_cap[CAPTURE_LEN];
+static uint32_t s_capLen;
+
+uint32_t UART_TX_Write(const void *data, uint32_t len)
+{
+    if (len > CAPTURE_LEN - s_capLen)
+    {
+        return 0U;
+    }
+    memcpy(&s_cap[s_capLen], data, len);
+    s_capLen += len;
+    return len;
+}
+
+uint32_t UART_TX_Free(void)
+{
+    return CAPTURE_LEN - s_capLen;
+}
+
+void UART_TX_Flush(void)
+{
+}
+
+void CLI_IF_Print(const char *s)
+{
+    (void)UART_TX_Write(s, (uint32_t)strlen(s));
+}
+
+/* --------------------------------------------------------------------------
+ * Frames and the two logging paths
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uint32_t id;
+    uint8_t  ide;
+    uint8_t  dlc;
+    uint8_t  data[8];
+} Frame_t;
+
+static void make_frame(Frame_t *f)
+{
+    const uint32_t kind = rng_next() % 4U;
+
+    memset(f, 0, sizeof(*f));
+    f->ide = (kind == 3U) ? 1U : 0U;
+    f->id  = f->ide ? (rng_next() & 0x1FFFFFFFU) : (rng_next() & 0x7FFU);
+    f->dlc = (uint8_t)(rng_next() % 9U);
+    if (kind == 0U)
+    {
+        f->id  = CAN_DB_VEHICLE_TELEMETRY_ID;
+        f->dlc = CAN_DB_VEHICLE_TELEMETRY_DLC;
+    }
+    else if (kind == 1U)
+    {
+        f->id  = CAN_DB_VEHICLE_COMMAND_ID;
+        f->dlc = CAN_DB_VEHICLE_COMMAND_DLC;
+    }
+    for (uint32_t i = 0U; i < f->dlc; i++)
+    {
+        f->data[i] = (uint8_t)rng_next();
+    }
+}
+
+/* Reference: the former CAN_IF_ProcessRxMsg() formatting, unchanged */
+static int ref_decode(const Frame_t *msg, char *buf, size_t size)
+{
+    if (msg->ide)
+    {
+        return 0;
+    }
+
+    if (msg->id == CAN_DB_VEHICLE_TELEMETRY_ID && msg->dlc >= CAN_DB_VEHICLE_TELEMETRY_DLC)
+    {
+        CAN_DB_VehicleTelemetry_t t;
+        CAN_DB_VehicleTelemetry_Unpack(&t, msg->data);
+        const int32_t temp10 = t.coolant_temp;
+        return snprintf(buf, size,
+                        "  Telemetry: speed=%u.%u kph rpm=%u coolant=%s%ld.%ld C\r\n",
+                        (unsigned int)(t.speed / 10U), (unsigned int)(t.speed % 10U),
+                        (unsigned int)t.engine_rpm,
+                        (temp10 < 0) ? "-" : "",
+                        (long)(labs(temp10) / 10), (long)(labs(temp10) % 10));
+    }
+
+    if (msg->id == CAN_DB_VEHICLE_COMMAND_ID && msg->dlc >= CAN_DB_VEHICLE_COMMAND_DLC)
+    {
+        CAN_DB_VehicleCommand_t c;
+        CAN_DB_VehicleCommand_Unpack(&c, msg->data);
+        const int32_t accel10 = (int32_t)c.accel_limit * 5;
+        return snprintf(buf, size,
+                        "  Command: mode=%u target=%u.%u kph accel_limit=%s%ld.%ld kph/s alive=%u\r\n",
+                        (unsigned int)c.cmd_mode,
+                        (unsigned int)(c.target_speed / 10U),
+                        (unsigned int)(c.target_speed % 10U),
+                        (accel10 < 0) ? "-" : "",
+                        (long)(labs(accel10) / 10), (long)(labs(accel10) % 10),
+                        (unsigned int)c.alive_counter);
+    }
+
+    return 0;
+}
+
+static int ref_line(const Frame_t *msg, char *buf, size_t size)
+{
+    int len = snprintf(buf, size,
+                       msg->ide ? "CAN RX: ID=0x%08lX DLC=%u Data="
+                                : "CAN RX: ID=0x%03lX DLC=%u Data=",
+                       (unsigned long)msg->id,
+                       (unsigned int)msg->dlc);
+
+    for (uint8_t i = 0; i < msg->dlc; i++)
+    {
+        len += snprintf(&buf[len], size - (size_t)len, "%02X ", msg->data[i]);
+    }
+    len += snprintf(&buf[len], size - (size_t)len, "\r\n");
+    len += ref_decode(msg, &buf[len], size - (size_t)len);
+    if (len >= (int)size)
+    {
+        len = (int)size - 1;
+    }
+    return len;
+}
+
+/* The records CAN_IF_ProcessRxMsg() now writes (can_if.c) */
+static void dlog_line(const Frame_t *msg)
+{
+    uint32_t w[2];
+    memcpy(w, msg->data, sizeof(w));
+    DLOG5(msg->ide ? DLOG_CAN_RX_EXT : DLOG_CAN_RX_STD,
+          msg->id, msg->dlc, msg->dlc, w[0], w[1]);
+
+    if (msg->ide)
+    {
+        return;
+    }
+    if (msg->id == CAN_DB_VEHICLE_TELEMETRY_ID && msg->dlc >= CAN_DB_VEHICLE_TELEMETRY_DLC)
+    {
+        CAN_DB_VehicleTelemetry_t t;
+        CAN_DB_VehicleTelemetry_Unpack(&t, msg->data);
+        DLOG3(DLOG_CAN_TELEMETRY, t.speed, t.engine_rpm, (int32_t)t.coolant_temp);
+    }
+    else if (msg->id == CAN_DB_VEHICLE_COMMAND_ID && msg->dlc >= CAN_DB_VEHICLE_COMMAND_DLC)
+    {
+        CAN_DB_VehicleCommand_t c;
+        CAN_DB_VehicleCommand_Unpack(&c, msg->data);
+        DLOG4(DLOG_CAN_COMMAND, c.cmd_mode, c.target_speed,
+              (int32_t)c.accel_limit * 5, c.alive_counter);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * 1. Conformance
+ * -------------------------------------------------------------------------- */
+
+/* Binary capture back to text, as Tools/dlog/dlog_decode does */
+static uint32_t decode_capture(const uint8_t *in, uint32_t len, char *out, uint32_t size)
+{
+    uint32_t pos = 0U;
+    uint32_t n = 0U;
+    DLOG_Record_t rec;
+
+    while (pos < len)
+    {
+        const int used = DLOG_Decode(&in[pos], len - pos, &rec);
+        if (used <= 0)
+        {
+            out[n++] = (char)in[pos++];
+            continue;
+        }
+        n += DLOG_Format(&out[n], size - n, &rec);
+        pos += (uint32_t)used;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static uint32_t check_frames(uint32_t frames)
+{
+    static char ref[CAPTURE_LEN];
+    static char txt[CAPTURE_LEN];
+    static char bin[CAPTURE_LEN];
+    uint32_t fail = 0U;
+    uint32_t done = 0U;
+
+    while (done < frames)
+    {
+        uint32_t ref_len = 0U;
+        uint32_t txt_len;
+        uint32_t saved = s_rng;
+        const uint32_t n = (frames - done < BATCH / 2U) ? frames - done : BATCH / 2U;
+
+        /* Text mode */
+        DLOG_SetMode(DLOG_MODE_TEXT);
+        s_capLen = 0U;
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            Frame_t f;
+            make_frame(&f);
+            ref_len += (uint32_t)ref_line(&f, &ref[ref_len], sizeof(ref) - ref_len);
+            dlog_line(&f);
+        }
+        (void)DLOG_Process();
+        memcpy(txt, s_cap, s_capLen);
+        txt_len = s_capLen;
+        txt[txt_len] = '\0';
+
+        /* Same frames again, binary mode */
+        s_rng = saved;
+        DLOG_SetMode(DLOG_MODE_BINARY);
+        s_capLen = 0U;
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            Frame_t f;
+            make_frame(&f);
+            dlog_line(&f);
+        }
+        (void)DLOG_Process();
+        const uint32_t bin_len = decode_capture(s_cap, s_capLen, bin, sizeof(bin));
+
+        if (txt_len != ref_len || memcmp(txt, ref, ref_len) != 0 ||
+            bin_len != ref_len || memcmp(bin, ref, ref_len) != 0)
+        {
+            if (fail == 0U)
+            {
+                printf("  first mismatch:\n--- snprintf\n%s--- text\n%s--- binary\n%s",
+                       ref, txt, bin);
+            }
+            fail++;
+        }
+        done += n;
+    }
+    return fail;
+}
+
+/* Start-up messages with edge values against their former snprintf() */
+static uint32_t check_startup(void)
+{
+    static const int32_t  st[]  = { 0, 1, 3 };
+    static const uint32_t err[] = { 0U, 0x00000100U, 0xFFFFFFFFU };
+    char ref[512];
+    int len = 0;
+
+    DLOG_SetMode(DLOG_MODE_TEXT);
+    s_capLen = 0U;
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        len += snprintf(&ref[len], sizeof(ref) - (size_t)len,
+                        "CAN_IF: ConfigFilters status=%ld banks=%u err=0x%08lX\r\n",
+                        (long)st[i], (unsigned int)(i * 13U), (unsigned long)err[i]);
+        DLOG3(DLOG_CAN_FILTERS, st[i], i * 13U, err[i]);
+        len += snprintf(&ref[len], sizeof(ref) - (size_t)len,
+                        "CAN_IF: Start status=%ld state=%lu err=0x%08lX\r\n",
+                        (long)st[i], (unsigned long)(i + 1U), (unsigned long)err[i]);
+        DLOG3(DLOG_CAN_START, st[i], i + 1U, err[i]);
+    }
+    (void)DLOG_Process();
+
+    if (s_capLen != (uint32_t)len || memcmp(s_cap, ref, (size_t)len) != 0)
+    {
+        printf("  start-up mismatch:\n--- snprintf\n%s--- dlog\n%.*s", ref,
+               (int)s_capLen, (const char *)s_cap);
+        return 1U;
+    }
+    return 0U;
+}
+
+/* --------------------------------------------------------------------------
+ * 2. Cost
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uint64_t call;      /* ticks at the call site    */
+    uint64_t drain;     /* ticks in DLOG_Process()   */
+    uint32_t calls;
+    uint32_t records;
+} Cost_t;
+
+static volatile uint32_t s_sink;   /* keeps the snprintf() result alive */
+
+static void cost_snprintf(const Frame_t *frames, uint32_t n, Cost_t *c)
+{
+    char buf[192];
+
+    for (uint32_t i = 0U; i < n; i += BATCH)
+    {
+        const uint64_t t0 = ticks();
+        for (uint32_t k = i; k < i + BATCH && k < n; k++)
+        {
+            s_sink += (uint32_t)ref_line(&frames[k], buf, sizeof(buf));
+        }
+        c->call += ticks() - t0;
+    }
+    c->calls = n;
+}
+
+static void cost_dlog(const Frame_t *frames, uint32_t n, DLOG_Mode_t mode, Cost_t *c)
+{
+    DLOG_Stats_t st0, st1;
+
+    DLOG_SetMode(mode);
+    DLOG_GetStats(&st0);
+    for (uint32_t i = 0U; i < n; i += BATCH / 2U)
+    {
+        const uint64_t t0 = ticks();
+        for (uint32_t k = i; k < i + BATCH / 2U && k < n; k++)
+        {
+            dlog_line(&frames[k]);
+        }
+        const uint64_t t1 = ticks();
+        s_capLen = 0U;
+        (void)DLOG_Process();
+        c->drain += ticks() - t1;
+        c->call  += t1 - t0;
+    }
+    DLOG_GetStats(&st1);
+    c->calls   = n;
+    c->records = st1.emitted - st0.emitted;
+}
+
+static void cost_dlog0(uint32_t n, Cost_t *c)
+{
+    DLOG_SetMode(DLOG_MODE_BINARY);
+    for (uint32_t i = 0U; i < n; i += BATCH)
+    {
+        const uint64_t t0 = ticks();
+        for (uint32_t k = i; k < i + BATCH && k < n; k++)
+        {
+            DLOG0(DLOG_CAN_RXQ_FAIL);
+        }
+        c->call += ticks() - t0;
+        s_capLen = 0U;
+        (void)DLOG_Process();
+    }
+    c->calls = n;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = 200000U;
+    uint32_t fail;
+
+    if (argc > 1)
+    {
+        frames = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    DLOG_Init();
+    printf("bench_dlog: %lu frames, ring %u records\n", (unsigned long)frames,
+           (unsigned int)DLOG_RING_LEN);
+
+    fail  = check_startup();
+    fail += check_frames(frames / 10U);
+    printf("  conformance: %s (%lu frames, text and binary vs snprintf)\n",
+           fail ? "FAIL" : "ok", (unsigned long)(frames / 10U));
+
+    Frame_t *f = calloc(frames, sizeof(Frame_t));
+    if (f == NULL)
+    {
+        return 1;
+    }
+    for (uint32_t i = 0U; i < frames; i++)
+    {
+        make_frame(&f[i]);
+    }
+
+    Cost_t ref = { 0 }, txt = { 0 }, bin = { 0 }, d0 = { 0 };
+    cost_snprintf(f, frames, &ref);
+    cost_dlog(f, frames, DLOG_MODE_TEXT, &txt);
+    cost_dlog(f, frames, DLOG_MODE_BINARY, &bin);
+    cost_dlog0(frames, &d0);
+
+    printf("  %-28s %10s %10s\n", "", BENCH_UNIT "/frame", BENCH_UNIT "/rec");
+    printf("  %-28s %10.1f\n", "call site, snprintf line",
+           (double)ref.call / ref.calls);
+    printf("  %-28s %10.1f %10.1f\n", "call site, dlog records",
+           (double)txt.call / txt.calls, (double)txt.call / txt.records);
+    printf("  %-28s %10s %10.1f\n", "call site, DLOG0", "",
+           (double)d0.call / d0.calls);
+    printf("  %-28s %10.1f %10.1f\n", "LogTask, text mode",
+           (double)txt.drain / txt.calls, (double)txt.drain / txt.records);
+    printf("  %-28s %10.1f %10.1f\n", "LogTask, binary mode",
+           (double)bin.drain / bin.calls, (double)bin.drain / bin.records);
+    printf("  call-site speed-up: %.1fx\n", (double)ref.call / (double)txt.call);
+
+    DLOG_Stats_t st;
+    DLOG_GetStats(&st);
+    if (st.dropped != 0U)
+    {
+        printf("  FAIL: %lu records dropped\n", (unsigned long)st.dropped);
+        fail++;
+    }
+
+    free(f);
+    return fail ? 1 : 0;
+}
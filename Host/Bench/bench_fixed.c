@@ -0,0 +1,254 @@
+/**
+ * @file    bench_fixed.c
+ * @brief   Q16.16 vehicle model: replay determinism and cost vs the float model.
+ *
+ * 1. Replay: a scripted drive (speed commands, an overheat injection, and a
+ *    fleet of random start states drawn from an integer RNG) is run through
+ *    VehicleQ16_Update() at 100 ms. Every step's CAN telemetry payload
+ *    (0x100 layout) is hashed with FNV-1a. The digest depends on integer
+ *    arithmetic only, so it is the same on every host and on the target; it
+ *    is checked against VEHICLE_Q16_REPLAY_DIGEST.
+ * 2. Agreement: the same drive on the float model; the largest telemetry
+ *    difference between the two builds is reported (informational).
+ * 3. Cost: cycles per vehicle update for Vehicle_Update() (float) and
+ *    VehicleQ16_Update(), read from the TSC on x86 (nanoseconds elsewhere).
+ *    On the Cortex-M4 the same loops can be timed with DWT->CYCCNT.
+ *
+ * Built with VEHICLE_DYNAMICS=0: the Q16.16 twin implements the basic
+ * model, so the float reference is the basic model too.
+ *
+ * Usage: bench_fixed [vehicles] [steps]     (default 1024 x 2000)
+ * Exit status is non-zero if the replay digest does not match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#include "can_db.h"
+#include "vehicle.h"
+#include "vehicle_q16.h"
+
+/* FNV-1a over every telemetry frame of replay() */
+#define VEHICLE_Q16_REPLAY_DIGEST   0x37348F3C08BC149AULL
+
+#define REPLAY_VEHICLES   64U
+#define REPLAY_STEPS      6000U            /* 10 minutes at 100 ms */
+#define REPLAY_DT_MS      100U
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t s_rng;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1664525U + 1013904223U;
+    return s_rng >> 8;
+}
+
+static uint64_t fnv1a(uint64_t h, const uint8_t *p, size_t n)
+{
+    while (n--)
+    {
+        h ^= *p++;
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+/* Same packing as CAN_IF_SendTelemetry() */
+static void pack(uint8_t out[CAN_DB_VEHICLE_TELEMETRY_DLC],
+                 int32_t speed10, uint16_t rpm, int32_t temp10)
+{
+    CAN_DB_VehicleTelemetry_t m;
+
+    m.speed        = (uint16_t)speed10;
+    m.engine_rpm   = rpm;
+    m.coolant_temp = (int16_t)temp10;
+    CAN_DB_VehicleTelemetry_Pack(out, &m);
+}
+
+typedef struct
+{
+    uint32_t step;
+    uint32_t speed_kph;       /* 0 = no speed command */
+    uint8_t  overheat;
+} ReplayCmd_t;
+
+static const ReplayCmd_t s_script[] =
+{
+    {    0U, 120U, 0U },
+    {  600U,  50U, 0U },
+    { 1500U,   0U, 1U },
+    { 2400U, 200U, 0U },
+    { 4200U,   5U, 0U },
+};
+
+typedef struct
+{
+    uint64_t digest;
+    int32_t  max_dspeed10;
+    int32_t  max_drpm;
+    int32_t  max_dtemp10;
+} ReplayResult_t;
+
+static int32_t iabs32(int32_t v)
+{
+    return (v < 0) ? -v : v;
+}
+
+/* Runs the drive on both models side by side */
+static ReplayResult_t replay(void)
+{
+    VehicleStateQ16_t q[REPLAY_VEHICLES];
+    VehicleState_t    f[REPLAY_VEHICLES];
+    ReplayResult_t r = { 0xCBF29CE484222325ULL, 0, 0, 0 };
+    size_t next = 0U;
+
+    s_rng = 0x2545F491U;
+    for (uint32_t i = 0; i < REPLAY_VEHICLES; i++)
+    {
+        uint32_t speed = rng_next() % 200U;
+        uint16_t rpm   = (uint16_t)(600U + rng_next() % 5400U);
+        uint32_t temp  = 20U + rng_next() % 90U;
+
+        VehicleQ16_Force(&q[i], (q16_16_t)(speed << 16), rpm, (q16_16_t)(temp << 16));
+        Vehicle_Force(&f[i], (float)speed, rpm, (float)temp);
+    }
+
+    for (uint32_t st = 0; st < REPLAY_STEPS; st++)
+    {
+        if (next < sizeof(s_script) / sizeof(s_script[0]) && s_script[next].step == st)
+        {
+            const ReplayCmd_t *c = &s_script[next++];
+            for (uint32_t i = 0; i < REPLAY_VEHICLES; i++)
+            {
+                if (c->overheat)
+                {
+                    VehicleQ16_Force(&q[i], q[i].speed_kph, q[i].engine_rpm, VEHICLE_Q16(115.0));
+                    Vehicle_Force(&f[i], f[i].speed_kph, f[i].engine_rpm, 115.0f);
+                }
+                else if (c->speed_kph != 0U || i % 2U == 0U)
+                {
+                    /* Even vehicles follow every command, odd ones only non-zero speeds */
+                    VehicleQ16_SetTargetSpeed(&q[i], (q16_16_t)(c->speed_kph << 16));
+                    Vehicle_SetTargetSpeed(&f[i], (float)c->speed_kph);
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < REPLAY_VEHICLES; i++)
+        {
+            uint8_t frame[6];
+
+            VehicleQ16_Update(&q[i], VEHICLE_Q16_FROM_MS(REPLAY_DT_MS));
+            Vehicle_UpdateMs(&f[i], REPLAY_DT_MS);
+
+            int32_t qs = VehicleQ16_ToTenths(q[i].speed_kph);
+            int32_t qt = VehicleQ16_ToTenths(q[i].coolant_temp_c);
+            pack(frame, qs, q[i].engine_rpm, qt);
+            r.digest = fnv1a(r.digest, frame, sizeof(frame));
+
+            int32_t ds = iabs32(qs - Vehicle_GetSpeedKph10(&f[i]));
+            int32_t dr = iabs32((int32_t)q[i].engine_rpm - (int32_t)f[i].engine_rpm);
+            int32_t dt = iabs32(qt - Vehicle_GetCoolantC10(&f[i]));
+            if (ds > r.max_dspeed10) r.max_dspeed10 = ds;
+            if (dr > r.max_drpm)     r.max_drpm     = dr;
+            if (dt > r.max_dtemp10)  r.max_dtemp10  = dt;
+        }
+    }
+    return r;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+#define COST_RUNS 7
+
+int main(int argc, char **argv)
+{
+    uint32_t n     = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1024U;
+    uint32_t steps = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 2000U;
+    int failed = 0;
+
+    ReplayResult_t r = replay();
+    printf("bench_fixed: replay %u vehicles x %u steps of %u ms\n",
+           REPLAY_VEHICLES, REPLAY_STEPS, REPLAY_DT_MS);
+    printf("  telemetry digest     : 0x%016llx (expected 0x%016llx) %s\n",
+           (unsigned long long)r.digest, (unsigned long long)VEHICLE_Q16_REPLAY_DIGEST,
+           (r.digest == VEHICLE_Q16_REPLAY_DIGEST) ? "PASS" : "FAIL");
+    printf("  max |q16 - float|    : speed %.1f km/h, rpm %ld, coolant %.1f C\n",
+           r.max_dspeed10 / 10.0, (long)r.max_drpm, r.max_dtemp10 / 10.0);
+    failed |= (r.digest != VEHICLE_Q16_REPLAY_DIGEST);
+
+    VehicleState_t    *f = malloc(n * sizeof(*f));
+    VehicleStateQ16_t *q = malloc(n * sizeof(*q));
+    if (f == NULL || q == NULL)
+    {
+        fprintf(stderr, "bench_fixed: out of memory\n");
+        return 2;
+    }
+
+    s_rng = 0x12345678U;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t speed = (i % 4U == 0U) ? 0U : rng_next() % 200U;
+        uint16_t rpm   = (uint16_t)(600U + rng_next() % 5400U);
+        uint32_t temp  = 20U + rng_next() % 90U;
+
+        Vehicle_Force(&f[i], (float)speed, rpm, (float)temp);
+        VehicleQ16_Force(&q[i], (q16_16_t)(speed << 16), rpm, (q16_16_t)(temp << 16));
+    }
+
+    /* Median of COST_RUNS, each run stepping the whole array `steps` times */
+    uint64_t tf[COST_RUNS], tq[COST_RUNS];
+    const q16_16_t dt_q = VEHICLE_Q16_FROM_MS(100);
+    for (int run = 0; run < COST_RUNS; run++)
+    {
+        uint64_t t0 = ticks();
+        for (uint32_t st = 0; st < steps; st++)
+            for (uint32_t i = 0; i < n; i++)
+                Vehicle_Update(&f[i], 0.1f);
+        tf[run] = ticks() - t0;
+
+        t0 = ticks();
+        for (uint32_t st = 0; st < steps; st++)
+            for (uint32_t i = 0; i < n; i++)
+                VehicleQ16_Update(&q[i], dt_q);
+        tq[run] = ticks() - t0;
+    }
+    qsort(tf, COST_RUNS, sizeof(tf[0]), cmp_u64);
+    qsort(tq, COST_RUNS, sizeof(tq[0]), cmp_u64);
+
+    const double updates = (double)n * (double)steps;
+    const double cf = (double)tf[COST_RUNS / 2] / updates;
+    const double cq = (double)tq[COST_RUNS / 2] / updates;
+    printf("\ncost per vehicle update (%lu vehicles x %lu steps, median of %d):\n",
+           (unsigned long)n, (unsigned long)steps, COST_RUNS);
+    printf("  float  Vehicle_Update    : %7.2f %s\n", cf, BENCH_UNIT);
+    printf("  Q16.16 VehicleQ16_Update : %7.2f %s  (%.2fx)\n", cq, BENCH_UNIT, cf / cq);
+
+    free(f);
+    free(q);
+    return failed;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file    bench_fleet.c
+ * @brief   Fleet simulation benchmark and kernel conformance check.
+ *
+ * 1. Conformance: every available kernel (vehicle_simd.h) is stepped once
+ *    from a set of edge-case and random states and compared against
+ *    Vehicle_Update() within VEHICLE_SIMD_TOL_ULP / VEHICLE_SIMD_TOL_RPM.
+ * 2. Throughput: the scalar model (array of VehicleState_t) and each kernel
+ *    step the same randomly initialised fleet; vehicle updates per second
+ *    are reported, together with whether the final state is bit-identical
+ *    to the scalar model.
+ *
+ * Built with VEHICLE_DYNAMICS=0: the kernels implement the basic model, so
+ * Vehicle_Update() is the basic model here too.
+ *
+ * Usage: bench_fleet [vehicles] [steps]     (default 10000 x 1000)
+ * Exit status is non-zero if any kernel is out of tolerance, or if the
+ * scalar batch path differs from Vehicle_Update() at all.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vehicle.h"
+#include "vehicle_simd.h"
+
+static uint32_t s_rng = 0x12345678U;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1664525U + 1013904223U;
+    return s_rng >> 8;
+}
+
+static float rng_range(float lo, float hi)
+{
+    return lo + (hi - lo) * ((float)rng_next() / (float)(1U << 24));
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Distance between two floats in units in the last place */
+static uint32_t ulp_diff(float a, float b)
+{
+    int32_t ia, ib;
+
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) ia = (int32_t)0x80000000 - ia;
+    if (ib < 0) ib = (int32_t)0x80000000 - ib;
+    return (ia > ib) ? (uint32_t)(ia - ib) : (uint32_t)(ib - ia);
+}
+
+typedef struct
+{
+    float          *speed;
+    uint16_t       *rpm;
+    float          *temp;
+    VehicleFleet_t  fleet;
+} Soa_t;
+
+static int soa_alloc(Soa_t *s, uint32_t n)
+{
+    s->speed = malloc(n * sizeof(float));
+    s->rpm   = malloc(n * sizeof(uint16_t));
+    s->temp  = malloc(n * sizeof(float));
+    s->fleet = (VehicleFleet_t){ s->speed, s->rpm, s->temp, n };
+    return (s->speed != NULL && s->rpm != NULL && s->temp != NULL) ? 0 : -1;
+}
+
+static void soa_free(Soa_t *s)
+{
+    free(s->speed);
+    free(s->rpm);
+    free(s->temp);
+}
+
+static void soa_from_aos(Soa_t *s, const VehicleState_t *aos, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        s->speed[i] = aos[i].speed_kph;
+        s->rpm[i]   = aos[i].engine_rpm;
+        s->temp[i]  = aos[i].coolant_temp_c;
+    }
+}
+
+static uint32_t soa_mismatches(const Soa_t *s, const VehicleState_t *ref, uint32_t n,
+                               uint32_t tol_ulp, uint32_t tol_rpm, const char *tag)
+{
+    uint32_t bad = 0U;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t drpm = (s->rpm[i] > ref[i].engine_rpm) ? (uint32_t)(s->rpm[i] - ref[i].engine_rpm)
+                                                        : (uint32_t)(ref[i].engine_rpm - s->rpm[i]);
+        if (ulp_diff(s->speed[i], ref[i].speed_kph) > tol_ulp ||
+            drpm > tol_rpm ||
+            ulp_diff(s->temp[i], ref[i].coolant_temp_c) > tol_ulp)
+        {
+            if (bad++ < 3U && tag != NULL)
+            {
+                fprintf(stderr, "  %s: vehicle %lu: ref %.9g/%u/%.9g got %.9g/%u/%.9g\n",
+                        tag, (unsigned long)i,
+                        ref[i].speed_kph, ref[i].engine_rpm, ref[i].coolant_temp_c,
+                        s->speed[i], s->rpm[i], s->temp[i]);
+            }
+        }
+    }
+    return bad;
+}
+
+/* Edge cases around every threshold and clamp, then random states */
+static uint32_t make_conformance_set(VehicleState_t *v, uint32_t cap)
+{
+    static const float    speeds[] = { 0.0f, 0.05f, 0.1f, 0.10000001f, 0.2f, 1.0f,
+                                       1.0000001f, 1.1f, 60.0f, 200.0f, 300.0f };
+    static const uint16_t rpms[]   = { 0U, 599U, 600U, 601U, 1499U, 1500U, 1501U,
+                                       5999U, 6000U, 6001U, 8000U };
+    static const float    temps[]  = { -40.0f, 19.99f, 20.0f, 20.01f, 90.0f,
+                                       109.99f, 110.0f, 110.01f, 140.0f };
+    uint32_t n = 0U;
+
+    for (size_t a = 0; a < sizeof(speeds) / sizeof(speeds[0]); a++)
+        for (size_t b = 0; b < sizeof(rpms) / sizeof(rpms[0]); b++)
+            for (size_t c = 0; c < sizeof(temps) / sizeof(temps[0]); c++)
+                if (n < cap)
+                {
+                    v[n].speed_kph = speeds[a];
+                    v[n].engine_rpm = rpms[b];
+                    v[n].coolant_temp_c = temps[c];
+                    n++;
+                }
+
+    while (n < cap)
+    {
+        Vehicle_Force(&v[n], rng_range(0.0f, 200.0f), (uint16_t)rng_range(0.0f, 8000.0f),
+                      rng_range(-40.0f, 140.0f));
+        n++;
+    }
+    return n;
+}
+
+static int run_conformance(void)
+{
+    const uint32_t n = 100000U;
+    const float dts[] = { 0.001f, 0.01f, 0.1f, 0.5f };
+    VehicleState_t *in  = malloc(n * sizeof(*in));
+    VehicleState_t *ref = malloc(n * sizeof(*ref));
+    Soa_t s;
+    int failed = 0;
+
+    if (in == NULL || ref == NULL || soa_alloc(&s, n) != 0)
+    {
+        fprintf(stderr, "bench_fleet: out of memory\n");
+        return 1;
+    }
+    make_conformance_set(in, n);
+
+    printf("conformance vs Vehicle_Update (%lu states x %zu dt, tol %u ULP / %u rpm):\n",
+           (unsigned long)n, sizeof(dts) / sizeof(dts[0]),
+           VEHICLE_SIMD_TOL_ULP, VEHICLE_SIMD_TOL_RPM);
+
+    for (int kk = 0; kk < VEHICLE_KERNEL_COUNT; kk++)
+    {
+        VehicleKernel_t k = (VehicleKernel_t)kk;
+        uint32_t bad = 0U, inexact = 0U;
+
+        if (!Vehicle_KernelAvailable(k))
+        {
+            printf("  %-10s : not available\n", Vehicle_KernelName(k));
+            continue;
+        }
+
+        for (size_t d = 0; d < sizeof(dts) / sizeof(dts[0]); d++)
+        {
+            memcpy(ref, in, n * sizeof(*in));
+            for (uint32_t i = 0; i < n; i++)
+            {
+                Vehicle_Update(&ref[i], dts[d]);
+            }
+            soa_from_aos(&s, in, n);
+            (void)Vehicle_UpdateBatchKernel(&s.fleet, dts[d], k);
+
+            inexact += soa_mismatches(&s, ref, n, 0U, 0U, NULL);
+            bad     += soa_mismatches(&s, ref, n, VEHICLE_SIMD_TOL_ULP, VEHICLE_SIMD_TOL_RPM,
+                                      Vehicle_KernelName(k));
+        }
+
+        /* The scalar batch path shares its code with Vehicle_Update() */
+        if (k == VEHICLE_KERNEL_SCALAR && inexact != 0U)
+        {
+            bad += inexact;
+        }
+        printf("  %-10s : %s (%lu not bit-exact)\n", Vehicle_KernelName(k),
+               (bad == 0U) ? "PASS" : "FAIL", (unsigned long)inexact);
+        failed |= (bad != 0U);
+    }
+
+    soa_free(&s);
+    free(in);
+    free(ref);
+    return failed;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t n     = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 10000U;
+    uint32_t steps = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1000U;
+    const float dt_s = 0.1f;
+    int failed = run_conformance();
+
+    VehicleState_t *init = malloc(n * sizeof(*init));
+    VehicleState_t *aos  = malloc(n * sizeof(*aos));
+    Soa_t s;
+
+    if (init == NULL || aos == NULL || soa_alloc(&s, n) != 0)
+    {
+        fprintf(stderr, "bench_fleet: out of memory\n");
+        return 2;
+    }
+
+    /* Mix of stopped, cruising, cold and hot vehicles */
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Vehicle_Init(&init[i]);
+        Vehicle_Force(&init[i],
+                      (i % 4U == 0U) ? 0.0f : rng_range(0.0f, 200.0f),
+                      (uint16_t)rng_range(600.0f, 6000.0f),
+                      rng_range(20.0f, 110.0f));
+    }
+
+    memcpy(aos, init, n * sizeof(*aos));
+    double t0 = now_s();
+    for (uint32_t st = 0; st < steps; st++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            Vehicle_Update(&aos[i], dt_s);
+        }
+    }
+    double t_scalar = now_s() - t0;
+    const double updates = (double)n * (double)steps;
+
+    printf("\nbench_fleet: %lu vehicles x %lu steps\n", (unsigned long)n, (unsigned long)steps);
+    printf("  %-22s : %8.3f s  %12.0f vehicles/s\n", "Vehicle_Update (AoS)",
+           t_scalar, updates / t_scalar);
+
+    for (int kk = 0; kk < VEHICLE_KERNEL_COUNT; kk++)
+    {
+        VehicleKernel_t k = (VehicleKernel_t)kk;
+        if (!Vehicle_KernelAvailable(k))
+        {
+            continue;
+        }
+
+        soa_from_aos(&s, init, n);
+        t0 = now_s();
+        for (uint32_t st = 0; st < steps; st++)
+        {
+            (void)Vehicle_UpdateBatchKernel(&s.fleet, dt_s, k);
+        }
+        double t = now_s() - t0;
+        uint32_t diff = soa_mismatches(&s, aos, n, 0U, 0U, NULL);
+
+        printf("  batch %-16s : %8.3f s  %12.0f vehicles/s  (%5.2fx)  %s\n",
+               Vehicle_KernelName(k), t, updates / t, t_scalar / t,
+               (diff == 0U) ? "bit-identical" : "differs");
+        if (k == VEHICLE_KERNEL_SCALAR && diff != 0U)
+        {
+            failed = 1;
+        }
+    }
+    printf("  best kernel on this CPU: %s\n", Vehicle_KernelName(Vehicle_KernelBest()));
+
+    soa_free(&s);
+    free(init);
+    free(aos);
+    return failed;
+}
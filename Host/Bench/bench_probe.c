@@ -0,0 +1,199 @@
+/**
+ * @file    bench_probe.c
+ * @brief   Hot-path probes (probe.h): cost, statistics check, firmware run.
+ *
+ * 1. Cost: an empty PROBE_SCOPE() and a bare pair of counter reads, in ns.
+ *    On the host both read the monotonic clock; on target the counter is
+ *    a single DWT->CYCCNT load, so these are host-only upper bounds.
+ * 2. Statistics: 1..1000 cycles recorded on one probe must give min 1,
+ *    max 1000, mean 500, p50 511 (upper edge of [256, 512)) and p99 1000
+ *    (edge 1023 capped at max); after PROBE_Reset() the probe must read
+ *    empty and restart with the next call.
+ * 3. Firmware: boots the ECU on the FreeRTOS host port with CAN frames
+ *    at about 1 kHz and a CLI command every 50 ms, then prints the `probe`
+ *    table. Every probe must have fired, and each must satisfy
+ *    min <= p50 <= p99 <= max. The feeder is paced by the wall clock, so
+ *    this phase always runs at real time: VECU_HOST_SPEED is ignored (in
+ *    virtual time the run would end before the first CLI line).
+ *
+ * Usage: bench_probe [firmware_ms]      (default 2000)
+ * Exit status is 1 if any check fails.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "probe.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+#define COST_LOOPS       10000000U
+#define CAN_PERIOD_US    1000U
+#define CLI_PERIOD_US    50000U
+
+static uint32_t s_fwMs = 2000U;
+static int      s_failed;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void phase_cost(void)
+{
+    volatile uint32_t sink = 0U;
+    double t0 = now_s();
+    for (uint32_t i = 0U; i < COST_LOOPS; i++)
+    {
+        PROBE_SCOPE(PROBE_CLI_CHAR);
+        sink++;
+    }
+    const double probe_ns = (now_s() - t0) * 1e9 / COST_LOOPS;
+
+    t0 = now_s();
+    for (uint32_t i = 0U; i < COST_LOOPS; i++)
+    {
+        const uint32_t c0 = CYCCNT_Read();
+        sink += CYCCNT_Read() - c0;
+    }
+    const double read_ns = (now_s() - t0) * 1e9 / COST_LOOPS;
+    (void)sink;
+
+    PROBE_Clear(&g_probe[PROBE_CLI_CHAR]);
+    printf("  cost:        PROBE_SCOPE %.1f ns, two counter reads %.1f ns (host clock)\n",
+           probe_ns, read_ns);
+}
+
+static void expect(const char *what, uint32_t got, uint32_t want)
+{
+    if (got != want)
+    {
+        printf("  FAIL: %s = %lu, expected %lu\n", what, (unsigned long)got, (unsigned long)want);
+        s_failed = 1;
+    }
+}
+
+static void phase_stats(void)
+{
+    PROBE_Stats_t st;
+
+    for (uint32_t c = 1U; c <= 1000U; c++)
+    {
+        PROBE_Record(PROBE_CLI_CHAR, c);
+    }
+    (void)PROBE_GetStats(PROBE_CLI_CHAR, &st);
+    printf("  stats:       calls=%lu min=%lu mean=%lu p50=%lu p99=%lu max=%lu\n",
+           (unsigned long)st.calls, (unsigned long)st.min, (unsigned long)st.mean,
+           (unsigned long)st.p50, (unsigned long)st.p99, (unsigned long)st.max);
+    expect("calls", st.calls, 1000U);
+    expect("min", st.min, 1U);
+    expect("max", st.max, 1000U);
+    expect("mean", st.mean, 500U);
+    expect("p50", st.p50, 511U);
+    expect("p99", st.p99, 1000U);
+    expect("bin [512, 1024)", st.hist[9], 489U);
+
+    PROBE_Reset();
+    (void)PROBE_GetStats(PROBE_CLI_CHAR, &st);
+    expect("calls after reset", st.calls, 0U);
+    PROBE_Record(PROBE_CLI_CHAR, 7U);
+    (void)PROBE_GetStats(PROBE_CLI_CHAR, &st);
+    expect("calls after reset + 1", st.calls, 1U);
+    expect("min after reset + 1", st.min, 7U);
+
+    PROBE_Reset();
+    for (uint32_t i = 0U; i < PROBE_COUNT; i++)
+    {
+        PROBE_Clear(&g_probe[i]);
+    }
+}
+
+static void *feeder(void *arg)
+{
+    static const char cmd[] = "status\r";
+    uint8_t data[8] = { 0 };
+    uint32_t n = 0U;
+
+    (void)arg;
+    for (;;)
+    {
+        data[0] = (uint8_t)n++;
+        (void)HOST_CAN_InjectFrame(0x200U, 8U, data);
+        if ((n % (CLI_PERIOD_US / CAN_PERIOD_US)) == 0U)
+        {
+            (void)HOST_UART_InjectRx(USART2, (const uint8_t *)cmd, strlen(cmd));
+        }
+        usleep(CAN_PERIOD_US);
+    }
+    return NULL;
+}
+
+/* Runs from the tick that ends the simulation */
+static void fw_report(void)
+{
+    printf("  firmware:    %lu ms\n", (unsigned long)s_fwMs);
+    printf("    %-12s %10s %8s %8s %8s %8s %8s\n",
+           "probe", "calls", "min", "mean", "p50", "p99", "max");
+    for (uint32_t i = 0U; i < PROBE_COUNT; i++)
+    {
+        PROBE_Stats_t st;
+
+        (void)PROBE_GetStats((PROBE_Id_t)i, &st);
+        printf("    %-12s %10lu %8lu %8lu %8lu %8lu %8lu\n",
+               st.name, (unsigned long)st.calls, (unsigned long)st.min,
+               (unsigned long)st.mean, (unsigned long)st.p50,
+               (unsigned long)st.p99, (unsigned long)st.max);
+        if (st.calls == 0U)
+        {
+            printf("  FAIL: %s never fired\n", st.name);
+            s_failed = 1;
+        }
+        else if (st.min > st.p50 || st.p50 > st.p99 || st.p99 > st.max)
+        {
+            printf("  FAIL: %s percentiles out of order\n", st.name);
+            s_failed = 1;
+        }
+    }
+    HOST_PORT_Exit(s_failed);
+}
+
+static void uart_null_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)data;
+    (void)len;
+    (void)ctx;
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t t;
+
+    if (argc > 1)
+    {
+        s_fwMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    printf("bench_probe: %lu ms firmware, CAN frame every %u us, CLI line every %u us\n",
+           (unsigned long)s_fwMs, CAN_PERIOD_US, CLI_PERIOD_US);
+    phase_cost();
+    phase_stats();
+
+    HOST_UART_SetTxSink(USART2, uart_null_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_PORT_StopAfter(s_fwMs, fw_report);
+    HOST_PORT_SetTimeScale(1U);     /* the feeder runs on the wall clock */
+
+    pthread_create(&t, NULL, feeder, NULL);
+    pthread_detach(t);
+
+    return vecu_firmware_main();
+}
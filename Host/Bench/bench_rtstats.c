@@ -0,0 +1,178 @@
+/**
+ * @file    bench_rtstats.c
+ * @brief   Run-time statistics (rtstats.h) cost and firmware check.
+ *
+ * 1. Cost: one RTSTATS_IsrEnter() / RTSTATS_IsrExit() pair and one read of
+ *    the kernel's run-time counter, in ns. On the host both read the
+ *    monotonic clock; on target they are single DWT->CYCCNT loads, so the
+ *    numbers here are an upper bound for the host build only.
+ * 2. Firmware: boots the ECU on the FreeRTOS host port at real time while
+ *    a host thread offers CAN frames at about 1 kHz, then prints the last
+ *    `top` snapshot. The task shares of a window must add up to 100 %, the
+ *    CPU load must be below 100 %, and the CAN RX and TIM6 interrupts must
+ *    have been counted.
+ *
+ * Usage: bench_rtstats [firmware_ms]      (default 3500)
+ * Exit status is 1 if any firmware check fails.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "rtstats.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+#define COST_LOOPS       10000000U
+#define CAN_PERIOD_US    1000U
+
+static uint32_t s_fwMs = 3500U;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void phase_cost(void)
+{
+    /* Stand-alone counters: the firmware has not started yet */
+    double t0 = now_s();
+    for (uint32_t i = 0U; i < COST_LOOPS; i++)
+    {
+        const uint32_t t = RTSTATS_IsrEnter();
+        RTSTATS_IsrExit(RTSTATS_ISR_CAN1_RX1, t);
+    }
+    const double isr_ns = (now_s() - t0) * 1e9 / COST_LOOPS;
+
+    volatile uint32_t sink = 0U;
+    t0 = now_s();
+    for (uint32_t i = 0U; i < COST_LOOPS; i++)
+    {
+        sink += portGET_RUN_TIME_COUNTER_VALUE();
+    }
+    const double ctr_ns = (now_s() - t0) * 1e9 / COST_LOOPS;
+    (void)sink;
+
+    g_rtstatsIsr[RTSTATS_ISR_CAN1_RX1].calls   = 0U;
+    g_rtstatsIsr[RTSTATS_ISR_CAN1_RX1].cyc     = 0U;
+    g_rtstatsIsr[RTSTATS_ISR_CAN1_RX1].cyc_max = 0U;
+
+    printf("  cost:        ISR enter/exit %.1f ns, run-time counter read %.1f ns (host clock)\n",
+           isr_ns, ctr_ns);
+}
+
+static void *can_feeder(void *arg)
+{
+    uint8_t data[8] = { 0 };
+    uint32_t n = 0U;
+
+    (void)arg;
+    for (;;)
+    {
+        data[0] = (uint8_t)n++;
+        (void)HOST_CAN_InjectFrame(0x200U, 8U, data);
+        usleep(CAN_PERIOD_US);
+    }
+    return NULL;
+}
+
+/* Runs from the tick that ends the simulation */
+static void fw_report(void)
+{
+    static RTSTATS_Snapshot_t snap;
+    uint32_t task_x100 = 0U;
+    int failed = 0;
+
+    RTSTATS_GetSnapshot(&snap);
+
+    printf("  firmware:    %lu ms, %lu windows, CPU load %u.%02u %%\n",
+           (unsigned long)s_fwMs, (unsigned long)snap.windows,
+           (unsigned)(snap.load_x100 / 100U), (unsigned)(snap.load_x100 % 100U));
+    for (uint32_t i = 0U; i < snap.n; i++)
+    {
+        const RTSTATS_Entry_t *e = &snap.e[i];
+
+        printf("    %s %-16s %6.2f %%  total %6.2f %%  %10lu cyc",
+               (e->kind == RTSTATS_KIND_TASK) ? "task" : "isr ", e->name,
+               e->win_x100 / 100.0, e->total_x100 / 100.0, (unsigned long)e->win_cyc);
+        if (e->kind == RTSTATS_KIND_ISR)
+        {
+            printf("  calls=%lu max=%lu", (unsigned long)e->calls, (unsigned long)e->cyc_max);
+        }
+        printf("\n");
+        if (e->kind == RTSTATS_KIND_TASK)
+        {
+            task_x100 += e->win_x100;
+        }
+    }
+
+    /* Per-line rounding: up to half a hundredth each */
+    const uint32_t slack = (snap.n + 1U) / 2U;
+    const RTSTATS_Entry_t *rx0  = &snap.e[snap.n - RTSTATS_ISRS + RTSTATS_ISR_CAN1_RX0];
+    const RTSTATS_Entry_t *tim6 = &snap.e[snap.n - RTSTATS_ISRS + RTSTATS_ISR_TIM6];
+
+    if (snap.windows < 2U)
+    {
+        printf("  FAIL: fewer than two windows closed\n");
+        failed = 1;
+    }
+    else
+    {
+        if (task_x100 + slack < 10000U || task_x100 > 10000U + slack)
+        {
+            printf("  FAIL: task shares add up to %.2f %%\n", task_x100 / 100.0);
+            failed = 1;
+        }
+        if (snap.load_x100 >= 10000U)
+        {
+            printf("  FAIL: no idle time\n");
+            failed = 1;
+        }
+        if (rx0->calls == 0U || tim6->calls == 0U)
+        {
+            printf("  FAIL: CAN1_RX0 or TIM6 interrupts not counted\n");
+            failed = 1;
+        }
+    }
+    HOST_PORT_Exit(failed);
+}
+
+static void uart_null_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)data;
+    (void)len;
+    (void)ctx;
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t feeder;
+
+    if (argc > 1)
+    {
+        s_fwMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    printf("bench_rtstats: %lu ms firmware, CAN frame every %u us\n",
+           (unsigned long)s_fwMs, CAN_PERIOD_US);
+    phase_cost();
+
+    /* Real time (the default scale): shares are of wall-clock time */
+    HOST_UART_SetTxSink(USART2, uart_null_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_PORT_StopAfter(s_fwMs, fw_report);
+
+    pthread_create(&feeder, NULL, can_feeder, NULL);
+    pthread_detach(feeder);
+
+    return vecu_firmware_main();
+}
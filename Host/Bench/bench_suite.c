@@ -0,0 +1,748 @@
+/**
+ * @file    bench_suite.c
+ * @brief   Host benchmark suite for the firmware's hot paths, with JSON
+ *          results and a baseline comparison.
+ *
+ * Cases (firmware code as built for the ECU, on the host HAL stand-ins;
+ * the kernel is never started):
+ *
+ *   vehicle_update  Vehicle_UpdateMs() at 10 ms steps, target speed
+ *                   changed every 1024 steps                  (per step)
+ *   can_tlm_codec   CAN_DB_VehicleTelemetry_Pack() + _Unpack()
+ *                                                             (per frame)
+ *   hostlink_codec  vehicle payload -> HOSTLINK_Encode() -> byte-wise
+ *                   HOSTLINK_DecodeByte() until the frame is back
+ *                                                             (per frame)
+ *   cli_parse       CLI_IF_Exec() of a four-argument line (u, i, f, s)
+ *                   into a bench command: lookup, tokenising, number
+ *                   parsing, dispatch                         (per line)
+ *   can_rx_ring     FIFO0 RX: three frames into the host bxCAN, one
+ *                   HAL_CAN_IRQHandler() drain into the CAN_IF ring,
+ *                   three CAN_IF_RxGet() / CAN_IF_RxRelease() (per frame)
+ *
+ * Method: every case restores its state before each sample, so each
+ * sample does exactly the same work on the same inputs (fixed seeds, no
+ * randomness). The cases run in rounds, one sample of each per round: one
+ * warm-up round is discarded, then -r rounds are timed and each case is
+ * reduced to min / median / mean / stddev / max in ns per operation.
+ * Samples are timed in CPU time of the thread (CLOCK_THREAD_CPUTIME_ID),
+ * so time slices given to other processes are not counted. For steadier
+ * figures, pin the process to one idle core (taskset -c N bench_suite ...).
+ * Every case also checks its own output (round trips, argument values,
+ * frame IDs) and folds it into a digest, so the work cannot be optimised
+ * away and a functional break fails the run.
+ *
+ * Calibration: right before each sample, a fixed integer / float divide /
+ * table loop is timed too, and the sample is also expressed relative to it
+ * ("rel": case ns per op / calibration ns per op). The ratio cancels the
+ * host's clock speed and load that drifts slower than a sample, so it
+ * moves far less between runs than the ns figures do.
+ *
+ * Baseline: -b compares each case's rel median against the file's. The
+ * limit is
+ *
+ *   base * (1 + tol/100) + k * sqrt(base_sd^2 + sd^2)
+ *
+ * with the rel stddevs of the baseline and of this run, so a noisy case
+ * gets more room than a steady one. If a case is above the limit, all
+ * cases are measured again, up to -a attempts, and each keeps its best
+ * result; a case still above the limit after that is a regression: it
+ * prints a FAIL line, the results file says "status": "fail", and the
+ * exit status is 1 (so bench_suite_check fails the build step). The
+ * baseline is a results file from an earlier run (the same JSON), so
+ * updating it is:
+ *
+ *   build-host/bench_suite -o Host/Bench/bench_suite_baseline.json
+ *
+ * Ratios still depend on the CPU model, compiler and build type: record
+ * the baseline on the machine that runs the check.
+ *
+ * Usage: bench_suite [-r samples] [-o results.json] [-b baseline.json]
+ *                    [-t tol_pct] [-k sigmas] [-a attempts]
+ *                    (default 15 rounds, 10 %, 3 sigmas, 3 attempts)
+ * Exit status is 1 if a check fails or a case regressed.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "main.h"
+#include "can_db.h"
+#include "can_if.h"
+#include "cli_if.h"
+#include "hostlink_proto.h"
+#include "host_hal.h"
+#include "vehicle.h"
+
+/* Linked against vecu_firmware_main for hcan1; the firmware is not run */
+extern CAN_HandleTypeDef hcan1;
+
+#define SUITE_NAME        "vecu_bench_suite"
+#define SUITE_VERSION     2
+#define MAX_SAMPLES       101U
+#define MAX_CASES         8U
+#define BASELINE_MAX      65536U
+#define CALIB_OPS         100000U   /* about 0.3 ms per calibration run */
+
+typedef struct
+{
+    const char *name;
+    const char *unit;                 /* what one operation is */
+    uint32_t    ops;                  /* operations per sample */
+    void      (*setup)(void);         /* restore state before a sample */
+    uint32_t  (*run)(uint32_t ops);   /* returns a digest of the output */
+} Case_t;
+
+typedef struct
+{
+    double   min, median, mean, stddev, max;
+} Stats_t;
+
+typedef struct
+{
+    Stats_t  ns;                    /* ns per operation */
+    Stats_t  rel;                   /* relative to the calibration loop */
+    uint32_t digest;
+    double   base_rel;              /* 0 if not in the baseline */
+    double   limit;                 /* rel median above this regressed */
+    int      regressed;
+} Result_t;
+
+static uint32_t s_fail;
+static Stats_t  s_calib;            /* calibration ns per op, all samples */
+static double   s_calibNs[MAX_CASES * MAX_SAMPLES];
+static uint32_t s_calibCount;
+
+static void check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        if (s_fail < 10U)
+        {
+            printf("  FAIL: %s\n", what);
+        }
+        s_fail++;
+    }
+}
+
+/* CPU time of this thread: preemption by other processes is not counted */
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* --------------------------------------------------------------------------
+ * Calibration: integer, float and table work, not firmware code, so it
+ * does not move when the firmware changes
+ * -------------------------------------------------------------------------- */
+
+static uint32_t s_calTab[256];
+
+static uint32_t calib_run(uint32_t ops)
+{
+    uint32_t x = 0x12345678U;
+    float f = 1.0f;
+
+    memset(s_calTab, 0, sizeof(s_calTab));
+    for (uint32_t i = 0U; i < ops; i++)
+    {
+        x = x * 1664525U + 1013904223U;
+        s_calTab[x >> 24] += x;
+        f = f * 0.999f + (float)(s_calTab[(x >> 8) & 255U] & 255U) / (float)((x >> 16) | 1U);
+    }
+    return x ^ s_calTab[x & 255U] ^ (uint32_t)(f * 1000.0f);
+}
+
+/* --------------------------------------------------------------------------
+ * vehicle_update
+ * -------------------------------------------------------------------------- */
+
+static VehicleState_t s_vs;
+
+static const float s_targets[8] = { 50.0f, 120.0f, 0.0f, 80.0f, 30.0f, 100.0f, 10.0f, 60.0f };
+
+static void vehicle_setup(void)
+{
+    Vehicle_Init(&s_vs);
+}
+
+static uint32_t vehicle_run(uint32_t ops)
+{
+    uint32_t digest = 0U;
+
+    for (uint32_t i = 0U; i < ops; i++)
+    {
+        if ((i & 1023U) == 0U)
+        {
+            Vehicle_SetTargetSpeed(&s_vs, s_targets[(i >> 10) & 7U]);
+        }
+        Vehicle_UpdateMs(&s_vs, 10U);
+    }
+    digest = (uint32_t)(Vehicle_GetSpeedKph(&s_vs) * 10.0f) * 31U + s_vs.engine_rpm;
+    check(Vehicle_GetSpeedKph(&s_vs) >= 0.0f, "vehicle_update: negative speed");
+    return digest;
+}
+
+/* --------------------------------------------------------------------------
+ * can_tlm_codec
+ * -------------------------------------------------------------------------- */
+
+static uint32_t tlm_run(uint32_t ops)
+{
+    uint8_t data[CAN_DB_VEHICLE_TELEMETRY_DLC];
+    CAN_DB_VehicleTelemetry_t in;
+    CAN_DB_VehicleTelemetry_t out;
+    uint32_t digest = 0U;
+    uint32_t bad = 0U;
+
+    for (uint32_t i = 0U; i < ops; i++)
+    {
+        in.speed        = (uint16_t)(i * 7U);
+        in.engine_rpm   = (uint16_t)(i * 13U);
+        in.coolant_temp = (int16_t)((int32_t)(i % 1500U) - 400);
+        CAN_DB_VehicleTelemetry_Pack(data, &in);
+        CAN_DB_VehicleTelemetry_Unpack(&out, data);
+        bad += (out.speed != in.speed) + (out.engine_rpm != in.engine_rpm) +
+               (out.coolant_temp != in.coolant_temp);
+        digest = digest * 31U + data[0] + data[3] + data[5];
+    }
+    check(bad == 0U, "can_tlm_codec: round trip mismatch");
+    return digest;
+}
+
+/* --------------------------------------------------------------------------
+ * hostlink_codec
+ * -------------------------------------------------------------------------- */
+
+static HOSTLINK_Decoder_t s_dec;
+
+static void hostlink_setup(void)
+{
+    HOSTLINK_DecoderInit(&s_dec, 1U);
+}
+
+static uint32_t hostlink_run(uint32_t ops)
+{
+    uint8_t p[1U + HOSTLINK_VEHICLE_LEN];
+    uint8_t frame[HOSTLINK_MAX_FRAME];
+    uint32_t digest = 0U;
+    uint32_t frames = 0U;
+
+    for (uint32_t i = 0U; i < ops; i++)
+    {
+        p[0] = HOSTLINK_MSG_VEHICLE;
+        HOSTLINK_PutU32(&p[1],  i);
+        HOSTLINK_PutU32(&p[5],  i * 10U);
+        HOSTLINK_PutF32(&p[9],  (float)(i % 2000U) * 0.1f);
+        HOSTLINK_PutU16(&p[13], (uint16_t)(i * 3U));
+        HOSTLINK_PutF32(&p[15], 90.0f);
+
+        const uint32_t n = HOSTLINK_Encode(frame, p, sizeof(p));
+        for (uint32_t k = 0U; k < n; k++)
+        {
+            const uint8_t *payload;
+            uint32_t len;
+
+            if (HOSTLINK_DecodeByte(&s_dec, frame[k], &payload, &len) == 1)
+            {
+                frames += (len == sizeof(p) && HOSTLINK_GetU32(&payload[1]) == i);
+                digest = digest * 31U + n;
+            }
+        }
+    }
+    check(frames == ops, "hostlink_codec: frame lost or corrupted");
+    return digest;
+}
+
+/* --------------------------------------------------------------------------
+ * cli_parse
+ * -------------------------------------------------------------------------- */
+
+static uint32_t s_cliDigest;
+static uint32_t s_cliCalls;
+
+static void cmd_suite_parse(const CLI_IF_Args_t *args)
+{
+    s_cliCalls++;
+    s_cliDigest = s_cliDigest * 31U + args->argv[0].u + (uint32_t)args->argv[1].i +
+                  (uint32_t)(int32_t)(args->argv[2].f * 4.0f) + (uint32_t)args->argv[3].s[0];
+}
+
+CLI_IF_CMD(suite_parse, "suite parse", "u:a i:b f:c s:d", cmd_suite_parse, NULL);
+
+static const char *const s_lines[4] = {
+    "suite parse 4096 -17 3.25 abc",
+    "suite parse 0x10 5 -0.5 xyz",
+    "suite  parse 7 -1 100 speed",
+    "suite parse 65535 123456 0.75 q",
+};
+
+static void cli_setup(void)
+{
+    s_cliDigest = 0U;
+    s_cliCalls  = 0U;
+}
+
+static uint32_t cli_run(uint32_t ops)
+{
+    char line[CLI_IF_LINE_LEN];
+
+    for (uint32_t i = 0U; i < ops; i++)
+    {
+        /* The parser tokenises in place: a fresh copy per line */
+        (void)strcpy(line, s_lines[i & 3U]);
+        CLI_IF_Exec(line);
+    }
+    check(s_cliCalls == ops, "cli_parse: handler not reached");
+    return s_cliDigest;
+}
+
+/* --------------------------------------------------------------------------
+ * can_rx_ring
+ * -------------------------------------------------------------------------- */
+
+static void can_setup_once(void)
+{
+    /* Same parameters as MX_CAN1_Init() in main.c */
+    hcan1.Instance = CAN1;
+    hcan1.Init.Prescaler = 16;
+    hcan1.Init.Mode = CAN_MODE_LOOPBACK;
+    hcan1.Init.SyncJumpWidth = CAN_SJW_1TQ;
+    hcan1.Init.TimeSeg1 = CAN_BS1_13TQ;
+    hcan1.Init.TimeSeg2 = CAN_BS2_2TQ;
+    hcan1.Init.TimeTriggeredMode = DISABLE;
+    hcan1.Init.AutoBusOff = DISABLE;
+    hcan1.Init.AutoWakeUp = DISABLE;
+    hcan1.Init.AutoRetransmission = ENABLE;
+    hcan1.Init.ReceiveFifoLocked = DISABLE;
+    hcan1.Init.TransmitFifoPriority = DISABLE;
+    check(HAL_CAN_Init(&hcan1) == HAL_OK, "can_rx_ring: HAL_CAN_Init");
+    check(CAN_IF_Init() == HAL_OK, "can_rx_ring: CAN_IF_Init");
+}
+
+static uint32_t can_rx_run(uint32_t ops)
+{
+    uint8_t data[8] = { 0 };
+    uint32_t digest = 0U;
+    uint32_t bad = 0U;
+
+    /* FIFO0 holds three frames: one interrupt per burst, as on target */
+    for (uint32_t i = 0U; i < ops; i += 3U)
+    {
+        for (uint32_t k = 0U; k < 3U; k++)
+        {
+            data[0] = (uint8_t)(i + k);
+            bad += (HOST_CAN_InjectFrame(0x200U + k, 8U, data) != 1);
+        }
+        HAL_CAN_IRQHandler(&hcan1);
+        for (uint32_t k = 0U; k < 3U; k++)
+        {
+            const CAN_IF_Msg_t *m = CAN_IF_RxGet(CAN_RX_FIFO0, 0U);
+
+            if (m == NULL)
+            {
+                bad++;
+                continue;
+            }
+            bad += (m->id != 0x200U + k) || (m->data[0] != (uint8_t)(i + k));
+            digest = digest * 31U + m->id + m->data[0];
+            CAN_IF_RxRelease(CAN_RX_FIFO0);
+        }
+    }
+    check(bad == 0U, "can_rx_ring: frame lost, reordered or misrouted");
+    return digest;
+}
+
+/* --------------------------------------------------------------------------
+ * Runner
+ * -------------------------------------------------------------------------- */
+
+static const Case_t s_cases[] = {
+    { "vehicle_update", "step",  200000U, vehicle_setup,  vehicle_run  },
+    { "can_tlm_codec",  "frame", 4000000U, NULL,           tlm_run      },
+    { "hostlink_codec", "frame", 100000U, hostlink_setup, hostlink_run },
+    { "cli_parse",      "line",  100000U, cli_setup,      cli_run      },
+    { "can_rx_ring",    "frame",  60000U, NULL,           can_rx_run   },
+};
+
+#define CASE_COUNT   (sizeof(s_cases) / sizeof(s_cases[0]))
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Sorts @p v in place */
+static void reduce(double *v, uint32_t n, Stats_t *st)
+{
+    double sum = 0.0;
+    double sq = 0.0;
+
+    qsort(v, n, sizeof(v[0]), cmp_double);
+    st->min    = v[0];
+    st->max    = v[n - 1U];
+    st->median = ((n & 1U) != 0U) ? v[n / 2U] : (v[n / 2U - 1U] + v[n / 2U]) * 0.5;
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        sum += v[i];
+    }
+    st->mean = sum / (double)n;
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        sq += (v[i] - st->mean) * (v[i] - st->mean);
+    }
+    st->stddev = (n > 1U) ? sqrt(sq / (double)(n - 1U)) : 0.0;
+}
+
+/*
+ * Round @p s of every case: the calibration loop, then the case. Round 0
+ * is the warm-up and only records the digests. Running the cases in turn,
+ * rather than all samples of one case in a row, spreads a burst of host
+ * load over one sample of several cases instead of every sample of one.
+ */
+static void run_round(uint32_t s, Result_t *res, double ns[][MAX_SAMPLES],
+                      double rel[][MAX_SAMPLES])
+{
+    static uint32_t calDigest;
+
+    for (uint32_t i = 0U; i < CASE_COUNT; i++)
+    {
+        const Case_t *c = &s_cases[i];
+        Result_t *r = &res[i];
+
+        const double tc = now_ns();
+        const uint32_t cd = calib_run(CALIB_OPS);
+        const double cal = (now_ns() - tc) / (double)CALIB_OPS;
+
+        if (c->setup != NULL)
+        {
+            c->setup();
+        }
+        const double t0 = now_ns();
+        const uint32_t digest = c->run(c->ops);
+        const double dt = (now_ns() - t0) / (double)c->ops;
+
+        if (s == 0U)
+        {
+            r->digest = digest;     /* warm-up: not timed */
+            calDigest = cd;
+            continue;
+        }
+        check(digest == r->digest, "digest differs between samples (not reproducible)");
+        check(cd == calDigest, "calibration digest differs between samples");
+        ns[i][s - 1U]  = dt;
+        rel[i][s - 1U] = dt / cal;
+        s_calibNs[s_calibCount++] = cal;
+    }
+}
+
+/*
+ * Number @p field of case @p name in a results file written by this
+ * program: the first one after its "name" entry. 0 if absent (also for a
+ * version 1 file, which has no "rel_" fields).
+ */
+static double baseline_field(const char *json, const char *name, const char *field)
+{
+    char key[64];
+    const char *p;
+
+    snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+    p = strstr(json, key);
+    if (p == NULL)
+    {
+        return 0.0;
+    }
+    const char *end = strchr(p, '}');
+    snprintf(key, sizeof(key), "\"%s\":", field);
+    p = strstr(p, key);
+    if (p == NULL || (end != NULL && p > end))
+    {
+        return 0.0;
+    }
+    return strtod(p + strlen(key), NULL);
+}
+
+static char *read_file(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char *buf;
+    size_t n;
+
+    if (f == NULL)
+    {
+        return NULL;
+    }
+    buf = malloc(BASELINE_MAX + 1U);
+    n = (buf != NULL) ? fread(buf, 1U, BASELINE_MAX, f) : 0U;
+    fclose(f);
+    if (buf != NULL)
+    {
+        buf[n] = '\0';
+    }
+    return buf;
+}
+
+static int write_json(const char *path, const Result_t *res, uint32_t samples,
+                      uint32_t attempts, const char *baseline, double tol, double k, int pass)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL)
+    {
+        return -1;
+    }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"suite\": \"%s\",\n", SUITE_NAME);
+    fprintf(f, "  \"version\": %d,\n", SUITE_VERSION);
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(f, "  \"samples\": %lu,\n", (unsigned long)samples);
+    if (baseline != NULL)
+    {
+        fprintf(f, "  \"baseline\": \"%s\",\n", baseline);
+        fprintf(f, "  \"tolerance_pct\": %.1f,\n", tol);
+        fprintf(f, "  \"sigmas\": %.1f,\n", k);
+        fprintf(f, "  \"attempts\": %lu,\n", (unsigned long)attempts);
+    }
+    fprintf(f, "  \"calibration_ns\": { \"ops\": %lu, \"median\": %.3f, \"stddev\": %.3f },\n",
+            (unsigned long)CALIB_OPS, s_calib.median, s_calib.stddev);
+    fprintf(f, "  \"status\": \"%s\",\n", pass ? "pass" : "fail");
+    fprintf(f, "  \"cases\": [\n");
+    for (uint32_t i = 0U; i < CASE_COUNT; i++)
+    {
+        const Case_t *c = &s_cases[i];
+        const Result_t *r = &res[i];
+
+        fprintf(f, "    {\n");
+        fprintf(f, "      \"name\": \"%s\",\n", c->name);
+        fprintf(f, "      \"unit\": \"ns/%s\",\n", c->unit);
+        fprintf(f, "      \"ops\": %lu,\n", (unsigned long)c->ops);
+        fprintf(f, "      \"min_ns\": %.3f,\n", r->ns.min);
+        fprintf(f, "      \"median_ns\": %.3f,\n", r->ns.median);
+        fprintf(f, "      \"mean_ns\": %.3f,\n", r->ns.mean);
+        fprintf(f, "      \"stddev_ns\": %.3f,\n", r->ns.stddev);
+        fprintf(f, "      \"max_ns\": %.3f,\n", r->ns.max);
+        fprintf(f, "      \"ops_per_s\": %.0f,\n", 1e9 / r->ns.median);
+        fprintf(f, "      \"rel_median\": %.5f,\n", r->rel.median);
+        fprintf(f, "      \"rel_stddev\": %.5f,\n", r->rel.stddev);
+        if (r->base_rel > 0.0)
+        {
+            fprintf(f, "      \"baseline_rel_median\": %.5f,\n", r->base_rel);
+            fprintf(f, "      \"limit_rel\": %.5f,\n", r->limit);
+            fprintf(f, "      \"delta_pct\": %.1f,\n",
+                    (r->rel.median / r->base_rel - 1.0) * 100.0);
+            fprintf(f, "      \"regressed\": %s,\n", r->regressed ? "true" : "false");
+        }
+        fprintf(f, "      \"digest\": \"0x%08lx\"\n", (unsigned long)r->digest);
+        fprintf(f, "    }%s\n", (i + 1U < CASE_COUNT) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    static double ns[MAX_CASES][MAX_SAMPLES];
+    static double rel[MAX_CASES][MAX_SAMPLES];
+    Result_t res[MAX_CASES];
+    Result_t cur[MAX_CASES];
+    uint32_t samples = 15U;
+    uint32_t attempts = 3U;
+    uint32_t attempt;
+    const char *out = NULL;
+    const char *base = NULL;
+    char *baseJson = NULL;
+    double tol = 10.0;
+    double k = 3.0;
+    uint32_t regressions = 0U;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            samples = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            out = argv[++i];
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            base = argv[++i];
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            tol = strtod(argv[++i], NULL);
+            if (tol < 0.0)
+            {
+                printf("bench_suite: tolerance must be >= 0\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc)
+        {
+            attempts = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+        {
+            k = strtod(argv[++i], NULL);
+            if (k < 0.0)
+            {
+                printf("bench_suite: sigmas must be >= 0\n");
+                return 1;
+            }
+        }
+        else
+        {
+            printf("usage: %s [-r samples] [-o results.json] [-b baseline.json] [-t tol_pct]"
+                   " [-k sigmas] [-a attempts]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (samples == 0U)
+    {
+        samples = 1U;
+    }
+    if (samples > MAX_SAMPLES)
+    {
+        samples = MAX_SAMPLES;
+    }
+    if (attempts == 0U)
+    {
+        attempts = 1U;
+    }
+    if (base != NULL)
+    {
+        baseJson = read_file(base);
+        if (baseJson == NULL)
+        {
+            printf("bench_suite: cannot read baseline %s\n", base);
+            return 1;
+        }
+        char ver[32];
+        snprintf(ver, sizeof(ver), "\"version\": %d,", SUITE_VERSION);
+        if (strstr(baseJson, ver) == NULL)
+        {
+            printf("bench_suite: baseline %s is not version %d, record it again\n",
+                   base, SUITE_VERSION);
+            free(baseJson);
+            return 1;
+        }
+    }
+
+    CLI_IF_Init(NULL, NULL);   /* no console: index only */
+    can_setup_once();
+
+    printf("bench_suite: %lu rounds + 1 warm-up, ns per op%s%s\n",
+           (unsigned long)samples, (base != NULL) ? ", baseline " : "",
+           (base != NULL) ? base : "");
+
+    /*
+     * Host load can shift every sample of a run for seconds, which no
+     * per-run statistic sees. A case over the limit is measured again, up
+     * to -a attempts, keeping its best result: a real regression stays
+     * over the limit every time, a busy host rarely does.
+     */
+    for (attempt = 1U; ; attempt++)
+    {
+        s_calibCount = 0U;
+        for (uint32_t s = 0U; s <= samples; s++)
+        {
+            run_round(s, cur, ns, rel);
+        }
+
+        regressions = 0U;
+        for (uint32_t i = 0U; i < CASE_COUNT; i++)
+        {
+            const Case_t *c = &s_cases[i];
+            Result_t *r = &res[i];
+
+            reduce(ns[i], samples, &cur[i].ns);
+            reduce(rel[i], samples, &cur[i].rel);
+            if (attempt == 1U || cur[i].rel.median < r->rel.median)
+            {
+                *r = cur[i];
+            }
+            r->base_rel = (baseJson != NULL) ? baseline_field(baseJson, c->name, "rel_median") : 0.0;
+            if (r->base_rel > 0.0)
+            {
+                const double bsd = baseline_field(baseJson, c->name, "rel_stddev");
+
+                r->limit = r->base_rel * (1.0 + tol / 100.0) +
+                           k * sqrt(bsd * bsd + r->rel.stddev * r->rel.stddev);
+            }
+            r->regressed = (r->base_rel > 0.0) && (r->rel.median > r->limit);
+            regressions += (uint32_t)r->regressed;
+        }
+        if (regressions == 0U || attempt >= attempts)
+        {
+            break;
+        }
+        printf("  %lu cases over the limit, measuring again (attempt %lu of %lu)\n",
+               (unsigned long)regressions, (unsigned long)(attempt + 1U), (unsigned long)attempts);
+    }
+
+    printf("  %-16s %10s %10s %10s %10s %10s %12s %8s\n",
+           "case", "min", "median", "mean", "stddev", "max", "ops/s", "rel");
+    for (uint32_t i = 0U; i < CASE_COUNT; i++)
+    {
+        const Case_t *c = &s_cases[i];
+        const Result_t *r = &res[i];
+
+        printf("  %-16s %10.2f %10.2f %10.2f %10.2f %10.2f %12.0f %8.3f",
+               c->name, r->ns.min, r->ns.median, r->ns.mean, r->ns.stddev, r->ns.max,
+               1e9 / r->ns.median, r->rel.median);
+        if (r->base_rel > 0.0)
+        {
+            printf("  %+6.1f %%", (r->rel.median / r->base_rel - 1.0) * 100.0);
+        }
+        else if (baseJson != NULL)
+        {
+            printf("  (not in baseline)");
+        }
+        printf("\n");
+    }
+    free(baseJson);
+    reduce(s_calibNs, s_calibCount, &s_calib);
+    printf("  calibration: %.3f ns per op (stddev %.3f); rel = case / calibration\n",
+           s_calib.median, s_calib.stddev);
+
+    for (uint32_t i = 0U; i < CASE_COUNT; i++)
+    {
+        if (res[i].regressed)
+        {
+            printf("  FAIL: %s regressed: rel %.3f, baseline %.3f, limit %.3f (%+.1f %%)\n",
+                   s_cases[i].name, res[i].rel.median, res[i].base_rel, res[i].limit,
+                   (res[i].rel.median / res[i].base_rel - 1.0) * 100.0);
+        }
+    }
+
+    const int pass = (s_fail == 0U && regressions == 0U);
+
+    if (out != NULL && write_json(out, res, samples, attempt, base, tol, k, pass) != 0)
+    {
+        printf("bench_suite: cannot write %s\n", out);
+        return 1;
+    }
+    if (out != NULL)
+    {
+        printf("  results written to %s\n", out);
+    }
+
+    if (!pass)
+    {
+        printf("  %lu check failures, %lu regressions: exit status 1\n",
+               (unsigned long)s_fail, (unsigned long)regressions);
+        return 1;
+    }
+    printf("  all checks OK\n");
+    return 0;
+}
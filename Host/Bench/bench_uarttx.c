@@ -0,0 +1,188 @@
+/**
+ * @file    bench_uarttx.c
+ * @brief   Console output benchmark: CPU time spent in logging.
+ *
+ * Boots the full firmware with CAN RX logging on (CAN_IF_SetLogging) and
+ * a feeder task that offers frames at a fixed rate, so every frame turns
+ * into console lines (written by LogTask from the deferred log, dlog.h).
+ * The UART sink counts the bytes that reach the wire. Reported from the
+ * uart_tx counters (uart_tx.h):
+ *
+ *   - writes and bytes accepted, messages/bytes dropped
+ *   - time per UART_TX_Write() call in core cycles (cyccnt.h; host wall
+ *     clock scaled to SystemCoreClock)
+ *   - caller stall: with UART_TX_DMA=0 the caller busy-waits for every
+ *     byte at 10 bit times per byte (8N1). The host UART model does not
+ *     charge that time to a blocking transmitter, so it is computed from
+ *     the bytes written and the configured baud rate.
+ *
+ * Built twice: bench_uarttx (DMA TX ring, the default) and
+ * bench_uarttx_blocking (UART_TX_DMA=0, blocking HAL_UART_Transmit()).
+ * With DMA, every accepted byte must have reached the sink or still be
+ * pending in the ring, or the benchmark exits with status 1. Offer
+ * more lines than the baud rate carries (e.g. 400 frames/s) to see the
+ * overflow policy at work.
+ *
+ * With DMA the feeder also fails one TX DMA transfer per second, half
+ * way through the second (HOST_UART_InjectTxError()). Each error must be
+ * counted and output must reach the wire after the last one, or the
+ * benchmark exits with status 1. Pass errors 0 to turn this off.
+ *
+ * Usage: bench_uarttx [run_ms] [frames_per_s] [errors]   (default 5000 100 1)
+ *        VECU_HOST_SPEED=0 for free-running virtual time (recommended).
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "can_if.h"
+#include "uart_tx.h"
+#include "dlog.h"
+#include "cyccnt.h"
+#include "cmsis_os2.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+extern UART_HandleTypeDef huart2;
+
+#define FEED_ID   0x200U
+
+static uint32_t     s_runMs = 5000U;
+static uint32_t     s_rate  = 100U;
+static uint32_t     s_txErrors = 1U;
+static atomic_ulong s_wireBytes;
+static atomic_uint  s_offered;
+static uint32_t     s_injected;          /* TX DMA errors injected        */
+static unsigned long s_wireAtInject;     /* wire bytes at the last one    */
+
+static void uart_count_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)data;
+    (void)ctx;
+    atomic_fetch_add(&s_wireBytes, len);
+}
+
+/* Frames spread evenly over each second, carried in whole ticks */
+static void feeder_task(void *argument)
+{
+    uint32_t wake = osKernelGetTickCount();
+    uint32_t acc = 0U;
+    uint8_t data[8] = { 0 };
+
+    (void)argument;
+    CAN_IF_SetLogging(1U);
+
+    for (;;)
+    {
+        (void)osDelayUntil(++wake);
+        if (UART_TX_DMA && s_txErrors != 0U && wake % 1000U == 500U)
+        {
+            s_wireAtInject = atomic_load(&s_wireBytes);
+            s_injected++;
+            HOST_UART_InjectTxError(USART2);
+        }
+        acc += s_rate;
+        while (acc >= 1000U)
+        {
+            acc -= 1000U;
+            const uint32_t seq = atomic_fetch_add(&s_offered, 1U);
+            memcpy(&data[0], &seq, sizeof(seq));
+            (void)HOST_CAN_InjectFrame(FEED_ID, 8U, data);
+        }
+    }
+}
+
+/* Runs from the tick that ends the simulation */
+static void report(void)
+{
+    UART_TX_Stats_t st;
+    DLOG_Stats_t lg;
+    const uint32_t baud = huart2.Init.BaudRate;
+    const unsigned long wire = atomic_load(&s_wireBytes);
+
+    UART_TX_GetStats(&st);
+    DLOG_GetStats(&lg);
+
+    /* What the same bytes cost a blocking caller on the target */
+    const double stall_ms = (double)st.bytes * 10.0 * 1000.0 / (double)baud;
+    const double cyc_ns   = 1.0e9 / (double)SystemCoreClock;
+    const double avg_cyc  = st.writes ? (double)st.write_cyc_sum / st.writes : 0.0;
+    const double write_ms = (double)st.write_cyc_sum * cyc_ns / 1.0e6;
+
+    printf("bench_uarttx: %s, %lu ms, %lu frames/s offered, %lu baud\n",
+           UART_TX_DMA ? "DMA TX ring" : "blocking HAL_UART_Transmit",
+           (unsigned long)s_runMs, (unsigned long)s_rate, (unsigned long)baud);
+    printf("  writes %lu  bytes %lu  on wire %lu  pending %lu  peak ring %lu  DMA starts %lu\n",
+           (unsigned long)st.writes, (unsigned long)st.bytes, wire,
+           (unsigned long)st.pending, (unsigned long)st.high_water,
+           (unsigned long)st.dma_starts);
+    printf("  dropped %lu msgs / %lu bytes  TX DMA errors %lu of %lu injected\n",
+           (unsigned long)st.dropped_msgs, (unsigned long)st.dropped_bytes,
+           (unsigned long)st.tx_errors, (unsigned long)s_injected);
+    printf("  dlog: written %lu  dropped %lu  UART stalls %lu\n",
+           (unsigned long)lg.written, (unsigned long)lg.dropped, (unsigned long)lg.stalls);
+    printf("  UART_TX_Write: avg %.1f cyc (%.0f ns)  max %lu cyc  total %.2f ms\n",
+           avg_cyc, avg_cyc * cyc_ns, (unsigned long)st.write_cyc_max, write_ms);
+    if (UART_TX_DMA)
+    {
+        printf("  caller stall: none, %.3f %% CPU in the copy\n",
+               100.0 * write_ms / (double)s_runMs);
+    }
+    else
+    {
+        printf("  caller stall: %.1f ms busy-waiting on the wire (%.1f %% CPU)\n",
+               stall_ms, 100.0 * stall_ms / (double)s_runMs);
+    }
+
+    /* pending still counts the part of the running transfer already sent */
+    if (UART_TX_DMA && (wire > st.bytes || st.bytes - wire > st.pending))
+    {
+        printf("  FAIL: %lu bytes accepted, %lu sent, %lu pending\n",
+               (unsigned long)st.bytes, wire, (unsigned long)st.pending);
+        HOST_PORT_Exit(1);
+    }
+    /* A TX DMA error must not end console output */
+    if (UART_TX_DMA && s_injected != 0U &&
+        (st.tx_errors != s_injected || wire <= s_wireAtInject))
+    {
+        printf("  FAIL: %lu of %lu TX DMA errors handled, %lu bytes sent since the last\n",
+               (unsigned long)st.tx_errors, (unsigned long)s_injected,
+               wire - s_wireAtInject);
+        HOST_PORT_Exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        s_runMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        s_rate = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+    {
+        s_txErrors = (uint32_t)strtoul(argv[3], NULL, 0);
+    }
+
+    HOST_UART_SetTxSink(USART2, uart_count_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_PORT_StopAfter(s_runMs, report);
+
+    osKernelInitialize();
+    const osThreadAttr_t attr = {
+        .name       = "feeder",
+        .stack_size = 256U * 4U,
+        .priority   = osPriorityNormal,
+    };
+    (void)osThreadNew(feeder_task, NULL, &attr);
+
+    return vecu_firmware_main();
+}
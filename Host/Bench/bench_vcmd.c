@@ -0,0 +1,389 @@
+/**
+ * @file    bench_vcmd.c
+ * @brief   Vehicle command mailbox: trace replay check and apply cost.
+ *
+ * Links vehicle.c, vehicle_cmd.c and the deferred logger on their own, with
+ * the console UART replaced by a capture buffer (as in bench_dlog), so the
+ * command trace can be read back.
+ *
+ * 1. Replay: a scripted producer posts random target-speed, force and
+ *    coolant commands in bursts between steps, some larger than the queue,
+ *    and the VehicleTask loop (apply, update) runs with the trace on in
+ *    binary log mode. The captured trace is decoded (DLOG_Decode()), and a
+ *    fresh model replays it: the logged commands of each step through
+ *    VehicleCmd_Exec(), then the update. Every step must match the live run
+ *    bit for bit, and the trace must hold exactly the accepted commands.
+ * 2. Cost, read from the TSC on x86 (nanoseconds elsewhere): one model
+ *    step, VehicleCmd_Post(), and VehicleCmd_Apply() with an empty queue,
+ *    one command and a full queue. Applying one command must cost less
+ *    than one model step. vehicle_cmd.c is built with
+ *    VEHICLE_CMD_APPLY_CYC=0: the host cycle counter is a clock_gettime()
+ *    call, which would dominate the apply. On the Cortex-M4, `veh stats`
+ *    shows the longest apply in DWT cycles.
+ *
+ * Usage: bench_vcmd [steps]   (default 20000)
+ * Exit status is 1 if the replay differs, a command is lost unreported, or
+ * one command costs more to apply than a model step.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#include "vehicle.h"
+#include "vehicle_cmd.h"
+#include "dlog.h"
+#include "uart_tx.h"
+#include "cli_if.h"
+
+/* cyccnt.h on the host scales the monotonic clock to the core clock */
+uint32_t SystemCoreClock = 16000000U;
+
+#define STEP_MS      100U
+#define CAPTURE_LEN  (16U * 1024U)
+#define COST_REPS    200000U
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t s_rng = 7U;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1664525U + 1013904223U;
+    return s_rng >> 8;
+}
+
+/* --------------------------------------------------------------------------
+ * Console UART stand-in: everything written lands in s_cap
+ * -------------------------------------------------------------------------- */
+
+static uint8_t  s_cap[CAPTURE_LEN];
+static uint32_t s_capLen;
+
+uint32_t UART_TX_Write(const void *data, uint32_t len)
+{
+    if (len > CAPTURE_LEN - s_capLen)
+    {
+        return 0U;
+    }
+    memcpy(&s_cap[s_capLen], data, len);
+    s_capLen += len;
+    return len;
+}
+
+uint32_t UART_TX_Free(void)
+{
+    return CAPTURE_LEN - s_capLen;
+}
+
+void UART_TX_Flush(void)
+{
+}
+
+void CLI_IF_Print(const char *s)
+{
+    (void)UART_TX_Write(s, (uint32_t)strlen(s));
+}
+
+/* --------------------------------------------------------------------------
+ * Commands and the trace
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uint32_t     step;
+    VehicleCmd_t cmd;
+} LoggedCmd_t;
+
+static LoggedCmd_t *s_log;
+static uint32_t     s_logLen;
+static uint32_t     s_logCap;
+static uint32_t     s_badRecords;
+
+static void make_cmd(VehicleCmd_t *c)
+{
+    memset(c, 0, sizeof(*c));
+    switch (rng_next() % 4U)
+    {
+    case 0U:
+        c->type      = VEHICLE_CMD_FORCE;
+        c->kph10     = (int32_t)(rng_next() % 3200U) - 100;
+        c->rpm       = (uint16_t)(rng_next() % 9000U);
+        c->coolant10 = (int32_t)(rng_next() % 2000U) - 500;
+        break;
+    case 1U:
+        c->type      = VEHICLE_CMD_COOLANT;
+        c->coolant10 = (int32_t)(rng_next() % 1500U);
+        break;
+    default:
+        c->type      = VEHICLE_CMD_TARGET_SPEED;
+        c->kph10     = (int32_t)(rng_next() % 2200U) - 100;
+        break;
+    }
+}
+
+/* Trace record back to the command it was logged for */
+static int cmd_from_record(const DLOG_Record_t *r, LoggedCmd_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->step = r->arg[0];
+    switch (r->id)
+    {
+    case DLOG_VEH_TARGET:
+        out->cmd.type      = VEHICLE_CMD_TARGET_SPEED;
+        out->cmd.kph10     = (int32_t)r->arg[1];
+        return 1;
+    case DLOG_VEH_FORCE:
+        out->cmd.type      = VEHICLE_CMD_FORCE;
+        out->cmd.kph10     = (int32_t)r->arg[1];
+        out->cmd.rpm       = (uint16_t)r->arg[2];
+        out->cmd.coolant10 = (int32_t)r->arg[3];
+        return 1;
+    case DLOG_VEH_COOLANT:
+        out->cmd.type      = VEHICLE_CMD_COOLANT;
+        out->cmd.coolant10 = (int32_t)r->arg[1];
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Drain the logger into the capture and decode it into s_log */
+static void collect_trace(void)
+{
+    DLOG_Record_t rec;
+    uint32_t pos = 0U;
+
+    while (DLOG_Process() != 0U)
+    {
+    }
+    while (pos < s_capLen)
+    {
+        const int n = DLOG_Decode(&s_cap[pos], s_capLen - pos, &rec);
+        if (n <= 0)
+        {
+            s_badRecords++;
+            pos++;
+            continue;
+        }
+        pos += (uint32_t)n;
+        if (s_logLen == s_logCap)
+        {
+            s_logCap = s_logCap ? 2U * s_logCap : 1024U;
+            s_log = realloc(s_log, s_logCap * sizeof(*s_log));
+            if (s_log == NULL)
+            {
+                exit(1);
+            }
+        }
+        if (cmd_from_record(&rec, &s_log[s_logLen]))
+        {
+            s_logLen++;
+        }
+        else
+        {
+            s_badRecords++;
+        }
+    }
+    s_capLen = 0U;
+}
+
+static int same_state(const VehicleState_t *a, const VehicleState_t *b)
+{
+    return memcmp(&a->speed_kph, &b->speed_kph, sizeof(a->speed_kph)) == 0 &&
+           a->engine_rpm == b->engine_rpm &&
+           memcmp(&a->coolant_temp_c, &b->coolant_temp_c, sizeof(a->coolant_temp_c)) == 0;
+}
+
+/* --------------------------------------------------------------------------
+ * 1. Live run and replay
+ * -------------------------------------------------------------------------- */
+
+static int check_replay(uint32_t steps)
+{
+    VehicleState_t *live = malloc((steps + 1U) * sizeof(*live));
+    VehicleState_t vs;
+    VehicleCmd_Stats_t st;
+    uint32_t accepted = 0U;
+    uint32_t refused = 0U;
+    int fail = 0;
+
+    if (live == NULL)
+    {
+        return 1;
+    }
+
+    DLOG_Init();
+    DLOG_SetMode(DLOG_MODE_BINARY);
+    VehicleCmd_Init();
+    VehicleCmd_SetTrace(1U);
+    Vehicle_Init(&vs);
+    live[0] = vs;
+
+    for (uint32_t step = 1U; step <= steps; step++)
+    {
+        /* Producer: mostly quiet, sometimes a burst past the queue size */
+        const uint32_t r = rng_next() % 16U;
+        const uint32_t burst = (r < 10U) ? 0U : (r < 15U) ? 1U + rng_next() % 4U
+                                                         : rng_next() % (VEHICLE_CMD_QUEUE_LEN + 8U);
+        for (uint32_t i = 0U; i < burst; i++)
+        {
+            VehicleCmd_t c;
+            make_cmd(&c);
+            if (VehicleCmd_Post(&c) == HAL_OK) accepted++;
+            else                               refused++;
+        }
+
+        /* VehicleTask */
+        (void)VehicleCmd_Apply(&vs, step);
+        Vehicle_UpdateMs(&vs, STEP_MS);
+        live[step] = vs;
+
+        collect_trace();
+    }
+    VehicleCmd_GetStats(&st);
+
+    /* Replay the trace on a fresh model */
+    uint32_t k = 0U;
+    uint32_t first_bad = 0U;
+    Vehicle_Init(&vs);
+    for (uint32_t step = 1U; step <= steps; step++)
+    {
+        while (k < s_logLen && s_log[k].step == step)
+        {
+            VehicleCmd_Exec(&vs, &s_log[k].cmd);
+            k++;
+        }
+        Vehicle_UpdateMs(&vs, STEP_MS);
+        if (!same_state(&vs, &live[step]) && first_bad == 0U)
+        {
+            first_bad = step;
+        }
+    }
+
+    printf("  replay: %lu steps, %lu commands posted, %lu refused (queue full),"
+           " %lu applied, %lu traced\n",
+           (unsigned long)steps, (unsigned long)(accepted + refused),
+           (unsigned long)refused, (unsigned long)st.applied, (unsigned long)s_logLen);
+    printf("          max batch %lu, %s\n", (unsigned long)st.max_batch,
+           first_bad ? "DIFFERS" : "every step bit-identical");
+
+    if (first_bad != 0U)
+    {
+        printf("  FAIL: replay differs from step %lu\n", (unsigned long)first_bad);
+        fail = 1;
+    }
+    if (st.applied != accepted || st.dropped != refused || s_logLen != accepted ||
+        k != s_logLen || s_badRecords != 0U)
+    {
+        printf("  FAIL: command accounting (accepted %lu applied %lu traced %lu"
+               " replayed %lu bad records %lu)\n",
+               (unsigned long)accepted, (unsigned long)st.applied,
+               (unsigned long)s_logLen, (unsigned long)k, (unsigned long)s_badRecords);
+        fail = 1;
+    }
+    free(live);
+    return fail;
+}
+
+/* --------------------------------------------------------------------------
+ * 2. Cost
+ * -------------------------------------------------------------------------- */
+
+static int measure_cost(void)
+{
+    VehicleState_t vs;
+    VehicleCmd_t cmd[VEHICLE_CMD_QUEUE_LEN];
+    uint64_t t0;
+    uint64_t t_step = 0U, t_empty = 0U, t_one = 0U, t_full = 0U, t_post = 0U;
+
+    VehicleCmd_Init();
+    VehicleCmd_SetTrace(0U);
+    Vehicle_Init(&vs);
+    for (uint32_t i = 0U; i < VEHICLE_CMD_QUEUE_LEN; i++)
+    {
+        make_cmd(&cmd[i]);
+        cmd[i].type = VEHICLE_CMD_TARGET_SPEED;   /* keep the model moving */
+    }
+
+    for (uint32_t r = 0U; r < COST_REPS; r++)
+    {
+        t0 = ticks();
+        Vehicle_UpdateMs(&vs, STEP_MS);
+        t_step += ticks() - t0;
+
+        t0 = ticks();
+        (void)VehicleCmd_Apply(&vs, r);
+        t_empty += ticks() - t0;
+
+        (void)VehicleCmd_Post(&cmd[r % VEHICLE_CMD_QUEUE_LEN]);
+        t0 = ticks();
+        (void)VehicleCmd_Apply(&vs, r);
+        t_one += ticks() - t0;
+
+        t0 = ticks();
+        for (uint32_t i = 0U; i < VEHICLE_CMD_QUEUE_LEN; i++)
+        {
+            (void)VehicleCmd_Post(&cmd[i]);
+        }
+        t_post += ticks() - t0;
+        t0 = ticks();
+        (void)VehicleCmd_Apply(&vs, r);
+        t_full += ticks() - t0;
+    }
+
+    printf("  cost (" BENCH_UNIT ", mean of %lu, timer overhead included):\n",
+           (unsigned long)COST_REPS);
+    printf("    model step              %7.1f\n", (double)t_step / COST_REPS);
+    printf("    post                    %7.1f\n",
+           (double)t_post / COST_REPS / VEHICLE_CMD_QUEUE_LEN);
+    printf("    apply, empty queue      %7.1f\n", (double)t_empty / COST_REPS);
+    printf("    apply, 1 command        %7.1f\n", (double)t_one / COST_REPS);
+    printf("    apply, %2lu commands      %7.1f  (%.1f per command)\n",
+           (unsigned long)VEHICLE_CMD_QUEUE_LEN, (double)t_full / COST_REPS,
+           (double)t_full / COST_REPS / VEHICLE_CMD_QUEUE_LEN);
+
+    if (t_one >= t_step)
+    {
+        printf("  FAIL: applying one command costs more than a model step\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t steps = 20000U;
+
+    if (argc > 1)
+    {
+        steps = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (steps == 0U)
+    {
+        steps = 1U;
+    }
+
+    printf("bench_vcmd: queue %lu commands\n", (unsigned long)VEHICLE_CMD_QUEUE_LEN);
+    int fail = check_replay(steps);
+    fail |= measure_cost();
+    free(s_log);
+    return fail;
+}
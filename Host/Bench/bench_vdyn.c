@@ -0,0 +1,324 @@
+/**
+ * @file    bench_vdyn.c
+ * @brief   Longitudinal vehicle model: drive-cycle checks and cost per step.
+ *
+ * 1. Drive cycle: one vehicle at 10 ms steps through a scripted set of
+ *    target speeds (launch, cruise, braking, a run to 200 km/h, stop) and
+ *    an overheat injection during a cruise. Every step is checked:
+ *      - acceleration within the controller's limits
+ *      - RPM within idle .. limit, gear within 1 .. 6, one shift per step,
+ *        at least 1 s between shifts
+ *      - speed settled to the target before each new command
+ *      - no gear change in the last 10 s of each cruise (no hunting)
+ *      - coolant warmed into the thermostat band, back below 100 °C
+ *        within 60 s of the overheat injection
+ *    The 0-100 km/h time, braking time and shift count are printed.
+ * 2. Cost: states are sampled along a random drive; each is stepped from
+ *    a copy reps times, and the fastest of three such loops, minus the
+ *    copy-only loop, gives that state's cost per step. Mean and worst
+ *    case over all states are reported for Vehicle_Update() (this model)
+ *    and for the basic model (Vehicle_UpdateBatch() on a one-vehicle
+ *    fleet). A worst case close to the mean shows the per-step cost does
+ *    not depend on the state. Read from the TSC on x86 (nanoseconds
+ *    elsewhere); on the Cortex-M4 the same loop can be timed with
+ *    DWT->CYCCNT.
+ *
+ * Usage: bench_vdyn [states] [reps]     (default 4096 x 64)
+ * Exit status is 1 if any drive-cycle check fails.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#include "vehicle.h"
+
+#define DT_MS          10U         /* VehicleTask step (10 ms rate group)  */
+#define DT_S           0.01f
+#define STEPS_S        100U        /* steps per second                      */
+#define ACCEL_LIMIT    10.0f       /* km/h/s, vehicle.c VEHICLE_DYN_ACCEL_MAX */
+#define BRAKE_LIMIT    15.0f       /* km/h/s, vehicle.c VEHICLE_DYN_BRAKE_MAX */
+#define SETTLE_KPH     0.5f
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t s_rng = 0x9E3779B9U;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1664525U + 1013904223U;
+    return s_rng >> 8;
+}
+
+static uint32_t s_fail;
+
+static void check(int ok, uint32_t step, const char *what, float value)
+{
+    if (!ok && s_fail < 20U)
+    {
+        printf("  FAIL: t=%.1f s: %s (%.2f)\n", step * DT_S, what, value);
+    }
+    if (!ok)
+    {
+        s_fail++;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Drive cycle
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uint32_t t_100ms;       /* applied at this time, in 0.1 s              */
+    float    target_kph;    /* < 0: inject coolant overheat instead        */
+} DriveCmd_t;
+
+static const DriveCmd_t s_cycle[] =
+{
+    {    0U, 100.0f },      /* launch                                     */
+    {  600U,  50.0f },      /* brake                                      */
+    { 1000U, 130.0f },
+    { 1400U,  -1.0f },      /* overheat at 130 km/h                       */
+    { 2200U,   0.0f },      /* stop                                       */
+    { 2500U, 200.0f },      /* flat out                                   */
+    { 3500U,   0.0f },
+    { 3900U,   0.0f },      /* end                                        */
+};
+
+#define CYCLE_CMDS   (sizeof(s_cycle) / sizeof(s_cycle[0]))
+
+static void drive_cycle(void)
+{
+    VehicleState_t vs;
+    uint32_t next = 0U;
+    uint32_t shifts = 0U;
+    uint32_t last_shift = 0U;
+    uint32_t t_100 = 0U, t_brake = 0U, t_overheat = 0U, t_cooled = 0U;
+    float    warm_c = 0.0f, max_c = 0.0f, max_kph = 0.0f;
+    float    target = 0.0f;
+
+    Vehicle_Init(&vs);
+
+    const uint32_t end = s_cycle[CYCLE_CMDS - 1U].t_100ms * (STEPS_S / 10U);
+
+    for (uint32_t st = 0U; st < end; st++)
+    {
+        if (next < CYCLE_CMDS && s_cycle[next].t_100ms * (STEPS_S / 10U) == st)
+        {
+            const DriveCmd_t *c = &s_cycle[next++];
+
+            if (st > 0U)
+            {
+                check(fabsf(vs.speed_kph - target) < SETTLE_KPH, st,
+                      "speed not settled before next command", vs.speed_kph);
+                check(st - last_shift > 10U * STEPS_S || st < 10U * STEPS_S, st,
+                      "gear change in the last 10 s of a cruise", (float)vs.gear);
+            }
+            if (c->target_kph < 0.0f)
+            {
+                Vehicle_Force(&vs, vs.speed_kph, vs.engine_rpm, 115.0f);
+                t_overheat = st;
+            }
+            else
+            {
+                target = c->target_kph;
+                Vehicle_SetTargetSpeed(&vs, target);
+            }
+        }
+
+        const float   v0 = vs.speed_kph;
+        const uint8_t g0 = vs.gear;
+
+        Vehicle_UpdateMs(&vs, DT_MS);
+
+        const float a = (vs.speed_kph - v0) / DT_S;
+        check(a <= ACCEL_LIMIT + 0.01f, st, "acceleration above limit", a);
+        check(a >= -BRAKE_LIMIT - 0.01f, st, "deceleration above limit", a);
+        check(vs.engine_rpm >= 800U && vs.engine_rpm <= 7000U, st,
+              "rpm out of range", (float)vs.engine_rpm);
+        check(vs.gear >= 1U && vs.gear <= 6U, st, "gear out of range", (float)vs.gear);
+        check(abs((int)vs.gear - (int)g0) <= 1, st, "more than one shift", (float)vs.gear);
+        check(vs.speed_kph >= 0.0f && vs.speed_kph <= 200.5f, st,
+              "speed out of range", vs.speed_kph);
+        if (vs.gear != g0)
+        {
+            check(shifts == 0U || st - last_shift >= STEPS_S, st,
+                  "two shifts within 1 s", (float)vs.gear);
+            shifts++;
+            last_shift = st;
+        }
+
+        if (t_100 == 0U && vs.speed_kph >= 100.0f - SETTLE_KPH)  t_100 = st + 1U;
+        if (st >= 60U * STEPS_S && t_brake == 0U && vs.speed_kph <= 50.0f + SETTLE_KPH)
+        {
+            t_brake = st + 1U - 60U * STEPS_S;
+        }
+        if (st == 140U * STEPS_S - 1U)         warm_c = vs.coolant_temp_c;
+        if (t_overheat != 0U && t_cooled == 0U && vs.coolant_temp_c < 100.0f)
+        {
+            t_cooled = st + 1U - t_overheat;
+        }
+        if (t_overheat == 0U && vs.coolant_temp_c > max_c) max_c = vs.coolant_temp_c;
+        if (vs.speed_kph > max_kph)            max_kph = vs.speed_kph;
+    }
+
+    check(warm_c >= 82.0f && warm_c <= 100.0f, 140U * STEPS_S, "coolant not in thermostat band",
+          warm_c);
+    check(max_c <= 105.0f, 140U * STEPS_S, "coolant above 105 C before the injection", max_c);
+    check(t_cooled != 0U && t_cooled <= 60U * STEPS_S, t_overheat + t_cooled,
+          "coolant not below 100 C within 60 s", (float)t_cooled * DT_S);
+    check(vs.speed_kph == 0.0f, end, "not stopped at the end", vs.speed_kph);
+
+    printf("  0-100 km/h     %5.1f s\n", t_100 * DT_S);
+    printf("  100-50 km/h    %5.1f s\n", t_brake * DT_S);
+    printf("  top speed      %5.1f km/h\n", max_kph);
+    printf("  shifts         %5lu\n", (unsigned long)shifts);
+    printf("  coolant        %5.1f C at 130 km/h, overheat 115 C -> <100 C in %.1f s\n",
+           warm_c, t_cooled * DT_S);
+}
+
+/* --------------------------------------------------------------------------
+ * Cost per step
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    double mean;
+    double worst;
+} Cost_t;
+
+/* One state stepped from a copy reps times, minus the copy-only loop;
+   fastest of three trials, per step */
+static double time_state(int basic, const VehicleState_t *s, uint32_t reps)
+{
+    uint64_t best = UINT64_MAX;
+    uint64_t base = UINT64_MAX;
+    volatile float sink = 0.0f;
+
+    for (uint32_t trial = 0U; trial < 3U; trial++)
+    {
+        uint64_t t0 = ticks();
+        for (uint32_t r = 0U; r < reps; r++)
+        {
+            VehicleState_t tmp = *s;
+            __asm__ __volatile__("" : : "r"(&tmp) : "memory");
+            sink += tmp.speed_kph;
+        }
+        uint64_t t = ticks() - t0;
+        if (t < base) base = t;
+
+        t0 = ticks();
+        for (uint32_t r = 0U; r < reps; r++)
+        {
+            VehicleState_t tmp = *s;
+            if (basic)
+            {
+                const VehicleFleet_t one = { &tmp.speed_kph, &tmp.engine_rpm,
+                                             &tmp.coolant_temp_c, 1U };
+                Vehicle_UpdateBatch(&one, DT_S);
+            }
+            else
+            {
+                Vehicle_Update(&tmp, DT_S);
+            }
+            sink += tmp.speed_kph;
+        }
+        t = ticks() - t0;
+        if (t < best) best = t;
+    }
+    (void)sink;
+    return (best > base) ? (double)(best - base) / reps : 0.0;
+}
+
+static Cost_t measure(int basic, const VehicleState_t *states, uint32_t n, uint32_t reps)
+{
+    Cost_t c = { 0.0, 0.0 };
+
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        const double t = time_state(basic, &states[i], reps);
+        c.mean += t;
+        if (t > c.worst) c.worst = t;
+    }
+    c.mean /= n;
+    return c;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t n    = 4096U;
+    uint32_t reps = 64U;
+
+    if (argc > 1) n    = (uint32_t)strtoul(argv[1], NULL, 0);
+    if (argc > 2) reps = (uint32_t)strtoul(argv[2], NULL, 0);
+    if (n == 0U)    n = 1U;
+    if (reps == 0U) reps = 1U;
+
+    printf("bench_vdyn: drive cycle at %u ms steps\n", DT_MS);
+    drive_cycle();
+
+    /* States along a random drive: new target every 5-30 s, now and then
+       an overheat, so every gear, load and thermostat region is visited */
+    VehicleState_t *states = malloc(n * sizeof(*states));
+    VehicleState_t vs;
+    uint32_t hold = 0U;
+
+    if (states == NULL)
+    {
+        return 1;
+    }
+    Vehicle_Init(&vs);
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        if (hold-- == 0U)
+        {
+            hold = 50U + rng_next() % 250U;
+            if (rng_next() % 8U == 0U)
+            {
+                Vehicle_Force(&vs, vs.speed_kph, vs.engine_rpm, 100.0f + (float)(rng_next() % 30U));
+            }
+            Vehicle_SetTargetSpeed(&vs, (float)(rng_next() % 201U));
+        }
+        for (uint32_t k = 0U; k < 30U; k++)
+        {
+            Vehicle_UpdateMs(&vs, DT_MS);
+        }
+        states[i] = vs;
+    }
+
+    const Cost_t dyn   = measure(0, states, n, reps);
+    const Cost_t basic = measure(1, states, n, reps);
+
+    printf("cost per step over %lu states (best of %lu):\n",
+           (unsigned long)n, (unsigned long)reps);
+    printf("  longitudinal   mean %6.1f  worst %6.1f " BENCH_UNIT "\n", dyn.mean, dyn.worst);
+    printf("  basic          mean %6.1f  worst %6.1f " BENCH_UNIT "\n", basic.mean, basic.worst);
+    free(states);
+
+    if (s_fail != 0U)
+    {
+        printf("  %lu failures\n", (unsigned long)s_fail);
+        return 1;
+    }
+    printf("  drive cycle OK\n");
+    return 0;
+}
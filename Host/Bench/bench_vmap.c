@@ -0,0 +1,473 @@
+/**
+ * @file    bench_vmap.c
+ * @brief   Calibration maps: search conformance and cycles per lookup.
+ *
+ * 1. Conformance, for axes of 2 .. 256 breakpoints:
+ *      - linear, binary and hint search return the same segment on an
+ *        unevenly spaced axis, for random inputs, inputs off both ends and
+ *        every breakpoint, with the hint carried over or stale
+ *      - uniform search gives the same values as binary search on an
+ *        evenly spaced axis (at a breakpoint it may pick the segment below,
+ *        with fraction 1)
+ *      - curves are exact at breakpoints, and linear / bilinear functions
+ *        are reproduced anywhere by 1-D / 2-D lookups
+ *      - the Q16.16 search finds the same segment as the float one and
+ *        its lookups agree within a few LSB of the table range
+ * 2. Cost per search for linear, binary, hint and uniform search, per
+ *    axis size, for random inputs and for coherent ones (a slow drift of
+ *    a quarter segment per lookup at most, like a model input between two
+ *    steps). Then full 1-D and 2-D lookups on a hint axis, float and Q16.
+ *    Each figure is the fastest of three loops over 4096 inputs. Read
+ *    from the TSC on x86 (nanoseconds elsewhere); on the Cortex-M4 the
+ *    same loops can be timed with DWT->CYCCNT.
+ *
+ * Usage: bench_vmap [reps]     (default 64)
+ * Exit status is 1 if any conformance check fails.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#include "vehicle_map.h"
+
+#define MAX_N      256U
+#define INPUTS     4096U
+#define GRID       64.0f       /* breakpoints and inputs on a 1/64 grid:
+                                  exact in float and in Q16.16 */
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t s_rng = 0x9E3779B9U;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1664525U + 1013904223U;
+    return s_rng >> 8;
+}
+
+/* 0 .. 1 */
+static float rng_unit(void)
+{
+    return (float)(rng_next() & 0xFFFFU) / 65535.0f;
+}
+
+static uint32_t s_fail;
+
+static void check(int ok, uint16_t n, const char *what, float x)
+{
+    if (!ok && s_fail < 20U)
+    {
+        printf("  FAIL: n=%u: %s (x=%.4f)\n", n, what, x);
+    }
+    if (!ok)
+    {
+        s_fail++;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Test axes and tables
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    float             bp[MAX_N];
+    float             inv[MAX_N];
+    float             z[MAX_N];
+    q16_16_t          bp_q[MAX_N];
+    uint32_t          inv_q[MAX_N];
+    q16_16_t          z_q[MAX_N];
+    VehicleMapAxis_t    ax;
+    VehicleMapAxisQ16_t ax_q;
+    VehicleMap1D_t      m;
+    VehicleMap1DQ16_t   m_q;
+} TestAxis_t;
+
+/* Evenly spaced (8 apart) or uneven (1/8 .. 16 apart) breakpoints, with a
+   curve over them and the Q16.16 twin of both */
+static void axis_build(TestAxis_t *t, uint16_t n, uint8_t search)
+{
+    float x = 0.0f;
+
+    for (uint16_t i = 0U; i < n; i++)
+    {
+        t->bp[i] = x;
+        x += (search == VEHICLE_MAP_UNIFORM) ? 8.0f
+                                             : (float)(8U + rng_next() % 1017U) / GRID;
+    }
+    for (uint16_t i = 0U; i < n; i++)
+    {
+        t->z[i]    = 60.0f * sinf(t->bp[i] * 0.01f) + (float)(rng_next() % 200U) * 0.1f;
+        t->bp_q[i] = (q16_16_t)(t->bp[i] * 65536.0f);
+        t->z_q[i]  = (q16_16_t)lrintf(t->z[i] * 65536.0f);
+    }
+    for (uint16_t i = 0U; i + 1U < n; i++)
+    {
+        t->inv[i]   = 1.0f / (t->bp[i + 1U] - t->bp[i]);
+        t->inv_q[i] = (uint32_t)((1ULL << 32) / (uint32_t)(t->bp_q[i + 1U] - t->bp_q[i]));
+    }
+
+    t->ax   = (VehicleMapAxis_t){ t->bp, t->inv, n, search };
+    t->ax_q = (VehicleMapAxisQ16_t){ t->bp_q, t->inv_q, n, search };
+    t->m    = (VehicleMap1D_t){ &t->ax, t->z };
+    t->m_q  = (VehicleMap1DQ16_t){ &t->ax_q, t->z_q };
+}
+
+static float axis_span(const TestAxis_t *t)
+{
+    return t->bp[t->ax.n - 1U] - t->bp[0];
+}
+
+/* Inputs spread over the axis and 2 % past either end, on the 1/64 grid */
+static void inputs_random(const TestAxis_t *t, float *x)
+{
+    const float span = axis_span(t);
+
+    for (uint32_t k = 0U; k < INPUTS; k++)
+    {
+        x[k] = floorf((t->bp[0] + span * (rng_unit() * 1.04f - 0.02f)) * GRID) / GRID;
+    }
+}
+
+/* Random walk, a quarter of the mean segment width per step at most */
+static void inputs_coherent(const TestAxis_t *t, float *x)
+{
+    const float span = axis_span(t);
+    const float step = span / (float)(t->ax.n - 1U) * 0.25f;
+    float v = t->bp[0] + span * 0.5f;
+
+    for (uint32_t k = 0U; k < INPUTS; k++)
+    {
+        v += step * (rng_unit() * 2.0f - 1.0f);
+        if (v < t->bp[0])               v = t->bp[0] + (t->bp[0] - v);
+        if (v > t->bp[t->ax.n - 1U])    v = t->bp[t->ax.n - 1U] - (v - t->bp[t->ax.n - 1U]);
+        x[k] = floorf(v * GRID) / GRID;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Conformance
+ * -------------------------------------------------------------------------- */
+
+static float ref_lerp(const TestAxis_t *t, float x)
+{
+    const uint16_t n = t->ax.n;
+
+    if (x <= t->bp[0])       return t->z[0];
+    if (x >= t->bp[n - 1U])  return t->z[n - 1U];
+    for (uint16_t i = 0U; ; i++)
+    {
+        if (x < t->bp[i + 1U])
+        {
+            return t->z[i] + (t->z[i + 1U] - t->z[i]) * (x - t->bp[i]) / (t->bp[i + 1U] - t->bp[i]);
+        }
+    }
+}
+
+static void check_axis(uint16_t n)
+{
+    static TestAxis_t uneven, even;
+    static float      x[INPUTS];
+    VehicleMapHint_t  hint = 0U, hint_q = 0U;
+
+    axis_build(&uneven, n, VEHICLE_MAP_HINT);
+    axis_build(&even, n, VEHICLE_MAP_UNIFORM);
+    inputs_random(&uneven, x);
+
+    /* Same segment from every method; the hint is carried, or stale */
+    for (uint32_t k = 0U; k < INPUTS + n; k++)
+    {
+        const float xi = (k < INPUTS) ? x[k] : uneven.bp[k - INPUTS];
+        const uint16_t lin = VehicleMap_FindLinear(&uneven.ax, xi);
+        VehicleMapHint_t stale = (VehicleMapHint_t)(rng_next() % (n + 4U));
+
+        check(VehicleMap_FindBinary(&uneven.ax, xi) == lin, n, "binary != linear", xi);
+        check(VehicleMap_FindHint(&uneven.ax, xi, &hint) == lin, n, "hint != linear", xi);
+        check(VehicleMap_FindHint(&uneven.ax, xi, &stale) == lin && stale == lin, n,
+              "stale hint != linear", xi);
+        check(VehicleMap_FindQ16(&uneven.ax_q, (q16_16_t)(xi * 65536.0f), &hint_q).i == lin ||
+              xi <= uneven.bp[0] || xi >= uneven.bp[n - 1U], n, "Q16 segment != float", xi);
+
+        const float ref = ref_lerp(&uneven, xi);
+        const float v   = VehicleMap_Lookup1D(&uneven.m, xi, &hint);
+        check(fabsf(v - ref) <= 1e-4f * (1.0f + fabsf(ref)), n, "1-D value", xi);
+        if (k >= INPUTS)
+        {
+            check(v == uneven.z[k - INPUTS] || k + 1U == INPUTS + n, n,
+                  "not exact at breakpoint", xi);
+        }
+
+        const float vq = (float)VehicleMap_Lookup1DQ16(&uneven.m_q, (q16_16_t)(xi * 65536.0f),
+                                                       &hint_q) / 65536.0f;
+        check(fabsf(vq - ref) <= 0.01f, n, "Q16 1-D value", xi);
+    }
+
+    /* Uniform search by value, float and Q16 */
+    inputs_random(&even, x);
+    for (uint32_t k = 0U; k < INPUTS + n; k++)
+    {
+        const float xi = (k < INPUTS) ? x[k] : even.bp[k - INPUTS];
+        const VehicleMapPos_t pu = VehicleMap_Find(&even.ax, xi, NULL);
+        const uint16_t        ib = VehicleMap_FindBinary(&even.ax, xi);
+        const float ref = ref_lerp(&even, xi);
+
+        check(pu.i == ib || pu.i + 1U == ib, n, "uniform segment", xi);
+        check(fabsf(VehicleMap_At1D(even.z, pu) - ref) <= 1e-4f * (1.0f + fabsf(ref)), n,
+              "uniform 1-D value", xi);
+        const float vq = (float)VehicleMap_Lookup1DQ16(&even.m_q, (q16_16_t)(xi * 65536.0f),
+                                                       NULL) / 65536.0f;
+        check(fabsf(vq - ref) <= 0.01f, n, "uniform Q16 1-D value", xi);
+    }
+
+    /* 2-D: a bilinear function is reproduced exactly (x uneven, y even) */
+    static float    z2[MAX_N * MAX_N];
+    static q16_16_t z2_q[MAX_N * MAX_N];
+    const uint16_t  ny = (n < 16U) ? n : 16U;
+    TestAxis_t     *ty = &even;
+
+    even.ax.n = ny;
+    even.ax_q.n = ny;
+    for (uint16_t j = 0U; j < ny; j++)
+    {
+        for (uint16_t i = 0U; i < n; i++)
+        {
+            const float xv = uneven.bp[i], yv = ty->bp[j];
+            z2[j * n + i]   = 3.0f + 0.05f * xv - 0.25f * yv + 0.001f * xv * yv;
+            z2_q[j * n + i] = (q16_16_t)lrintf(z2[j * n + i] * 65536.0f);
+        }
+    }
+    const VehicleMap2D_t    m2   = { &uneven.ax, &ty->ax, z2 };
+    const VehicleMap2DQ16_t m2_q = { &uneven.ax_q, &ty->ax_q, z2_q };
+    VehicleMapHint_t hx = 0U, hy = 0U;
+
+    for (uint32_t k = 0U; k < INPUTS; k++)
+    {
+        const float xv = floorf(rng_unit() * axis_span(&uneven) * GRID) / GRID;
+        const float yv = floorf(rng_unit() * (ty->bp[ny - 1U]) * GRID) / GRID;
+        const float ref = 3.0f + 0.05f * xv - 0.25f * yv + 0.001f * xv * yv;
+        const float v   = VehicleMap_Lookup2D(&m2, xv, yv, &hx, &hy);
+        const float vq  = (float)VehicleMap_Lookup2DQ16(&m2_q, (q16_16_t)(xv * 65536.0f),
+                                                        (q16_16_t)(yv * 65536.0f),
+                                                        NULL, NULL) / 65536.0f;
+
+        check(fabsf(v - ref) <= 1e-4f * (1.0f + fabsf(ref)), n, "2-D value", xv);
+        check(fabsf(vq - ref) <= 0.01f + 1e-5f * fabsf(ref), n, "Q16 2-D value", xv);
+    }
+    for (uint16_t j = 0U; j + 1U < ny; j++)
+    {
+        for (uint16_t i = 0U; i + 1U < n; i++)
+        {
+            check(VehicleMap_Lookup2D(&m2, uneven.bp[i], ty->bp[j], NULL, NULL) == z2[j * n + i],
+                  n, "2-D not exact at grid point", uneven.bp[i]);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Cost
+ * -------------------------------------------------------------------------- */
+
+typedef enum
+{
+    M_LINEAR, M_BINARY, M_HINT, M_UNIFORM,
+    M_LOOKUP1D, M_LOOKUP1D_Q16, M_LOOKUP2D, M_LOOKUP2D_Q16
+} Method_t;
+
+typedef struct
+{
+    const TestAxis_t        *t;
+    const VehicleMap2D_t    *m2;
+    const VehicleMap2DQ16_t *m2_q;
+    const float             *x;
+    const float             *y;
+    const q16_16_t          *xq;
+    const q16_16_t          *yq;
+} CostCase_t;
+
+static double time_method(Method_t m, const CostCase_t *c, uint32_t reps)
+{
+    uint64_t best = UINT64_MAX;
+    volatile float sink = 0.0f;
+
+    for (uint32_t trial = 0U; trial < 3U; trial++)
+    {
+        VehicleMapHint_t h = 0U, hy = 0U;
+        float acc = 0.0f;
+        const uint64_t t0 = ticks();
+
+        for (uint32_t r = 0U; r < reps; r++)
+        {
+            switch (m)
+            {
+            case M_LINEAR:
+                for (uint32_t k = 0U; k < INPUTS; k++) acc += VehicleMap_FindLinear(&c->t->ax, c->x[k]);
+                break;
+            case M_BINARY:
+                for (uint32_t k = 0U; k < INPUTS; k++) acc += VehicleMap_FindBinary(&c->t->ax, c->x[k]);
+                break;
+            case M_HINT:
+                for (uint32_t k = 0U; k < INPUTS; k++) acc += VehicleMap_FindHint(&c->t->ax, c->x[k], &h);
+                break;
+            case M_UNIFORM:
+                for (uint32_t k = 0U; k < INPUTS; k++) acc += VehicleMap_FindUniform(&c->t->ax, c->x[k]);
+                break;
+            case M_LOOKUP1D:
+                for (uint32_t k = 0U; k < INPUTS; k++) acc += VehicleMap_Lookup1D(&c->t->m, c->x[k], &h);
+                break;
+            case M_LOOKUP1D_Q16:
+                for (uint32_t k = 0U; k < INPUTS; k++)
+                {
+                    acc += (float)VehicleMap_Lookup1DQ16(&c->t->m_q, c->xq[k], &h);
+                }
+                break;
+            case M_LOOKUP2D:
+                for (uint32_t k = 0U; k < INPUTS; k++)
+                {
+                    acc += VehicleMap_Lookup2D(c->m2, c->x[k], c->y[k], &h, &hy);
+                }
+                break;
+            default:
+                for (uint32_t k = 0U; k < INPUTS; k++)
+                {
+                    acc += (float)VehicleMap_Lookup2DQ16(c->m2_q, c->xq[k], c->yq[k], &h, &hy);
+                }
+                break;
+            }
+        }
+        const uint64_t t = ticks() - t0;
+        if (t < best) best = t;
+        sink += acc;
+    }
+    (void)sink;
+    return (double)best / ((double)reps * INPUTS);
+}
+
+static void cost(uint32_t reps)
+{
+    static const uint16_t sizes[] = { 8U, 16U, 32U, 64U, 128U, 256U };
+    static TestAxis_t uneven, even, ty;
+    static float      x[INPUTS], xe[INPUTS], y[INPUTS];
+    static q16_16_t   xq[INPUTS], yq[INPUTS];
+    static float      z2[MAX_N * 16U];
+    static q16_16_t   z2_q[MAX_N * 16U];
+
+    printf("cost per search (" BENCH_UNIT "):\n");
+    printf("  input       n    linear    binary      hint   uniform\n");
+    for (uint32_t coherent = 0U; coherent < 2U; coherent++)
+    {
+        for (uint32_t s = 0U; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            const uint16_t n = sizes[s];
+
+            axis_build(&uneven, n, VEHICLE_MAP_HINT);
+            axis_build(&even, n, VEHICLE_MAP_UNIFORM);
+            if (coherent)
+            {
+                inputs_coherent(&uneven, x);
+                inputs_coherent(&even, xe);
+            }
+            else
+            {
+                inputs_random(&uneven, x);
+                inputs_random(&even, xe);
+            }
+
+            const CostCase_t cu = { &uneven, NULL, NULL, x, NULL, NULL, NULL };
+            const CostCase_t ce = { &even, NULL, NULL, xe, NULL, NULL, NULL };
+            printf("  %-8s  %4u  %8.1f  %8.1f  %8.1f  %8.1f\n",
+                   coherent ? "coherent" : "random", n,
+                   time_method(M_LINEAR, &cu, reps), time_method(M_BINARY, &cu, reps),
+                   time_method(M_HINT, &cu, reps), time_method(M_UNIFORM, &ce, reps));
+        }
+    }
+
+    /* Full lookups: 1-D on an n-point hint axis, 2-D over it x 16 rows */
+    axis_build(&ty, 16U, VEHICLE_MAP_HINT);
+    printf("cost per lookup, hint axes (" BENCH_UNIT "):\n");
+    printf("  input       n   1-D f32   1-D Q16   2-D f32   2-D Q16\n");
+    for (uint32_t coherent = 0U; coherent < 2U; coherent++)
+    {
+        for (uint32_t s = 0U; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            const uint16_t n = sizes[s];
+
+            axis_build(&uneven, n, VEHICLE_MAP_HINT);
+            if (coherent)
+            {
+                inputs_coherent(&uneven, x);
+                inputs_coherent(&ty, y);
+            }
+            else
+            {
+                inputs_random(&uneven, x);
+                inputs_random(&ty, y);
+            }
+            for (uint32_t k = 0U; k < INPUTS; k++)
+            {
+                xq[k] = (q16_16_t)(x[k] * 65536.0f);
+                yq[k] = (q16_16_t)(y[k] * 65536.0f);
+            }
+            for (uint32_t j = 0U; j < 16U; j++)
+            {
+                for (uint32_t i = 0U; i < n; i++)
+                {
+                    z2[j * n + i]   = uneven.z[i] + ty.z[j];
+                    z2_q[j * n + i] = uneven.z_q[i] + ty.z_q[j];
+                }
+            }
+
+            const VehicleMap2D_t    m2   = { &uneven.ax, &ty.ax, z2 };
+            const VehicleMap2DQ16_t m2_q = { &uneven.ax_q, &ty.ax_q, z2_q };
+            const CostCase_t c = { &uneven, &m2, &m2_q, x, y, xq, yq };
+            printf("  %-8s  %4u  %8.1f  %8.1f  %8.1f  %8.1f\n",
+                   coherent ? "coherent" : "random", n,
+                   time_method(M_LOOKUP1D, &c, reps), time_method(M_LOOKUP1D_Q16, &c, reps),
+                   time_method(M_LOOKUP2D, &c, reps), time_method(M_LOOKUP2D_Q16, &c, reps));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reps = 64U;
+
+    if (argc > 1) reps = (uint32_t)strtoul(argv[1], NULL, 0);
+    if (reps == 0U) reps = 1U;
+
+    printf("bench_vmap: conformance\n");
+    for (uint16_t n = 2U; n < MAX_N; n = (uint16_t)(n * 2U))
+    {
+        check_axis(n);
+        check_axis((uint16_t)(n + 1U));
+    }
+    check_axis(MAX_N);
+
+    cost(reps);
+
+    if (s_fail != 0U)
+    {
+        printf("  %lu failures\n", (unsigned long)s_fail);
+        return 1;
+    }
+    printf("  conformance OK\n");
+    return 0;
+}
@@ -0,0 +1,385 @@
+/**
+ * @file    bench_vsnap.c
+ * @brief   Vehicle snapshot (vehicle_snap.h) stress test and cost.
+ *
+ * 1. Cost: uncontended VehicleSnap_Publish() and VehicleSnap_Read() in ns.
+ * 2. Parallel stress: one writer thread publishes synthetic states as fast
+ *    as it can while the other cores read them. Each field of a state is
+ *    a function of its step number, so a reader can tell a torn copy from a
+ *    good one. The same run on an unprotected copy of the sample shows what
+ *    the check catches without the seqlock (reported, not a failure).
+ * 3. Firmware: boots the ECU on the FreeRTOS host port in virtual time.
+ *    VehicleTask publishes g_vehicleSnap as usual, while reader threads
+ *    outside the scheduler read it concurrently. Each sample is compared
+ *    with the model replayed to the same step (no CLI or CAN input, so
+ *    the model is deterministic).
+ *
+ * Usage: bench_vsnap [stress_ms] [firmware_ms]   (default 1000 60000)
+ * Exit status is 1 if any protected read is torn or goes back in time, or
+ * if the firmware phase sees no publish.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "cmsis_os2.h"
+#include "vehicle.h"
+#include "vehicle_snap.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+int vecu_firmware_main(void);
+
+extern VehicleSnap_t g_vehicleSnap;
+
+#define MAX_READERS      7U
+#define COST_LOOPS       10000000U
+#define FW_PERIOD_MS     10U          /* model slot (10 ms rate group) */
+
+typedef struct
+{
+    pthread_t thread;
+    uint64_t  reads;
+    uint64_t  retries;
+    uint64_t  torn;
+    uint64_t  backwards;
+} Reader_t;
+
+static atomic_int       s_stop;
+static VehicleSnap_t    s_snap;
+static volatile VehicleSample_t s_plain;   /* control: no protection */
+static Reader_t         s_reader[MAX_READERS];
+static uint32_t         s_readers;
+static uint32_t         s_stressMs = 1000U;
+static uint32_t         s_fwMs     = 60000U;
+static VehicleState_t  *s_expect;          /* firmware phase: state per step */
+static uint32_t         s_expectLen;
+static int              s_failed;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* --------------------------------------------------------------------------
+ * Synthetic states for the parallel stress
+ * -------------------------------------------------------------------------- */
+
+static void synth_state(VehicleState_t *vs, uint32_t step)
+{
+    vs->speed_kph      = (float)(step & 0xFFFFFFU);
+    vs->engine_rpm     = (uint16_t)(step * 3U);
+    vs->coolant_temp_c = (float)((step * 7U) & 0xFFFFFFU);
+}
+
+static int synth_ok(const VehicleSample_t *s)
+{
+    VehicleState_t e;
+    synth_state(&e, s->step);
+    return s->state.speed_kph == e.speed_kph &&
+           s->state.engine_rpm == e.engine_rpm &&
+           s->state.coolant_temp_c == e.coolant_temp_c;
+}
+
+static void *stress_writer(void *arg)
+{
+    uint64_t *publishes = arg;
+    VehicleState_t vs;
+    uint32_t step = 0U;
+
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed))
+    {
+        step++;
+        synth_state(&vs, step);
+        VehicleSnap_Publish(&s_snap, &vs);
+    }
+    *publishes = step;
+    return NULL;
+}
+
+static void *stress_reader(void *arg)
+{
+    Reader_t *r = arg;
+    VehicleSample_t s;
+    uint32_t last = 0U;
+
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed))
+    {
+        r->retries += VehicleSnap_Read(&s_snap, &s);
+        r->reads++;
+        if (!synth_ok(&s)) r->torn++;
+        if (s.step < last) r->backwards++;
+        last = s.step;
+    }
+    return NULL;
+}
+
+/* Control: the same traffic on a plain struct, copied field by field */
+static void *plain_writer(void *arg)
+{
+    uint64_t *publishes = arg;
+    VehicleState_t vs;
+    uint32_t step = 0U;
+
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed))
+    {
+        step++;
+        synth_state(&vs, step);
+        s_plain.step                 = step;
+        s_plain.state.speed_kph      = vs.speed_kph;
+        s_plain.state.engine_rpm     = vs.engine_rpm;
+        s_plain.state.coolant_temp_c = vs.coolant_temp_c;
+    }
+    *publishes = step;
+    return NULL;
+}
+
+static void *plain_reader(void *arg)
+{
+    Reader_t *r = arg;
+    VehicleSample_t s;
+
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed))
+    {
+        s.step                 = s_plain.step;
+        s.state.speed_kph      = s_plain.state.speed_kph;
+        s.state.engine_rpm     = s_plain.state.engine_rpm;
+        s.state.coolant_temp_c = s_plain.state.coolant_temp_c;
+        r->reads++;
+        if (!synth_ok(&s)) r->torn++;
+    }
+    return NULL;
+}
+
+static void reader_totals(Reader_t *sum)
+{
+    memset(sum, 0, sizeof(*sum));
+    for (uint32_t i = 0U; i < s_readers; i++)
+    {
+        sum->reads     += s_reader[i].reads;
+        sum->retries   += s_reader[i].retries;
+        sum->torn      += s_reader[i].torn;
+        sum->backwards += s_reader[i].backwards;
+    }
+}
+
+/* Run one writer and s_readers readers for s_stressMs */
+static void stress_run(void *(*writer)(void *), void *(*reader)(void *),
+                       uint64_t *publishes, Reader_t *sum)
+{
+    pthread_t w;
+
+    atomic_store(&s_stop, 0);
+    memset(s_reader, 0, sizeof(s_reader));
+    for (uint32_t i = 0U; i < s_readers; i++)
+    {
+        pthread_create(&s_reader[i].thread, NULL, reader, &s_reader[i]);
+    }
+    pthread_create(&w, NULL, writer, publishes);
+    usleep(s_stressMs * 1000U);
+    atomic_store(&s_stop, 1);
+    pthread_join(w, NULL);
+    for (uint32_t i = 0U; i < s_readers; i++)
+    {
+        pthread_join(s_reader[i].thread, NULL);
+    }
+    reader_totals(sum);
+}
+
+static void phase_cost(void)
+{
+    VehicleState_t vs;
+    VehicleSample_t s;
+    uint32_t sink = 0U;
+
+    Vehicle_Init(&vs);
+    VehicleSnap_Init(&s_snap, &vs);
+
+    double t0 = now_s();
+    for (uint32_t i = 0U; i < COST_LOOPS; i++)
+    {
+        vs.engine_rpm = (uint16_t)i;
+        VehicleSnap_Publish(&s_snap, &vs);
+    }
+    const double t_pub = (now_s() - t0) * 1e9 / COST_LOOPS;
+
+    t0 = now_s();
+    for (uint32_t i = 0U; i < COST_LOOPS; i++)
+    {
+        sink += VehicleSnap_Read(&s_snap, &s) + s.step;
+    }
+    const double t_read = (now_s() - t0) * 1e9 / COST_LOOPS;
+
+    printf("  uncontended: publish %.1f ns, read %.1f ns  (sample %zu bytes, check %u)\n",
+           t_pub, t_read, sizeof(VehicleSample_t), sink & 1U);
+}
+
+static void phase_stress(void)
+{
+    uint64_t pubs;
+    Reader_t sum;
+    VehicleState_t vs;
+
+    Vehicle_Init(&vs);
+    synth_state(&vs, 0U);
+    VehicleSnap_Init(&s_snap, &vs);
+
+    stress_run(stress_writer, stress_reader, &pubs, &sum);
+    printf("  seqlock:     %8.2f M publishes/s, %8.2f M reads/s, retried %llu, torn %llu, backwards %llu\n",
+           pubs / (s_stressMs * 1e3), sum.reads / (s_stressMs * 1e3),
+           (unsigned long long)sum.retries,
+           (unsigned long long)sum.torn, (unsigned long long)sum.backwards);
+    if (sum.torn != 0U || sum.backwards != 0U || sum.reads == 0U)
+    {
+        printf("  FAIL: inconsistent snapshot read\n");
+        s_failed = 1;
+    }
+
+    memset((void *)&s_plain, 0, sizeof(s_plain));
+    stress_run(plain_writer, plain_reader, &pubs, &sum);
+    printf("  unprotected: %8.2f M publishes/s, %8.2f M reads/s, torn %llu (%.3f %%)\n",
+           pubs / (s_stressMs * 1e3), sum.reads / (s_stressMs * 1e3),
+           (unsigned long long)sum.torn,
+           sum.reads ? 100.0 * (double)sum.torn / (double)sum.reads : 0.0);
+}
+
+/* --------------------------------------------------------------------------
+ * Firmware phase: readers outside the scheduler, VehicleTask publishing
+ * -------------------------------------------------------------------------- */
+
+static int fw_ok(const VehicleSample_t *s)
+{
+    if (s->step >= s_expectLen)
+    {
+        return 0;
+    }
+    const VehicleState_t *e = &s_expect[s->step];
+    return s->state.speed_kph == e->speed_kph &&
+           s->state.engine_rpm == e->engine_rpm &&
+           s->state.coolant_temp_c == e->coolant_temp_c;
+}
+
+static void *fw_reader(void *arg)
+{
+    Reader_t *r = arg;
+    VehicleSample_t s;
+    uint32_t last = 0U;
+
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed))
+    {
+        r->retries += VehicleSnap_Read(&g_vehicleSnap, &s);
+        r->reads++;
+        if (!fw_ok(&s)) r->torn++;
+        if (s.step < last) r->backwards++;
+        last = s.step;
+    }
+    return NULL;
+}
+
+/* Lowest priority task: the scheduler is running, so g_vehicleSnap is set */
+static void fw_start_task(void *argument)
+{
+    (void)argument;
+
+    atomic_store(&s_stop, 0);
+    memset(s_reader, 0, sizeof(s_reader));
+    for (uint32_t i = 0U; i < s_readers; i++)
+    {
+        pthread_create(&s_reader[i].thread, NULL, fw_reader, &s_reader[i]);
+    }
+    (void)osThreadTerminate(osThreadGetId());
+}
+
+/* Runs from the tick that ends the simulation */
+static void fw_report(void)
+{
+    Reader_t sum;
+    VehicleSample_t last;
+
+    atomic_store(&s_stop, 1);
+    for (uint32_t i = 0U; i < s_readers; i++)
+    {
+        pthread_join(s_reader[i].thread, NULL);
+    }
+    reader_totals(&sum);
+    (void)VehicleSnap_Read(&g_vehicleSnap, &last);
+
+    printf("  firmware:    %lu VehicleTask publishes in %lu ms, %.2f M reads, retried %llu, torn %llu, backwards %llu\n",
+           (unsigned long)last.step, (unsigned long)s_fwMs, sum.reads * 1e-6,
+           (unsigned long long)sum.retries, (unsigned long long)sum.torn,
+           (unsigned long long)sum.backwards);
+    if (sum.torn != 0U || sum.backwards != 0U || last.step == 0U)
+    {
+        printf("  FAIL: inconsistent or missing snapshot in the firmware\n");
+        s_failed = 1;
+    }
+    HOST_PORT_Exit(s_failed);
+}
+
+static void uart_null_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)data;
+    (void)len;
+    (void)ctx;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        s_stressMs = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2)
+    {
+        s_fwMs = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    s_readers = (cpus > 1) ? (uint32_t)(cpus - 1) : 1U;
+    if (s_readers > MAX_READERS) s_readers = MAX_READERS;
+
+    printf("bench_vsnap: 1 writer, %lu readers, %lu ms stress, %lu ms firmware\n",
+           (unsigned long)s_readers, (unsigned long)s_stressMs, (unsigned long)s_fwMs);
+    phase_cost();
+    phase_stress();
+
+    /* Model replayed step by step, as VehicleTask will run it */
+    s_expectLen = s_fwMs / FW_PERIOD_MS + 2U;
+    s_expect = malloc(s_expectLen * sizeof(*s_expect));
+    if (s_expect == NULL)
+    {
+        return 1;
+    }
+    Vehicle_Init(&s_expect[0]);
+    for (uint32_t i = 1U; i < s_expectLen; i++)
+    {
+        s_expect[i] = s_expect[i - 1U];
+        Vehicle_UpdateMs(&s_expect[i], FW_PERIOD_MS);
+    }
+
+    if (getenv("VECU_HOST_SPEED") == NULL)
+    {
+        HOST_PORT_SetTimeScale(0U);
+    }
+    HOST_UART_SetTxSink(USART2, uart_null_sink, NULL);
+    HOST_UART_SetRxFd(USART2, -1);
+    HOST_PORT_StopAfter(s_fwMs, fw_report);
+
+    osKernelInitialize();
+    const osThreadAttr_t attr = {
+        .name       = "vsnapStart",
+        .stack_size = 256U * 4U,
+        .priority   = osPriorityLow,
+    };
+    (void)osThreadNew(fw_start_task, NULL, &attr);
+
+    return vecu_firmware_main();
+}
@@ -0,0 +1,872 @@
+/**
+ * @file    host_can.c
+ * @brief   Behavioural bxCAN (CAN1) model behind the HAL CAN API.
+ *
+ * What is modelled:
+ *   - 3 TX mailboxes, arbitrated by identifier (TXFP = 0) or request order
+ *     (TXFP = 1), drained on every HAL tick at the bit rate derived from the
+ *     BTR settings in hcan->Init (stuff bits are not counted).
+ *   - Filter banks with identifier list / mask modes and 16/32-bit scale,
+ *     including the RM0390 match priority rules and filter match index.
+ *     Banks at or above SlaveStartFilterBank belong to CAN2 and are ignored.
+ *   - Two 3-deep RX FIFOs with FULL / overrun flags and locked/unlocked
+ *     overrun behaviour (ReceiveFifoLocked).
+ *   - Loopback: in CAN_MODE_LOOPBACK / SILENT_LOOPBACK every transmitted
+ *     frame is also received through the filters.
+ *   - Level-triggered interrupt lines CAN1_TX, CAN1_RX0 and CAN1_RX1.
+ *
+ * All model state is guarded by one mutex because frames can be injected
+ * from host threads while the simulated CPU reads the FIFOs.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "main.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+#define HOST_CAN_MAILBOXES   3U
+#define HOST_CAN_FIFO_DEPTH  3U
+#define HOST_CAN_BANKS       28U
+
+typedef struct
+{
+    uint8_t  busy;
+    uint8_t  aborted;
+    uint32_t seq;                 /* request order, for TXFP = 1 */
+    CAN_TxHeaderTypeDef hdr;
+    uint8_t  data[8];
+} HostCanMailbox_t;
+
+typedef struct
+{
+    CAN_RxHeaderTypeDef hdr;
+    uint8_t data[8];
+} HostCanRxEntry_t;
+
+typedef struct
+{
+    uint8_t  active;
+    uint8_t  list_mode;           /* 0 = mask, 1 = list       */
+    uint8_t  scale32;             /* 0 = 16-bit, 1 = 32-bit   */
+    uint8_t  fifo;
+    uint32_t fr1;
+    uint32_t fr2;
+} HostCanBank_t;
+
+typedef struct
+{
+    pthread_mutex_t    lock;
+    pthread_cond_t     space;
+    CAN_HandleTypeDef *hcan;
+    uint32_t           ier;               /* CAN_IT_* enabled            */
+    uint32_t           slave_start;
+    HostCanMailbox_t   mb[HOST_CAN_MAILBOXES];
+    uint32_t           rqcp;              /* completed mailboxes (bits)  */
+    uint32_t           tx_seq;
+    uint32_t           bit_budget;
+    HostCanRxEntry_t   fifo[2][HOST_CAN_FIFO_DEPTH];
+    uint8_t            head[2];
+    uint8_t            count[2];
+    uint8_t            full_flag[2];
+    uint8_t            ovr_flag[2];
+    HostCanBank_t      bank[HOST_CAN_BANKS];
+    HOST_CAN_TxTap_t   tap;
+    void              *tap_ctx;
+    HOST_CAN_Stats_t   stats;
+} HostCan_t;
+
+static HostCan_t s_can = {
+    .lock        = PTHREAD_MUTEX_INITIALIZER,
+    .space       = PTHREAD_COND_INITIALIZER,
+    .slave_start = HOST_CAN_BANKS,
+};
+
+/* --------------------------------------------------------------------------
+ * Weak HAL callbacks (same defaults as stm32f4xx_hal_can.c)
+ * -------------------------------------------------------------------------- */
+
+__weak void HAL_CAN_MspInit(CAN_HandleTypeDef *hcan)              { (void)hcan; }
+__weak void HAL_CAN_MspDeInit(CAN_HandleTypeDef *hcan)            { (void)hcan; }
+__weak void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan) { (void)hcan; }
+__weak void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan) { (void)hcan; }
+__weak void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan) { (void)hcan; }
+__weak void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan)    { (void)hcan; }
+__weak void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan)    { (void)hcan; }
+__weak void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan)    { (void)hcan; }
+__weak void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)  { (void)hcan; }
+__weak void HAL_CAN_RxFifo0FullCallback(CAN_HandleTypeDef *hcan)        { (void)hcan; }
+__weak void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)  { (void)hcan; }
+__weak void HAL_CAN_RxFifo1FullCallback(CAN_HandleTypeDef *hcan)        { (void)hcan; }
+__weak void HAL_CAN_SleepCallback(CAN_HandleTypeDef *hcan)              { (void)hcan; }
+__weak void HAL_CAN_WakeUpFromRxMsgCallback(CAN_HandleTypeDef *hcan)    { (void)hcan; }
+__weak void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan)              { (void)hcan; }
+
+/* --------------------------------------------------------------------------
+ * Model internals (call with s_can.lock held)
+ * -------------------------------------------------------------------------- */
+
+static int can_is_bound(const CAN_HandleTypeDef *hcan)
+{
+    return (hcan != NULL) && (hcan->Instance == CAN1);
+}
+
+static int can_is_listening(void)
+{
+    return (s_can.hcan != NULL) && (s_can.hcan->State == HAL_CAN_STATE_LISTENING);
+}
+
+static void can_update_irqs(void)
+{
+    if (((s_can.ier & CAN_IT_TX_MAILBOX_EMPTY) != 0U) && (s_can.rqcp != 0U))
+    {
+        HOST_PORT_PendIRQ(CAN1_TX_IRQn);
+    }
+    if ((((s_can.ier & CAN_IT_RX_FIFO0_MSG_PENDING) != 0U) && (s_can.count[0] != 0U)) ||
+        (((s_can.ier & CAN_IT_RX_FIFO0_FULL) != 0U) && (s_can.full_flag[0] != 0U)) ||
+        (((s_can.ier & CAN_IT_RX_FIFO0_OVERRUN) != 0U) && (s_can.ovr_flag[0] != 0U)))
+    {
+        HOST_PORT_PendIRQ(CAN1_RX0_IRQn);
+    }
+    if ((((s_can.ier & CAN_IT_RX_FIFO1_MSG_PENDING) != 0U) && (s_can.count[1] != 0U)) ||
+        (((s_can.ier & CAN_IT_RX_FIFO1_FULL) != 0U) && (s_can.full_flag[1] != 0U)) ||
+        (((s_can.ier & CAN_IT_RX_FIFO1_OVERRUN) != 0U) && (s_can.ovr_flag[1] != 0U)))
+    {
+        HOST_PORT_PendIRQ(CAN1_RX1_IRQn);
+    }
+}
+
+/* Identifier in filter-register layout (RM0390 "Filter bank scale and mode
+   configuration"). */
+static uint32_t can_word32(uint32_t ide, uint32_t rtr, uint32_t std_id, uint32_t ext_id)
+{
+    if (ide == CAN_ID_EXT)
+    {
+        return (ext_id << 3) | 0x4U | ((rtr == CAN_RTR_REMOTE) ? 0x2U : 0U);
+    }
+    return (std_id << 21) | ((rtr == CAN_RTR_REMOTE) ? 0x2U : 0U);
+}
+
+static uint32_t can_word16(uint32_t ide, uint32_t rtr, uint32_t std_id, uint32_t ext_id)
+{
+    uint32_t w;
+
+    if (ide == CAN_ID_EXT)
+    {
+        w = ((ext_id >> 18) << 5) | 0x8U | ((ext_id >> 15) & 0x7U);
+    }
+    else
+    {
+        w = std_id << 5;
+    }
+    return w | ((rtr == CAN_RTR_REMOTE) ? 0x10U : 0U);
+}
+
+/**
+ * Find the matching filter: 32-bit before 16-bit, list before mask, then the
+ * lowest filter number. Returns the FIFO (0/1) or -1, and the FMI.
+ */
+static int can_filter_match(uint32_t ide, uint32_t rtr, uint32_t std_id, uint32_t ext_id,
+                            uint32_t *fmi_out)
+{
+    const uint32_t w32 = can_word32(ide, rtr, std_id, ext_id);
+    const uint32_t w16 = can_word16(ide, rtr, std_id, ext_id);
+    uint32_t fmi_next[2] = { 0U, 0U };
+    int      best_fifo = -1;
+    uint32_t best_rank = 0U;
+    uint32_t best_fmi = 0U;
+
+    for (uint32_t b = 0U; b < s_can.slave_start && b < HOST_CAN_BANKS; b++)
+    {
+        const HostCanBank_t *bk = &s_can.bank[b];
+        const uint32_t fifo = bk->fifo;
+        const uint32_t base = fmi_next[fifo];
+        const uint32_t n = bk->scale32 ? (bk->list_mode ? 2U : 1U) : (bk->list_mode ? 4U : 2U);
+        fmi_next[fifo] += n;
+
+        if (!bk->active)
+        {
+            continue;
+        }
+
+        int hit = -1;
+        if (bk->scale32)
+        {
+            if (bk->list_mode)
+            {
+                hit = (w32 == bk->fr1) ? 0 : ((w32 == bk->fr2) ? 1 : -1);
+            }
+            else if ((w32 & bk->fr2) == (bk->fr1 & bk->fr2))
+            {
+                hit = 0;
+            }
+        }
+        else
+        {
+            const uint32_t f[4] = { bk->fr1 & 0xFFFFU, bk->fr1 >> 16, bk->fr2 & 0xFFFFU, bk->fr2 >> 16 };
+            if (bk->list_mode)
+            {
+                for (int i = 0; i < 4 && hit < 0; i++)
+                {
+                    if (w16 == f[i]) hit = i;
+                }
+            }
+            else
+            {
+                if ((w16 & f[1]) == (f[0] & f[1]))      hit = 0;
+                else if ((w16 & f[3]) == (f[2] & f[3])) hit = 1;
+            }
+        }
+
+        if (hit < 0)
+        {
+            continue;
+        }
+
+        /* Lower rank wins: scale first, then mode, then filter number */
+        uint32_t rank = ((bk->scale32 ? 0U : 2U) + (bk->list_mode ? 0U : 1U)) << 16;
+        rank |= (b << 2) | (uint32_t)hit;
+        if (best_fifo < 0 || rank < best_rank)
+        {
+            best_fifo = (int)fifo;
+            best_rank = rank;
+            best_fmi = base + (uint32_t)hit;
+        }
+    }
+
+    *fmi_out = best_fmi;
+    return best_fifo;
+}
+
+/* Bus → receiver. Returns 1 if the frame was stored. */
+static int can_receive(uint32_t ide, uint32_t rtr, uint32_t std_id, uint32_t ext_id,
+                       uint32_t dlc, const uint8_t *data)
+{
+    uint32_t fmi;
+    int fifo;
+
+    if (!can_is_listening())
+    {
+        return 0;
+    }
+
+    fifo = can_filter_match(ide, rtr, std_id, ext_id, &fmi);
+    if (fifo < 0)
+    {
+        s_can.stats.rx_filtered++;
+        return 0;
+    }
+
+    if (s_can.count[fifo] == HOST_CAN_FIFO_DEPTH)
+    {
+        s_can.ovr_flag[fifo] = 1U;
+        s_can.stats.rx_overruns[fifo]++;
+        if (s_can.hcan->Init.ReceiveFifoLocked == ENABLE)
+        {
+            can_update_irqs();
+            return 0;               /* locked: new frame discarded */
+        }
+        /* unlocked: the newest stored frame is overwritten */
+        s_can.count[fifo]--;
+    }
+
+    uint32_t slot = (s_can.head[fifo] + s_can.count[fifo]) % HOST_CAN_FIFO_DEPTH;
+    HostCanRxEntry_t *e = &s_can.fifo[fifo][slot];
+
+    memset(e, 0, sizeof(*e));
+    e->hdr.IDE = ide;
+    e->hdr.RTR = rtr;
+    e->hdr.StdId = std_id;
+    e->hdr.ExtId = ext_id;
+    e->hdr.DLC = (dlc > 8U) ? 8U : dlc;
+    e->hdr.FilterMatchIndex = fmi;
+    e->hdr.Timestamp = (uint32_t)(HAL_GetTick() & 0xFFFFU);
+    if (data != NULL)
+    {
+        memcpy(e->data, data, e->hdr.DLC);
+    }
+
+    s_can.count[fifo]++;
+    if (s_can.count[fifo] == HOST_CAN_FIFO_DEPTH)
+    {
+        s_can.full_flag[fifo] = 1U;
+    }
+    s_can.stats.rx_frames[fifo]++;
+    can_update_irqs();
+    return 1;
+}
+
+static int can_pick_mailbox(void)
+{
+    int best = -1;
+
+    for (uint32_t i = 0U; i < HOST_CAN_MAILBOXES; i++)
+    {
+        const HostCanMailbox_t *m = &s_can.mb[i];
+        if (!m->busy)
+        {
+            continue;
+        }
+        if (best < 0)
+        {
+            best = (int)i;
+            continue;
+        }
+
+        const HostCanMailbox_t *b = &s_can.mb[best];
+        if (s_can.hcan->Init.TransmitFifoPriority == ENABLE)
+        {
+            if ((int32_t)(m->seq - b->seq) < 0) best = (int)i;
+        }
+        else
+        {
+            uint32_t wm = can_word32(m->hdr.IDE, m->hdr.RTR, m->hdr.StdId, m->hdr.ExtId);
+            uint32_t wb = can_word32(b->hdr.IDE, b->hdr.RTR, b->hdr.StdId, b->hdr.ExtId);
+            if (wm < wb) best = (int)i;
+        }
+    }
+    return best;
+}
+
+static uint32_t can_bitrate(void)
+{
+    const CAN_InitTypeDef *init = &s_can.hcan->Init;
+    uint32_t tq = 1U + ((init->TimeSeg1 >> CAN_BTR_TS1_Pos) + 1U) +
+                       ((init->TimeSeg2 >> CAN_BTR_TS2_Pos) + 1U);
+    uint32_t presc = (init->Prescaler == 0U) ? 1U : init->Prescaler;
+
+    return HAL_RCC_GetPCLK1Freq() / (presc * tq);
+}
+
+/* --------------------------------------------------------------------------
+ * Bus clock: called from HAL_IncTick() (SysTick context)
+ * -------------------------------------------------------------------------- */
+
+void HOST_CAN_Tick(void)
+{
+    pthread_mutex_lock(&s_can.lock);
+
+    if (!can_is_listening())
+    {
+        pthread_mutex_unlock(&s_can.lock);
+        return;
+    }
+
+    s_can.bit_budget += can_bitrate() / 1000U;
+
+    for (;;)
+    {
+        int i = can_pick_mailbox();
+        if (i < 0)
+        {
+            s_can.bit_budget = 0U;   /* an idle bus does not bank bits */
+            break;
+        }
+
+        HostCanMailbox_t *m = &s_can.mb[i];
+        uint32_t bits = ((m->hdr.IDE == CAN_ID_EXT) ? 67U : 47U) +
+                        ((m->hdr.RTR == CAN_RTR_DATA) ? 8U * m->hdr.DLC : 0U);
+        if (s_can.bit_budget < bits)
+        {
+            break;
+        }
+        s_can.bit_budget -= bits;
+
+        m->busy = 0U;
+        s_can.rqcp |= (1UL << i);
+        s_can.stats.tx_frames++;
+
+        CAN_TxHeaderTypeDef hdr = m->hdr;
+        uint8_t data[8];
+        memcpy(data, m->data, sizeof(data));
+
+        if (s_can.tap != NULL)
+        {
+            HOST_CAN_TxTap_t tap = s_can.tap;
+            void *ctx = s_can.tap_ctx;
+            pthread_mutex_unlock(&s_can.lock);
+            tap(&hdr, data, ctx);
+            pthread_mutex_lock(&s_can.lock);
+        }
+
+        if (s_can.hcan->Init.Mode == CAN_MODE_LOOPBACK ||
+            s_can.hcan->Init.Mode == CAN_MODE_SILENT_LOOPBACK)
+        {
+            (void)can_receive(hdr.IDE, hdr.RTR, hdr.StdId, hdr.ExtId, hdr.DLC, data);
+        }
+    }
+
+    can_update_irqs();
+    pthread_mutex_unlock(&s_can.lock);
+}
+
+/* --------------------------------------------------------------------------
+ * HAL CAN API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef HAL_CAN_Init(CAN_HandleTypeDef *hcan)
+{
+    if (!can_is_bound(hcan))
+    {
+        return HAL_ERROR;
+    }
+
+    if (hcan->State == HAL_CAN_STATE_RESET)
+    {
+        HAL_CAN_MspInit(hcan);
+    }
+
+    pthread_mutex_lock(&s_can.lock);
+    s_can.hcan = hcan;
+    s_can.ier = 0U;
+    s_can.rqcp = 0U;
+    memset(s_can.mb, 0, sizeof(s_can.mb));
+    memset(s_can.count, 0, sizeof(s_can.count));
+    hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+    hcan->State = HAL_CAN_STATE_READY;
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_DeInit(CAN_HandleTypeDef *hcan)
+{
+    if (!can_is_bound(hcan))
+    {
+        return HAL_ERROR;
+    }
+    (void)HAL_CAN_Stop(hcan);
+    HAL_CAN_MspDeInit(hcan);
+    hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+    hcan->State = HAL_CAN_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan, const CAN_FilterTypeDef *sFilterConfig)
+{
+    if (!can_is_bound(hcan) || sFilterConfig == NULL ||
+        sFilterConfig->FilterBank >= HOST_CAN_BANKS ||
+        sFilterConfig->SlaveStartFilterBank >= HOST_CAN_BANKS)   /* HAL: <= 27 */
+    {
+        return HAL_ERROR;
+    }
+    if (hcan->State != HAL_CAN_STATE_READY && hcan->State != HAL_CAN_STATE_LISTENING)
+    {
+        hcan->ErrorCode |= HAL_CAN_ERROR_NOT_INITIALIZED;
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_can.lock);
+    HostCanBank_t *bk = &s_can.bank[sFilterConfig->FilterBank];
+
+    s_can.slave_start = sFilterConfig->SlaveStartFilterBank;
+    bk->active    = (sFilterConfig->FilterActivation == CAN_FILTER_ENABLE) ? 1U : 0U;
+    bk->list_mode = (sFilterConfig->FilterMode == CAN_FILTERMODE_IDLIST) ? 1U : 0U;
+    bk->scale32   = (sFilterConfig->FilterScale == CAN_FILTERSCALE_32BIT) ? 1U : 0U;
+    bk->fifo      = (sFilterConfig->FilterFIFOAssignment == CAN_FILTER_FIFO1) ? 1U : 0U;
+
+    if (bk->scale32)
+    {
+        bk->fr1 = ((0xFFFFU & sFilterConfig->FilterIdHigh) << 16) | (0xFFFFU & sFilterConfig->FilterIdLow);
+        bk->fr2 = ((0xFFFFU & sFilterConfig->FilterMaskIdHigh) << 16) | (0xFFFFU & sFilterConfig->FilterMaskIdLow);
+    }
+    else
+    {
+        bk->fr1 = ((0xFFFFU & sFilterConfig->FilterMaskIdLow) << 16) | (0xFFFFU & sFilterConfig->FilterIdLow);
+        bk->fr2 = ((0xFFFFU & sFilterConfig->FilterMaskIdHigh) << 16) | (0xFFFFU & sFilterConfig->FilterIdHigh);
+    }
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan)
+{
+    if (!can_is_bound(hcan))
+    {
+        return HAL_ERROR;
+    }
+    if (hcan->State != HAL_CAN_STATE_READY)
+    {
+        hcan->ErrorCode |= HAL_CAN_ERROR_NOT_READY;
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_can.lock);
+    hcan->State = HAL_CAN_STATE_LISTENING;
+    hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+    pthread_cond_broadcast(&s_can.space);
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_Stop(CAN_HandleTypeDef *hcan)
+{
+    if (!can_is_bound(hcan))
+    {
+        return HAL_ERROR;
+    }
+    if (hcan->State != HAL_CAN_STATE_LISTENING)
+    {
+        hcan->ErrorCode |= HAL_CAN_ERROR_NOT_STARTED;
+        return HAL_ERROR;
+    }
+    pthread_mutex_lock(&s_can.lock);
+    hcan->State = HAL_CAN_STATE_READY;
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_RequestSleep(CAN_HandleTypeDef *hcan)
+{
+    (void)hcan;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_WakeUp(CAN_HandleTypeDef *hcan)
+{
+    (void)hcan;
+    return HAL_OK;
+}
+
+uint32_t HAL_CAN_IsSleepActive(const CAN_HandleTypeDef *hcan)
+{
+    (void)hcan;
+    return 0U;
+}
+
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan, const CAN_TxHeaderTypeDef *pHeader,
+                                       const uint8_t aData[], uint32_t *pTxMailbox)
+{
+    if (!can_is_bound(hcan) || pHeader == NULL || pTxMailbox == NULL || pHeader->DLC > 8U)
+    {
+        return HAL_ERROR;
+    }
+    if (hcan->State != HAL_CAN_STATE_READY && hcan->State != HAL_CAN_STATE_LISTENING)
+    {
+        hcan->ErrorCode |= HAL_CAN_ERROR_NOT_INITIALIZED;
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_can.lock);
+    for (uint32_t i = 0U; i < HOST_CAN_MAILBOXES; i++)
+    {
+        HostCanMailbox_t *m = &s_can.mb[i];
+        if (m->busy)
+        {
+            continue;
+        }
+
+        m->busy = 1U;
+        m->aborted = 0U;
+        m->seq = s_can.tx_seq++;
+        m->hdr = *pHeader;
+        memset(m->data, 0, sizeof(m->data));
+        if (aData != NULL)
+        {
+            memcpy(m->data, aData, pHeader->DLC);
+        }
+        *pTxMailbox = (CAN_TX_MAILBOX0 << i);
+        pthread_mutex_unlock(&s_can.lock);
+        return HAL_OK;
+    }
+    pthread_mutex_unlock(&s_can.lock);
+
+    hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_CAN_AbortTxRequest(CAN_HandleTypeDef *hcan, uint32_t TxMailboxes)
+{
+    if (!can_is_bound(hcan))
+    {
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_can.lock);
+    for (uint32_t i = 0U; i < HOST_CAN_MAILBOXES; i++)
+    {
+        if ((TxMailboxes & (CAN_TX_MAILBOX0 << i)) != 0U && s_can.mb[i].busy)
+        {
+            s_can.mb[i].busy = 0U;
+            s_can.mb[i].aborted = 1U;
+            s_can.rqcp |= (1UL << i);
+        }
+    }
+    can_update_irqs();
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(const CAN_HandleTypeDef *hcan)
+{
+    uint32_t n = 0U;
+
+    if (!can_is_bound(hcan))
+    {
+        return 0U;
+    }
+    pthread_mutex_lock(&s_can.lock);
+    for (uint32_t i = 0U; i < HOST_CAN_MAILBOXES; i++)
+    {
+        n += s_can.mb[i].busy ? 0U : 1U;
+    }
+    pthread_mutex_unlock(&s_can.lock);
+    return n;
+}
+
+uint32_t HAL_CAN_IsTxMessagePending(const CAN_HandleTypeDef *hcan, uint32_t TxMailboxes)
+{
+    uint32_t pending = 0U;
+
+    if (!can_is_bound(hcan))
+    {
+        return 0U;
+    }
+    pthread_mutex_lock(&s_can.lock);
+    for (uint32_t i = 0U; i < HOST_CAN_MAILBOXES; i++)
+    {
+        if ((TxMailboxes & (CAN_TX_MAILBOX0 << i)) != 0U && s_can.mb[i].busy)
+        {
+            pending = 1U;
+        }
+    }
+    pthread_mutex_unlock(&s_can.lock);
+    return pending;
+}
+
+uint32_t HAL_CAN_GetTxTimestamp(const CAN_HandleTypeDef *hcan, uint32_t TxMailbox)
+{
+    (void)hcan;
+    (void)TxMailbox;
+    return 0U;
+}
+
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan, uint32_t RxFifo,
+                                       CAN_RxHeaderTypeDef *pHeader, uint8_t aData[])
+{
+    const uint32_t f = (RxFifo == CAN_RX_FIFO1) ? 1U : 0U;
+
+    if (!can_is_bound(hcan) || pHeader == NULL || aData == NULL)
+    {
+        return HAL_ERROR;
+    }
+    if (hcan->State != HAL_CAN_STATE_READY && hcan->State != HAL_CAN_STATE_LISTENING)
+    {
+        hcan->ErrorCode |= HAL_CAN_ERROR_NOT_INITIALIZED;
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_can.lock);
+    if (s_can.count[f] == 0U)
+    {
+        pthread_mutex_unlock(&s_can.lock);
+        hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+        return HAL_ERROR;
+    }
+
+    const HostCanRxEntry_t *e = &s_can.fifo[f][s_can.head[f]];
+    *pHeader = e->hdr;
+    memcpy(aData, e->data, e->hdr.DLC);
+
+    /* Release the output mailbox (RFOM) */
+    s_can.head[f] = (uint8_t)((s_can.head[f] + 1U) % HOST_CAN_FIFO_DEPTH);
+    s_can.count[f]--;
+    s_can.stats.rx_read[f]++;
+    pthread_cond_broadcast(&s_can.space);
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+uint32_t HAL_CAN_GetRxFifoFillLevel(const CAN_HandleTypeDef *hcan, uint32_t RxFifo)
+{
+    uint32_t n;
+
+    if (!can_is_bound(hcan))
+    {
+        return 0U;
+    }
+    pthread_mutex_lock(&s_can.lock);
+    n = s_can.count[(RxFifo == CAN_RX_FIFO1) ? 1U : 0U];
+    pthread_mutex_unlock(&s_can.lock);
+    return n;
+}
+
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef *hcan, uint32_t ActiveITs)
+{
+    if (!can_is_bound(hcan))
+    {
+        return HAL_ERROR;
+    }
+    pthread_mutex_lock(&s_can.lock);
+    s_can.ier |= ActiveITs;
+    can_update_irqs();
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_DeactivateNotification(CAN_HandleTypeDef *hcan, uint32_t InactiveITs)
+{
+    if (!can_is_bound(hcan))
+    {
+        return HAL_ERROR;
+    }
+    pthread_mutex_lock(&s_can.lock);
+    s_can.ier &= ~InactiveITs;
+    pthread_mutex_unlock(&s_can.lock);
+    return HAL_OK;
+}
+
+void HAL_CAN_IRQHandler(CAN_HandleTypeDef *hcan)
+{
+    static void (* const complete_cb[HOST_CAN_MAILBOXES])(CAN_HandleTypeDef *) = {
+        HAL_CAN_TxMailbox0CompleteCallback,
+        HAL_CAN_TxMailbox1CompleteCallback,
+        HAL_CAN_TxMailbox2CompleteCallback,
+    };
+    static void (* const abort_cb[HOST_CAN_MAILBOXES])(CAN_HandleTypeDef *) = {
+        HAL_CAN_TxMailbox0AbortCallback,
+        HAL_CAN_TxMailbox1AbortCallback,
+        HAL_CAN_TxMailbox2AbortCallback,
+    };
+    uint32_t rqcp = 0U;
+    uint32_t aborted = 0U;
+    uint8_t  full[2] = { 0U, 0U };
+    uint8_t  pending[2] = { 0U, 0U };
+
+    if (!can_is_bound(hcan))
+    {
+        return;
+    }
+
+    /* Snapshot and acknowledge flags, then run callbacks unlocked (they call
+       back into the HAL, e.g. HAL_CAN_GetRxMessage). */
+    pthread_mutex_lock(&s_can.lock);
+    const uint32_t ier = s_can.ier;
+
+    if ((ier & CAN_IT_TX_MAILBOX_EMPTY) != 0U)
+    {
+        rqcp = s_can.rqcp;
+        s_can.rqcp = 0U;
+        for (uint32_t i = 0U; i < HOST_CAN_MAILBOXES; i++)
+        {
+            if (s_can.mb[i].aborted)
+            {
+                aborted |= (1UL << i);
+                s_can.mb[i].aborted = 0U;
+            }
+        }
+    }
+    for (uint32_t f = 0U; f < 2U; f++)
+    {
+        const uint32_t it_ovr  = (f == 0U) ? CAN_IT_RX_FIFO0_OVERRUN : CAN_IT_RX_FIFO1_OVERRUN;
+        const uint32_t it_full = (f == 0U) ? CAN_IT_RX_FIFO0_FULL : CAN_IT_RX_FIFO1_FULL;
+        const uint32_t it_pend = (f == 0U) ? CAN_IT_RX_FIFO0_MSG_PENDING : CAN_IT_RX_FIFO1_MSG_PENDING;
+
+        if ((ier & it_ovr) != 0U && s_can.ovr_flag[f])
+        {
+            hcan->ErrorCode |= (f == 0U) ? HAL_CAN_ERROR_RX_FOV0 : HAL_CAN_ERROR_RX_FOV1;
+            s_can.ovr_flag[f] = 0U;
+        }
+        if ((ier & it_full) != 0U && s_can.full_flag[f])
+        {
+            full[f] = 1U;
+            s_can.full_flag[f] = 0U;
+        }
+        pending[f] = ((ier & it_pend) != 0U) && (s_can.count[f] != 0U);
+    }
+    pthread_mutex_unlock(&s_can.lock);
+
+    for (uint32_t i = 0U; i < HOST_CAN_MAILBOXES; i++)
+    {
+        if ((rqcp & (1UL << i)) != 0U)
+        {
+            if ((aborted & (1UL << i)) != 0U) abort_cb[i](hcan);
+            else                              complete_cb[i](hcan);
+        }
+    }
+    if (full[0])    HAL_CAN_RxFifo0FullCallback(hcan);
+    if (pending[0]) HAL_CAN_RxFifo0MsgPendingCallback(hcan);
+    if (full[1])    HAL_CAN_RxFifo1FullCallback(hcan);
+    if (pending[1]) HAL_CAN_RxFifo1MsgPendingCallback(hcan);
+
+    if (hcan->ErrorCode != HAL_CAN_ERROR_NONE)
+    {
+        HAL_CAN_ErrorCallback(hcan);
+    }
+
+    /* Level-triggered: re-assert lines whose condition still holds */
+    pthread_mutex_lock(&s_can.lock);
+    can_update_irqs();
+    pthread_mutex_unlock(&s_can.lock);
+}
+
+HAL_CAN_StateTypeDef HAL_CAN_GetState(const CAN_HandleTypeDef *hcan)
+{
+    return hcan->State;
+}
+
+uint32_t HAL_CAN_GetError(const CAN_HandleTypeDef *hcan)
+{
+    return hcan->ErrorCode;
+}
+
+HAL_StatusTypeDef HAL_CAN_ResetError(CAN_HandleTypeDef *hcan)
+{
+    hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+    return HAL_OK;
+}
+
+/* --------------------------------------------------------------------------
+ * Host control API
+ * -------------------------------------------------------------------------- */
+
+void HOST_CAN_SetTxTap(HOST_CAN_TxTap_t tap, void *ctx)
+{
+    pthread_mutex_lock(&s_can.lock);
+    s_can.tap = tap;
+    s_can.tap_ctx = ctx;
+    pthread_mutex_unlock(&s_can.lock);
+}
+
+int HOST_CAN_InjectFrame(uint32_t std_id, uint8_t dlc, const uint8_t *data)
+{
+    int stored;
+
+    pthread_mutex_lock(&s_can.lock);
+    stored = can_receive(CAN_ID_STD, CAN_RTR_DATA, std_id & 0x7FFU, 0U, dlc, data);
+    s_can.stats.injected += (uint32_t)stored;
+    pthread_mutex_unlock(&s_can.lock);
+    return stored;
+}
+
+int HOST_CAN_InjectFrameBlocking(uint32_t std_id, uint8_t dlc, const uint8_t *data)
+{
+    uint32_t fmi;
+    int fifo;
+    int stored;
+
+    pthread_mutex_lock(&s_can.lock);
+    for (;;)
+    {
+        if (can_is_listening())
+        {
+            fifo = can_filter_match(CAN_ID_STD, CAN_RTR_DATA, std_id & 0x7FFU, 0U, &fmi);
+            if (fifo < 0 || s_can.count[fifo] < HOST_CAN_FIFO_DEPTH)
+            {
+                break;
+            }
+        }
+        pthread_cond_wait(&s_can.space, &s_can.lock);
+    }
+    stored = can_receive(CAN_ID_STD, CAN_RTR_DATA, std_id & 0x7FFU, 0U, dlc, data);
+    s_can.stats.injected += (uint32_t)stored;
+    pthread_mutex_unlock(&s_can.lock);
+    return stored;
+}
+
+void HOST_CAN_GetStats(HOST_CAN_Stats_t *out)
+{
+    pthread_mutex_lock(&s_can.lock);
+    *out = s_can.stats;
+    pthread_mutex_unlock(&s_can.lock);
+}
@@ -0,0 +1,398 @@
+/**
+ * @file    host_hal.c
+ * @brief   Host stand-ins for the HAL core, RCC, GPIO, DMA and Cortex (NVIC)
+ *          APIs.
+ *
+ * Clock configuration is recorded but not simulated: the host build always
+ * reports the HSI-based tree that SystemClock_Config() selects. GPIO output
+ * state is kept in the (RAM-backed) ODR so HAL_GPIO_ReadPin sees writes.
+ */
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_port.h"
+
+/* Symbols owned by the real stm32f4xx_hal.c */
+__IO uint32_t       uwTick;
+uint32_t            uwTickPrio = (1UL << __NVIC_PRIO_BITS);
+HAL_TickFreqTypeDef uwTickFreq = HAL_TICK_FREQ_DEFAULT;
+
+/* Peripheral models advance with the HAL tick (host_can.c, host_uart.c,
+   host_tim.c) */
+extern void HOST_CAN_Tick(void);
+extern void HOST_UART_Tick(void);
+extern void HOST_TIM_Tick(void);
+
+/* --------------------------------------------------------------------------
+ * HAL core
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+    HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+    (void)HAL_InitTick(TICK_INT_PRIORITY);
+    HAL_MspInit();
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DeInit(void)
+{
+    HAL_MspDeInit();
+    return HAL_OK;
+}
+
+__weak void HAL_MspInit(void)
+{
+}
+
+__weak void HAL_MspDeInit(void)
+{
+}
+
+/* The tick itself is generated by the host port (SysTick exception). */
+__weak HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority)
+{
+    uwTickPrio = TickPriority;
+    HOST_PORT_SetPriority(SysTick_IRQn, TickPriority);
+    return HAL_OK;
+}
+
+__weak void HAL_IncTick(void)
+{
+    uwTick += (uint32_t)uwTickFreq;
+    HOST_CAN_Tick();
+    HOST_UART_Tick();
+    HOST_TIM_Tick();
+}
+
+__weak uint32_t HAL_GetTick(void)
+{
+    return uwTick;
+}
+
+uint32_t HAL_GetTickPrio(void)
+{
+    return uwTickPrio;
+}
+
+HAL_TickFreqTypeDef HAL_GetTickFreq(void)
+{
+    return uwTickFreq;
+}
+
+/* On target this busy-waits on uwTick. Host ticks only advance while the
+   idle task runs, so a spinning task would never see time pass: block
+   instead. Before the scheduler starts (or in an ISR) there is no tick at
+   all and the delay is skipped. */
+__weak void HAL_Delay(uint32_t Delay)
+{
+    if (xPortIsInsideInterrupt() ||
+        xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+    {
+        return;
+    }
+    vTaskDelay(pdMS_TO_TICKS(Delay) + 1U);
+}
+
+__weak void HAL_SuspendTick(void)
+{
+}
+
+__weak void HAL_ResumeTick(void)
+{
+}
+
+uint32_t HAL_GetHalVersion(void)
+{
+    return 0x01080000U;
+}
+
+uint32_t HAL_GetREVID(void)
+{
+    return 0x1000U;
+}
+
+uint32_t HAL_GetDEVID(void)
+{
+    return 0x421U;   /* STM32F446xx */
+}
+
+/* --------------------------------------------------------------------------
+ * RCC
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(const RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    return (RCC_OscInitStruct == NULL) ? HAL_ERROR : HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(const RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+    (void)FLatency;
+    if (RCC_ClkInitStruct == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    /* Reflect the prescalers in CFGR so register-level readers agree */
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2,
+               RCC_ClkInitStruct->AHBCLKDivider |
+               RCC_ClkInitStruct->APB1CLKDivider |
+               (RCC_ClkInitStruct->APB2CLKDivider << 3));
+    SystemCoreClock = HSI_VALUE >> AHBPrescTable[(RCC->CFGR & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+    return HAL_InitTick(uwTickPrio);
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void)
+{
+    return HSI_VALUE;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+    return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+}
+
+/* --------------------------------------------------------------------------
+ * GPIO
+ * -------------------------------------------------------------------------- */
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    (void)GPIOx;
+    (void)GPIO_Init;
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return ((GPIOx->ODR & GPIO_Pin) != 0U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState != GPIO_PIN_RESET)
+    {
+        GPIOx->ODR |= GPIO_Pin;
+    }
+    else
+    {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+/* --------------------------------------------------------------------------
+ * DMA
+ *
+ * Handle bookkeeping only. A transfer is carried out by the model of the
+ * peripheral that requested it (host_uart.c moves bytes at the baud rate),
+ * which counts NDTR down (reloading it in circular mode), clears EN at the
+ * end of a normal transfer and raises the half/complete (or transfer
+ * error) flags in the controller's LISR/HISR with HOST_DMA_RaiseFlags().
+ * -------------------------------------------------------------------------- */
+
+/* Stream interrupt line (RM0390 vector table) */
+IRQn_Type HOST_DMA_StreamIrq(const DMA_Stream_TypeDef *stream)
+{
+    static const IRQn_Type dma1[8] = {
+        DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+        DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn,
+    };
+    static const IRQn_Type dma2[8] = {
+        DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+        DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn,
+    };
+    const uintptr_t a = (uintptr_t)stream;
+
+    if (a >= (uintptr_t)DMA1_Stream0 && a <= (uintptr_t)DMA1_Stream7)
+    {
+        return dma1[(a - (uintptr_t)DMA1_Stream0) / sizeof(DMA_Stream_TypeDef)];
+    }
+    return dma2[((a - (uintptr_t)DMA2_Stream0) / sizeof(DMA_Stream_TypeDef)) & 7U];
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    if (hdma == NULL || hdma->Instance == NULL)
+    {
+        return HAL_ERROR;
+    }
+    hdma->Instance->CR   = hdma->Init.Mode & DMA_SxCR_CIRC;
+    hdma->Instance->NDTR = 0U;
+    hdma->ErrorCode = HAL_DMA_ERROR_NONE;
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    if (hdma == NULL)
+    {
+        return HAL_ERROR;
+    }
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+    if (hdma == NULL || hdma->State != HAL_DMA_STATE_BUSY)
+    {
+        return HAL_ERROR;
+    }
+    hdma->Instance->CR &= ~DMA_SxCR_EN;   /* NDTR keeps the untransferred count */
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+/* Controller status register and bit offset of a stream's flag group */
+static __IO uint32_t *dma_isr(const DMA_Stream_TypeDef *stream, uint32_t *shift)
+{
+    static const uint8_t offset[4] = { 0U, 6U, 16U, 22U };
+    const uintptr_t a = (uintptr_t)stream;
+    DMA_TypeDef *dma = DMA2;
+    uint32_t index;
+
+    if (a >= (uintptr_t)DMA1_Stream0 && a <= (uintptr_t)DMA1_Stream7)
+    {
+        dma = DMA1;
+        index = (uint32_t)((a - (uintptr_t)DMA1_Stream0) / sizeof(DMA_Stream_TypeDef));
+    }
+    else
+    {
+        index = (uint32_t)((a - (uintptr_t)DMA2_Stream0) / sizeof(DMA_Stream_TypeDef)) & 7U;
+    }
+    *shift = offset[index & 3U];
+    return (index < 4U) ? &dma->LISR : &dma->HISR;
+}
+
+/* flags in stream 0/4 positions (DMA_FLAG_TCIF0_4, _HTIF0_4, _TEIF0_4) */
+void HOST_DMA_RaiseFlags(DMA_Stream_TypeDef *stream, uint32_t flags)
+{
+    uint32_t shift;
+    __IO uint32_t *isr = dma_isr(stream, &shift);
+
+    *isr |= flags << shift;
+    HOST_PORT_PendIRQ(HOST_DMA_StreamIrq(stream));
+}
+
+HAL_DMA_StateTypeDef HAL_DMA_GetState(DMA_HandleTypeDef *hdma)
+{
+    return hdma->State;
+}
+
+/* Transfer error, else half transfer, then transfer complete; a circular
+   stream stays busy */
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    uint32_t shift;
+    uint32_t flags;
+    __IO uint32_t *isr;
+
+    if (hdma == NULL || hdma->State != HAL_DMA_STATE_BUSY)
+    {
+        return;
+    }
+    isr = dma_isr(hdma->Instance, &shift);
+    flags = (*isr >> shift) & (DMA_FLAG_TEIF0_4 | DMA_FLAG_HTIF0_4 | DMA_FLAG_TCIF0_4);
+    *isr &= ~(flags << shift);
+
+    if ((flags & DMA_FLAG_TEIF0_4) != 0U)
+    {
+        /* The stream has stopped (EN cleared by the peripheral model) */
+        hdma->ErrorCode |= HAL_DMA_ERROR_TE;
+        hdma->State = HAL_DMA_STATE_READY;
+        if (hdma->XferErrorCallback != NULL)
+        {
+            hdma->XferErrorCallback(hdma);
+        }
+        return;
+    }
+
+    if ((flags & DMA_FLAG_HTIF0_4) != 0U && hdma->XferHalfCpltCallback != NULL)
+    {
+        hdma->XferHalfCpltCallback(hdma);
+    }
+    if ((flags & DMA_FLAG_TCIF0_4) != 0U)
+    {
+        if ((hdma->Instance->CR & DMA_SxCR_CIRC) == 0U)
+        {
+            hdma->State = HAL_DMA_STATE_READY;
+        }
+        if (hdma->XferCpltCallback != NULL)
+        {
+            hdma->XferCpltCallback(hdma);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Cortex / NVIC
+ * -------------------------------------------------------------------------- */
+
+void HAL_NVIC_SetPriorityGrouping(uint32_t PriorityGroup)
+{
+    (void)PriorityGroup;
+}
+
+uint32_t HAL_NVIC_GetPriorityGrouping(void)
+{
+    return NVIC_PRIORITYGROUP_4;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    (void)SubPriority;
+    HOST_PORT_SetPriority((int32_t)IRQn, PreemptPriority);
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    HOST_PORT_EnableIRQ((int32_t)IRQn);
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    HOST_PORT_DisableIRQ((int32_t)IRQn);
+}
+
+uint32_t HAL_NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+    return HOST_PORT_GetPendingIRQ((int32_t)IRQn);
+}
+
+void HAL_NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    HOST_PORT_PendIRQ((int32_t)IRQn);
+}
+
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    HOST_PORT_ClearPendingIRQ((int32_t)IRQn);
+}
+
+void HAL_NVIC_SystemReset(void)
+{
+    HOST_PORT_Exit(0);
+}
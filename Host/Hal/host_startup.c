@@ -0,0 +1,313 @@
+/**
+ * @file    host_startup.c
+ * @brief   Host counterpart of Core/Startup/startup_stm32f446retx.s.
+ *
+ * Responsibilities:
+ *   - Back the STM32F446 peripheral and Cortex-M system register windows with
+ *     anonymous RAM at their real addresses, so the register-level macros in
+ *     main.c / stm32f4xx_hal_msp.c (__HAL_RCC_*_CLK_ENABLE, SCB, DWT ...)
+ *     execute unchanged.
+ *   - Run SystemInit() before main(), as Reset_Handler does.
+ *   - Provide the vector table used by the host port's NVIC emulation, with
+ *     weak Default_Handler aliases exactly like the target startup file.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "main.h"
+#include "host_port.h"
+
+extern void SystemInit(void);
+
+/* --------------------------------------------------------------------------
+ * Register windows
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uintptr_t base;
+    size_t    size;
+} HostRegWindow_t;
+
+static const HostRegWindow_t s_regWindows[] = {
+    { PERIPH_BASE,  0x00080000U },   /* APB1, APB2, AHB1 (RCC, GPIO, DMA, CAN, USART) */
+    { AHB2PERIPH_BASE, 0x00060000U },/* AHB2 (USB OTG, DCMI)                          */
+    { 0xE0000000U,  0x00100000U },   /* ITM, DWT, SCS (SCB, NVIC, SysTick), DBGMCU     */
+};
+
+static void host_map_registers(void)
+{
+    for (size_t i = 0; i < sizeof(s_regWindows) / sizeof(s_regWindows[0]); i++)
+    {
+        void *p = mmap((void *)s_regWindows[i].base, s_regWindows[i].size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                       -1, 0);
+        if (p != (void *)s_regWindows[i].base)
+        {
+            fprintf(stderr, "host: cannot map register window at 0x%08lX\n",
+                    (unsigned long)s_regWindows[i].base);
+            abort();
+        }
+    }
+}
+
+static uint32_t host_env_u32(const char *name, uint32_t dflt)
+{
+    const char *v = getenv(name);
+    return (v != NULL && *v != '\0') ? (uint32_t)strtoul(v, NULL, 0) : dflt;
+}
+
+/* Reset_Handler equivalent: runs before main() */
+__attribute__((constructor(101))) static void host_reset(void)
+{
+    host_map_registers();
+    SystemInit();
+
+    HOST_PORT_SetTimeScale(host_env_u32("VECU_HOST_SPEED", 1U));
+    HOST_PORT_StopAfter(host_env_u32("VECU_HOST_RUN_MS", 0U), NULL);
+}
+
+/* --------------------------------------------------------------------------
+ * Fault reporting
+ * -------------------------------------------------------------------------- */
+
+void Default_Handler(void)
+{
+    fprintf(stderr, "host: unexpected exception %lu\n",
+            (unsigned long)__get_IPSR());
+    abort();
+}
+
+void vHostAssertCalled(const char *file, int line)
+{
+    fprintf(stderr, "host: configASSERT failed at %s:%d\n", file, line);
+    abort();
+}
+
+/* --------------------------------------------------------------------------
+ * Vector table (mirrors g_pfnVectors, indexed by exception number)
+ * -------------------------------------------------------------------------- */
+
+#define HOST_WEAK_HANDLER(name) \
+    void name(void) __attribute__((weak, alias("Default_Handler")));
+
+/* Handler names as in startup_stm32f446retx.s */
+HOST_WEAK_HANDLER(NMI_Handler)
+HOST_WEAK_HANDLER(HardFault_Handler)
+HOST_WEAK_HANDLER(MemManage_Handler)
+HOST_WEAK_HANDLER(BusFault_Handler)
+HOST_WEAK_HANDLER(UsageFault_Handler)
+HOST_WEAK_HANDLER(SVC_Handler)
+HOST_WEAK_HANDLER(DebugMon_Handler)
+HOST_WEAK_HANDLER(PendSV_Handler)
+HOST_WEAK_HANDLER(SysTick_Handler)
+HOST_WEAK_HANDLER(WWDG_IRQHandler)
+HOST_WEAK_HANDLER(PVD_IRQHandler)
+HOST_WEAK_HANDLER(TAMP_STAMP_IRQHandler)
+HOST_WEAK_HANDLER(RTC_WKUP_IRQHandler)
+HOST_WEAK_HANDLER(FLASH_IRQHandler)
+HOST_WEAK_HANDLER(RCC_IRQHandler)
+HOST_WEAK_HANDLER(EXTI0_IRQHandler)
+HOST_WEAK_HANDLER(EXTI1_IRQHandler)
+HOST_WEAK_HANDLER(EXTI2_IRQHandler)
+HOST_WEAK_HANDLER(EXTI3_IRQHandler)
+HOST_WEAK_HANDLER(EXTI4_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream0_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream1_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream2_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream3_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream4_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream5_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream6_IRQHandler)
+HOST_WEAK_HANDLER(ADC_IRQHandler)
+HOST_WEAK_HANDLER(CAN1_TX_IRQHandler)
+HOST_WEAK_HANDLER(CAN1_RX0_IRQHandler)
+HOST_WEAK_HANDLER(CAN1_RX1_IRQHandler)
+HOST_WEAK_HANDLER(CAN1_SCE_IRQHandler)
+HOST_WEAK_HANDLER(EXTI9_5_IRQHandler)
+HOST_WEAK_HANDLER(TIM1_BRK_TIM9_IRQHandler)
+HOST_WEAK_HANDLER(TIM1_UP_TIM10_IRQHandler)
+HOST_WEAK_HANDLER(TIM1_TRG_COM_TIM11_IRQHandler)
+HOST_WEAK_HANDLER(TIM1_CC_IRQHandler)
+HOST_WEAK_HANDLER(TIM2_IRQHandler)
+HOST_WEAK_HANDLER(TIM3_IRQHandler)
+HOST_WEAK_HANDLER(TIM4_IRQHandler)
+HOST_WEAK_HANDLER(I2C1_EV_IRQHandler)
+HOST_WEAK_HANDLER(I2C1_ER_IRQHandler)
+HOST_WEAK_HANDLER(I2C2_EV_IRQHandler)
+HOST_WEAK_HANDLER(I2C2_ER_IRQHandler)
+HOST_WEAK_HANDLER(SPI1_IRQHandler)
+HOST_WEAK_HANDLER(SPI2_IRQHandler)
+HOST_WEAK_HANDLER(USART1_IRQHandler)
+HOST_WEAK_HANDLER(USART2_IRQHandler)
+HOST_WEAK_HANDLER(USART3_IRQHandler)
+HOST_WEAK_HANDLER(EXTI15_10_IRQHandler)
+HOST_WEAK_HANDLER(RTC_Alarm_IRQHandler)
+HOST_WEAK_HANDLER(OTG_FS_WKUP_IRQHandler)
+HOST_WEAK_HANDLER(TIM8_BRK_TIM12_IRQHandler)
+HOST_WEAK_HANDLER(TIM8_UP_TIM13_IRQHandler)
+HOST_WEAK_HANDLER(TIM8_TRG_COM_TIM14_IRQHandler)
+HOST_WEAK_HANDLER(TIM8_CC_IRQHandler)
+HOST_WEAK_HANDLER(DMA1_Stream7_IRQHandler)
+HOST_WEAK_HANDLER(FMC_IRQHandler)
+HOST_WEAK_HANDLER(SDIO_IRQHandler)
+HOST_WEAK_HANDLER(TIM5_IRQHandler)
+HOST_WEAK_HANDLER(SPI3_IRQHandler)
+HOST_WEAK_HANDLER(UART4_IRQHandler)
+HOST_WEAK_HANDLER(UART5_IRQHandler)
+HOST_WEAK_HANDLER(TIM6_DAC_IRQHandler)
+HOST_WEAK_HANDLER(TIM7_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream0_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream1_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream2_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream3_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream4_IRQHandler)
+HOST_WEAK_HANDLER(CAN2_TX_IRQHandler)
+HOST_WEAK_HANDLER(CAN2_RX0_IRQHandler)
+HOST_WEAK_HANDLER(CAN2_RX1_IRQHandler)
+HOST_WEAK_HANDLER(CAN2_SCE_IRQHandler)
+HOST_WEAK_HANDLER(OTG_FS_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream5_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream6_IRQHandler)
+HOST_WEAK_HANDLER(DMA2_Stream7_IRQHandler)
+HOST_WEAK_HANDLER(USART6_IRQHandler)
+HOST_WEAK_HANDLER(I2C3_EV_IRQHandler)
+HOST_WEAK_HANDLER(I2C3_ER_IRQHandler)
+HOST_WEAK_HANDLER(OTG_HS_EP1_OUT_IRQHandler)
+HOST_WEAK_HANDLER(OTG_HS_EP1_IN_IRQHandler)
+HOST_WEAK_HANDLER(OTG_HS_WKUP_IRQHandler)
+HOST_WEAK_HANDLER(OTG_HS_IRQHandler)
+HOST_WEAK_HANDLER(DCMI_IRQHandler)
+HOST_WEAK_HANDLER(FPU_IRQHandler)
+HOST_WEAK_HANDLER(SPI4_IRQHandler)
+HOST_WEAK_HANDLER(SAI1_IRQHandler)
+HOST_WEAK_HANDLER(SAI2_IRQHandler)
+HOST_WEAK_HANDLER(QUADSPI_IRQHandler)
+HOST_WEAK_HANDLER(CEC_IRQHandler)
+HOST_WEAK_HANDLER(SPDIF_RX_IRQHandler)
+HOST_WEAK_HANDLER(FMPI2C1_EV_IRQHandler)
+HOST_WEAK_HANDLER(FMPI2C1_ER_IRQHandler)
+
+void (* const HOST_Vectors[])(void) = {
+  0,
+  0,                    /* Reset_Handler: host_reset() constructor */
+  NMI_Handler,
+  HardFault_Handler,
+  MemManage_Handler,
+  BusFault_Handler,
+  UsageFault_Handler,
+  0,
+  0,
+  0,
+  0,
+  SVC_Handler,
+  DebugMon_Handler,
+  0,
+  PendSV_Handler,
+  SysTick_Handler,
+
+  /* External Interrupts */
+  WWDG_IRQHandler,
+  PVD_IRQHandler,
+  TAMP_STAMP_IRQHandler,
+  RTC_WKUP_IRQHandler,
+  FLASH_IRQHandler,
+  RCC_IRQHandler,
+  EXTI0_IRQHandler,
+  EXTI1_IRQHandler,
+  EXTI2_IRQHandler,
+  EXTI3_IRQHandler,
+  EXTI4_IRQHandler,
+  DMA1_Stream0_IRQHandler,
+  DMA1_Stream1_IRQHandler,
+  DMA1_Stream2_IRQHandler,
+  DMA1_Stream3_IRQHandler,
+  DMA1_Stream4_IRQHandler,
+  DMA1_Stream5_IRQHandler,
+  DMA1_Stream6_IRQHandler,
+  ADC_IRQHandler,
+  CAN1_TX_IRQHandler,
+  CAN1_RX0_IRQHandler,
+  CAN1_RX1_IRQHandler,
+  CAN1_SCE_IRQHandler,
+  EXTI9_5_IRQHandler,
+  TIM1_BRK_TIM9_IRQHandler,
+  TIM1_UP_TIM10_IRQHandler,
+  TIM1_TRG_COM_TIM11_IRQHandler,
+  TIM1_CC_IRQHandler,
+  TIM2_IRQHandler,
+  TIM3_IRQHandler,
+  TIM4_IRQHandler,
+  I2C1_EV_IRQHandler,
+  I2C1_ER_IRQHandler,
+  I2C2_EV_IRQHandler,
+  I2C2_ER_IRQHandler,
+  SPI1_IRQHandler,
+  SPI2_IRQHandler,
+  USART1_IRQHandler,
+  USART2_IRQHandler,
+  USART3_IRQHandler,
+  EXTI15_10_IRQHandler,
+  RTC_Alarm_IRQHandler,
+  OTG_FS_WKUP_IRQHandler,
+  TIM8_BRK_TIM12_IRQHandler,
+  TIM8_UP_TIM13_IRQHandler,
+  TIM8_TRG_COM_TIM14_IRQHandler,
+  TIM8_CC_IRQHandler,
+  DMA1_Stream7_IRQHandler,
+  FMC_IRQHandler,
+  SDIO_IRQHandler,
+  TIM5_IRQHandler,
+  SPI3_IRQHandler,
+  UART4_IRQHandler,
+  UART5_IRQHandler,
+  TIM6_DAC_IRQHandler,
+  TIM7_IRQHandler,
+  DMA2_Stream0_IRQHandler,
+  DMA2_Stream1_IRQHandler,
+  DMA2_Stream2_IRQHandler,
+  DMA2_Stream3_IRQHandler,
+  DMA2_Stream4_IRQHandler,
+  0,
+  0,
+  CAN2_TX_IRQHandler,
+  CAN2_RX0_IRQHandler,
+  CAN2_RX1_IRQHandler,
+  CAN2_SCE_IRQHandler,
+  OTG_FS_IRQHandler,
+  DMA2_Stream5_IRQHandler,
+  DMA2_Stream6_IRQHandler,
+  DMA2_Stream7_IRQHandler,
+  USART6_IRQHandler,
+  I2C3_EV_IRQHandler,
+  I2C3_ER_IRQHandler,
+  OTG_HS_EP1_OUT_IRQHandler,
+  OTG_HS_EP1_IN_IRQHandler,
+  OTG_HS_WKUP_IRQHandler,
+  OTG_HS_IRQHandler,
+  DCMI_IRQHandler,
+  0,
+  0,
+  FPU_IRQHandler,
+  0,
+  0,
+  SPI4_IRQHandler,
+  0,
+  0,
+  SAI1_IRQHandler,
+  0,
+  0,
+  0,
+  SAI2_IRQHandler,
+  QUADSPI_IRQHandler,
+  CEC_IRQHandler,
+  SPDIF_RX_IRQHandler,
+  FMPI2C1_EV_IRQHandler,
+  FMPI2C1_ER_IRQHandler,
+};
+
+const uint32_t HOST_VectorCount = sizeof(HOST_Vectors) / sizeof(HOST_Vectors[0]);
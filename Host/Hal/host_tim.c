@@ -0,0 +1,91 @@
+/**
+ * @file    host_tim.c
+ * @brief   Behavioural basic timer (TIM6 / TIM7) model.
+ *
+ * The firmware programs the basic timers at register level; their
+ * registers live in the mapped APB1 window (host_startup.c). On every HAL
+ * tick each enabled timer (CR1.CEN) advances its counter by one
+ * millisecond of prescaled timer clock (PSC, with the APB1 x2 rule) and
+ * wraps at ARR. A wrap sets SR.UIF and, with DIER.UIE, pends the timer's
+ * interrupt. EGR.UG resets the counter and prescaler as on target.
+ *
+ * What is not modelled: one-pulse mode, URS, UDIS, the master mode output
+ * and DMA requests. Update periods shorter than the HAL tick still set UIF,
+ * but at most once per tick.
+ */
+
+#include "main.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+typedef struct
+{
+    TIM_TypeDef *tim;
+    int32_t      irqn;
+    uint64_t     acc;        /* timer clock cycles not yet counted */
+} HostTim_t;
+
+static HostTim_t s_tim[] = {
+    { TIM6, (int32_t)TIM6_DAC_IRQn, 0U },
+    { TIM7, (int32_t)TIM7_IRQn,     0U },
+};
+
+/* --------------------------------------------------------------------------
+ * Local helpers
+ * -------------------------------------------------------------------------- */
+
+static uint32_t tim_clock(void)
+{
+    const uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    return ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) ? 2U * pclk1 : pclk1;
+}
+
+static void tim_step(HostTim_t *t, uint32_t clk_per_ms)
+{
+    TIM_TypeDef *tim = t->tim;
+
+    if ((tim->EGR & TIM_EGR_UG) != 0U)
+    {
+        tim->EGR &= ~TIM_EGR_UG;
+        tim->CNT  = 0U;
+        tim->SR  |= TIM_SR_UIF;
+        t->acc    = 0U;
+    }
+    if ((tim->CR1 & TIM_CR1_CEN) == 0U)
+    {
+        return;
+    }
+
+    const uint64_t div    = (uint64_t)(tim->PSC & 0xFFFFU) + 1U;
+    const uint64_t period = (uint64_t)(tim->ARR & 0xFFFFU) + 1U;
+
+    t->acc += clk_per_ms;
+    const uint64_t counts = t->acc / div;
+    t->acc %= div;
+
+    const uint64_t cnt = (uint64_t)(tim->CNT & 0xFFFFU) + counts;
+    tim->CNT = (uint32_t)(cnt % period);
+    if (cnt >= period)
+    {
+        tim->SR |= TIM_SR_UIF;
+        if ((tim->DIER & TIM_DIER_UIE) != 0U)
+        {
+            HOST_PORT_PendIRQ(t->irqn);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * HAL tick hook
+ * -------------------------------------------------------------------------- */
+
+void HOST_TIM_Tick(void)
+{
+    const uint32_t clk_per_ms = tim_clock() / 1000U;
+
+    for (size_t i = 0; i < sizeof(s_tim) / sizeof(s_tim[0]); i++)
+    {
+        tim_step(&s_tim[i], clk_per_ms);
+    }
+}
@@ -0,0 +1,950 @@
+/**
+ * @file    host_uart.c
+ * @brief   Behavioural USART model behind the HAL UART API.
+ *
+ * TX: HAL_UART_Transmit() hands the bytes straight to the instance's sink
+ *     (stdout by default); the host does not charge wire time to a blocking
+ *     transmitter. HAL_UART_Transmit_DMA() is paced like the wire: each HAL
+ *     tick moves up to baud/10 bytes per millisecond to the sink and counts
+ *     the stream's NDTR down. At zero the DMA stream interrupt fires, then
+ *     the USART (TC) interrupt calls HAL_UART_TxCpltCallback(), as on target.
+ * RX: a reader thread moves bytes from a file descriptor (stdin by default)
+ *     into a host-side line buffer. On every HAL tick up to baud/10 bytes per
+ *     millisecond are shifted into DR (RXNE); HAL_UART_Receive_IT() consumes
+ *     them from USARTx_IRQn one byte per interrupt, as on target. A byte is
+ *     only shifted in once DR has been read, so the interrupt path never
+ *     overruns; the line buffer applies backpressure to the reader instead.
+ *     HAL_UARTEx_ReceiveToIdle_DMA() instead lets the tick write the bytes
+ *     straight into the buffer, counting NDTR down (and reloading it in
+ *     circular mode) with half/complete flags on the DMA stream. The line
+ *     falling silent after a burst raises IDLE, reported by the USART
+ *     interrupt through HAL_UARTEx_RxEventCallback() as on target.
+ *     HOST_UART_InjectError() corrupts the next byte to exercise the error
+ *     path.
+ * TX DMA errors: HOST_UART_InjectTxError() stops the next DMA transfer
+ *     part way with a transfer error; the HAL ends the transmission (and a
+ *     DMA reception) and calls HAL_UART_ErrorCallback(), as on target.
+ */
+
+#include "main.h"
+#include "host_hal.h"
+#include "host_port.h"
+
+/* After the device header: <termios.h> defines CR1..CR3 as macros, which
+   would clobber the USART/CAN register struct members. */
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define HOST_UART_RXBUF_SIZE   4096U
+
+typedef struct
+{
+    USART_TypeDef      *instance;
+    IRQn_Type           irqn;
+    UART_HandleTypeDef *huart;
+    HOST_UART_TxSink_t  sink;
+    void               *sink_ctx;
+    int                 rx_fd;
+    int                 reader_started;
+    pthread_t           reader;
+    uint8_t             line[HOST_UART_RXBUF_SIZE];
+    uint32_t            line_head;
+    uint32_t            line_count;
+    uint32_t            baud_acc;            /* bit-time accumulator     */
+    uint32_t            budget;              /* bytes allowed this tick  */
+    uint8_t             dr;
+    uint8_t             rxne;
+    const uint8_t      *tx_dma;              /* next byte of a DMA transfer */
+    uint32_t            tx_left;             /* bytes the DMA still owes   */
+    uint8_t             tc;                  /* transmission complete      */
+    uint8_t             tx_err_next;         /* fail the next DMA transfer */
+    uint8_t            *rx_dma;              /* DMA reception buffer       */
+    uint8_t             rx_seen;             /* bytes since the last IDLE  */
+    uint8_t             idle;                /* IDLE line detected         */
+    uint32_t            err_next;            /* error for the next byte    */
+    uint32_t            err;                 /* error awaiting the IRQ     */
+} HostUart_t;
+
+/* host_hal.c */
+extern IRQn_Type HOST_DMA_StreamIrq(const DMA_Stream_TypeDef *stream);
+extern void      HOST_DMA_RaiseFlags(DMA_Stream_TypeDef *stream, uint32_t flags);
+
+static pthread_mutex_t s_lock  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_space = PTHREAD_COND_INITIALIZER;
+
+static HostUart_t s_uart[] = {
+    { .instance = USART1, .irqn = USART1_IRQn, .rx_fd = -1 },
+    { .instance = USART2, .irqn = USART2_IRQn, .rx_fd = STDIN_FILENO },
+    { .instance = USART3, .irqn = USART3_IRQn, .rx_fd = -1 },
+    { .instance = USART6, .irqn = USART6_IRQn, .rx_fd = -1 },
+};
+
+static struct termios s_savedTermios;
+static int            s_termiosSaved;
+
+/* --------------------------------------------------------------------------
+ * Weak HAL callbacks (same defaults as stm32f4xx_hal_uart.c)
+ * -------------------------------------------------------------------------- */
+
+__weak void HAL_UART_MspInit(UART_HandleTypeDef *huart)             { (void)huart; }
+__weak void HAL_UART_MspDeInit(UART_HandleTypeDef *huart)           { (void)huart; }
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)      { (void)huart; }
+__weak void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart)  { (void)huart; }
+__weak void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)      { (void)huart; }
+__weak void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)  { (void)huart; }
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)       { (void)huart; }
+__weak void HAL_UART_AbortReceiveCpltCallback(UART_HandleTypeDef *huart) { (void)huart; }
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    (void)huart;
+    (void)Size;
+}
+
+/* --------------------------------------------------------------------------
+ * Internals
+ * -------------------------------------------------------------------------- */
+
+static HostUart_t *uart_find(const USART_TypeDef *instance)
+{
+    for (size_t i = 0; i < sizeof(s_uart) / sizeof(s_uart[0]); i++)
+    {
+        if (s_uart[i].instance == instance)
+        {
+            return &s_uart[i];
+        }
+    }
+    return NULL;
+}
+
+static void uart_default_sink(const uint8_t *data, uint16_t len, void *ctx)
+{
+    (void)ctx;
+    while (len > 0U)
+    {
+        ssize_t n = write(STDOUT_FILENO, data, len);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        len = (uint16_t)(len - (uint16_t)n);
+    }
+}
+
+static void uart_restore_tty(void)
+{
+    if (s_termiosSaved)
+    {
+        (void)tcsetattr(STDIN_FILENO, TCSANOW, &s_savedTermios);
+    }
+}
+
+static void uart_sigint(int sig)
+{
+    uart_restore_tty();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/* Enter delivers '\r' like a serial terminal; Ctrl-C still works. */
+static void uart_raw_tty(int fd)
+{
+    struct termios t;
+
+    if (fd != STDIN_FILENO || !isatty(fd) || tcgetattr(fd, &s_savedTermios) != 0)
+    {
+        return;
+    }
+    s_termiosSaved = 1;
+    atexit(uart_restore_tty);
+    signal(SIGINT, uart_sigint);
+    signal(SIGTERM, uart_sigint);
+
+    t = s_savedTermios;
+    t.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+    t.c_iflag &= ~(tcflag_t)(ICRNL | INLCR);
+    t.c_cc[VMIN] = 1;
+    t.c_cc[VTIME] = 0;
+    (void)tcsetattr(fd, TCSANOW, &t);
+}
+
+static size_t uart_line_put(HostUart_t *u, const uint8_t *data, size_t len, int block)
+{
+    size_t done = 0;
+
+    while (done < len)
+    {
+        if (u->line_count == HOST_UART_RXBUF_SIZE)
+        {
+            if (!block) break;
+            pthread_cond_wait(&s_space, &s_lock);
+            continue;
+        }
+        u->line[(u->line_head + u->line_count) % HOST_UART_RXBUF_SIZE] = data[done++];
+        u->line_count++;
+    }
+    return done;
+}
+
+static void *uart_reader(void *arg)
+{
+    HostUart_t *u = arg;
+    uint8_t buf[256];
+
+    for (;;)
+    {
+        ssize_t n = read(u->rx_fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        pthread_mutex_lock(&s_lock);
+        (void)uart_line_put(u, buf, (size_t)n, 1);
+        pthread_mutex_unlock(&s_lock);
+    }
+    return NULL;
+}
+
+/* Shift the next byte into DR if the receiver is free. Lock held. */
+static void uart_shift_in(HostUart_t *u)
+{
+    if (u->rxne || u->budget == 0U || u->line_count == 0U)
+    {
+        return;
+    }
+    u->dr = u->line[u->line_head];
+    u->line_head = (u->line_head + 1U) % HOST_UART_RXBUF_SIZE;
+    u->line_count--;
+    u->budget--;
+    u->rxne = 1U;
+    pthread_cond_broadcast(&s_space);
+}
+
+/* A ReceiveToIdle DMA reception is running */
+static int uart_dma_rx_active(const HostUart_t *u)
+{
+    const UART_HandleTypeDef *huart = u->huart;
+
+    return huart != NULL && huart->RxState == HAL_UART_STATE_BUSY_RX &&
+           huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE && huart->hdmarx != NULL &&
+           (huart->hdmarx->Instance->CR & DMA_SxCR_EN) != 0U;
+}
+
+/* The next byte on the line carries an injected error: it is lost and the
+   error waits for the USART interrupt. Lock held; returns 1 if it fired. */
+static int uart_take_error(HostUart_t *u)
+{
+    if (u->err_next == 0U || u->budget == 0U || u->line_count == 0U)
+    {
+        return 0;
+    }
+    u->line_head = (u->line_head + 1U) % HOST_UART_RXBUF_SIZE;
+    u->line_count--;
+    u->budget--;
+    u->err = u->err_next;
+    u->err_next = 0U;
+    pthread_cond_broadcast(&s_space);
+    return 1;
+}
+
+/* Write up to budget bytes through the RX DMA stream. Lock held. */
+static void uart_dma_rx_step(HostUart_t *u)
+{
+    UART_HandleTypeDef *huart = u->huart;
+    DMA_Stream_TypeDef *stream = huart->hdmarx->Instance;
+    const uint32_t size = huart->RxXferSize;
+
+    while (u->budget > 0U && (u->rxne || u->line_count > 0U) && u->err == 0U)
+    {
+        uint32_t ndtr = stream->NDTR;
+        uint32_t flags = 0U;
+
+        if (uart_take_error(u))
+        {
+            break;
+        }
+        if (u->rxne)
+        {
+            u->rx_dma[size - ndtr] = u->dr;   /* DR filled before DMA was armed */
+            u->rxne = 0U;
+        }
+        else
+        {
+            u->rx_dma[size - ndtr] = u->line[u->line_head];
+            u->line_head = (u->line_head + 1U) % HOST_UART_RXBUF_SIZE;
+            u->line_count--;
+            u->budget--;
+            pthread_cond_broadcast(&s_space);
+        }
+        u->rx_seen = 1U;
+
+        if (--ndtr == size / 2U)
+        {
+            flags |= DMA_FLAG_HTIF0_4;
+        }
+        if (ndtr == 0U)
+        {
+            flags |= DMA_FLAG_TCIF0_4;
+            if ((stream->CR & DMA_SxCR_CIRC) != 0U)
+            {
+                ndtr = size;
+            }
+            else
+            {
+                stream->CR &= ~DMA_SxCR_EN;
+            }
+        }
+        stream->NDTR = ndtr;
+        if (flags != 0U)
+        {
+            HOST_DMA_RaiseFlags(stream, flags);
+        }
+        if ((stream->CR & DMA_SxCR_EN) == 0U)
+        {
+            break;
+        }
+    }
+}
+
+static void uart_update_irq(HostUart_t *u)
+{
+    const int rx_it = u->huart != NULL && u->huart->RxState == HAL_UART_STATE_BUSY_RX &&
+                      u->huart->ReceptionType != HAL_UART_RECEPTION_TOIDLE;
+
+    if ((u->rxne && rx_it) || u->tc || u->idle || u->err)
+    {
+        HOST_PORT_PendIRQ(u->irqn);
+    }
+}
+
+/* Move up to budget bytes of the running DMA transfer out. Lock held;
+   returns the chunk for the sink, which is called after unlocking. */
+static uint32_t uart_dma_tx_step(HostUart_t *u, uint32_t budget, const uint8_t **chunk)
+{
+    DMA_HandleTypeDef *hdma = u->huart->hdmatx;
+    uint32_t n;
+
+    if (u->tx_left == 0U || hdma == NULL || (hdma->Instance->CR & DMA_SxCR_EN) == 0U)
+    {
+        return 0U;
+    }
+
+    n = (u->tx_left < budget) ? u->tx_left : budget;
+    if (u->tx_err_next)
+    {
+        n = (u->tx_left / 2U < n) ? u->tx_left / 2U : n;   /* fail part way */
+    }
+    *chunk = u->tx_dma;
+    u->tx_dma  += n;
+    u->tx_left -= n;
+    hdma->Instance->NDTR = u->tx_left;
+
+    if (u->tx_err_next)
+    {
+        /* Transfer error: the stream stops, NDTR keeps what was not sent */
+        u->tx_err_next = 0U;
+        hdma->Instance->CR &= ~DMA_SxCR_EN;
+        HOST_DMA_RaiseFlags(hdma->Instance, DMA_FLAG_TEIF0_4);
+    }
+    else if (u->tx_left == 0U)
+    {
+        hdma->Instance->CR &= ~DMA_SxCR_EN;
+        HOST_DMA_RaiseFlags(hdma->Instance, DMA_FLAG_TCIF0_4);
+    }
+    return n;
+}
+
+/* DMA transfer complete: the real HAL enables TCIE here and finishes in
+   the USART interrupt once the last byte has left the shift register. */
+static void uart_dma_tx_cplt(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+    HostUart_t *u = uart_find(huart->Instance);
+
+    pthread_mutex_lock(&s_lock);
+    u->tc = 1U;
+    uart_update_irq(u);
+    pthread_mutex_unlock(&s_lock);
+}
+
+/* DMA transfer error (UART_DMAError() in the HAL): end the transmission
+   and a DMA reception, then report HAL_UART_ERROR_DMA */
+static void uart_dma_error(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+    HostUart_t *u = uart_find(huart->Instance);
+
+    pthread_mutex_lock(&s_lock);
+    if (huart->gState == HAL_UART_STATE_BUSY_TX)
+    {
+        huart->TxXferCount = 0U;
+        huart->gState = HAL_UART_STATE_READY;
+        u->tx_left = 0U;
+        u->tc = 0U;
+    }
+    if (huart->RxState == HAL_UART_STATE_BUSY_RX &&
+        huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE && huart->hdmarx != NULL)
+    {
+        if (huart->hdmarx->State == HAL_DMA_STATE_BUSY)
+        {
+            (void)HAL_DMA_Abort(huart->hdmarx);
+        }
+        huart->RxXferCount = 0U;
+        huart->RxState = HAL_UART_STATE_READY;
+        huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+        u->idle = 0U;
+        u->rx_seen = 0U;
+    }
+    huart->ErrorCode |= HAL_UART_ERROR_DMA;
+    pthread_mutex_unlock(&s_lock);
+
+    HAL_UART_ErrorCallback(huart);
+}
+
+/* Circular reception: the HAL reports both halves as reception events */
+static void uart_dma_rx_half(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    huart->RxEventType = HAL_UART_RXEVENT_HT;
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE)
+    {
+        HAL_UARTEx_RxEventCallback(huart, (uint16_t)(huart->RxXferSize / 2U));
+    }
+    else
+    {
+        HAL_UART_RxHalfCpltCallback(huart);
+    }
+}
+
+static void uart_dma_rx_cplt(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    if ((hdma->Instance->CR & DMA_SxCR_CIRC) == 0U)
+    {
+        huart->RxXferCount = 0U;
+        huart->RxState = HAL_UART_STATE_READY;
+        if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE)
+        {
+            huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+            huart->RxEventType = HAL_UART_RXEVENT_TC;
+            HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize);
+            return;
+        }
+    }
+    huart->RxEventType = HAL_UART_RXEVENT_TC;
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE)
+    {
+        HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize);
+    }
+    else
+    {
+        HAL_UART_RxCpltCallback(huart);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Line clock: called from HAL_IncTick() (SysTick context)
+ * -------------------------------------------------------------------------- */
+
+void HOST_UART_Tick(void)
+{
+    enum { N = sizeof(s_uart) / sizeof(s_uart[0]) };
+    const uint8_t *chunk[N];
+    uint32_t len[N] = { 0U };
+
+    pthread_mutex_lock(&s_lock);
+    for (size_t i = 0; i < N; i++)
+    {
+        HostUart_t *u = &s_uart[i];
+        if (u->huart == NULL)
+        {
+            continue;
+        }
+
+        /* 10 bit times per byte (8N1); budget does not bank while idle.
+           Full duplex: the same number of bytes may go out by DMA. */
+        u->baud_acc += u->huart->Init.BaudRate;
+        u->budget = u->baud_acc / 10000U;
+        u->baud_acc %= 10000U;
+
+        len[i] = uart_dma_tx_step(u, u->budget, &chunk[i]);
+        if (uart_dma_rx_active(u))
+        {
+            uart_dma_rx_step(u);
+        }
+        else if (!uart_take_error(u))
+        {
+            uart_shift_in(u);
+        }
+
+        /* Approximation: IDLE once the line buffer has run dry after a
+           burst, rather than one character time later */
+        if (u->rx_seen && u->line_count == 0U)
+        {
+            u->rx_seen = 0U;
+            u->idle = (u->huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE) ? 1U : 0U;
+        }
+        uart_update_irq(u);
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    /* One DMA transfer per USART at a time, so the sink sees bytes in order */
+    for (size_t i = 0; i < N; i++)
+    {
+        if (len[i] != 0U)
+        {
+            s_uart[i].sink(chunk[i], (uint16_t)len[i], s_uart[i].sink_ctx);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * HAL UART API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    HostUart_t *u;
+
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    if (huart->gState == HAL_UART_STATE_RESET)
+    {
+        huart->Lock = HAL_UNLOCKED;
+        HAL_UART_MspInit(huart);
+    }
+
+    pthread_mutex_lock(&s_lock);
+    u->huart = huart;
+    if (u->sink == NULL)
+    {
+        u->sink = uart_default_sink;
+    }
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+
+    if (u->rx_fd >= 0 && !u->reader_started)
+    {
+        uart_raw_tty(u->rx_fd);
+        if (pthread_create(&u->reader, NULL, uart_reader, u) == 0)
+        {
+            pthread_detach(u->reader);
+            u->reader_started = 1;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart)
+{
+    HostUart_t *u;
+
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return HAL_ERROR;
+    }
+    HAL_UART_MspDeInit(huart);
+
+    pthread_mutex_lock(&s_lock);
+    u->huart = NULL;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_RESET;
+    huart->RxState = HAL_UART_STATE_RESET;
+    pthread_mutex_unlock(&s_lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                    uint16_t Size, uint32_t Timeout)
+{
+    HostUart_t *u;
+    HOST_UART_TxSink_t sink;
+    void *ctx;
+
+    (void)Timeout;
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if (pData == NULL || Size == 0U)
+    {
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    sink = u->sink;
+    ctx = u->sink_ctx;
+    pthread_mutex_unlock(&s_lock);
+
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    huart->TxXferSize = Size;
+    huart->TxXferCount = 0U;
+    sink(pData, Size, ctx);
+    huart->gState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                        uint16_t Size)
+{
+    HostUart_t *u;
+    DMA_HandleTypeDef *hdma;
+
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if (pData == NULL || Size == 0U || (hdma = huart->hdmatx) == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    huart->TxXferSize  = Size;
+    huart->TxXferCount = Size;
+    huart->ErrorCode   = HAL_UART_ERROR_NONE;
+    huart->gState      = HAL_UART_STATE_BUSY_TX;
+
+    hdma->XferCpltCallback  = uart_dma_tx_cplt;
+    hdma->XferErrorCallback = uart_dma_error;
+    hdma->State             = HAL_DMA_STATE_BUSY;
+    hdma->Instance->NDTR   = Size;
+    hdma->Instance->CR    |= DMA_SxCR_EN;
+
+    u->tx_dma  = pData;
+    u->tx_left = Size;
+    u->tc      = 0U;
+    pthread_mutex_unlock(&s_lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart)
+{
+    HostUart_t *u;
+
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if (huart->hdmatx != NULL && huart->hdmatx->State == HAL_DMA_STATE_BUSY)
+    {
+        (void)HAL_DMA_Abort(huart->hdmatx);
+    }
+    u->tx_left = 0U;
+    u->tc      = 0U;
+    huart->TxXferCount = 0U;
+    huart->gState = HAL_UART_STATE_READY;
+    pthread_mutex_unlock(&s_lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    HostUart_t *u;
+
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return HAL_ERROR;
+    }
+    if (huart->RxState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if (pData == NULL || Size == 0U)
+    {
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    uart_update_irq(u);
+    pthread_mutex_unlock(&s_lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData,
+                                               uint16_t Size)
+{
+    HostUart_t *u;
+    DMA_HandleTypeDef *hdma;
+
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return HAL_ERROR;
+    }
+    if (huart->RxState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if (pData == NULL || Size == 0U || (hdma = huart->hdmarx) == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    huart->ReceptionType = HAL_UART_RECEPTION_TOIDLE;
+    huart->RxEventType   = HAL_UART_RXEVENT_TC;
+    huart->pRxBuffPtr    = pData;
+    huart->RxXferSize    = Size;
+    huart->RxXferCount   = Size;
+    huart->ErrorCode     = HAL_UART_ERROR_NONE;
+    huart->RxState       = HAL_UART_STATE_BUSY_RX;
+
+    hdma->XferCpltCallback     = uart_dma_rx_cplt;
+    hdma->XferHalfCpltCallback = uart_dma_rx_half;
+    hdma->State                = HAL_DMA_STATE_BUSY;
+    hdma->Instance->NDTR       = Size;
+    hdma->Instance->CR        |= DMA_SxCR_EN;
+
+    u->rx_dma  = pData;
+    u->rx_seen = 0U;
+    u->idle    = 0U;
+    pthread_mutex_unlock(&s_lock);
+    return HAL_OK;
+}
+
+HAL_UART_RxEventTypeTypeDef HAL_UARTEx_GetRxEventType(UART_HandleTypeDef *huart)
+{
+    return huart->RxEventType;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+    if (huart == NULL || uart_find(huart->Instance) == NULL)
+    {
+        return HAL_ERROR;
+    }
+    pthread_mutex_lock(&s_lock);
+    if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE && huart->hdmarx != NULL &&
+        huart->hdmarx->State == HAL_DMA_STATE_BUSY)
+    {
+        (void)HAL_DMA_Abort(huart->hdmarx);
+    }
+    huart->RxXferCount = 0U;
+    huart->RxState = HAL_UART_STATE_READY;
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    pthread_mutex_unlock(&s_lock);
+    return HAL_OK;
+}
+
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    HostUart_t *u;
+    int complete = 0;
+    int tx_complete = 0;
+    int error = 0;
+    int idle = 0;
+    uint16_t idle_size = 0U;
+
+    if (huart == NULL || (u = uart_find(huart->Instance)) == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if (u->err)
+    {
+        /* Like the HAL: ORE, or any error under DMA reception, ends the
+           reception; the application restarts it from the callback */
+        huart->ErrorCode |= u->err;
+        if ((u->err & HAL_UART_ERROR_ORE) != 0U ||
+            huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE)
+        {
+            if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE && huart->hdmarx != NULL &&
+                huart->hdmarx->State == HAL_DMA_STATE_BUSY)
+            {
+                (void)HAL_DMA_Abort(huart->hdmarx);
+            }
+            huart->RxState = HAL_UART_STATE_READY;
+            huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+            u->idle = 0U;
+            u->rx_seen = 0U;
+        }
+        u->err = 0U;
+        error = 1;
+    }
+    if (u->idle)
+    {
+        u->idle = 0U;
+        if (huart->ReceptionType == HAL_UART_RECEPTION_TOIDLE &&
+            huart->RxState == HAL_UART_STATE_BUSY_RX && huart->hdmarx != NULL)
+        {
+            const uint16_t rem = (uint16_t)huart->hdmarx->Instance->NDTR;
+            const int circular = (huart->hdmarx->Instance->CR & DMA_SxCR_CIRC) != 0U;
+
+            if (rem > 0U && rem < huart->RxXferSize)
+            {
+                huart->RxXferCount = rem;
+                if (!circular)
+                {
+                    (void)HAL_DMA_Abort(huart->hdmarx);
+                    huart->RxState = HAL_UART_STATE_READY;
+                    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+                }
+                idle_size = (uint16_t)(huart->RxXferSize - rem);
+                idle = 1;
+            }
+            else if (rem == huart->RxXferSize && circular)
+            {
+                idle_size = huart->RxXferSize;
+                idle = 1;
+            }
+            if (idle)
+            {
+                huart->RxEventType = HAL_UART_RXEVENT_IDLE;
+            }
+        }
+    }
+    if (u->tc)
+    {
+        u->tc = 0U;
+        huart->TxXferCount = 0U;
+        huart->gState = HAL_UART_STATE_READY;
+        tx_complete = 1;
+    }
+    if (u->rxne && huart->RxState == HAL_UART_STATE_BUSY_RX)
+    {
+        *huart->pRxBuffPtr++ = u->dr;
+        u->rxne = 0U;
+        if (--huart->RxXferCount == 0U)
+        {
+            huart->RxState = HAL_UART_STATE_READY;
+            complete = 1;
+        }
+        uart_shift_in(u);
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    if (error)
+    {
+        HAL_UART_ErrorCallback(huart);
+        if (huart->RxState == HAL_UART_STATE_BUSY_RX &&
+            huart->ReceptionType == HAL_UART_RECEPTION_STANDARD)
+        {
+            huart->ErrorCode = HAL_UART_ERROR_NONE;   /* non-blocking error */
+        }
+    }
+    if (idle)
+    {
+        HAL_UARTEx_RxEventCallback(huart, idle_size);
+    }
+    if (tx_complete)
+    {
+        HAL_UART_TxCpltCallback(huart);
+    }
+    if (complete)
+    {
+        HAL_UART_RxCpltCallback(huart);
+    }
+
+    pthread_mutex_lock(&s_lock);
+    uart_update_irq(u);
+    pthread_mutex_unlock(&s_lock);
+}
+
+HAL_UART_StateTypeDef HAL_UART_GetState(const UART_HandleTypeDef *huart)
+{
+    return (HAL_UART_StateTypeDef)(huart->gState | huart->RxState);
+}
+
+uint32_t HAL_UART_GetError(const UART_HandleTypeDef *huart)
+{
+    return huart->ErrorCode;
+}
+
+/* --------------------------------------------------------------------------
+ * Host control API
+ * -------------------------------------------------------------------------- */
+
+void HOST_UART_SetTxSink(USART_TypeDef *instance, HOST_UART_TxSink_t sink, void *ctx)
+{
+    HostUart_t *u = uart_find(instance);
+
+    if (u == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&s_lock);
+    u->sink = (sink != NULL) ? sink : uart_default_sink;
+    u->sink_ctx = ctx;
+    pthread_mutex_unlock(&s_lock);
+}
+
+void HOST_UART_SetRxFd(USART_TypeDef *instance, int fd)
+{
+    HostUart_t *u = uart_find(instance);
+
+    if (u != NULL)
+    {
+        pthread_mutex_lock(&s_lock);
+        u->rx_fd = fd;
+        pthread_mutex_unlock(&s_lock);
+    }
+}
+
+size_t HOST_UART_InjectRx(USART_TypeDef *instance, const uint8_t *data, size_t len)
+{
+    HostUart_t *u = uart_find(instance);
+    size_t n;
+
+    if (u == NULL || data == NULL)
+    {
+        return 0U;
+    }
+    pthread_mutex_lock(&s_lock);
+    n = uart_line_put(u, data, len, 0);
+    pthread_mutex_unlock(&s_lock);
+    return n;
+}
+
+void HOST_UART_InjectError(USART_TypeDef *instance, uint32_t error)
+{
+    HostUart_t *u = uart_find(instance);
+
+    if (u != NULL)
+    {
+        pthread_mutex_lock(&s_lock);
+        u->err_next = error;
+        pthread_mutex_unlock(&s_lock);
+    }
+}
+
+void HOST_UART_InjectTxError(USART_TypeDef *instance)
+{
+    HostUart_t *u = uart_find(instance);
+
+    if (u != NULL)
+    {
+        pthread_mutex_lock(&s_lock);
+        u->tx_err_next = 1U;
+        pthread_mutex_unlock(&s_lock);
+    }
+}
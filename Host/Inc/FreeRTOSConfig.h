@@ -0,0 +1,34 @@
+/*
+ * Host build FreeRTOS configuration.
+ *
+ * The host build runs the same kernel configuration as the firmware: this
+ * file pulls in Core/Inc/FreeRTOSConfig.h and only overrides what the POSIX
+ * port needs. Keep it that way - any tuning belongs in the target file so
+ * both builds stay comparable.
+ */
+
+#ifndef HOST_FREERTOS_CONFIG_H
+#define HOST_FREERTOS_CONFIG_H
+
+#include "../../Core/Inc/FreeRTOSConfig.h"
+
+/* Simulated time advances in the idle task (Host/Port/port.c). */
+#undef  configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK                      1
+
+/* glibc is thread-safe on its own; there is no newlib reent struct. */
+#undef  configUSE_NEWLIB_REENTRANT
+#define configUSE_NEWLIB_REENTRANT               0
+
+/* No DWT: the run-time stats counter comes from the host's monotonic
+   clock, in the same units as Host/Inc/cyccnt.h. */
+#undef  portGET_RUN_TIME_COUNTER_VALUE
+uint32_t HOST_PORT_CycleCount(void);
+#define portGET_RUN_TIME_COUNTER_VALUE()         HOST_PORT_CycleCount()
+
+/* Fail loudly instead of spinning with interrupts disabled. */
+#undef  configASSERT
+void vHostAssertCalled(const char *file, int line);
+#define configASSERT( x ) if ((x) == 0) { vHostAssertCalled(__FILE__, __LINE__); }
+
+#endif /* HOST_FREERTOS_CONFIG_H */
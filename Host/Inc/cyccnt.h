@@ -0,0 +1,35 @@
+/*
+ * Host build cycle counter.
+ *
+ * Replaces Core/Inc/cyccnt.h (Host/Inc comes first on the include path).
+ * The host has no DWT, so the count is derived from CLOCK_MONOTONIC and
+ * scaled to SystemCoreClock: readings keep the target's units and 32-bit
+ * wrap, and latencies measured on the host are wall-clock latencies.
+ */
+
+#ifndef CYCCNT_H
+#define CYCCNT_H
+
+#include "main.h"
+#include <stdint.h>
+#include <time.h>
+
+static inline void CYCCNT_Init(void)
+{
+}
+
+static inline uint32_t CYCCNT_Read(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * SystemCoreClock +
+                      ((uint64_t)ts.tv_nsec * SystemCoreClock) / 1000000000ULL);
+}
+
+static inline uint32_t CYCCNT_ToUs(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000U) / SystemCoreClock);
+}
+
+#endif /* CYCCNT_H */
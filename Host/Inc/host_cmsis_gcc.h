@@ -0,0 +1,156 @@
+/**
+ * @file    host_cmsis_gcc.h
+ * @brief   Host replacement for CMSIS cmsis_gcc.h (force-included by the host build).
+ *
+ * The STM32 device and core headers pull in cmsis_gcc.h, which is full of
+ * Cortex-M inline assembly. The host build force-includes this file first and
+ * claims the __CMSIS_GCC_H include guard, so the real header is skipped and
+ * the intrinsics below are used instead.
+ *
+ * Core-register intrinsics (IPSR, PRIMASK, enable/disable IRQ) are routed to
+ * the host FreeRTOS port, which is the only place that knows whether the
+ * simulated CPU is currently "in an interrupt". Everything else is either a
+ * portable C equivalent or a compiler barrier.
+ */
+
+#ifndef HOST_CMSIS_GCC_H
+#define HOST_CMSIS_GCC_H
+
+#define __CMSIS_GCC_H   /* keep Drivers/CMSIS/Include/cmsis_gcc.h out */
+
+#include <stdint.h>
+
+/* --------------------------------------------------------------------------
+ * Compiler abstraction
+ * -------------------------------------------------------------------------- */
+
+#ifndef __has_builtin
+  #define __has_builtin(x) (0)
+#endif
+
+#define __ASM                                  __asm
+#define __INLINE                               inline
+#define __STATIC_INLINE                        static inline
+#define __STATIC_FORCEINLINE                   __attribute__((always_inline)) static inline
+#define __NO_RETURN                            __attribute__((__noreturn__))
+#define __USED                                 __attribute__((used))
+#define __WEAK                                 __attribute__((weak))
+#define __PACKED                               __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT                        struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION                         union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)                           __attribute__((aligned(x)))
+#define __RESTRICT                             __restrict
+#define __COMPILER_BARRIER()                   __asm volatile("" ::: "memory")
+
+#define __UNALIGNED_UINT32(x)                  (*(uint32_t *)(x))
+#define __UNALIGNED_UINT16_WRITE(addr, val)    (void)(*(uint16_t *)(void *)(addr) = (val))
+#define __UNALIGNED_UINT16_READ(addr)          (*(const uint16_t *)(const void *)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val)    (void)(*(uint32_t *)(void *)(addr) = (val))
+#define __UNALIGNED_UINT32_READ(addr)          (*(const uint32_t *)(const void *)(addr))
+
+/* --------------------------------------------------------------------------
+ * Core register access (backed by Host/Port/port.c)
+ * -------------------------------------------------------------------------- */
+
+uint32_t HOST_PORT_GetIPSR(void);
+uint32_t HOST_PORT_GetPRIMASK(void);
+void     HOST_PORT_SetPRIMASK(uint32_t primask);
+
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void)        { return HOST_PORT_GetIPSR(); }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)     { return HOST_PORT_GetPRIMASK(); }
+__STATIC_FORCEINLINE void     __set_PRIMASK(uint32_t m) { HOST_PORT_SetPRIMASK(m); }
+__STATIC_FORCEINLINE void     __disable_irq(void)     { HOST_PORT_SetPRIMASK(1U); }
+__STATIC_FORCEINLINE void     __enable_irq(void)      { HOST_PORT_SetPRIMASK(0U); }
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void)     { return 0U; }
+__STATIC_FORCEINLINE void     __set_BASEPRI(uint32_t v) { (void)v; }
+__STATIC_FORCEINLINE void     __set_BASEPRI_MAX(uint32_t v) { (void)v; }
+__STATIC_FORCEINLINE uint32_t __get_FAULTMASK(void)   { return 0U; }
+__STATIC_FORCEINLINE void     __set_FAULTMASK(uint32_t v) { (void)v; }
+__STATIC_FORCEINLINE void     __enable_fault_irq(void)  { }
+__STATIC_FORCEINLINE void     __disable_fault_irq(void) { }
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void)     { return 0U; }
+__STATIC_FORCEINLINE void     __set_CONTROL(uint32_t v) { (void)v; }
+__STATIC_FORCEINLINE uint32_t __get_APSR(void)        { return 0U; }
+__STATIC_FORCEINLINE uint32_t __get_xPSR(void)        { return __get_IPSR(); }
+__STATIC_FORCEINLINE uint32_t __get_PSP(void)         { return 0U; }
+__STATIC_FORCEINLINE void     __set_PSP(uint32_t v)   { (void)v; }
+__STATIC_FORCEINLINE uint32_t __get_MSP(void)         { return 0U; }
+__STATIC_FORCEINLINE void     __set_MSP(uint32_t v)   { (void)v; }
+__STATIC_FORCEINLINE uint32_t __get_FPSCR(void)       { return 0U; }
+__STATIC_FORCEINLINE void     __set_FPSCR(uint32_t v) { (void)v; }
+
+/* --------------------------------------------------------------------------
+ * Instruction intrinsics
+ * -------------------------------------------------------------------------- */
+
+#define __NOP()        __asm volatile("" ::: "memory")
+#define __WFI()        __asm volatile("" ::: "memory")
+#define __WFE()        __asm volatile("" ::: "memory")
+#define __SEV()        __asm volatile("" ::: "memory")
+#define __BKPT(value)  __builtin_trap()
+
+__STATIC_FORCEINLINE void __ISB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_FORCEINLINE void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+/* The firmware uses DMB only to publish (stores before an index or type)
+   and consume (index before the data): an acquire-release fence. On x86
+   that is a compiler barrier; a full fence would be an MFENCE, tens of
+   cycles where the Cortex-M4 spends one or two. */
+__STATIC_FORCEINLINE void __DMB(void) { __atomic_thread_fence(__ATOMIC_ACQ_REL); }
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t v)   { return __builtin_bswap32(v); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t v)
+{
+    return ((v & 0xFF00FF00UL) >> 8) | ((v & 0x00FF00FFUL) << 8);
+}
+__STATIC_FORCEINLINE int16_t  __REVSH(int16_t v)  { return (int16_t)__builtin_bswap16((uint16_t)v); }
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+    op2 %= 32U;
+    return (op2 == 0U) ? op1 : ((op1 >> op2) | (op1 << (32U - op2)));
+}
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t v)
+{
+    uint32_t r = 0U;
+    for (uint32_t i = 0U; i < 32U; i++)
+    {
+        r = (r << 1) | (v & 1U);
+        v >>= 1;
+    }
+    return r;
+}
+__STATIC_FORCEINLINE uint8_t  __CLZ(uint32_t v)   { return (v == 0U) ? 32U : (uint8_t)__builtin_clz(v); }
+
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t val, uint32_t sat)
+{
+    if ((sat >= 1U) && (sat <= 32U))
+    {
+        const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+        const int32_t min = -1 - max;
+        if (val > max) return max;
+        if (val < min) return min;
+    }
+    return val;
+}
+
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t val, uint32_t sat)
+{
+    if (sat <= 31U)
+    {
+        const uint32_t max = ((1U << sat) - 1U);
+        if (val > (int32_t)max) return max;
+        if (val < 0) return 0U;
+    }
+    return (uint32_t)val;
+}
+
+/* Exclusive monitors: the host port runs one simulated CPU at a time, so a
+   plain load/store pair is a faithful stand-in. */
+__STATIC_FORCEINLINE uint8_t  __LDREXB(volatile uint8_t *a)  { return *a; }
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t *a) { return *a; }
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *a) { return *a; }
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t v, volatile uint8_t *a)   { *a = v; return 0U; }
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t v, volatile uint16_t *a) { *a = v; return 0U; }
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t v, volatile uint32_t *a) { *a = v; return 0U; }
+__STATIC_FORCEINLINE void     __CLREX(void) { }
+
+#endif /* HOST_CMSIS_GCC_H */
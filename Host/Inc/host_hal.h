@@ -0,0 +1,131 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include "main.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Module: Host HAL stand-ins (host_hal)
+ *
+ * Role:
+ *   - In-process replacements for the STM32Cube HAL entry points used by
+ *     Core/ (RCC, GPIO, NVIC, CAN, UART), compiled against the real HAL
+ *     headers so every type and constant is the firmware's own.
+ *   - A behavioural bxCAN model: 3 TX mailboxes drained at the configured
+ *     bit rate on every HAL tick, 28 filter banks with list/mask and
+ *     16/32-bit matching, two 3-deep RX FIFOs with overrun, loopback.
+ *   - A USART model whose TX goes to a sink (stdout by default) and whose
+ *     RX is fed from a file descriptor (stdin by default) or injected bytes.
+ *   - A basic timer (TIM6 / TIM7) model: the firmware programs them at
+ *     register level; they count and raise update interrupts on the tick.
+ *
+ * The control functions below are for host harnesses and benchmarks; they
+ * are thread-safe unless stated otherwise.
+ *
+ * Version history (module-level):
+ *   v1.0 - Initial stand-ins: RCC/GPIO/NVIC, bxCAN model, USART model.
+ *   v2.4 - Basic timer model (host_tim.c) for the scheduler tick.
+ */
+
+/* --------------------------------------------------------------------------
+ * CAN bus model
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Counters kept by the bxCAN model.
+ */
+typedef struct
+{
+    uint32_t tx_frames;          /**< Frames put on the bus from TX mailboxes */
+    uint32_t rx_frames[2];       /**< Frames stored into FIFO0 / FIFO1        */
+    uint32_t rx_filtered;        /**< Frames rejected by the filter banks     */
+    uint32_t rx_overruns[2];     /**< Frames lost to a full FIFO0 / FIFO1     */
+    uint32_t rx_read[2];         /**< Frames read out by HAL_CAN_GetRxMessage */
+    uint32_t injected;           /**< Frames delivered via HOST_CAN_Inject*() */
+} HOST_CAN_Stats_t;
+
+/**
+ * @brief Callback observing every frame that leaves a TX mailbox.
+ *
+ * Runs in simulated interrupt context (from the tick).
+ */
+typedef void (*HOST_CAN_TxTap_t)(const CAN_TxHeaderTypeDef *hdr,
+                                 const uint8_t data[8],
+                                 void *ctx);
+
+void HOST_CAN_SetTxTap(HOST_CAN_TxTap_t tap, void *ctx);
+
+/**
+ * @brief Deliver a frame from "another node" into the receive path.
+ *
+ * The frame goes through the filter banks and lands in FIFO0/1, raising the
+ * RX interrupt. If the FIFO is full the frame is lost (overrun), exactly as
+ * on hardware.
+ *
+ * @retval 1 if stored, 0 if filtered out or lost to overrun.
+ */
+int HOST_CAN_InjectFrame(uint32_t std_id, uint8_t dlc, const uint8_t *data);
+
+/**
+ * @brief Like HOST_CAN_InjectFrame() but waits for FIFO space instead of
+ *        overrunning. Use this to measure the maximum sustained RX rate.
+ *
+ * Must not be called from simulated (task/ISR) context.
+ */
+int HOST_CAN_InjectFrameBlocking(uint32_t std_id, uint8_t dlc, const uint8_t *data);
+
+void HOST_CAN_GetStats(HOST_CAN_Stats_t *out);
+
+/* --------------------------------------------------------------------------
+ * USART model
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Sink for transmitted bytes. Runs in the context of the transmitter
+ *        (HAL_UART_Transmit), or from the tick for DMA transfers.
+ */
+typedef void (*HOST_UART_TxSink_t)(const uint8_t *data, uint16_t len, void *ctx);
+
+/**
+ * @brief Redirect TX bytes of a USART (default: write to stdout).
+ *
+ * Call before main()/HAL_UART_Init() or at any later point.
+ */
+void HOST_UART_SetTxSink(USART_TypeDef *instance, HOST_UART_TxSink_t sink, void *ctx);
+
+/**
+ * @brief Select the file descriptor feeding a USART's RX line.
+ *
+ * Default for USART2 is stdin (put in raw mode if it is a terminal).
+ * Pass -1 to disconnect. Must be called before HAL_UART_Init().
+ */
+void HOST_UART_SetRxFd(USART_TypeDef *instance, int fd);
+
+/**
+ * @brief Queue bytes on a USART's RX line from any OS thread.
+ *
+ * @retval Number of bytes accepted.
+ */
+size_t HOST_UART_InjectRx(USART_TypeDef *instance, const uint8_t *data, size_t len);
+
+/**
+ * @brief Flag a line error (HAL_UART_ERROR_PE/NE/FE/ORE) on the next
+ *        received byte, which is lost, as on the wire.
+ *
+ * The USART interrupt reports it like the real HAL: HAL_UART_ErrorCallback()
+ * with huart->ErrorCode set, after aborting a DMA reception.
+ */
+void HOST_UART_InjectError(USART_TypeDef *instance, uint32_t error);
+
+/**
+ * @brief Fail the next TX DMA transfer part way with a DMA transfer error.
+ *
+ * The stream stops with NDTR holding the bytes not sent. The DMA interrupt
+ * reports it like the real HAL (UART_DMAError()): the transmission, and a
+ * DMA reception, end and HAL_UART_ErrorCallback() runs with
+ * HAL_UART_ERROR_DMA set. HAL_UART_TxCpltCallback() is not called.
+ */
+void HOST_UART_InjectTxError(USART_TypeDef *instance);
+
+#endif /* HOST_HAL_H */
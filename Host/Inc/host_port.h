@@ -0,0 +1,80 @@
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#include <stdint.h>
+
+/*
+ * Module: Host FreeRTOS port control (host_port)
+ *
+ * Role:
+ *   - Runs the unmodified FreeRTOS kernel (Middlewares/) on Linux, one
+ *     pthread per task, with exactly one task thread on the "CPU" at a time.
+ *   - Emulates the NVIC: peripheral stand-ins pend IRQ numbers, and the port
+ *     dispatches the matching handlers from the host vector table at
+ *     interrupt points (critical-section exit, yield, idle).
+ *   - Generates the RTOS tick either paced against the wall clock or as fast
+ *     as the simulation can go (virtual time), which is what lets the host
+ *     build run the ECU at many times real time.
+ *
+ * Interrupts are never taken in the middle of straight-line task code; a
+ * task that spins without entering the kernel holds off every IRQ. All task
+ * code in Core/ blocks on RTOS objects, so this is invisible to the firmware.
+ *
+ * Environment (read once at start-up by host_startup.c):
+ *   VECU_HOST_SPEED   0 = free-running virtual time, N = N x real time (default 1)
+ *   VECU_HOST_RUN_MS  stop the process after this many ticks (default: run forever)
+ *
+ * Version history (module-level):
+ *   v1.0 - Initial POSIX port: pthread tasks, NVIC emulation, paced/virtual tick.
+ *   v2.4 - Cycle counter for the kernel's run-time stats.
+ */
+
+/**
+ * @brief Select how the tick advances.
+ *
+ * @param scale 0 = virtual time (a tick is taken every time the idle task
+ *              runs), N = ticks are paced at N x configTICK_RATE_HZ.
+ */
+void HOST_PORT_SetTimeScale(uint32_t scale);
+
+/**
+ * @brief Stop the simulation once the tick count reaches @p ticks.
+ *
+ * @param ticks   Tick count at which to stop (0 = never).
+ * @param on_stop Optional callback run from the SysTick handler (interrupt
+ *                context, scheduler running) just before the process exits
+ *                with status 0.
+ */
+void HOST_PORT_StopAfter(uint32_t ticks, void (*on_stop)(void));
+
+/**
+ * @brief Flush stdio, run atexit handlers and terminate the process.
+ */
+void HOST_PORT_Exit(int status);
+
+/**
+ * @brief NVIC emulation. Safe to call from any OS thread.
+ *
+ * @param irqn CMSIS IRQ number (negative numbers are core exceptions,
+ *             e.g. -1 = SysTick).
+ */
+void     HOST_PORT_PendIRQ(int32_t irqn);
+void     HOST_PORT_ClearPendingIRQ(int32_t irqn);
+uint32_t HOST_PORT_GetPendingIRQ(int32_t irqn);
+void     HOST_PORT_EnableIRQ(int32_t irqn);
+void     HOST_PORT_DisableIRQ(int32_t irqn);
+void     HOST_PORT_SetPriority(int32_t irqn, uint32_t priority);
+
+/**
+ * @brief Number of ticks taken since the scheduler started.
+ */
+uint32_t HOST_PORT_GetTickCount(void);
+
+/**
+ * @brief Stand-in for DWT->CYCCNT: the monotonic clock scaled to
+ *        SystemCoreClock, wrapping at 32 bits. Feeds the kernel's run-time
+ *        stats (Host/Inc/FreeRTOSConfig.h).
+ */
+uint32_t HOST_PORT_CycleCount(void);
+
+#endif /* HOST_PORT_H */
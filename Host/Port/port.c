@@ -0,0 +1,599 @@
+/*
+ * FreeRTOS Kernel V10.3.1 - host (POSIX/pthreads) port for the Vehicle ECU
+ * host build.
+ *
+ * Execution model (see Host/Inc/host_port.h):
+ *   - Every task is a pthread. A task thread only executes while it holds
+ *     the simulated CPU; handing the CPU to another task is a condition
+ *     variable hand-off, so kernel data is never touched concurrently.
+ *   - Interrupts are dispatched from the vector table in host_startup.c at
+ *     interrupt points: when the critical nesting drops to zero, on yield and
+ *     from the idle hook. Handlers run on the interrupted task's thread with
+ *     IPSR set, so IS_IRQ() in cmsis_os2.c selects the FromISR APIs exactly
+ *     as it does on the Cortex-M4.
+ *   - A context switch requested while inside a critical section or an ISR
+ *     is deferred until the next interrupt point, like PendSV.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_port.h"
+
+/*-----------------------------------------------------------*/
+
+/* Exception numbers, as in the Cortex-M IPSR. IRQn = exception - 16. */
+#define portEXC_SYSTICK           15U
+#define portEXC_FIRST_IRQ         16U
+#define portEXC_COUNT             ( portEXC_FIRST_IRQ + 128U )
+#define portPENDING_WORDS         ( ( portEXC_COUNT + 31U ) / 32U )
+
+/* Lagging more than this many ticks behind the wall clock re-bases pacing
+   instead of bursting (e.g. after the process was stopped in a debugger). */
+#define portMAX_TICK_BACKLOG      100U
+
+typedef struct HostThread
+{
+    pthread_t       thread;
+    pthread_cond_t  cond;
+    int             running;   /* holds the simulated CPU */
+    int             exiting;   /* TCB freed, thread must terminate */
+    TaskFunction_t  code;
+    void           *params;
+} HostThread_t;
+
+/* Vector table provided by host_startup.c, indexed by exception number. */
+extern void (* const HOST_Vectors[])( void );
+extern const uint32_t HOST_VectorCount;
+
+extern void * volatile pxCurrentTCB;
+
+/* CPU ownership hand-off. */
+static pthread_mutex_t s_cpuLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_parkCond = PTHREAD_COND_INITIALIZER;
+
+/* Simulated core state: only touched by the thread holding the CPU. Like the
+   ARM ports, interrupts stay masked from the first task creation until the
+   scheduler starts. */
+static uint32_t s_criticalNesting = 0xaaaaaaaaUL;
+static uint32_t s_basepriMasked   = 1U;
+static uint32_t s_primask         = 0U;
+static uint32_t s_ipsr            = 0U;
+static uint32_t s_yieldPending    = 0U;
+static uint32_t s_schedulerRunning = 0U;
+
+/* NVIC: pending bits may be set from any OS thread. */
+static uint32_t s_pending[ portPENDING_WORDS ];
+static uint8_t  s_enabled[ portEXC_COUNT ];
+static uint8_t  s_priority[ portEXC_COUNT ];
+
+/* Wake-up of the idle task when an IRQ is pended from outside. */
+static pthread_mutex_t s_wakeLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_wakeCond;
+static int             s_wakeFlag = 0;
+
+/* Tick generation. */
+static uint32_t s_timeScale    = 1U;
+static uint64_t s_tickPeriodNs = 0U;
+static uint64_t s_nextTickNs   = 0U;
+static uint32_t s_tickCount    = 0U;
+static uint32_t s_stopTicks    = 0U;
+static void   (*s_onStop)( void ) = NULL;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( ( uint64_t ) ts.tv_sec * 1000000000ULL ) + ( uint64_t ) ts.tv_nsec;
+}
+
+static HostThread_t *prvThreadOf( void *pxTCB )
+{
+    /* pxTopOfStack is the first TCB member; pxPortInitialiseStack() left the
+       thread pointer in the top stack word. */
+    StackType_t *pxTopOfStack = *( StackType_t ** ) pxTCB;
+    return ( HostThread_t * ) *pxTopOfStack;
+}
+
+static int prvExcFromIrqn( int32_t irqn )
+{
+    int32_t exc = irqn + ( int32_t ) portEXC_FIRST_IRQ;
+
+    if( ( exc <= 0 ) || ( exc >= ( int32_t ) portEXC_COUNT ) )
+    {
+        return -1;
+    }
+    return ( int ) exc;
+}
+
+static void prvWake( void )
+{
+    pthread_mutex_lock( &s_wakeLock );
+    s_wakeFlag = 1;
+    pthread_cond_signal( &s_wakeCond );
+    pthread_mutex_unlock( &s_wakeLock );
+}
+
+static void prvSetPending( uint32_t exc )
+{
+    __atomic_fetch_or( &s_pending[ exc / 32U ], 1UL << ( exc % 32U ), __ATOMIC_SEQ_CST );
+}
+
+static int prvIsEnabled( uint32_t exc )
+{
+    return ( exc < portEXC_FIRST_IRQ ) || ( s_enabled[ exc ] != 0U );
+}
+
+/* Highest-priority (lowest value, then lowest number) pending + enabled
+   exception, or -1. */
+static int prvNextPending( void )
+{
+int best = -1;
+
+    for( uint32_t w = 0U; w < portPENDING_WORDS; w++ )
+    {
+        uint32_t bits = __atomic_load_n( &s_pending[ w ], __ATOMIC_SEQ_CST );
+
+        while( bits != 0U )
+        {
+            uint32_t exc = ( w * 32U ) + ( uint32_t ) __builtin_ctz( bits );
+            bits &= bits - 1U;
+
+            if( prvIsEnabled( exc ) &&
+                ( ( best < 0 ) || ( s_priority[ exc ] < s_priority[ best ] ) ) )
+            {
+                best = ( int ) exc;
+            }
+        }
+    }
+    return best;
+}
+
+static void prvPaceTick( void )
+{
+    if( s_timeScale == 0U )
+    {
+        return;
+    }
+
+    uint64_t now = prvNowNs();
+
+    if( now >= s_nextTickNs )
+    {
+        prvSetPending( portEXC_SYSTICK );
+        s_nextTickNs += s_tickPeriodNs;
+
+        if( now > ( s_nextTickNs + ( portMAX_TICK_BACKLOG * s_tickPeriodNs ) ) )
+        {
+            s_nextTickNs = now + s_tickPeriodNs;
+        }
+    }
+}
+
+static void prvHandoff( HostThread_t *from, HostThread_t *to )
+{
+    pthread_mutex_lock( &s_cpuLock );
+    from->running = 0;
+    to->running = 1;
+    pthread_cond_signal( &to->cond );
+
+    while( ( from->running == 0 ) && ( from->exiting == 0 ) )
+    {
+        pthread_cond_wait( &from->cond, &s_cpuLock );
+    }
+
+    if( from->exiting != 0 )
+    {
+        pthread_mutex_unlock( &s_cpuLock );
+        pthread_cond_destroy( &from->cond );
+        free( from );
+        pthread_exit( NULL );
+    }
+    pthread_mutex_unlock( &s_cpuLock );
+}
+
+static void prvSwitchContext( void )
+{
+HostThread_t *from = prvThreadOf( pxCurrentTCB );
+HostThread_t *to;
+
+    s_yieldPending = 0U;
+    vTaskSwitchContext();
+    to = prvThreadOf( pxCurrentTCB );
+
+    if( from != to )
+    {
+        prvHandoff( from, to );
+    }
+}
+
+/* Take pending interrupts and any deferred context switch. Only legal with
+   the critical nesting at zero and outside of an ISR. */
+static void prvInterruptPoint( void )
+{
+    if( ( s_schedulerRunning == 0U ) || ( s_ipsr != 0U ) || ( s_criticalNesting != 0U ) )
+    {
+        return;
+    }
+
+    while( ( s_basepriMasked == 0U ) && ( s_primask == 0U ) )
+    {
+        prvPaceTick();
+
+        int exc = prvNextPending();
+        if( exc < 0 )
+        {
+            break;
+        }
+
+        __atomic_fetch_and( &s_pending[ exc / 32 ], ~( 1UL << ( exc % 32 ) ), __ATOMIC_SEQ_CST );
+
+        if( ( ( uint32_t ) exc < HOST_VectorCount ) && ( HOST_Vectors[ exc ] != NULL ) )
+        {
+            s_ipsr = ( uint32_t ) exc;
+            HOST_Vectors[ exc ]();
+            s_ipsr = 0U;
+        }
+    }
+
+    if( s_yieldPending != 0U )
+    {
+        prvSwitchContext();
+    }
+}
+
+static void prvTaskExitError( void )
+{
+    /* Task functions must never return (same contract as the ARM_CM4F port). */
+    configASSERT( 0 );
+}
+
+static void *prvThreadEntry( void *arg )
+{
+HostThread_t *self = ( HostThread_t * ) arg;
+
+    pthread_mutex_lock( &s_cpuLock );
+    while( ( self->running == 0 ) && ( self->exiting == 0 ) )
+    {
+        pthread_cond_wait( &self->cond, &s_cpuLock );
+    }
+    if( self->exiting != 0 )
+    {
+        pthread_mutex_unlock( &s_cpuLock );
+        pthread_cond_destroy( &self->cond );
+        free( self );
+        return NULL;
+    }
+    pthread_mutex_unlock( &s_cpuLock );
+
+    self->code( self->params );
+    prvTaskExitError();
+    return NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+HostThread_t *t = calloc( 1, sizeof( *t ) );
+pthread_attr_t attr;
+
+    configASSERT( t != NULL );
+    t->code = pxCode;
+    t->params = pvParameters;
+    pthread_cond_init( &t->cond, NULL );
+
+    /* The FreeRTOS stack only carries the thread pointer; the task body runs
+       on the pthread's own (much larger) host stack. */
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    if( pthread_create( &t->thread, &attr, prvThreadEntry, t ) != 0 )
+    {
+        configASSERT( 0 );
+    }
+    pthread_attr_destroy( &attr );
+
+    *pxTopOfStack = ( StackType_t ) t;
+    return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+HostThread_t *first = prvThreadOf( pxCurrentTCB );
+
+    s_tickPeriodNs = ( s_timeScale == 0U ) ? 0U :
+                     ( 1000000000ULL / configTICK_RATE_HZ ) / s_timeScale;
+    s_nextTickNs = prvNowNs() + s_tickPeriodNs;
+
+    s_criticalNesting = 0U;
+    s_basepriMasked = 0U;
+    s_schedulerRunning = 1U;
+
+    pthread_mutex_lock( &s_cpuLock );
+    first->running = 1;
+    pthread_cond_signal( &first->cond );
+
+    /* The calling (main) thread never runs kernel code again. */
+    for( ;; )
+    {
+        pthread_cond_wait( &s_parkCond, &s_cpuLock );
+    }
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+    HOST_PORT_Exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+    s_yieldPending = 1U;
+
+    /* Inside a critical section or ISR the switch is deferred (PendSV). */
+    prvInterruptPoint();
+}
+
+void vPortYieldFromISR( void )
+{
+    s_yieldPending = 1U;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+    s_basepriMasked = 1U;
+    s_criticalNesting++;
+}
+
+void vPortExitCritical( void )
+{
+    configASSERT( s_criticalNesting != 0U );
+    s_criticalNesting--;
+
+    if( s_criticalNesting == 0U )
+    {
+        s_basepriMasked = 0U;
+        prvInterruptPoint();
+    }
+}
+
+void vPortDisableInterrupts( void )
+{
+    s_basepriMasked = 1U;
+}
+
+void vPortEnableInterrupts( void )
+{
+    s_basepriMasked = 0U;
+}
+
+uint32_t ulPortSetInterruptMask( void )
+{
+uint32_t prev = s_basepriMasked;
+
+    s_basepriMasked = 1U;
+    return prev;
+}
+
+void vPortClearInterruptMask( uint32_t ulMask )
+{
+    s_basepriMasked = ulMask;
+}
+
+BaseType_t xPortIsInsideInterrupt( void )
+{
+    return ( s_ipsr != 0U ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCleanUpTCB( void *pxTCB )
+{
+HostThread_t *t = prvThreadOf( pxTCB );
+
+    pthread_mutex_lock( &s_cpuLock );
+    t->exiting = 1;
+    pthread_cond_signal( &t->cond );
+    pthread_mutex_unlock( &s_cpuLock );
+}
+/*-----------------------------------------------------------*/
+
+void xPortSysTickHandler( void )
+{
+    if( xTaskIncrementTick() != pdFALSE )
+    {
+        s_yieldPending = 1U;
+    }
+
+    s_tickCount++;
+    if( ( s_stopTicks != 0U ) && ( s_tickCount >= s_stopTicks ) )
+    {
+        if( s_onStop != NULL )
+        {
+            s_onStop();
+        }
+        HOST_PORT_Exit( 0 );
+    }
+}
+
+/* The idle task is where simulated time passes: in virtual-time mode every
+   idle pass is one tick, in paced mode the host thread sleeps until the next
+   tick is due or an IRQ is pended from outside. */
+void vApplicationIdleHook( void )
+{
+    if( s_timeScale == 0U )
+    {
+        prvSetPending( portEXC_SYSTICK );
+    }
+    else
+    {
+        pthread_mutex_lock( &s_wakeLock );
+        while( ( s_wakeFlag == 0 ) && ( prvNextPending() < 0 ) )
+        {
+            uint64_t now = prvNowNs();
+            struct timespec ts;
+
+            if( now >= s_nextTickNs )
+            {
+                break;
+            }
+            ts.tv_sec  = ( time_t ) ( s_nextTickNs / 1000000000ULL );
+            ts.tv_nsec = ( long ) ( s_nextTickNs % 1000000000ULL );
+            pthread_cond_timedwait( &s_wakeCond, &s_wakeLock, &ts );
+        }
+        s_wakeFlag = 0;
+        pthread_mutex_unlock( &s_wakeLock );
+    }
+
+    prvInterruptPoint();
+}
+/*-----------------------------------------------------------*/
+
+/* CMSIS core-register intrinsics (see host_cmsis_gcc.h). */
+uint32_t HOST_PORT_GetIPSR( void )
+{
+    return s_ipsr;
+}
+
+uint32_t HOST_PORT_GetPRIMASK( void )
+{
+    return s_primask;
+}
+
+void HOST_PORT_SetPRIMASK( uint32_t primask )
+{
+    s_primask = ( primask != 0U ) ? 1U : 0U;
+
+    if( s_primask == 0U )
+    {
+        prvInterruptPoint();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void HOST_PORT_SetTimeScale( uint32_t scale )
+{
+    s_timeScale = scale;
+
+    if( s_schedulerRunning != 0U )
+    {
+        s_tickPeriodNs = ( scale == 0U ) ? 0U : ( 1000000000ULL / configTICK_RATE_HZ ) / scale;
+        s_nextTickNs = prvNowNs() + s_tickPeriodNs;
+        prvWake();
+    }
+}
+
+void HOST_PORT_StopAfter( uint32_t ticks, void ( *on_stop )( void ) )
+{
+    s_stopTicks = ticks;
+    s_onStop = on_stop;
+}
+
+void HOST_PORT_Exit( int status )
+{
+    fflush( stdout );
+    fflush( stderr );
+    exit( status );
+}
+
+uint32_t HOST_PORT_GetTickCount( void )
+{
+    return s_tickCount;
+}
+
+uint32_t HOST_PORT_CycleCount( void )
+{
+const uint64_t ns = prvNowNs();
+
+    return ( uint32_t ) ( ( ( ns / 1000000000ULL ) * SystemCoreClock ) +
+                          ( ( ( ns % 1000000000ULL ) * SystemCoreClock ) / 1000000000ULL ) );
+}
+
+void HOST_PORT_PendIRQ( int32_t irqn )
+{
+int exc = prvExcFromIrqn( irqn );
+
+    if( exc < 0 )
+    {
+        return;
+    }
+    prvSetPending( ( uint32_t ) exc );
+    prvWake();
+}
+
+void HOST_PORT_ClearPendingIRQ( int32_t irqn )
+{
+int exc = prvExcFromIrqn( irqn );
+
+    if( exc >= 0 )
+    {
+        __atomic_fetch_and( &s_pending[ exc / 32 ], ~( 1UL << ( exc % 32 ) ), __ATOMIC_SEQ_CST );
+    }
+}
+
+uint32_t HOST_PORT_GetPendingIRQ( int32_t irqn )
+{
+int exc = prvExcFromIrqn( irqn );
+
+    if( exc < 0 )
+    {
+        return 0U;
+    }
+    return ( __atomic_load_n( &s_pending[ exc / 32 ], __ATOMIC_SEQ_CST ) >> ( exc % 32 ) ) & 1U;
+}
+
+void HOST_PORT_EnableIRQ( int32_t irqn )
+{
+int exc = prvExcFromIrqn( irqn );
+
+    if( exc >= 0 )
+    {
+        s_enabled[ exc ] = 1U;
+        prvWake();
+    }
+}
+
+void HOST_PORT_DisableIRQ( int32_t irqn )
+{
+int exc = prvExcFromIrqn( irqn );
+
+    if( exc >= 0 )
+    {
+        s_enabled[ exc ] = 0U;
+    }
+}
+
+void HOST_PORT_SetPriority( int32_t irqn, uint32_t priority )
+{
+int exc = prvExcFromIrqn( irqn );
+
+    if( exc >= 0 )
+    {
+        s_priority[ exc ] = ( uint8_t ) priority;
+    }
+}
+
+/* Runs before main(): the wake condition must use the monotonic clock. */
+__attribute__( ( constructor ) ) static void prvPortInit( void )
+{
+pthread_condattr_t attr;
+
+    pthread_condattr_init( &attr );
+    pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+    pthread_cond_init( &s_wakeCond, &attr );
+    pthread_condattr_destroy( &attr );
+}
@@ -0,0 +1,411 @@
+#!/usr/bin/env python3
+"""
+dbc2c.py - generate a header-only C signal codec from a DBC file.
+
+Reads the subset of the DBC format used by Tools/can_db/vecu.dbc:
+
+    BO_ <id> <Name>: <dlc> <sender>
+     SG_ <Name> : <start>|<length>@<0|1><+|-> (<scale>,<offset>) [<min>|<max>] "<unit>" <rx>
+    CM_ BO_ <id> "<text>";
+    CM_ SG_ <id> <Name> "<text>";
+    VAL_ <id> <Name> <value> "<label>" ... ;
+
+Byte order follows DBC: @1 = Intel (little-endian, start = LSB),
+@0 = Motorola (big-endian, start = MSB in sawtooth bit numbering).
+IDs above 0x7FF, or with bit 31 set, are extended.
+
+For every message the output has ID / DLC macros, a struct of raw signal
+values, and static inline Pack / Unpack functions made of fixed shifts
+and masks. Each signal gets static inline Encode / Decode functions that
+convert physical values (float, with scale, offset and [min|max]
+saturation). With CAN_DB_DESCRIPTORS defined, the header also provides
+the signal table, which a generic table-driven codec can use as a
+reference.
+
+Usage: dbc2c.py <in.dbc> <out.h>
+"""
+
+import re
+import sys
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional
+
+PREFIX = "CAN_DB"
+
+
+@dataclass
+class Signal:
+    name: str
+    start: int
+    length: int
+    intel: bool
+    signed: bool
+    scale: float
+    offset: float
+    minimum: float
+    maximum: float
+    unit: str
+    comment: str = ""
+    values: Dict[int, str] = field(default_factory=dict)
+
+
+@dataclass
+class Message:
+    can_id: int
+    name: str
+    dlc: int
+    sender: str
+    signals: List[Signal] = field(default_factory=list)
+    comment: str = ""
+
+    @property
+    def extended(self) -> bool:
+        return (self.can_id & 0x80000000) != 0 or self.can_id > 0x7FF
+
+    @property
+    def frame_id(self) -> int:
+        return self.can_id & 0x1FFFFFFF
+
+
+RE_BO = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)")
+RE_SG = re.compile(r"^SG_\s+(\w+)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+                   r"\(\s*([-+0-9.eE]+)\s*,\s*([-+0-9.eE]+)\s*\)\s*"
+                   r"\[\s*([-+0-9.eE]+)\s*\|\s*([-+0-9.eE]+)\s*\]\s*\"([^\"]*)\"")
+RE_CM_BO = re.compile(r'^CM_\s+BO_\s+(\d+)\s+"([^"]*)"\s*;')
+RE_CM_SG = re.compile(r'^CM_\s+SG_\s+(\d+)\s+(\w+)\s+"([^"]*)"\s*;')
+RE_VAL = re.compile(r"^VAL_\s+(\d+)\s+(\w+)\s+(.*);")
+RE_VAL_ITEM = re.compile(r'(-?\d+)\s+"([^"]*)"')
+
+
+def fail(msg: str) -> None:
+    sys.exit("dbc2c: " + msg)
+
+
+def parse(path: str) -> List[Message]:
+    msgs: List[Message] = []
+    by_id: Dict[int, Message] = {}
+    cur: Optional[Message] = None
+
+    with open(path, encoding="utf-8") as f:
+        for lineno, raw in enumerate(f, 1):
+            line = raw.strip()
+            m = RE_BO.match(line)
+            if m:
+                cur = Message(int(m.group(1)), m.group(2), int(m.group(3)), m.group(4))
+                if cur.dlc > 8:
+                    fail(f"{path}:{lineno}: DLC {cur.dlc} > 8")
+                msgs.append(cur)
+                by_id[cur.can_id] = cur
+                continue
+            m = RE_SG.match(line)
+            if m:
+                if cur is None:
+                    fail(f"{path}:{lineno}: SG_ outside BO_")
+                cur.signals.append(Signal(
+                    name=m.group(1), start=int(m.group(2)), length=int(m.group(3)),
+                    intel=(m.group(4) == "1"), signed=(m.group(5) == "-"),
+                    scale=float(m.group(6)), offset=float(m.group(7)),
+                    minimum=float(m.group(8)), maximum=float(m.group(9)),
+                    unit=m.group(10)))
+                continue
+            if not line.startswith("SG_"):
+                cur = None
+            m = RE_CM_BO.match(line)
+            if m and int(m.group(1)) in by_id:
+                by_id[int(m.group(1))].comment = m.group(2)
+                continue
+            m = RE_CM_SG.match(line)
+            if m and int(m.group(1)) in by_id:
+                for s in by_id[int(m.group(1))].signals:
+                    if s.name == m.group(2):
+                        s.comment = m.group(3)
+                continue
+            m = RE_VAL.match(line)
+            if m and int(m.group(1)) in by_id:
+                for s in by_id[int(m.group(1))].signals:
+                    if s.name == m.group(2):
+                        s.values = {int(v): lbl for v, lbl in RE_VAL_ITEM.findall(m.group(3))}
+    return msgs
+
+
+def bit_positions(sig: Signal) -> List[int]:
+    """Message bit position (byte * 8 + bit) of signal bit k, k = 0 is the LSB."""
+    if sig.intel:
+        return [sig.start + k for k in range(sig.length)]
+    msb_first = []
+    p = sig.start
+    for _ in range(sig.length):
+        msb_first.append(p)
+        p = p + 15 if p % 8 == 0 else p - 1
+    return list(reversed(msb_first))
+
+
+def snake(name: str) -> str:
+    s = re.sub(r"(?<=[a-z0-9])([A-Z])", r"_\1", name)
+    s = re.sub(r"(?<=[A-Z])([A-Z][a-z])", r"_\1", s)
+    return s.lower()
+
+
+def upper(name: str) -> str:
+    return snake(name).upper()
+
+
+def raw_width(sig: Signal) -> int:
+    for w in (8, 16, 32, 64):
+        if sig.length <= w:
+            return w
+    fail(f"signal {sig.name}: length {sig.length} > 64")
+    return 0
+
+
+def c_type(sig: Signal) -> str:
+    return ("int%d_t" if sig.signed else "uint%d_t") % raw_width(sig)
+
+
+def u_type(sig: Signal) -> str:
+    return "uint%d_t" % raw_width(sig)
+
+
+def c_float(v: float) -> str:
+    s = repr(float(v))
+    if "e" not in s and "." not in s:
+        s += ".0"
+    return s + "f"
+
+
+def suffix(width: int) -> str:
+    return "ULL" if width == 64 else "U"
+
+
+def runs(sig: Signal):
+    """Per byte: (byte, first signal bit, first byte bit, bit count)."""
+    out = {}
+    for k, pos in enumerate(bit_positions(sig)):
+        byte, bit = divmod(pos, 8)
+        if byte not in out:
+            out[byte] = [k, bit, 0]
+        out[byte][2] += 1
+    return sorted((b, k, bit, n) for b, (k, bit, n) in out.items())
+
+
+def raw_limits(sig: Signal):
+    if sig.signed:
+        return -(1 << (sig.length - 1)), (1 << (sig.length - 1)) - 1
+    return 0, (1 << sig.length) - 1
+
+
+def check(msg: Message) -> None:
+    used = {}
+    for s in msg.signals:
+        if s.length < 1 or s.length > 64:
+            fail(f"{msg.name}.{s.name}: bad length {s.length}")
+        if s.scale == 0.0:
+            fail(f"{msg.name}.{s.name}: scale 0")
+        for pos in bit_positions(s):
+            if pos < 0 or pos >= msg.dlc * 8:
+                fail(f"{msg.name}.{s.name}: bit {pos} outside DLC {msg.dlc}")
+            if pos in used:
+                fail(f"{msg.name}.{s.name}: bit {pos} overlaps {used[pos]}")
+            used[pos] = s.name
+
+
+def gen(msgs: List[Message], src: str) -> str:
+    o: List[str] = []
+    w = o.append
+
+    w("/* Generated by Tools/can_db/dbc2c.py from %s - do not edit. */" % src)
+    w("")
+    w("#ifndef CAN_DB_H")
+    w("#define CAN_DB_H")
+    w("")
+    w("#include <stdint.h>")
+    w("")
+    w("/*")
+    w(" * Module: CAN signal database (can_db)")
+    w(" *")
+    w(" * Role:")
+    w(" *   - ID, DLC, raw signal struct and Pack / Unpack per message.")
+    w(" *   - Encode / Decode per signal: physical value <-> raw value")
+    w(" *     (phys = raw * scale + offset, saturated to [min, max]).")
+    w(" *")
+    w(" * Byte order is per signal: Intel (little-endian) or Motorola")
+    w(" * (big-endian), as in the DBC. Pack writes all DLC bytes; bits not")
+    w(" * covered by a signal are 0.")
+    w(" */")
+    w("")
+
+    for msg in msgs:
+        check(msg)
+        M = upper(msg.name)
+        T = "%s_%s" % (PREFIX, msg.name)
+        w("/* " + "-" * 74 + "")
+        w(" * %s (0x%03X, DLC %d, sent by %s)%s" % (
+            msg.name, msg.frame_id, msg.dlc, msg.sender,
+            ("\n * " + msg.comment) if msg.comment else ""))
+        w(" * " + "-" * 74 + " */")
+        w("")
+        w("#define %s_%s_ID        0x%03XU" % (PREFIX, M, msg.frame_id))
+        w("#define %s_%s_IDE       %dU" % (PREFIX, M, 1 if msg.extended else 0))
+        w("#define %s_%s_DLC       %dU" % (PREFIX, M, msg.dlc))
+        for s in msg.signals:
+            for v, lbl in sorted(s.values.items()):
+                w("#define %s_%s_%s_%s  %d%s" % (PREFIX, M, upper(s.name), upper(lbl), v,
+                                                 "U" if v >= 0 else ""))
+        w("")
+        w("typedef struct")
+        w("{")
+        for s in msg.signals:
+            order = "Intel" if s.intel else "Motorola"
+            note = "%s %d|%d %s, x%g%+g %s" % (
+                "signed" if s.signed else "unsigned", s.start, s.length, order,
+                s.scale, s.offset, s.unit)
+            w("    %-9s %-16s /**< %s */" % (c_type(s), snake(s.name) + ";", note.rstrip()))
+        w("} %s_t;" % T)
+        w("")
+
+        # Pack: one store per byte
+        w("static inline void %s_Pack(uint8_t data[%s_%s_DLC]," % (T, PREFIX, M))
+        w("%s const %s_t *m)" % (" " * len("static inline void %s_Pack(" % T), T))
+        w("{")
+        per_byte: Dict[int, List[str]] = {b: [] for b in range(msg.dlc)}
+        for s in msg.signals:
+            for b, k, bit, n in runs(s):
+                expr = "(%s)m->%s" % (u_type(s), snake(s.name))
+                if k:
+                    expr = "(%s >> %d)" % (expr, k)
+                if n < 8 and k + n < raw_width(s):
+                    expr = "(%s & 0x%XU)" % (expr, (1 << n) - 1)
+                if bit:
+                    expr = "(%s << %d)" % (expr, bit)
+                per_byte[b].append(expr)
+        for b in range(msg.dlc):
+            parts = per_byte[b]
+            if not parts:
+                w("    data[%d] = 0U;" % b)
+            else:
+                w("    data[%d] = (uint8_t)(%s);" % (b, " | ".join(parts)))
+        w("}")
+        w("")
+
+        # Unpack
+        w("static inline void %s_Unpack(%s_t *m," % (T, T))
+        w("%s const uint8_t data[%s_%s_DLC])" % (" " * len("static inline void %s_Unpack(" % T), PREFIX, M))
+        w("{")
+        for s in msg.signals:
+            U = u_type(s)
+            width = raw_width(s)
+            parts = []
+            for b, k, bit, n in runs(s):
+                expr = "data[%d]" % b
+                if bit:
+                    expr = "(%s >> %d)" % (expr, bit)
+                if bit + n < 8:
+                    expr = "(%s & 0x%XU)" % (expr, (1 << n) - 1)
+                expr = "(%s)%s" % (U, expr) if k == 0 else "((%s)%s << %d)" % (U, expr, k)
+                parts.append(expr)
+            raw = " | ".join(parts)
+            if s.signed and s.length < width:
+                # Sign-extend from bit length-1: (r ^ sign) - sign
+                sb = 1 << (s.length - 1)
+                if width <= 16:
+                    w("    m->%s = (%s)(((int32_t)(%s) ^ 0x%X) - 0x%X);" % (
+                        snake(s.name), c_type(s), raw, sb, sb))
+                else:
+                    w("    m->%s = (%s)((%s)(%s ^ 0x%X%s) - 0x%X%s);" % (
+                        snake(s.name), c_type(s), U, raw, sb, suffix(width), sb, suffix(width)))
+            elif s.signed or len(parts) > 1:
+                w("    m->%s = (%s)(%s);" % (snake(s.name), c_type(s), raw))
+            else:
+                w("    m->%s = %s;" % (snake(s.name), raw))
+        w("}")
+        w("")
+
+        # Physical conversions
+        for s in msg.signals:
+            S = "%s_%s" % (T, s.name)
+            lo, hi = raw_limits(s)
+            rmin = max(lo, round((s.minimum - s.offset) / s.scale))
+            rmax = min(hi, round((s.maximum - s.offset) / s.scale))
+            if s.minimum == 0.0 and s.maximum == 0.0:
+                rmin, rmax = lo, hi
+            if rmin > rmax:
+                rmin, rmax = rmax, rmin
+            w("static inline float %s_Decode(%s raw)" % (S, c_type(s)))
+            w("{")
+            if s.offset != 0.0:
+                w("    return (float)raw * %s + %s;" % (c_float(s.scale), c_float(s.offset)))
+            elif s.scale != 1.0:
+                w("    return (float)raw * %s;" % c_float(s.scale))
+            else:
+                w("    return (float)raw;")
+            w("}")
+            w("")
+            w("static inline %s %s_Encode(float phys)" % (c_type(s), S))
+            w("{")
+            x = "phys"
+            if s.offset != 0.0:
+                x = "(phys - %s)" % c_float(s.offset)
+            if s.scale != 1.0:
+                x = "%s / %s" % (x, c_float(s.scale))
+            w("    float x = %s;" % x)
+            w("")
+            w("    if (x <= %s) return (%s)%d%s;" % (c_float(rmin), c_type(s), rmin,
+                                                   "" if s.signed else "U"))
+            w("    if (x >= %s) return (%s)%d%s;" % (c_float(rmax), c_type(s), rmax,
+                                                   "" if s.signed else "U"))
+            if s.signed:
+                w("    return (%s)((x < 0.0f) ? (x - 0.5f) : (x + 0.5f));" % c_type(s))
+            else:
+                w("    return (%s)(x + 0.5f);" % c_type(s))
+            w("}")
+            w("")
+
+    # Descriptor table
+    n_sig = sum(len(m.signals) for m in msgs)
+    w("/* " + "-" * 74)
+    w(" * Signal descriptors (define CAN_DB_DESCRIPTORS in one translation unit)")
+    w(" * " + "-" * 74 + " */")
+    w("")
+    w("typedef struct")
+    w("{")
+    w("    uint32_t    msg_id;     /**< Message ID                               */")
+    w("    const char *name;       /**< Message.Signal                           */")
+    w("    uint8_t     start;      /**< DBC start bit                            */")
+    w("    uint8_t     length;     /**< Bits                                     */")
+    w("    uint8_t     intel;      /**< 1 = little-endian, 0 = big-endian        */")
+    w("    uint8_t     is_signed;  /**< 1 = two's complement                     */")
+    w("    float       scale;")
+    w("    float       offset;")
+    w("    float       minimum;")
+    w("    float       maximum;")
+    w("} %s_SignalDesc_t;" % PREFIX)
+    w("")
+    w("#define %s_SIGNAL_COUNT  %dU" % (PREFIX, n_sig))
+    w("")
+    w("#ifdef CAN_DB_DESCRIPTORS")
+    w("static const %s_SignalDesc_t %s_Signals[%s_SIGNAL_COUNT] = {" % (PREFIX, PREFIX, PREFIX))
+    for msg in msgs:
+        for s in msg.signals:
+            w('    { 0x%03XU, "%s.%s", %d, %d, %d, %d, %s, %s, %s, %s },' % (
+                msg.frame_id, msg.name, s.name, s.start, s.length, int(s.intel), int(s.signed),
+                c_float(s.scale), c_float(s.offset), c_float(s.minimum), c_float(s.maximum)))
+    w("};")
+    w("#endif /* CAN_DB_DESCRIPTORS */")
+    w("")
+    w("#endif /* CAN_DB_H */")
+    return "\n".join(o) + "\n"
+
+
+def main() -> None:
+    if len(sys.argv) != 3:
+        sys.exit("usage: dbc2c.py <in.dbc> <out.h>")
+    msgs = parse(sys.argv[1])
+    if not msgs:
+        fail("no messages in " + sys.argv[1])
+    text = gen(msgs, sys.argv[1].replace("\\", "/").split("/")[-1])
+    with open(sys.argv[2], "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,144 @@
+/**
+ * @file    dlog_decode.c
+ * @brief   Host decoder for deferred log captures (binary log mode).
+ *
+ * Reads a console capture taken with `log bin` (a file, or the UART piped
+ * in) and writes it back as text. Binary records are formatted with the
+ * same catalog and formatter as LogTask on the target (dlog_fmt.h), so the
+ * lines are identical to text mode. Everything else in the stream (CLI
+ * prompts, replies, echo) is passed through unchanged.
+ *
+ * Usage: dlog_decode [-t] [-c core_hz] [capture]   (default: stdin)
+ *   -t          prefix each record with its time stamp in microseconds
+ *   -c core_hz  core clock the time stamps count (default 16000000, the
+ *               HSI clock tree in main.c)
+ *
+ *   ./build-host/vecu_host | ./build-host/dlog_decode -t
+ *
+ * Exit status is 1 if the input could not be read.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dlog_fmt.h"
+
+#define BUF_LEN   4096U
+
+static int      s_stamp;
+static double   s_coreHz = 16000000.0;
+static uint32_t s_lastTs;
+static double   s_timeUs;
+static int      s_haveTs;
+
+static void emit_record(const DLOG_Record_t *rec)
+{
+    char line[DLOG_TEXT_MAX];
+    const uint32_t len = DLOG_Format(line, sizeof(line), rec);
+
+    if (s_stamp)
+    {
+        /* Time stamps are 32-bit cycle counts; unwrap between records */
+        if (s_haveTs)
+        {
+            s_timeUs += (double)(uint32_t)(rec->ts - s_lastTs) * 1.0e6 / s_coreHz;
+        }
+        s_lastTs = rec->ts;
+        s_haveTs = 1;
+        printf("[%12.1f] ", s_timeUs);
+    }
+    fwrite(line, 1U, len, stdout);
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[BUF_LEN];
+    const char *path = NULL;
+    FILE *in = stdin;
+    size_t have = 0U;
+    int eof = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0)
+        {
+            s_stamp = 1;
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            s_coreHz = strtod(argv[++i], NULL);
+        }
+        else if (argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            fprintf(stderr, "usage: %s [-t] [-c core_hz] [capture]\n", argv[0]);
+            return 1;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path != NULL && (in = fopen(path, "rb")) == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+
+    while (!eof || have > 0U)
+    {
+        if (!eof && have < BUF_LEN)
+        {
+            const size_t n = fread(&buf[have], 1U, BUF_LEN - have, in);
+            have += n;
+            if (n == 0U)
+            {
+                eof = 1;
+            }
+        }
+
+        size_t pos = 0U;
+        while (pos < have)
+        {
+            if (buf[pos] != DLOG_SYNC)
+            {
+                /* Text run up to the next candidate record */
+                size_t end = pos;
+                while (end < have && buf[end] != DLOG_SYNC)
+                {
+                    end++;
+                }
+                fwrite(&buf[pos], 1U, end - pos, stdout);
+                pos = end;
+                continue;
+            }
+
+            DLOG_Record_t rec;
+            const int used = DLOG_Decode(&buf[pos], have - pos, &rec);
+            if (used > 0)
+            {
+                emit_record(&rec);
+                pos += (size_t)used;
+            }
+            else if (used == 0 && !eof)
+            {
+                break;   /* record continues in the next read */
+            }
+            else
+            {
+                fputc(buf[pos], stdout);   /* not a record: plain byte */
+                pos++;
+            }
+        }
+
+        memmove(buf, &buf[pos], have - pos);
+        have -= pos;
+        fflush(stdout);
+    }
+
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+    return ferror(stdout) ? 1 : 0;
+}
@@ -0,0 +1,566 @@
+/**
+ * @file    hostlink_client.c
+ * @brief   Host client for the binary host protocol (hostlink): streams
+ *          vehicle samples and CAN frames and measures rate and loss.
+ *
+ * By default it starts the host build of the firmware (vecu_host, next to
+ * this binary) on a pseudo-terminal, which stands in for the UART: the
+ * firmware's console is the pty slave and the client talks to the master,
+ * with the same bytes and the same baud-rate pacing (host USART model) as
+ * on target. With -d it opens a serial device instead (raw, 115200 8N1).
+ *
+ * Sequence: wait for the CLI prompt, `link bin`, empty frame + PING,
+ * SUBSCRIBE vehicle (and CAN), stream for the run time, UNSUBSCRIBE,
+ * STATS, TOP, TEXT, and check that the CLI prompt comes back.
+ *
+ * Reported: samples/s per stream, samples lost (sequence gaps), corrupt
+ * frames, link bytes/s, the ECU's own counters (STATS_REPLY) and its CPU
+ * time per task and interrupt (TOP_REPLY).
+ *
+ * Usage: hostlink_client [-v veh_ms] [-c can_ms|off] [-t seconds]
+ *                        [-d device] [vecu_host]
+ *   -v veh_ms   VEHICLE period (default 5)
+ *   -c can_ms   CAN stream: 0 = every frame (default), N = at most one per
+ *               N ms, off = not subscribed
+ *   -t seconds  streaming time (default 5)
+ *   -d device   serial device instead of a pty + vecu_host
+ *
+ *   ./build-host/hostlink_client -v 2 -t 10
+ *
+ * Exit status is 1 if the link could not be set up, a frame arrived
+ * corrupt, no samples arrived, the TOP reply was incomplete, or text mode
+ * did not come back.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hostlink_proto.h"
+
+typedef struct
+{
+    uint32_t samples;
+    uint32_t lost;          /* sequence gaps                      */
+    uint32_t reordered;     /* sequence went backwards            */
+    uint32_t next;          /* expected sequence number           */
+} Stream_t;
+
+typedef struct
+{
+    uint8_t  kind;
+    uint8_t  prio;
+    uint16_t win_x100;
+    uint16_t total_x100;
+    uint32_t win_cyc;
+    uint32_t calls;
+    uint32_t cyc_max;
+    char     name[HOSTLINK_TOP_NAME_LEN + 1U];
+} TopRow_t;
+
+#define TOP_MAX_ROWS 32U
+
+static int                s_fd = -1;
+static pid_t              s_child = -1;
+static HOSTLINK_Decoder_t s_dec;
+static int                s_binary;          /* parse frames, not text  */
+static Stream_t           s_stream[HOSTLINK_STREAM_COUNT];
+static uint32_t           s_corrupt;
+static uint64_t           s_bytes;
+static int                s_ackType = -1;    /* last ACK received       */
+static int                s_ackStatus;
+static int                s_haveStats;
+static uint32_t           s_ecu[HOSTLINK_STATS_WORDS];
+static int                s_topCount = -1;   /* rows announced; -1: none */
+static uint32_t           s_topSeen;         /* rows received            */
+static uint16_t           s_topLoad;
+static TopRow_t           s_top[TOP_MAX_ROWS];
+static char               s_text[64];        /* tail of the text stream */
+static uint32_t           s_textLen;
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* --------------------------------------------------------------------------
+ * Link setup
+ * -------------------------------------------------------------------------- */
+
+static int set_raw(int fd, int baud)
+{
+    struct termios t;
+
+    if (tcgetattr(fd, &t) != 0)
+    {
+        return -1;
+    }
+    cfmakeraw(&t);
+    if (baud)
+    {
+        cfsetispeed(&t, B115200);
+        cfsetospeed(&t, B115200);
+    }
+    return tcsetattr(fd, TCSANOW, &t);
+}
+
+/* vecu_host with its console on a new pty; returns the master */
+static int spawn_on_pty(const char *path)
+{
+    const int m = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (m < 0 || grantpt(m) != 0 || unlockpt(m) != 0)
+    {
+        perror("pty");
+        return -1;
+    }
+    const int s = open(ptsname(m), O_RDWR | O_NOCTTY);
+    if (s < 0 || set_raw(s, 0) != 0)
+    {
+        perror("pty slave");
+        return -1;
+    }
+
+    s_child = fork();
+    if (s_child < 0)
+    {
+        perror("fork");
+        return -1;
+    }
+    if (s_child == 0)
+    {
+        (void)setsid();
+        (void)dup2(s, STDIN_FILENO);
+        (void)dup2(s, STDOUT_FILENO);
+        close(s);
+        close(m);
+        execlp(path, path, (char *)NULL);
+        perror(path);
+        _exit(127);
+    }
+    close(s);
+    return m;
+}
+
+static void stop_child(void)
+{
+    if (s_child > 0)
+    {
+        (void)kill(s_child, SIGTERM);
+        (void)waitpid(s_child, NULL, 0);
+        s_child = -1;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Receive side
+ * -------------------------------------------------------------------------- */
+
+static void on_sample(HOSTLINK_Stream_t id, uint32_t seq)
+{
+    Stream_t *st = &s_stream[id];
+
+    if (seq > st->next)
+    {
+        st->lost += seq - st->next;
+    }
+    else if (seq < st->next)
+    {
+        st->reordered++;
+    }
+    st->next = seq + 1U;
+    st->samples++;
+}
+
+static void on_frame(const uint8_t *p, uint32_t len)
+{
+    switch (p[0])
+    {
+        case HOSTLINK_MSG_ACK:
+            if (len == 3U)
+            {
+                s_ackType   = p[1];
+                s_ackStatus = p[2];
+                if (p[1] == HOSTLINK_MSG_TEXT && p[2] == HOSTLINK_OK)
+                {
+                    s_binary = 0;   /* text follows this frame */
+                }
+                return;
+            }
+            break;
+
+        case HOSTLINK_MSG_VEHICLE:
+            if (len == 1U + HOSTLINK_VEHICLE_LEN)
+            {
+                on_sample(HOSTLINK_STREAM_VEHICLE, HOSTLINK_GetU32(&p[1]));
+                return;
+            }
+            break;
+
+        case HOSTLINK_MSG_CAN:
+            if (len >= 1U + HOSTLINK_CAN_LEN_MIN && len == 1U + HOSTLINK_CAN_LEN_MIN + p[13])
+            {
+                on_sample(HOSTLINK_STREAM_CAN, HOSTLINK_GetU32(&p[1]));
+                return;
+            }
+            break;
+
+        case HOSTLINK_MSG_STATS_REPLY:
+            if (len == 1U + 4U * HOSTLINK_STATS_WORDS)
+            {
+                for (uint32_t i = 0U; i < HOSTLINK_STATS_WORDS; i++)
+                {
+                    s_ecu[i] = HOSTLINK_GetU32(&p[1U + 4U * i]);
+                }
+                s_haveStats = 1;
+                return;
+            }
+            break;
+
+        case HOSTLINK_MSG_TOP_REPLY:
+            if (len == 1U + HOSTLINK_TOP_LEN && p[2] <= TOP_MAX_ROWS &&
+                (p[1] < p[2] || (p[1] == 0U && p[2] == 0U)))
+            {
+                s_topCount = p[2];
+                s_topLoad  = HOSTLINK_GetU16(&p[3]);
+                if (p[2] != 0U)
+                {
+                    TopRow_t *r = &s_top[p[1]];
+                    r->kind       = p[5];
+                    r->prio       = p[6];
+                    r->win_x100   = HOSTLINK_GetU16(&p[7]);
+                    r->total_x100 = HOSTLINK_GetU16(&p[9]);
+                    r->win_cyc    = HOSTLINK_GetU32(&p[11]);
+                    r->calls      = HOSTLINK_GetU32(&p[15]);
+                    r->cyc_max    = HOSTLINK_GetU32(&p[19]);
+                    memcpy(r->name, &p[23], HOSTLINK_TOP_NAME_LEN);
+                    r->name[HOSTLINK_TOP_NAME_LEN] = '\0';
+                    s_topSeen++;
+                }
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+    s_corrupt++;   /* valid CRC, but not a message this client knows */
+}
+
+static void on_text(uint8_t c)
+{
+    if (s_textLen == sizeof(s_text) - 1U)
+    {
+        memmove(s_text, &s_text[1], s_textLen - 1U);
+        s_textLen--;
+    }
+    s_text[s_textLen++] = (char)c;
+    s_text[s_textLen] = '\0';
+}
+
+/* Read for up to timeout seconds, or until done() holds */
+static int pump(double timeout, int (*done)(void))
+{
+    const double end = now_s() + timeout;
+    uint8_t buf[4096];
+
+    while (done == NULL || !done())
+    {
+        const double left = end - now_s();
+        if (left <= 0.0)
+        {
+            return 0;
+        }
+
+        struct pollfd pfd = { .fd = s_fd, .events = POLLIN };
+        const int r = poll(&pfd, 1, (int)(left * 1000.0) + 1);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) continue;
+
+        const ssize_t n = read(s_fd, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            return -1;   /* firmware gone */
+        }
+        s_bytes += (uint64_t)n;
+
+        for (ssize_t i = 0; i < n; i++)
+        {
+            if (!s_binary)
+            {
+                on_text(buf[i]);
+                continue;
+            }
+            const uint8_t *p;
+            uint32_t len;
+            const int f = HOSTLINK_DecodeByte(&s_dec, buf[i], &p, &len);
+            if (f > 0)
+            {
+                on_frame(p, len);
+            }
+            else if (f < 0)
+            {
+                s_corrupt++;
+            }
+        }
+    }
+    return 1;
+}
+
+static int have_prompt(void)
+{
+    return strstr(s_text, "> ") != NULL;
+}
+
+static int have_ack(void)
+{
+    return s_ackType >= 0;
+}
+
+static int have_stats(void)
+{
+    return s_haveStats;
+}
+
+static int have_top(void)
+{
+    return s_topCount >= 0 && s_topSeen >= (uint32_t)s_topCount;
+}
+
+/* --------------------------------------------------------------------------
+ * Send side
+ * -------------------------------------------------------------------------- */
+
+static void send_bytes(const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    while (len > 0U)
+    {
+        const ssize_t n = write(s_fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+static void send_frame(const uint8_t *payload, uint32_t len)
+{
+    uint8_t frame[HOSTLINK_MAX_FRAME];
+    send_bytes(frame, HOSTLINK_Encode(frame, payload, len));
+}
+
+/* Send a request and wait for its ACK; retried, since frames can be lost */
+static int request(const uint8_t *payload, uint32_t len)
+{
+    for (int attempt = 0; attempt < 3; attempt++)
+    {
+        s_ackType = -1;
+        send_frame(payload, len);
+        if (pump(1.0, have_ack) > 0 && s_ackType == payload[0])
+        {
+            return s_ackStatus == HOSTLINK_OK;
+        }
+    }
+    return 0;
+}
+
+static int subscribe(HOSTLINK_Stream_t id, uint16_t period_ms)
+{
+    uint8_t p[4] = { HOSTLINK_MSG_SUBSCRIBE, (uint8_t)id };
+
+    HOSTLINK_PutU16(&p[2], period_ms);
+    return request(p, sizeof(p));
+}
+
+/* --------------------------------------------------------------------------
+ * Main
+ * -------------------------------------------------------------------------- */
+
+static int fail(const char *what)
+{
+    printf("  FAIL: %s\n", what);
+    stop_child();
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned veh_ms = 5U;
+    long can_ms = 0;
+    double run_s = 5.0;
+    const char *device = NULL;
+    char host[4096] = "vecu_host";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "v:c:t:d:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'v': veh_ms = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'c': can_ms = (strcmp(optarg, "off") == 0) ? -1 : strtol(optarg, NULL, 0); break;
+            case 't': run_s  = strtod(optarg, NULL); break;
+            case 'd': device = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-v veh_ms] [-c can_ms|off] [-t seconds]"
+                                " [-d device] [vecu_host]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (veh_ms == 0U || veh_ms > 0xFFFFU || can_ms > 0xFFFF)
+    {
+        fprintf(stderr, "%s: periods are 1..65535 ms (CAN: 0 = every frame)\n", argv[0]);
+        return 1;
+    }
+    if (optind < argc)
+    {
+        snprintf(host, sizeof(host), "%s", argv[optind]);
+    }
+    else if (strchr(argv[0], '/') != NULL)
+    {
+        /* vecu_host from the same build directory */
+        snprintf(host, sizeof(host), "%.*s/vecu_host",
+                 (int)(strrchr(argv[0], '/') - argv[0]), argv[0]);
+    }
+
+    if (device != NULL)
+    {
+        s_fd = open(device, O_RDWR | O_NOCTTY);
+        if (s_fd < 0 || set_raw(s_fd, 1) != 0)
+        {
+            perror(device);
+            return 1;
+        }
+    }
+    else if ((s_fd = spawn_on_pty(host)) < 0)
+    {
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("hostlink_client: %s, %.1f s, vehicle every %u ms, CAN %s\n",
+           device ? device : "vecu_host on a pty", run_s, veh_ms,
+           can_ms < 0 ? "off" : can_ms == 0 ? "every frame" : "rate-limited");
+
+    /* Text mode: wait for the prompt, then switch */
+    send_bytes("\r", 1U);
+    if (pump(5.0, have_prompt) <= 0)
+    {
+        return fail("no CLI prompt");
+    }
+    HOSTLINK_DecoderInit(&s_dec, 0U);   /* the command's reply is text */
+    s_binary = 1;
+    send_bytes("link bin\r", 9U);
+    (void)pump(0.2, NULL);
+
+    static const uint8_t delim = HOSTLINK_DELIM;
+    static const uint8_t ping[1] = { HOSTLINK_MSG_PING };
+    send_bytes(&delim, 1U);
+    if (!request(ping, sizeof(ping)))
+    {
+        return fail("no answer to PING in binary mode");
+    }
+
+    /* Stream */
+    if (!subscribe(HOSTLINK_STREAM_VEHICLE, (uint16_t)veh_ms) ||
+        (can_ms >= 0 && !subscribe(HOSTLINK_STREAM_CAN, (uint16_t)can_ms)))
+    {
+        return fail("SUBSCRIBE not acknowledged");
+    }
+    /* Rates over the run time; losses since SUBSCRIBE */
+    const uint32_t veh0 = s_stream[HOSTLINK_STREAM_VEHICLE].samples;
+    const uint32_t can0 = s_stream[HOSTLINK_STREAM_CAN].samples;
+    const uint64_t bytes0 = s_bytes;
+    const double t0 = now_s();
+    (void)pump(run_s, NULL);
+    const double dt = now_s() - t0;
+    const uint64_t bytes = s_bytes - bytes0;
+    Stream_t veh = s_stream[HOSTLINK_STREAM_VEHICLE];
+    Stream_t can = s_stream[HOSTLINK_STREAM_CAN];
+    veh.samples -= veh0;
+    can.samples -= can0;
+
+    /* Stop, collect the ECU counters, back to text */
+    static const uint8_t unsub[2] = { HOSTLINK_MSG_UNSUBSCRIBE, HOSTLINK_STREAM_ALL };
+    static const uint8_t stats[1] = { HOSTLINK_MSG_STATS };
+    static const uint8_t top[1]   = { HOSTLINK_MSG_TOP };
+    static const uint8_t text[1]  = { HOSTLINK_MSG_TEXT };
+    const int unsub_ok = request(unsub, sizeof(unsub));
+    (void)pump(0.2, NULL);
+    send_frame(stats, sizeof(stats));
+    (void)pump(1.0, have_stats);
+    send_frame(top, sizeof(top));
+    (void)pump(1.0, have_top);
+    s_textLen = 0U;
+    s_text[0] = '\0';
+    const int text_ok = request(text, sizeof(text)) && pump(1.0, have_prompt) > 0;
+
+    printf("  vehicle: %8lu samples (%7.1f /s), lost %lu\n",
+           (unsigned long)veh.samples, veh.samples / dt, (unsigned long)veh.lost);
+    if (can_ms >= 0)
+    {
+        printf("  CAN:     %8lu frames  (%7.1f /s), lost %lu\n",
+               (unsigned long)can.samples, can.samples / dt, (unsigned long)can.lost);
+    }
+    printf("  link:    %8llu bytes   (%7.0f B/s), corrupt frames %lu, out of order %lu\n",
+           (unsigned long long)bytes, bytes / dt, (unsigned long)s_corrupt,
+           (unsigned long)(veh.reordered + can.reordered));
+    if (s_haveStats)
+    {
+        printf("  ECU:     rx=%lu err=%lu tx=%lu dropped=%lu vehicle=%lu can=%lu"
+               " skipped=%lu late=%lu\n",
+               (unsigned long)s_ecu[0], (unsigned long)s_ecu[1], (unsigned long)s_ecu[2],
+               (unsigned long)s_ecu[3], (unsigned long)s_ecu[4], (unsigned long)s_ecu[5],
+               (unsigned long)s_ecu[6], (unsigned long)s_ecu[7]);
+    }
+
+    if (s_topCount == 0)
+    {
+        printf("  top:     no window closed yet\n");
+    }
+    else if (have_top())
+    {
+        printf("  top:     CPU load %u.%02u %%\n",
+               (unsigned)(s_topLoad / 100U), (unsigned)(s_topLoad % 100U));
+        for (int i = 0; i < s_topCount; i++)
+        {
+            const TopRow_t *r = &s_top[i];
+            printf("    %s %-16s %3u.%02u %%  total %3u.%02u %%  %10lu cyc",
+                   (r->kind == 0U) ? "task" : "isr ", r->name,
+                   (unsigned)(r->win_x100 / 100U), (unsigned)(r->win_x100 % 100U),
+                   (unsigned)(r->total_x100 / 100U), (unsigned)(r->total_x100 % 100U),
+                   (unsigned long)r->win_cyc);
+            if (r->kind != 0U)
+            {
+                printf("  calls=%lu max=%lu", (unsigned long)r->calls,
+                       (unsigned long)r->cyc_max);
+            }
+            printf("\n");
+        }
+    }
+
+    if (s_corrupt != 0U)        return fail("corrupt frames");
+    if (veh.samples == 0U)      return fail("no vehicle samples");
+    if (!unsub_ok)              return fail("UNSUBSCRIBE not acknowledged");
+    if (!s_haveStats)           return fail("no STATS_REPLY");
+    if (!have_top())            return fail("TOP_REPLY missing or incomplete");
+    if (!text_ok)               return fail("text mode did not come back");
+
+    printf("  text mode restored\n");
+    stop_child();
+    return 0;
+}
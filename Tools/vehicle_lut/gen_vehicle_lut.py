@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""
+gen_vehicle_lut.py - precompute the longitudinal vehicle model tables.
+
+The vehicle parameters below (mass, drag, tyres, gearbox, torque curve,
+cooling system) are turned into a header of calibration maps
+(vehicle_map.h) in the model's own units, so Vehicle_Update() does no
+square roots, powers or transcendental math at run time:
+
+    speed axis (km/h)        resistance (km/h/s), radiator airflow factor
+    rpm axis                 full-load engine torque (N*m)
+    rpm x load               coolant heat input (degC/s)
+    coolant axis (degC)      thermostat + fan conductance factor
+    per gear                 rpm per km/h, km/h/s per N*m, shift speeds
+
+Each axis gets its breakpoints, the reciprocal of every segment width
+(so interpolation needs no division) and a search method: UNIFORM when
+the breakpoints are evenly spaced, otherwise HINT. Breakpoints are placed
+where the curves bend (idle, torque peak, thermostat, fan), not on a
+fixed grid.
+
+Usage: gen_vehicle_lut.py <out.h>
+"""
+
+import math
+import sys
+from typing import List
+
+# --------------------------------------------------------------------------
+# Vehicle parameters (compact car, six-speed gearbox)
+# --------------------------------------------------------------------------
+
+MASS_KG = 1300.0
+CD = 0.32                 # drag coefficient
+FRONTAL_AREA_M2 = 2.2
+AIR_DENSITY = 1.2         # kg/m^3
+CRR = 0.012               # rolling resistance coefficient
+G = 9.81
+WHEEL_RADIUS_M = 0.31
+FINAL_DRIVE = 4.1
+DRIVELINE_EFF = 0.90
+GEARS = [3.60, 2.10, 1.40, 1.05, 0.85, 0.70]
+
+IDLE_RPM = 800
+LIMIT_RPM = 7000
+
+# Full-load torque curve (rpm, N*m), as from a dyno sheet
+TORQUE_CURVE = [
+    (0, 90), (800, 128), (1200, 150), (1600, 176), (2000, 195),
+    (2500, 210), (3000, 220), (3500, 225), (4000, 225), (4500, 220),
+    (5000, 210), (5500, 195), (6000, 175), (6500, 140), (7000, 0),
+]
+
+# Shift schedule: engine rpm at zero and at full load (blended by load)
+UPSHIFT_RPM_LIGHT = 2200
+UPSHIFT_RPM_FULL = 6000
+DOWNSHIFT_RPM_LIGHT = 1200
+DOWNSHIFT_RPM_FULL = 2700
+
+# Cooling system, all rates in degC/s
+AMBIENT_C = 25.0
+HEAT_PER_RPM = 6.25e-5    # friction and pumping heat at zero load
+HEAT_PER_KW = 0.04        # share of brake power that ends up in the coolant
+COOL_PASSIVE = 0.0005     # block losses per degC above ambient
+COOL_RADIATOR = 0.03      # radiator per degC above ambient, fully open, full airflow
+AIRFLOW_IDLE = 0.25       # airflow factor at standstill
+AIRFLOW_FULL_KPH = 100.0  # airflow factor 1.0 from this speed on
+
+# Thermostat closed below 82, open at 95; fan (x2) from 100 to 101 degC
+RADIATOR_CURVE = [(-40.0, 0.0), (82.0, 0.0), (95.0, 1.0), (100.0, 1.0),
+                  (101.0, 2.0), (140.0, 2.0)]
+
+# Axes
+SPEED_STEP_KPH = 5.0
+SPEED_MAX_KPH = 260.0
+LOAD_STEP = 0.25
+
+KPH = 1.0 / 3.6           # m/s per km/h
+
+
+def fail(msg: str) -> None:
+    sys.exit("gen_vehicle_lut.py: error: " + msg)
+
+
+def uniform(lo: float, hi: float, step: float) -> List[float]:
+    n = int(round((hi - lo) / step)) + 1
+    return [lo + i * step for i in range(n)]
+
+
+def interp(curve, x: float) -> float:
+    for (x0, y0), (x1, y1) in zip(curve, curve[1:]):
+        if x <= x1:
+            return y0 + (y1 - y0) * (x - x0) / (x1 - x0)
+    return curve[-1][1]
+
+
+def resistance(kph: float) -> float:
+    """Rolling + aerodynamic deceleration in km/h/s (no force at rest)."""
+    v = kph * KPH
+    roll = CRR * MASS_KG * G * min(kph / SPEED_STEP_KPH, 1.0)
+    aero = 0.5 * AIR_DENSITY * CD * FRONTAL_AREA_M2 * v * v
+    return (roll + aero) / MASS_KG * 3.6
+
+
+def airflow(kph: float) -> float:
+    return AIRFLOW_IDLE + (1.0 - AIRFLOW_IDLE) * min(kph / AIRFLOW_FULL_KPH, 1.0)
+
+
+def heat(rpm: float, load: float) -> float:
+    """Coolant heat input in degC/s: idle losses + share of brake power."""
+    kw = load * interp(TORQUE_CURVE, rpm) * rpm * 2.0 * math.pi / 60.0 / 1000.0
+    return HEAT_PER_RPM * rpm + HEAT_PER_KW * kw
+
+
+def rpm_per_kph(ratio: float) -> float:
+    return ratio * FINAL_DRIVE / (2.0 * math.pi * WHEEL_RADIUS_M) * 60.0 * KPH
+
+
+def accel_per_nm(ratio: float) -> float:
+    """km/h/s of acceleration per N*m of engine torque."""
+    return ratio * FINAL_DRIVE * DRIVELINE_EFF / (WHEEL_RADIUS_M * MASS_KG) * 3.6
+
+
+def check() -> None:
+    if TORQUE_CURVE[-1][0] != LIMIT_RPM:
+        fail("torque curve must end at LIMIT_RPM")
+    for curve in (TORQUE_CURVE, RADIATOR_CURVE):
+        xs = [x for x, _ in curve]
+        if any(b <= a for a, b in zip(xs, xs[1:])):
+            fail("breakpoints must be strictly ascending")
+    for a, b in zip(GEARS, GEARS[1:]):
+        step = a / b
+        # An upshift must land above the downshift point and vice versa
+        for up, down in ((UPSHIFT_RPM_LIGHT, DOWNSHIFT_RPM_LIGHT),
+                         (UPSHIFT_RPM_FULL, DOWNSHIFT_RPM_FULL)):
+            if up / step <= down or down * step >= up:
+                fail("shift points hunt between ratios %.2f and %.2f" % (a, b))
+    if UPSHIFT_RPM_FULL >= LIMIT_RPM:
+        fail("full-load upshift above the rev limit")
+
+
+def c_float(v: float) -> str:
+    s = "%.7g" % v
+    if "e" not in s and "." not in s:
+        s += ".0"
+    return s + "f"
+
+
+def define(w, name: str, v: float, comment: str) -> None:
+    value = c_float(v)
+    if v < 0:
+        value = "(" + value + ")"
+    line = "#define %-28s %s" % (name, value)
+    if comment:
+        line = "%-50s /* %s */" % (line, comment)
+    w(line)
+
+
+def table(w, name: str, unit: str, values: List[float], per_line: int = 6) -> None:
+    w("static const float %s[%d] = {   /* %s */" % (name, len(values), unit))
+    for i in range(0, len(values), per_line):
+        w("    " + ", ".join("%13s" % c_float(v) for v in values[i:i + per_line]) + ",")
+    w("};")
+    w("")
+
+
+def axis(w, name: str, unit: str, bp: List[float]) -> None:
+    widths = [b - a for a, b in zip(bp, bp[1:])]
+    even = all(abs(d - widths[0]) < 1e-9 * abs(widths[0]) for d in widths)
+    table(w, name + "_BP", unit, bp)
+    table(w, name + "_INV", "1 / segment width", [1.0 / d for d in widths])
+    w("static const VehicleMapAxis_t %s_AXIS = {" % name)
+    w("    %s_BP, %s_INV, %dU, %s" %
+      (name, name, len(bp), "VEHICLE_MAP_UNIFORM" if even else "VEHICLE_MAP_HINT"))
+    w("};")
+    w("")
+
+
+def banner(w, text: str) -> None:
+    w("/* " + "-" * 74)
+    w(" * " + text)
+    w(" * " + "-" * 74 + " */")
+    w("")
+
+
+def gen() -> str:
+    o: List[str] = []
+    w = o.append
+
+    speeds = uniform(0.0, SPEED_MAX_KPH, SPEED_STEP_KPH)
+    rpms = [float(r) for r, _ in TORQUE_CURVE]
+    loads = uniform(0.0, 1.0, LOAD_STEP)
+    temps = [t for t, _ in RADIATOR_CURVE]
+    rpk = [rpm_per_kph(r) for r in GEARS]
+
+    w("/* Generated by Tools/vehicle_lut/gen_vehicle_lut.py - do not edit. */")
+    w("")
+    w("#ifndef VEHICLE_LUT_H")
+    w("#define VEHICLE_LUT_H")
+    w("")
+    w("#include \"vehicle_map.h\"")
+    w("")
+    w("/*")
+    w(" * Module: Vehicle model tables (vehicle_lut)")
+    w(" *")
+    w(" * Role:")
+    w(" *   - Calibration maps of the longitudinal vehicle model in vehicle.c")
+    w(" *     (VEHICLE_DYNAMICS=1), precomputed from the vehicle parameters")
+    w(" *     in the generator. Curves over one axis share its position, so")
+    w(" *     the model searches each axis once per step.")
+    w(" *")
+    w(" * Vehicle: %.0f kg, Cd %.2f, A %.1f m^2, Crr %.3f, wheel radius %.2f m," %
+      (MASS_KG, CD, FRONTAL_AREA_M2, CRR, WHEEL_RADIUS_M))
+    w(" * final drive %.2f, gears %s." %
+      (FINAL_DRIVE, " / ".join("%.2f" % r for r in GEARS)))
+    w(" */")
+    w("")
+    w("#define VEHICLE_LUT_GEARS            %dU" % len(GEARS))
+    w("#define VEHICLE_LUT_IDLE_RPM         %d.0f" % IDLE_RPM)
+    w("#define VEHICLE_LUT_LIMIT_RPM        %d.0f" % LIMIT_RPM)
+    w("")
+    w("/* Coolant heat flow, degC/s */")
+    define(w, "VEHICLE_LUT_AMBIENT_C", AMBIENT_C, "")
+    define(w, "VEHICLE_LUT_COOL_PASSIVE", COOL_PASSIVE, "x (T - ambient)")
+    define(w, "VEHICLE_LUT_COOL_RADIATOR", COOL_RADIATOR, "x airflow x radiator x (T - ambient)")
+    w("")
+
+    banner(w, "Speed axis: resistance, radiator airflow")
+    axis(w, "VEHICLE_LUT_SPEED", "km/h", speeds)
+    table(w, "VEHICLE_LUT_RESIST", "km/h/s, rolling + drag",
+          [resistance(v) for v in speeds])
+    table(w, "VEHICLE_LUT_AIRFLOW", "radiator airflow factor",
+          [airflow(v) for v in speeds])
+
+    banner(w, "RPM axis: full-load torque; RPM x load: coolant heat input")
+    axis(w, "VEHICLE_LUT_RPM", "rpm", rpms)
+    table(w, "VEHICLE_LUT_TORQUE", "N*m, full load", [float(t) for _, t in TORQUE_CURVE])
+    axis(w, "VEHICLE_LUT_LOAD", "fraction of full-load torque", loads)
+    table(w, "VEHICLE_LUT_HEAT_Z", "degC/s, [load][rpm]",
+          [heat(r, l) for l in loads for r in rpms], per_line=5)
+    w("static const VehicleMap2D_t VEHICLE_LUT_HEAT = {")
+    w("    &VEHICLE_LUT_RPM_AXIS, &VEHICLE_LUT_LOAD_AXIS, VEHICLE_LUT_HEAT_Z")
+    w("};")
+    w("")
+
+    banner(w, "Coolant axis: thermostat opening x fan")
+    axis(w, "VEHICLE_LUT_TEMP", "degC", temps)
+    table(w, "VEHICLE_LUT_RADIATOR_Z", "thermostat opening x fan",
+          [r for _, r in RADIATOR_CURVE])
+    w("static const VehicleMap1D_t VEHICLE_LUT_RADIATOR = {")
+    w("    &VEHICLE_LUT_TEMP_AXIS, VEHICLE_LUT_RADIATOR_Z")
+    w("};")
+    w("")
+
+    banner(w, "Gearbox")
+    table(w, "VEHICLE_LUT_RPM_PER_KPH", "per gear", rpk)
+    table(w, "VEHICLE_LUT_ACCEL_PER_NM", "km/h/s per N*m, per gear",
+          [accel_per_nm(r) for r in GEARS])
+    table(w, "VEHICLE_LUT_UP_KPH", "upshift speed at zero load, per gear",
+          [UPSHIFT_RPM_LIGHT / k for k in rpk])
+    table(w, "VEHICLE_LUT_UP_FULL_KPH", "upshift speed at full load, per gear",
+          [UPSHIFT_RPM_FULL / k for k in rpk])
+    table(w, "VEHICLE_LUT_DOWN_KPH", "downshift speed at zero load, per gear",
+          [DOWNSHIFT_RPM_LIGHT / k for k in rpk])
+    table(w, "VEHICLE_LUT_DOWN_FULL_KPH", "downshift speed at full load, per gear",
+          [DOWNSHIFT_RPM_FULL / k for k in rpk])
+    w("#endif /* VEHICLE_LUT_H */")
+    return "\n".join(o) + "\n"
+
+
+def main() -> None:
+    if len(sys.argv) != 2:
+        sys.exit("usage: gen_vehicle_lut.py <out.h>")
+    check()
+    with open(sys.argv[1], "w", encoding="utf-8", newline="\n") as f:
+        f.write(gen())
+
+
+if __name__ == "__main__":
+    main()